@@ -0,0 +1,185 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures throughput of passing data between two threads through an
+ * avs_buffer_t, comparing the lock-free SPSC mode against a plain circular
+ * buffer guarded by a mutex.
+ *
+ * Usage: avs_buffer_spsc_benchmark [buffer_size [chunk_size [megabytes]]]
+ */
+
+#include <avs_commons_posix_init.h>
+
+#include <avsystem/commons/avs_buffer.h>
+#include <avsystem/commons/avs_defs.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    avs_buffer_t *buffer;
+    pthread_mutex_t *mutex;
+    size_t chunk_size;
+    size_t total_bytes;
+} benchmark_args_t;
+
+static void lock(const benchmark_args_t *args) {
+    if (args->mutex) {
+        pthread_mutex_lock(args->mutex);
+    }
+}
+
+static void unlock(const benchmark_args_t *args) {
+    if (args->mutex) {
+        pthread_mutex_unlock(args->mutex);
+    }
+}
+
+static void *producer(void *args_) {
+    const benchmark_args_t *args = (const benchmark_args_t *) args_;
+    char *chunk = (char *) malloc(args->chunk_size);
+    if (!chunk) {
+        abort();
+    }
+    memset(chunk, 'x', args->chunk_size);
+    size_t sent = 0;
+    while (sent < args->total_bytes) {
+        size_t to_send = AVS_MIN(args->chunk_size, args->total_bytes - sent);
+        lock(args);
+        to_send = AVS_MIN(to_send, avs_buffer_space_left(args->buffer));
+        if (to_send) {
+            avs_buffer_append_bytes(args->buffer, chunk, to_send);
+        }
+        unlock(args);
+        if (to_send) {
+            sent += to_send;
+        } else {
+            sched_yield();
+        }
+    }
+    free(chunk);
+    return NULL;
+}
+
+static void consume(const benchmark_args_t *args, char *chunk) {
+    size_t received = 0;
+    while (received < args->total_bytes) {
+        avs_buffer_const_span_t spans[AVS_BUFFER_MAX_SPANS];
+        size_t consumed = 0;
+        lock(args);
+        size_t num_spans = avs_buffer_data_spans(args->buffer, spans);
+        for (size_t i = 0; i < num_spans && consumed < args->chunk_size; ++i) {
+            size_t size = AVS_MIN(spans[i].size, args->chunk_size - consumed);
+            memcpy(chunk + consumed, spans[i].data, size);
+            consumed += size;
+        }
+        if (consumed) {
+            avs_buffer_consume_bytes(args->buffer, consumed);
+        }
+        unlock(args);
+        if (consumed) {
+            received += consumed;
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static int run(const char *name,
+               avs_buffer_t *buffer,
+               pthread_mutex_t *mutex,
+               size_t chunk_size,
+               size_t total_bytes) {
+    benchmark_args_t args = {
+        .buffer = buffer,
+        .mutex = mutex,
+        .chunk_size = chunk_size,
+        .total_bytes = total_bytes
+    };
+    char *chunk = (char *) malloc(chunk_size);
+    if (!chunk) {
+        return -1;
+    }
+    pthread_t thread;
+    double start = now();
+    if (pthread_create(&thread, NULL, producer, &args)) {
+        free(chunk);
+        return -1;
+    }
+    consume(&args, chunk);
+    pthread_join(thread, NULL);
+    double elapsed = now() - start;
+    free(chunk);
+    printf("%-24s %10.1f MB/s (%.3f s)\n", name,
+           (double) total_bytes / elapsed / 1e6, elapsed);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    size_t buffer_size = argc > 1 ? strtoul(argv[1], NULL, 0) : 64 * 1024;
+    size_t chunk_size = argc > 2 ? strtoul(argv[2], NULL, 0) : 1024;
+    size_t total_bytes =
+            (argc > 3 ? strtoul(argv[3], NULL, 0) : 1024) * 1024 * 1024;
+    if (!buffer_size || !chunk_size) {
+        fprintf(stderr, "usage: %s [buffer_size [chunk_size [megabytes]]]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+    printf("buffer size %zu B, chunk size %zu B, %zu MB transferred\n",
+           buffer_size, chunk_size, total_bytes / (1024 * 1024));
+
+    static const struct {
+        const char *name;
+        avs_buffer_mode_t mode;
+        bool spsc;
+    } VARIANTS[] = {
+        { "mutex, circular", AVS_BUFFER_MODE_CIRCULAR, false },
+        { "spsc, circular", AVS_BUFFER_MODE_CIRCULAR, true },
+        { "spsc, mirrored", AVS_BUFFER_MODE_CIRCULAR_MIRRORED, true }
+    };
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    int result = EXIT_SUCCESS;
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(VARIANTS); ++i) {
+        avs_buffer_t *buffer;
+        if (VARIANTS[i].spsc
+                ? avs_buffer_create_spsc(&buffer, buffer_size,
+                                         VARIANTS[i].mode)
+                : avs_buffer_create_with_mode(&buffer, buffer_size,
+                                              VARIANTS[i].mode)) {
+            fprintf(stderr, "%s: could not create buffer\n", VARIANTS[i].name);
+            result = EXIT_FAILURE;
+            continue;
+        }
+        if (run(VARIANTS[i].name, buffer, VARIANTS[i].spsc ? NULL : &mutex,
+                chunk_size, total_bytes)) {
+            result = EXIT_FAILURE;
+        }
+        avs_buffer_free(&buffer);
+    }
+    return result;
+}
@@ -0,0 +1,314 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures throughput of downloading a gzip-encoded, chunked HTTP response
+ * body through avs_http, from a server running in another thread over the
+ * loopback interface. For reference, the time of decompressing the same data
+ * in memory with plain zlib is also reported.
+ *
+ * Usage: avs_http_gzip_download_benchmark [megabytes [read_size [rounds]]]
+ */
+
+#include <avs_commons_posix_init.h>
+
+#include <zlib.h>
+
+#include <avsystem/commons/avs_http.h>
+#include <avsystem/commons/avs_stream.h>
+#include <avsystem/commons/avs_url.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CHUNK_SIZE (16 * 1024)
+
+typedef struct {
+    int listen_fd;
+    const unsigned char *body;
+    size_t body_size;
+    size_t rounds;
+} server_args_t;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+/* Text-like data built from a small dictionary, compressing roughly 3:1. */
+static unsigned char *generate_plain(size_t size) {
+    static const char *const WORDS[] = {
+        "lorem ",   "ipsum ",  "dolor ",       "sit ",        "amet ",
+        "elit ",    "sed ",    "consectetur ", "adipiscing ", "do ",
+        "eiusmod ", "tempor ", "incididunt ",  "ut ",         "labore ",
+        "et ",      "dolore ", "magna ",       "aliqua\n",    "enim "
+    };
+    unsigned char *data = (unsigned char *) malloc(size);
+    if (!data) {
+        return NULL;
+    }
+    uint32_t state = 12345;
+    size_t offset = 0;
+    while (offset < size) {
+        state = state * 1103515245 + 12345;
+        const char *word = WORDS[(state >> 16) % AVS_ARRAY_SIZE(WORDS)];
+        size_t length = AVS_MIN(strlen(word), size - offset);
+        memcpy(data + offset, word, length);
+        offset += length;
+    }
+    return data;
+}
+
+static unsigned char *
+gzip(const unsigned char *plain, size_t plain_size, size_t *out_size) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY)
+            != Z_OK) {
+        return NULL;
+    }
+    size_t capacity = deflateBound(&zs, (uLong) plain_size);
+    unsigned char *result = (unsigned char *) malloc(capacity);
+    if (result) {
+        zs.next_in = (Bytef *) (intptr_t) plain;
+        zs.avail_in = (uInt) plain_size;
+        zs.next_out = result;
+        zs.avail_out = (uInt) capacity;
+        if (deflate(&zs, Z_FINISH) != Z_STREAM_END) {
+            free(result);
+            result = NULL;
+        }
+        *out_size = capacity - zs.avail_out;
+    }
+    deflateEnd(&zs);
+    return result;
+}
+
+static int send_all(int fd, const void *data, size_t size) {
+    while (size) {
+        ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return -1;
+        }
+        data = (const char *) data + sent;
+        size -= (size_t) sent;
+    }
+    return 0;
+}
+
+static int serve_one(int fd, const server_args_t *args) {
+    char request[4096];
+    size_t request_size = 0;
+    request[0] = '\0';
+    while (!strstr(request, "\r\n\r\n")) {
+        ssize_t received = recv(fd, request + request_size,
+                                sizeof(request) - 1 - request_size, 0);
+        if (received <= 0) {
+            return -1;
+        }
+        request_size += (size_t) received;
+        request[request_size] = '\0';
+    }
+    static const char HEADERS[] = "HTTP/1.1 200 OK\r\n"
+                                  "Content-Encoding: gzip\r\n"
+                                  "Transfer-Encoding: chunked\r\n"
+                                  "\r\n";
+    if (send_all(fd, HEADERS, sizeof(HEADERS) - 1)) {
+        return -1;
+    }
+    for (size_t offset = 0; offset < args->body_size; offset += CHUNK_SIZE) {
+        size_t size = AVS_MIN(CHUNK_SIZE, args->body_size - offset);
+        char header[32];
+        int header_size = snprintf(header, sizeof(header), "%zx\r\n", size);
+        if (send_all(fd, header, (size_t) header_size)
+                || send_all(fd, args->body + offset, size)
+                || send_all(fd, "\r\n", 2)) {
+            return -1;
+        }
+    }
+    if (send_all(fd, "0\r\n\r\n", 5)) {
+        return -1;
+    }
+    /* wait for the client to close the connection */
+    while (recv(fd, request, sizeof(request), 0) > 0) {
+    }
+    return 0;
+}
+
+static void *server(void *args_) {
+    const server_args_t *args = (const server_args_t *) args_;
+    for (size_t i = 0; i < args->rounds; ++i) {
+        int fd = accept(args->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            break;
+        }
+        int result = serve_one(fd, args);
+        close(fd);
+        if (result) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+static int download(avs_http_t *http,
+                    const avs_url_t *url,
+                    char *buffer,
+                    size_t read_size,
+                    size_t *out_total) {
+    avs_stream_t *stream = NULL;
+    if (avs_is_err(avs_http_open_stream(&stream, http, AVS_HTTP_GET,
+                                        AVS_HTTP_CONTENT_IDENTITY, url, NULL,
+                                        NULL))
+            || avs_is_err(avs_stream_finish_message(stream))) {
+        avs_stream_cleanup(&stream);
+        return -1;
+    }
+    bool message_finished = false;
+    *out_total = 0;
+    while (!message_finished) {
+        size_t bytes_read;
+        if (avs_is_err(avs_stream_read(stream, &bytes_read, &message_finished,
+                                       buffer, read_size))) {
+            avs_stream_cleanup(&stream);
+            return -1;
+        }
+        *out_total += bytes_read;
+    }
+    return avs_is_ok(avs_stream_cleanup(&stream)) ? 0 : -1;
+}
+
+static double inflate_in_memory(const unsigned char *body,
+                                size_t body_size,
+                                char *buffer,
+                                size_t read_size) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, 15 + 16) != Z_OK) {
+        return -1.0;
+    }
+    double start = now();
+    zs.next_in = (Bytef *) (intptr_t) body;
+    zs.avail_in = (uInt) body_size;
+    int result;
+    do {
+        zs.next_out = (Bytef *) buffer;
+        zs.avail_out = (uInt) read_size;
+        result = inflate(&zs, Z_NO_FLUSH);
+    } while (result == Z_OK);
+    double elapsed = now() - start;
+    inflateEnd(&zs);
+    return result == Z_STREAM_END ? elapsed : -1.0;
+}
+
+int main(int argc, char *argv[]) {
+    size_t plain_size =
+            (argc > 1 ? strtoul(argv[1], NULL, 0) : 64) * 1024 * 1024;
+    size_t read_size = argc > 2 ? strtoul(argv[2], NULL, 0) : 4096;
+    size_t rounds = argc > 3 ? strtoul(argv[3], NULL, 0) : 5;
+    if (!plain_size || !read_size || !rounds) {
+        fprintf(stderr, "usage: %s [megabytes [read_size [rounds]]]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    unsigned char *plain = generate_plain(plain_size);
+    size_t body_size;
+    unsigned char *body = plain ? gzip(plain, plain_size, &body_size) : NULL;
+    free(plain);
+    char *buffer = (char *) malloc(read_size);
+    if (!body || !buffer) {
+        fprintf(stderr, "could not prepare data\n");
+        return EXIT_FAILURE;
+    }
+    printf("%zu MB uncompressed, %zu B compressed, read size %zu B\n",
+           plain_size / (1024 * 1024), body_size, read_size);
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    if (listen_fd < 0
+            || bind(listen_fd, (struct sockaddr *) &addr, sizeof(addr))
+            || listen(listen_fd, 1)
+            || getsockname(listen_fd, (struct sockaddr *) &addr, &addr_len)) {
+        fprintf(stderr, "could not create server socket\n");
+        return EXIT_FAILURE;
+    }
+    server_args_t args = {
+        .listen_fd = listen_fd,
+        .body = body,
+        .body_size = body_size,
+        .rounds = rounds
+    };
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, server, &args)) {
+        return EXIT_FAILURE;
+    }
+
+    char url_string[64];
+    snprintf(url_string, sizeof(url_string), "http://127.0.0.1:%u/",
+             (unsigned) ntohs(addr.sin_port));
+    avs_url_t *url = avs_url_parse(url_string);
+    avs_http_t *http = avs_http_new(&AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    int result = EXIT_SUCCESS;
+    double best = -1.0;
+    for (size_t i = 0; url && http && i < rounds; ++i) {
+        size_t total;
+        double start = now();
+        if (download(http, url, buffer, read_size, &total)
+                || total != plain_size) {
+            fprintf(stderr, "download failed\n");
+            result = EXIT_FAILURE;
+            /* unblock the server thread if it is waiting in accept() */
+            shutdown(listen_fd, SHUT_RDWR);
+            break;
+        }
+        double elapsed = now() - start;
+        if (best < 0.0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    pthread_join(thread, NULL);
+
+    if (best >= 0.0) {
+        printf("%-24s %10.1f MB/s (%.3f s)\n", "avs_http download",
+               (double) plain_size / best / 1e6, best);
+    }
+    double reference = inflate_in_memory(body, body_size, buffer, read_size);
+    if (reference >= 0.0) {
+        printf("%-24s %10.1f MB/s (%.3f s)\n", "zlib in memory",
+               (double) plain_size / reference / 1e6, reference);
+    }
+    avs_http_free(http);
+    avs_url_free(url);
+    close(listen_fd);
+    free(buffer);
+    free(body);
+    return result;
+}
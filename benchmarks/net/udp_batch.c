@@ -0,0 +1,234 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures throughput of UDP datagrams passed over loopback between two
+ * threads, comparing per-datagram avs_net_socket_send_to() /
+ * avs_net_socket_receive_from() against avs_net_socket_send_batch() /
+ * avs_net_socket_receive_batch() with various batch sizes.
+ *
+ * The sender does not wait for the receiver, so some datagrams may be dropped
+ * by the kernel if the receiver cannot keep up; the rate is calculated from
+ * the datagrams actually received, and the loss is reported separately. The
+ * number of system calls issued by the receiving socket per received datagram
+ * is reported as well.
+ *
+ * Usage: avs_net_udp_batch_benchmark [datagram_size [count]]
+ */
+
+#include <avs_commons_posix_init.h>
+
+#include <avsystem/commons/avs_addrinfo.h>
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_net.h>
+#include <avsystem/commons/avs_socket.h>
+#include <avsystem/commons/avs_time.h>
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ADDRESS "127.0.0.1"
+#define MAX_BATCH_SIZE 64
+
+typedef struct {
+    avs_net_socket_t *socket;
+    const char *port;
+    avs_net_resolved_endpoint_t endpoint;
+    size_t datagram_size;
+    size_t count;
+    size_t batch_size;
+    avs_time_duration_t send_time;
+} sender_args_t;
+
+static void *sender(void *args_) {
+    sender_args_t *args = (sender_args_t *) args_;
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    char *payload = (char *) malloc(args->datagram_size);
+    if (!payload) {
+        abort();
+    }
+    memset(payload, 'x', args->datagram_size);
+    avs_net_socket_datagram_t datagrams[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < MAX_BATCH_SIZE; ++i) {
+        datagrams[i] = (avs_net_socket_datagram_t) {
+            .buffer = payload,
+            .buffer_length = args->datagram_size,
+            .peer = args->endpoint
+        };
+    }
+    size_t sent = 0;
+    while (sent < args->count) {
+        if (!args->batch_size) {
+            if (avs_is_err(avs_net_socket_send_to(args->socket, payload,
+                                                  args->datagram_size, ADDRESS,
+                                                  args->port))) {
+                break;
+            }
+            ++sent;
+        } else {
+            size_t batch_sent;
+            if (avs_is_err(avs_net_socket_send_batch(
+                        args->socket, datagrams,
+                        AVS_MIN(args->batch_size, args->count - sent),
+                        &batch_sent))) {
+                break;
+            }
+            sent += batch_sent;
+        }
+    }
+    args->send_time =
+            avs_time_monotonic_diff(avs_time_monotonic_now(), start);
+    free(payload);
+    return NULL;
+}
+
+static size_t receive(avs_net_socket_t *socket,
+                      size_t datagram_size,
+                      size_t count,
+                      size_t batch_size,
+                      avs_time_monotonic_t *out_last_received) {
+    // one extra byte, so that the datagrams are not reported as truncated if
+    // recvmsg() is not available
+    char *buffer = (char *) malloc(MAX_BATCH_SIZE * (datagram_size + 1));
+    if (!buffer) {
+        abort();
+    }
+    avs_net_socket_datagram_t datagrams[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < MAX_BATCH_SIZE; ++i) {
+        datagrams[i] = (avs_net_socket_datagram_t) {
+            .buffer = buffer + i * (datagram_size + 1),
+            .buffer_length = datagram_size + 1
+        };
+    }
+    size_t received = 0;
+    while (received < count) {
+        size_t batch_received;
+        if (!batch_size) {
+            char host[64];
+            char port[sizeof("65535")];
+            if (avs_is_err(avs_net_socket_receive_from(
+                        socket, &batch_received, buffer, datagram_size + 1,
+                        host, sizeof(host), port, sizeof(port)))) {
+                break;
+            }
+            batch_received = 1;
+        } else if (avs_is_err(avs_net_socket_receive_batch(
+                           socket, datagrams,
+                           AVS_MIN(batch_size, count - received),
+                           &batch_received))) {
+            break;
+        }
+        received += batch_received;
+        *out_last_received = avs_time_monotonic_now();
+    }
+    free(buffer);
+    return received;
+}
+
+static int measure(const char *name,
+                   avs_net_socket_t *server,
+                   sender_args_t *args) {
+    pthread_t thread;
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    avs_time_monotonic_t last_received = start;
+    if (pthread_create(&thread, NULL, sender, args)) {
+        return -1;
+    }
+    size_t received = receive(server, args->datagram_size, args->count,
+                              args->batch_size, &last_received);
+    pthread_join(thread, NULL);
+    avs_net_socket_opt_value_t syscalls;
+    if (avs_is_err(avs_net_socket_get_opt(
+                server, AVS_NET_SOCKET_OPT_SYSCALL_COUNT, &syscalls))) {
+        syscalls.syscall_count = 0;
+    }
+
+    double send_time =
+            avs_time_duration_to_fscalar(args->send_time, AVS_TIME_S);
+    double receive_time = avs_time_duration_to_fscalar(
+            avs_time_monotonic_diff(last_received, start), AVS_TIME_S);
+    printf("%-18s send %10.0f datagrams/s, receive %10.0f datagrams/s "
+           "(%.2f%% lost, %.2f syscalls/datagram)\n",
+           name, (double) args->count / send_time,
+           (double) received / receive_time,
+           100.0 * (double) (args->count - received) / (double) args->count,
+           received ? (double) syscalls.syscall_count / (double) received
+                    : 0.0);
+    return 0;
+}
+
+static int run(const char *name,
+               size_t datagram_size,
+               size_t count,
+               size_t batch_size) {
+    int result = -1;
+    avs_net_socket_t *server = NULL;
+    avs_net_socket_t *client = NULL;
+    char port[sizeof("65535")];
+    avs_net_addrinfo_t *info = NULL;
+    sender_args_t args = {
+        .port = port,
+        .datagram_size = datagram_size,
+        .count = count,
+        .batch_size = batch_size
+    };
+    if (avs_is_err(avs_net_udp_socket_create(&server, NULL))
+            || avs_is_err(avs_net_socket_bind(server, ADDRESS, "0"))
+            || avs_is_err(avs_net_socket_get_local_port(server, port,
+                                                        sizeof(port)))
+            || avs_is_err(avs_net_socket_set_opt(
+                       server, AVS_NET_SOCKET_OPT_RECV_TIMEOUT,
+                       (avs_net_socket_opt_value_t) {
+                           .recv_timeout = avs_time_duration_from_scalar(
+                                   200, AVS_TIME_MS)
+                       }))
+            || avs_is_err(avs_net_udp_socket_create(&client, NULL))
+            || avs_is_err(avs_net_socket_bind(client, ADDRESS, "0"))
+            || !(info = avs_net_addrinfo_resolve(AVS_NET_UDP_SOCKET,
+                                                 AVS_NET_AF_INET4, ADDRESS,
+                                                 port, NULL))
+            || avs_net_addrinfo_next(info, &args.endpoint)) {
+        fprintf(stderr, "could not set up sockets\n");
+    } else {
+        args.socket = client;
+        result = measure(name, server, &args);
+    }
+    avs_net_addrinfo_delete(&info);
+    avs_net_socket_cleanup(&client);
+    avs_net_socket_cleanup(&server);
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    size_t datagram_size = argc > 1 ? strtoul(argv[1], NULL, 0) : 64;
+    size_t count = argc > 2 ? strtoul(argv[2], NULL, 0) : 1000000;
+    if (!datagram_size || !count) {
+        fprintf(stderr, "usage: %s [datagram_size [count]]\n", argv[0]);
+        return 1;
+    }
+
+    static const size_t BATCH_SIZES[] = { 1, 8, 32, MAX_BATCH_SIZE };
+    int result = run("send_to/recv_from", datagram_size, count, 0);
+    for (size_t i = 0; !result && i < AVS_ARRAY_SIZE(BATCH_SIZES); ++i) {
+        char name[32];
+        snprintf(name, sizeof(name), "batch %u", (unsigned) BATCH_SIZES[i]);
+        result = run(name, datagram_size, count, BATCH_SIZES[i]);
+    }
+    return result ? 1 : 0;
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures the time of writing and then reading back a file through
+ * avs_stream_file_create() (stdio) and avs_stream_file_create_fd() with
+ * various settings.
+ *
+ * Usage: avs_stream_file_benchmark [directory [chunk_size [megabytes]]]
+ */
+
+#include <avs_commons_posix_init.h>
+
+#include <avsystem/commons/avs_stream.h>
+#include <avsystem/commons/avs_stream_file.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    const char *name;
+    /* NULL for a stdio stream */
+    const avs_stream_file_fd_config_t *config;
+} variant_t;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static avs_stream_t *
+open_stream(const variant_t *variant, const char *path, uint8_t mode) {
+    if (variant->config) {
+        return avs_stream_file_create_fd(path, mode, variant->config);
+    }
+    return avs_stream_file_create(path, mode);
+}
+
+static int write_file(const variant_t *variant,
+                      const char *path,
+                      char *chunk,
+                      size_t chunk_size,
+                      size_t total_bytes) {
+    avs_stream_t *stream = open_stream(variant, path, AVS_STREAM_FILE_WRITE);
+    if (!stream) {
+        return -1;
+    }
+    int result = 0;
+    for (size_t written = 0; !result && written < total_bytes;
+         written += chunk_size) {
+        size_t size = AVS_MIN(chunk_size, total_bytes - written);
+        if (avs_is_err(avs_stream_write(stream, chunk, size))) {
+            result = -1;
+        }
+    }
+    if (avs_is_err(avs_stream_finish_message(stream))
+            || avs_is_err(avs_stream_cleanup(&stream))) {
+        result = -1;
+    }
+    return result;
+}
+
+static int read_file(const variant_t *variant,
+                     const char *path,
+                     char *chunk,
+                     size_t chunk_size,
+                     size_t total_bytes) {
+    avs_stream_t *stream = open_stream(variant, path, AVS_STREAM_FILE_READ);
+    if (!stream) {
+        return -1;
+    }
+    size_t total_read = 0;
+    bool finished = false;
+    while (!finished) {
+        size_t bytes_read;
+        if (avs_is_err(avs_stream_read(stream, &bytes_read, &finished, chunk,
+                                       chunk_size))) {
+            break;
+        }
+        total_read += bytes_read;
+    }
+    avs_stream_cleanup(&stream);
+    return total_read == total_bytes ? 0 : -1;
+}
+
+int main(int argc, char *argv[]) {
+    const char *directory = argc > 1 ? argv[1] : ".";
+    size_t chunk_size = argc > 2 ? strtoul(argv[2], NULL, 0) : 1024;
+    size_t total_bytes =
+            (argc > 3 ? strtoul(argv[3], NULL, 0) : 256) * 1024 * 1024;
+    if (!chunk_size) {
+        fprintf(stderr, "usage: %s [directory [chunk_size [megabytes]]]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/avs_stream_file_benchmark.tmp",
+             directory);
+    printf("chunk size %zu B, %zu MB written and read\n", chunk_size,
+           total_bytes / (1024 * 1024));
+
+    const variant_t VARIANTS[] = {
+        { "stdio", NULL },
+        { "fd, 64 KiB", &(const avs_stream_file_fd_config_t) { 0 } },
+        { "fd, 1 MiB",
+          &(const avs_stream_file_fd_config_t) {
+              .buffer_size = 1024 * 1024
+          } },
+        { "fd, 1 MiB, prealloc",
+          &(const avs_stream_file_fd_config_t) {
+              .buffer_size = 1024 * 1024,
+              .preallocate_length = -1 /* replaced with the total size */
+          } },
+        { "fd, 1 MiB, O_DIRECT",
+          &(const avs_stream_file_fd_config_t) {
+              .buffer_size = 1024 * 1024,
+              .direct_io = true
+          } },
+        { "fd, 1 MiB, fdatasync",
+          &(const avs_stream_file_fd_config_t) {
+              .buffer_size = 1024 * 1024,
+              .sync_on_finish = true
+          } }
+    };
+    char *chunk = (char *) malloc(chunk_size);
+    if (!chunk) {
+        return EXIT_FAILURE;
+    }
+    memset(chunk, 'x', chunk_size);
+    int result = EXIT_SUCCESS;
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(VARIANTS); ++i) {
+        variant_t variant = VARIANTS[i];
+        avs_stream_file_fd_config_t config;
+        if (variant.config && variant.config->preallocate_length < 0) {
+            config = *variant.config;
+            config.preallocate_length = (avs_off_t) total_bytes;
+            variant.config = &config;
+        }
+        // truncating the previous file would be accounted to the write time
+        unlink(path);
+        double start = now();
+        if (write_file(&variant, path, chunk, chunk_size, total_bytes)) {
+            fprintf(stderr, "%s: write failed\n", variant.name);
+            result = EXIT_FAILURE;
+            continue;
+        }
+        double write_time = now() - start;
+        start = now();
+        if (read_file(&variant, path, chunk, chunk_size, total_bytes)) {
+            fprintf(stderr, "%s: read failed\n", variant.name);
+            result = EXIT_FAILURE;
+            continue;
+        }
+        double read_time = now() - start;
+        printf("%-24s write %8.1f MB/s, read %8.1f MB/s\n", variant.name,
+               (double) total_bytes / write_time / 1e6,
+               (double) total_bytes / read_time / 1e6);
+    }
+    unlink(path);
+    free(chunk);
+    return result;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures the throughput of hashing data with avs_stream_md5, written in
+ * pieces of a given size, both from an aligned and a misaligned buffer.
+ *
+ * Usage: avs_stream_md5_benchmark [write_size [megabytes]]
+ */
+
+#include <avs_commons_posix_init.h>
+
+#include <avsystem/commons/avs_stream.h>
+#include <avsystem/commons/avs_stream_md5.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static double hash(const char *data, size_t write_size, size_t total_bytes) {
+    avs_stream_t *stream = avs_stream_md5_create();
+    if (!stream) {
+        return -1.0;
+    }
+    double start = now();
+    int result = 0;
+    for (size_t written = 0; !result && written < total_bytes;
+         written += write_size) {
+        size_t size = AVS_MIN(write_size, total_bytes - written);
+        if (avs_is_err(avs_stream_write(stream, data, size))) {
+            result = -1;
+        }
+    }
+    unsigned char digest[16];
+    if (!result
+            && (avs_is_err(avs_stream_finish_message(stream))
+                || avs_is_err(avs_stream_read_reliably(stream, digest,
+                                                       sizeof(digest))))) {
+        result = -1;
+    }
+    double elapsed = now() - start;
+    avs_stream_cleanup(&stream);
+    return result ? -1.0 : elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    size_t write_size = argc > 1 ? strtoul(argv[1], NULL, 0) : 4096;
+    size_t total_bytes =
+            (argc > 2 ? strtoul(argv[2], NULL, 0) : 256) * 1024 * 1024;
+    if (!write_size) {
+        fprintf(stderr, "usage: %s [write_size [megabytes]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    char *buffer = (char *) malloc(write_size + 1);
+    if (!buffer) {
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < write_size + 1; ++i) {
+        buffer[i] = (char) (i * 7);
+    }
+    printf("write size %zu B, %zu MB\n", write_size,
+           total_bytes / (1024 * 1024));
+
+    int result = EXIT_SUCCESS;
+    for (size_t misalignment = 0; misalignment < 2; ++misalignment) {
+        double elapsed = hash(buffer + misalignment, write_size, total_bytes);
+        if (elapsed < 0.0) {
+            result = EXIT_FAILURE;
+            continue;
+        }
+        printf("%-12s %10.1f MB/s (%.3f s)\n",
+               misalignment ? "misaligned" : "aligned",
+               (double) total_bytes / elapsed / 1e6, elapsed);
+    }
+    free(buffer);
+    return result;
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures the time of filling a membuf stream with a large payload in small
+ * writes, and then either reading it back or taking ownership of it, for both
+ * contiguous and chunked membuf streams.
+ *
+ * Usage: avs_stream_membuf_benchmark [write_size [megabytes [chunk_size]]]
+ */
+
+#include <avs_commons_posix_init.h>
+
+#include <avsystem/commons/avs_memory.h>
+#include <avsystem/commons/avs_stream.h>
+#include <avsystem/commons/avs_stream_membuf.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static avs_stream_t *create_stream(size_t chunk_size) {
+    return chunk_size ? avs_stream_membuf_create_chunked(chunk_size)
+                      : avs_stream_membuf_create();
+}
+
+static int fill(avs_stream_t *stream,
+                const char *data,
+                size_t write_size,
+                size_t total_bytes) {
+    for (size_t written = 0; written < total_bytes; written += write_size) {
+        size_t size = AVS_MIN(write_size, total_bytes - written);
+        if (avs_is_err(avs_stream_write(stream, data, size))) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static double run(size_t chunk_size,
+                  bool take_ownership,
+                  char *data,
+                  size_t write_size,
+                  size_t total_bytes) {
+    avs_stream_t *stream = create_stream(chunk_size);
+    if (!stream) {
+        return -1.0;
+    }
+    double start = now();
+    int result = fill(stream, data, write_size, total_bytes);
+    if (!result && take_ownership) {
+        void *ptr = NULL;
+        size_t size;
+        if (avs_is_err(avs_stream_membuf_take_ownership(stream, &ptr, &size))
+                || size != total_bytes) {
+            result = -1;
+        }
+        avs_free(ptr);
+    } else if (!result) {
+        bool message_finished = false;
+        while (!result && !message_finished) {
+            if (avs_is_err(avs_stream_read(stream, NULL, &message_finished,
+                                           data, write_size))) {
+                result = -1;
+            }
+        }
+    }
+    double elapsed = now() - start;
+    avs_stream_cleanup(&stream);
+    return result ? -1.0 : elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    size_t write_size = argc > 1 ? strtoul(argv[1], NULL, 0) : 256;
+    size_t total_bytes =
+            (argc > 2 ? strtoul(argv[2], NULL, 0) : 64) * 1024 * 1024;
+    size_t chunk_size = argc > 3 ? strtoul(argv[3], NULL, 0) : 64 * 1024;
+    if (!write_size || !chunk_size) {
+        fprintf(stderr, "usage: %s [write_size [megabytes [chunk_size]]]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+    char *data = (char *) malloc(write_size);
+    if (!data) {
+        return EXIT_FAILURE;
+    }
+    memset(data, 'x', write_size);
+    printf("write size %zu B, %zu MB, chunk size %zu B\n", write_size,
+           total_bytes / (1024 * 1024), chunk_size);
+
+    int result = EXIT_SUCCESS;
+    for (int take_ownership = 0; take_ownership < 2; ++take_ownership) {
+        for (int chunked = 0; chunked < 2; ++chunked) {
+            double elapsed = run(chunked ? chunk_size : 0, take_ownership, data,
+                                 write_size, total_bytes);
+            if (elapsed < 0.0) {
+                result = EXIT_FAILURE;
+                continue;
+            }
+            printf("%-10s %-16s %10.1f MB/s (%.3f s)\n",
+                   chunked ? "chunked" : "contiguous",
+                   take_ownership ? "take_ownership" : "read back",
+                   (double) total_bytes / elapsed / 1e6, elapsed);
+        }
+    }
+    free(data);
+    return result;
+}
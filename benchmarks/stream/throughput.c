@@ -0,0 +1,828 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Pushes a text-like payload through each of the avs_stream implementations
+ * and some common compositions of them, writing or reading it in pieces of
+ * the given chunk sizes. For each case, the following is reported:
+ *
+ * - throughput, in MB of payload per second,
+ *
+ * - calls per byte - number of write_some, read and peek calls that reached
+ *   the lower stream of a composition (e.g. the file under a buffered stream),
+ *   per byte of payload; only reported for compositions,
+ *
+ * - number of avs_malloc(), avs_calloc() and avs_realloc() calls; only
+ *   reported if the library is configured with WITH_AVS_ALLOCATORS=ON.
+ *
+ * Setup, e.g. preparing the data to read, is not included in the results.
+ * The avs_stream_copy() cases do not use the chunk size; they show the
+ * effect of AVS_STREAM_STACK_BUFFER_SIZE and of the zero-copy extensions.
+ *
+ * Usage: avs_stream_throughput_benchmark [megabytes [chunk_sizes [filter]]]
+ *
+ * chunk_sizes is a comma-separated list, e.g. 64,512,4096. If filter is
+ * given, only the cases with names containing it are run. Files are created
+ * in $TMPDIR, or /tmp if it is not set.
+ */
+
+#include <avs_commons_posix_init.h>
+#include <avs_commons_init.h>
+
+#include <avsystem/commons/avs_memory.h>
+#include <avsystem/commons/avs_stream.h>
+#include <avsystem/commons/avs_stream_buffered.h>
+#include <avsystem/commons/avs_stream_hash.h>
+#include <avsystem/commons/avs_stream_inbuf.h>
+#include <avsystem/commons/avs_stream_md5.h>
+#include <avsystem/commons/avs_stream_membuf.h>
+#include <avsystem/commons/avs_stream_outbuf.h>
+#include <avsystem/commons/avs_stream_tee.h>
+#include <avsystem/commons/avs_stream_v_table.h>
+
+#ifdef AVS_COMMONS_UTILS_WITH_ALLOCATORS
+#    include <avsystem/commons/avs_allocator.h>
+#endif // AVS_COMMONS_UTILS_WITH_ALLOCATORS
+
+#ifdef AVS_COMMONS_STREAM_WITH_FILE
+#    include <avsystem/commons/avs_stream_file.h>
+#endif // AVS_COMMONS_STREAM_WITH_FILE
+
+#if defined(AVS_COMMONS_WITH_AVS_NET) && defined(AVS_COMMONS_WITH_AVS_BUFFER)
+#    define WITH_NETBUF
+#    include <avsystem/commons/avs_socket.h>
+#    include <avsystem/commons/avs_stream_netbuf.h>
+
+#    include <arpa/inet.h>
+#    include <netinet/in.h>
+#    include <pthread.h>
+#    include <sys/socket.h>
+#    include <unistd.h>
+#endif // defined(AVS_COMMONS_WITH_AVS_NET) &&
+       // defined(AVS_COMMONS_WITH_AVS_BUFFER)
+
+#ifdef AVS_COMMONS_WITH_AVS_HTTP
+#    include <avsystem/commons/avs_http.h>
+
+#    include "src/http/avs_body_receivers.h"
+#    ifdef AVS_COMMONS_HTTP_WITH_ZLIB
+#        include <zlib.h>
+
+#        include "src/http/avs_content_encoding.h"
+#    endif // AVS_COMMONS_HTTP_WITH_ZLIB
+#endif     // AVS_COMMONS_WITH_AVS_HTTP
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Buffer size used by the compositions with buffered and netbuf streams. */
+#define LAYER_BUFFER_SIZE 4096
+
+typedef struct {
+    const char *payload;
+    size_t payload_size;
+    size_t chunk_size;
+    /* chunk_size bytes of scratch space for reading */
+    char *chunk;
+    const char *file_path;
+    double start;
+    /* incremented by counting streams */
+    size_t calls;
+} bench_t;
+
+typedef int scenario_run_t(bench_t *bench);
+
+typedef struct {
+    const char *name;
+    scenario_run_t *run;
+} scenario_t;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+#ifdef AVS_COMMONS_UTILS_WITH_ALLOCATORS
+static size_t g_allocations;
+
+static void *counting_alloc(avs_allocator_t *allocator, size_t size) {
+    (void) allocator;
+    ++g_allocations;
+    return avs_allocator_system()->vtable->alloc_fn(avs_allocator_system(),
+                                                    size);
+}
+
+static void *counting_realloc(avs_allocator_t *allocator,
+                              void *ptr,
+                              size_t old_size,
+                              size_t new_size) {
+    (void) allocator;
+    ++g_allocations;
+    return avs_allocator_system()->vtable->realloc_fn(
+            avs_allocator_system(), ptr, old_size, new_size);
+}
+
+static void counting_free(avs_allocator_t *allocator, void *ptr, size_t size) {
+    (void) allocator;
+    avs_allocator_system()->vtable->free_fn(avs_allocator_system(), ptr, size);
+}
+
+static const avs_allocator_v_table_t counting_allocator_vtable = {
+    .alloc_fn = counting_alloc,
+    .realloc_fn = counting_realloc,
+    .free_fn = counting_free
+};
+
+static avs_allocator_t counting_allocator = {
+    .vtable = &counting_allocator_vtable
+};
+#endif // AVS_COMMONS_UTILS_WITH_ALLOCATORS
+
+/* Marks the end of setup; the measurement starts from here. */
+static void start_measurement(bench_t *bench) {
+    bench->calls = 0;
+#ifdef AVS_COMMONS_UTILS_WITH_ALLOCATORS
+    g_allocations = 0;
+#endif // AVS_COMMONS_UTILS_WITH_ALLOCATORS
+    bench->start = now();
+}
+
+/* Text-like data built from a small dictionary, compressing roughly 3:1. */
+static char *generate_payload(size_t size) {
+    static const char *const WORDS[] = {
+        "lorem ",   "ipsum ",  "dolor ",       "sit ",        "amet ",
+        "elit ",    "sed ",    "consectetur ", "adipiscing ", "do ",
+        "eiusmod ", "tempor ", "incididunt ",  "ut ",         "labore ",
+        "et ",      "dolore ", "magna ",       "aliqua\n",    "enim "
+    };
+    char *data = (char *) malloc(size);
+    if (!data) {
+        return NULL;
+    }
+    uint32_t state = 12345;
+    size_t offset = 0;
+    while (offset < size) {
+        state = state * 1103515245 + 12345;
+        const char *word = WORDS[(state >> 16) % AVS_ARRAY_SIZE(WORDS)];
+        size_t length = AVS_MIN(strlen(word), size - offset);
+        memcpy(data + offset, word, length);
+        offset += length;
+    }
+    return data;
+}
+
+/* Pass-through stream counting the calls made to the wrapped stream. The
+ * backend is not owned. No extensions are exposed, so that e.g.
+ * avs_stream_copy() falls back to plain reads and writes. */
+typedef struct {
+    const avs_stream_v_table_t *const vtable;
+    avs_stream_t *backend;
+    size_t *calls;
+} counting_stream_t;
+
+static avs_error_t counting_write_some(avs_stream_t *stream_,
+                                       const void *buffer,
+                                       size_t *inout_data_length) {
+    counting_stream_t *stream = (counting_stream_t *) stream_;
+    ++*stream->calls;
+    return avs_stream_write_some(stream->backend, buffer, inout_data_length);
+}
+
+static avs_error_t counting_finish_message(avs_stream_t *stream) {
+    return avs_stream_finish_message(((counting_stream_t *) stream)->backend);
+}
+
+static avs_error_t counting_read(avs_stream_t *stream_,
+                                 size_t *out_bytes_read,
+                                 bool *out_message_finished,
+                                 void *buffer,
+                                 size_t buffer_length) {
+    counting_stream_t *stream = (counting_stream_t *) stream_;
+    ++*stream->calls;
+    return avs_stream_read(stream->backend, out_bytes_read,
+                           out_message_finished, buffer, buffer_length);
+}
+
+static avs_error_t
+counting_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
+    counting_stream_t *stream = (counting_stream_t *) stream_;
+    ++*stream->calls;
+    return avs_stream_peek(stream->backend, offset, out_value);
+}
+
+static avs_error_t counting_reset(avs_stream_t *stream) {
+    return avs_stream_reset(((counting_stream_t *) stream)->backend);
+}
+
+static const avs_stream_v_table_t counting_vtable = {
+    .write_some = counting_write_some,
+    .finish_message = counting_finish_message,
+    .read = counting_read,
+    .peek = counting_peek,
+    .reset = counting_reset,
+    AVS_STREAM_V_TABLE_NO_EXTENSIONS
+};
+
+static avs_stream_t *counting_stream_create(avs_stream_t *backend,
+                                            size_t *calls) {
+    counting_stream_t *stream =
+            (counting_stream_t *) avs_calloc(1, sizeof(counting_stream_t));
+    if (stream) {
+        *(const avs_stream_v_table_t **) (intptr_t) &stream->vtable =
+                &counting_vtable;
+        stream->backend = backend;
+        stream->calls = calls;
+    }
+    return (avs_stream_t *) stream;
+}
+
+/* Stream that discards everything written to it. */
+static avs_error_t
+null_write_some(avs_stream_t *stream, const void *buffer, size_t *len) {
+    (void) stream;
+    (void) buffer;
+    (void) len;
+    return AVS_OK;
+}
+
+static avs_error_t null_finish_message(avs_stream_t *stream) {
+    (void) stream;
+    return AVS_OK;
+}
+
+static const avs_stream_v_table_t null_vtable = {
+    .write_some = null_write_some,
+    .finish_message = null_finish_message,
+    AVS_STREAM_V_TABLE_NO_EXTENSIONS
+};
+
+static struct {
+    const avs_stream_v_table_t *const vtable;
+} NULL_STREAM_INSTANCE = { &null_vtable };
+
+#define NULL_STREAM ((avs_stream_t *) &NULL_STREAM_INSTANCE)
+
+static avs_error_t write_payload(bench_t *bench, avs_stream_t *stream) {
+    for (size_t offset = 0; offset < bench->payload_size;
+         offset += bench->chunk_size) {
+        avs_error_t err = avs_stream_write(
+                stream, bench->payload + offset,
+                AVS_MIN(bench->chunk_size, bench->payload_size - offset));
+        if (avs_is_err(err)) {
+            return err;
+        }
+    }
+    return avs_stream_finish_message(stream);
+}
+
+/* Reads the stream to its end, expecting expected_size bytes. If verify is
+ * true, the data is also compared against the payload. */
+static int read_payload(bench_t *bench,
+                        avs_stream_t *stream,
+                        size_t expected_size,
+                        bool verify) {
+    size_t total = 0;
+    bool message_finished = false;
+    while (!message_finished) {
+        size_t bytes_read;
+        if (avs_is_err(avs_stream_read(stream, &bytes_read, &message_finished,
+                                       bench->chunk, bench->chunk_size))
+                || total + bytes_read > expected_size
+                || (verify
+                    && memcmp(bench->chunk, bench->payload + total,
+                              bytes_read))) {
+            return -1;
+        }
+        total += bytes_read;
+    }
+    return total == expected_size ? 0 : -1;
+}
+
+static int run_write_read(bench_t *bench, avs_stream_t *stream) {
+    if (!stream) {
+        return -1;
+    }
+    start_measurement(bench);
+    int result = (avs_is_ok(write_payload(bench, stream))
+                  && !read_payload(bench, stream, bench->payload_size, false))
+                         ? 0
+                         : -1;
+    avs_stream_cleanup(&stream);
+    return result;
+}
+
+static int run_membuf(bench_t *bench) {
+    return run_write_read(bench, avs_stream_membuf_create());
+}
+
+static int run_membuf_chunked(bench_t *bench) {
+    return run_write_read(bench, avs_stream_membuf_create_chunked(64 * 1024));
+}
+
+static int run_inbuf(bench_t *bench) {
+    avs_stream_inbuf_t inbuf = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+    avs_stream_inbuf_set_buffer(&inbuf, bench->payload, bench->payload_size);
+    start_measurement(bench);
+    return read_payload(bench, (avs_stream_t *) &inbuf, bench->payload_size,
+                        false);
+}
+
+static int run_outbuf(bench_t *bench) {
+    char *buffer = (char *) malloc(1024 * 1024);
+    if (!buffer) {
+        return -1;
+    }
+    avs_stream_outbuf_t outbuf = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+    avs_stream_outbuf_set_buffer(&outbuf, buffer, 1024 * 1024);
+    start_measurement(bench);
+    int result = 0;
+    for (size_t offset = 0; !result && offset < bench->payload_size;
+         offset += bench->chunk_size) {
+        size_t size = AVS_MIN(bench->chunk_size, bench->payload_size - offset);
+        if (avs_stream_outbuf_offset(&outbuf) + size > 1024 * 1024) {
+            avs_stream_reset((avs_stream_t *) &outbuf);
+        }
+        if (avs_is_err(avs_stream_write((avs_stream_t *) &outbuf,
+                                        bench->payload + offset, size))) {
+            result = -1;
+        }
+    }
+    free(buffer);
+    return result;
+}
+
+static int run_hash(bench_t *bench, avs_stream_t *stream) {
+    if (!stream) {
+        return -1;
+    }
+    start_measurement(bench);
+    unsigned char digest[32];
+    int result = (avs_is_ok(write_payload(bench, stream))
+                  && avs_is_ok(avs_stream_read(stream, NULL, NULL, digest,
+                                               sizeof(digest))))
+                         ? 0
+                         : -1;
+    avs_stream_cleanup(&stream);
+    return result;
+}
+
+static int run_md5(bench_t *bench) {
+    return run_hash(bench, avs_stream_md5_create());
+}
+
+static int run_crc32(bench_t *bench) {
+    return run_hash(bench, avs_stream_crc32_create());
+}
+
+static int run_sha1(bench_t *bench) {
+    return run_hash(bench, avs_stream_sha1_create());
+}
+
+static int run_sha256(bench_t *bench) {
+    return run_hash(bench, avs_stream_sha256_create());
+}
+
+static int run_tee_membuf_sha256(bench_t *bench) {
+    avs_stream_t *sinks[] = { avs_stream_membuf_create(),
+                              avs_stream_sha256_create() };
+    avs_stream_t *tee = NULL;
+    int result = -1;
+    if (sinks[0] && sinks[1]
+            && (tee = avs_stream_tee_create(sinks, AVS_ARRAY_SIZE(sinks)))) {
+        start_measurement(bench);
+        result = avs_is_ok(write_payload(bench, tee)) ? 0 : -1;
+    }
+    avs_stream_cleanup(&tee);
+    avs_stream_cleanup(&sinks[0]);
+    avs_stream_cleanup(&sinks[1]);
+    return result;
+}
+
+static int run_buffered_write(bench_t *bench) {
+    avs_stream_t *stream = counting_stream_create(NULL_STREAM, &bench->calls);
+    if (!stream || avs_stream_buffered_create(&stream, 0, LAYER_BUFFER_SIZE)) {
+        avs_stream_cleanup(&stream);
+        return -1;
+    }
+    start_measurement(bench);
+    int result = avs_is_ok(write_payload(bench, stream)) ? 0 : -1;
+    avs_stream_cleanup(&stream);
+    return result;
+}
+
+static int run_buffered_read(bench_t *bench) {
+    avs_stream_inbuf_t inbuf = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+    avs_stream_inbuf_set_buffer(&inbuf, bench->payload, bench->payload_size);
+    avs_stream_t *stream =
+            counting_stream_create((avs_stream_t *) &inbuf, &bench->calls);
+    if (!stream || avs_stream_buffered_create(&stream, LAYER_BUFFER_SIZE, 0)) {
+        avs_stream_cleanup(&stream);
+        return -1;
+    }
+    start_measurement(bench);
+    int result = read_payload(bench, stream, bench->payload_size, false);
+    avs_stream_cleanup(&stream);
+    return result;
+}
+
+static int run_copy_membuf(bench_t *bench) {
+    avs_stream_t *input = avs_stream_membuf_create();
+    avs_stream_t *output = avs_stream_membuf_create();
+    int result = -1;
+    if (input && output
+            && avs_is_ok(avs_stream_write(input, bench->payload,
+                                          bench->payload_size))
+            && avs_is_ok(avs_stream_finish_message(input))) {
+        start_measurement(bench);
+        result = avs_is_ok(avs_stream_copy(output, input)) ? 0 : -1;
+    }
+    avs_stream_cleanup(&input);
+    avs_stream_cleanup(&output);
+    return result;
+}
+
+static int run_copy_plain(bench_t *bench) {
+    avs_stream_inbuf_t inbuf = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+    avs_stream_inbuf_set_buffer(&inbuf, bench->payload, bench->payload_size);
+    avs_stream_t *input =
+            counting_stream_create((avs_stream_t *) &inbuf, &bench->calls);
+    avs_stream_t *output = counting_stream_create(NULL_STREAM, &bench->calls);
+    int result = -1;
+    if (input && output) {
+        start_measurement(bench);
+        result = avs_is_ok(avs_stream_copy(output, input)) ? 0 : -1;
+    }
+    avs_stream_cleanup(&input);
+    avs_stream_cleanup(&output);
+    return result;
+}
+
+#ifdef AVS_COMMONS_STREAM_WITH_FILE
+static int run_file_write(bench_t *bench) {
+    avs_stream_t *stream =
+            avs_stream_file_create(bench->file_path, AVS_STREAM_FILE_WRITE);
+    if (!stream) {
+        return -1;
+    }
+    start_measurement(bench);
+    int result = avs_is_ok(write_payload(bench, stream)) ? 0 : -1;
+    if (avs_is_err(avs_stream_cleanup(&stream))) {
+        result = -1;
+    }
+    return result;
+}
+
+static int run_file_read_impl(bench_t *bench, bool buffered) {
+    avs_stream_t *file = NULL;
+    avs_stream_t *stream = NULL;
+    int result = -1;
+    /* make sure that the file exists and has the expected contents */
+    if (!(file = avs_stream_file_create(bench->file_path,
+                                        AVS_STREAM_FILE_WRITE))
+            || avs_is_err(avs_stream_write(file, bench->payload,
+                                           bench->payload_size))
+            || avs_is_err(avs_stream_cleanup(&file))
+            || !(file = avs_stream_file_create(bench->file_path,
+                                               AVS_STREAM_FILE_READ))) {
+        goto finish;
+    }
+    if (!buffered) {
+        stream = file;
+        file = NULL;
+    } else if (!(stream = counting_stream_create(file, &bench->calls))
+               || avs_stream_buffered_create(&stream, LAYER_BUFFER_SIZE, 0)) {
+        goto finish;
+    }
+    start_measurement(bench);
+    result = read_payload(bench, stream, bench->payload_size, false);
+finish:
+    avs_stream_cleanup(&stream);
+    avs_stream_cleanup(&file);
+    return result;
+}
+
+static int run_file_read(bench_t *bench) {
+    return run_file_read_impl(bench, false);
+}
+
+static int run_buffered_file_read(bench_t *bench) {
+    return run_file_read_impl(bench, true);
+}
+#endif // AVS_COMMONS_STREAM_WITH_FILE
+
+#ifdef WITH_NETBUF
+typedef struct {
+    int listen_fd;
+    bool send_payload;
+    const bench_t *bench;
+    int result;
+} server_args_t;
+
+static void *server(void *args_) {
+    server_args_t *args = (server_args_t *) args_;
+    int fd = accept(args->listen_fd, NULL, NULL);
+    args->result = -1;
+    if (fd < 0) {
+        return NULL;
+    }
+    if (args->send_payload) {
+        const char *data = args->bench->payload;
+        size_t size = args->bench->payload_size;
+        while (size) {
+            ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                break;
+            }
+            data += sent;
+            size -= (size_t) sent;
+        }
+        args->result = size ? -1 : 0;
+    } else {
+        char buffer[65536];
+        size_t total = 0;
+        ssize_t received;
+        while ((received = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+            total += (size_t) received;
+        }
+        args->result = total == args->bench->payload_size ? 0 : -1;
+    }
+    close(fd);
+    return NULL;
+}
+
+static int run_netbuf(bench_t *bench, bool read) {
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    if (listen_fd < 0
+            || bind(listen_fd, (struct sockaddr *) &addr, sizeof(addr))
+            || listen(listen_fd, 1)
+            || getsockname(listen_fd, (struct sockaddr *) &addr, &addr_len)) {
+        if (listen_fd >= 0) {
+            close(listen_fd);
+        }
+        return -1;
+    }
+    server_args_t args = {
+        .listen_fd = listen_fd,
+        .send_payload = read,
+        .bench = bench
+    };
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, server, &args)) {
+        close(listen_fd);
+        return -1;
+    }
+
+    char port[8];
+    snprintf(port, sizeof(port), "%u", (unsigned) ntohs(addr.sin_port));
+    avs_net_socket_t *socket = NULL;
+    avs_stream_t *stream = NULL;
+    int result = -1;
+    if (avs_is_ok(avs_net_tcp_socket_create(&socket, NULL))
+            && avs_is_ok(avs_net_socket_connect(socket, "127.0.0.1", port))
+            && !avs_stream_netbuf_create(&stream, socket, LAYER_BUFFER_SIZE,
+                                         LAYER_BUFFER_SIZE)) {
+        /* the socket is now owned by the stream */
+        socket = NULL;
+        start_measurement(bench);
+        if (read) {
+            result = read_payload(bench, stream, bench->payload_size, false);
+        } else {
+            result = avs_is_ok(write_payload(bench, stream)) ? 0 : -1;
+        }
+    }
+    /* closing the connection lets the server thread finish */
+    avs_stream_cleanup(&stream);
+    avs_net_socket_cleanup(&socket);
+    pthread_join(thread, NULL);
+    close(listen_fd);
+    return result || args.result ? -1 : 0;
+}
+
+static int run_netbuf_write(bench_t *bench) {
+    return run_netbuf(bench, false);
+}
+
+static int run_netbuf_read(bench_t *bench) {
+    return run_netbuf(bench, true);
+}
+#endif // WITH_NETBUF
+
+#ifdef AVS_COMMONS_WITH_AVS_HTTP
+static int run_http_chunked(bench_t *bench) {
+    /* encode the payload in 16 KiB chunks, as a server would */
+    avs_stream_t *backend = avs_stream_membuf_create();
+    if (!backend) {
+        return -1;
+    }
+    for (size_t offset = 0; offset < bench->payload_size;
+         offset += 16 * 1024) {
+        size_t size = AVS_MIN(16 * 1024, bench->payload_size - offset);
+        if (avs_is_err(avs_stream_write_f(backend, "%zx\r\n", size))
+                || avs_is_err(avs_stream_write(backend, bench->payload + offset,
+                                               size))
+                || avs_is_err(avs_stream_write(backend, "\r\n", 2))) {
+            avs_stream_cleanup(&backend);
+            return -1;
+        }
+    }
+    avs_stream_t *stream = NULL;
+    if (avs_is_err(avs_stream_write(backend, "0\r\n\r\n", 5))
+            || !(stream = _avs_http_body_receiver_chunked_create(
+                         backend, &AVS_HTTP_DEFAULT_BUFFER_SIZES))) {
+        avs_stream_cleanup(&backend);
+        return -1;
+    }
+    start_measurement(bench);
+    int result = read_payload(bench, stream, bench->payload_size, true);
+    avs_stream_cleanup(&stream);
+    return result;
+}
+
+#    ifdef AVS_COMMONS_HTTP_WITH_ZLIB
+static int run_http_gzip(bench_t *bench) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY)
+            != Z_OK) {
+        return -1;
+    }
+    size_t capacity = deflateBound(&zs, (uLong) bench->payload_size);
+    unsigned char *compressed = (unsigned char *) malloc(capacity);
+    avs_stream_t *backend = avs_stream_membuf_create();
+    avs_stream_t *decoder = NULL;
+    avs_stream_t *stream = NULL;
+    int result = -1;
+    if (compressed && backend
+            && !_avs_http_content_decoder_create(
+                       &decoder, AVS_HTTP_CONTENT_GZIP,
+                       &AVS_HTTP_DEFAULT_BUFFER_SIZES)) {
+        zs.next_in = (Bytef *) (intptr_t) bench->payload;
+        zs.avail_in = (uInt) bench->payload_size;
+        zs.next_out = compressed;
+        zs.avail_out = (uInt) capacity;
+        if (deflate(&zs, Z_FINISH) == Z_STREAM_END
+                && avs_is_ok(avs_stream_write(backend, compressed,
+                                              capacity - zs.avail_out))
+                && avs_is_ok(avs_stream_finish_message(backend))
+                && (stream = _avs_http_decoding_stream_create(
+                            backend, decoder,
+                            &AVS_HTTP_DEFAULT_BUFFER_SIZES))) {
+            /* now owned by the decoding stream */
+            backend = NULL;
+            decoder = NULL;
+            start_measurement(bench);
+            result = read_payload(bench, stream, bench->payload_size, true);
+        }
+    }
+    deflateEnd(&zs);
+    free(compressed);
+    avs_stream_cleanup(&stream);
+    avs_stream_cleanup(&decoder);
+    avs_stream_cleanup(&backend);
+    return result;
+}
+#    endif // AVS_COMMONS_HTTP_WITH_ZLIB
+#endif     // AVS_COMMONS_WITH_AVS_HTTP
+
+static const scenario_t SCENARIOS[] = {
+    { "membuf", run_membuf },
+    { "membuf_chunked", run_membuf_chunked },
+    { "inbuf", run_inbuf },
+    { "outbuf", run_outbuf },
+    { "md5", run_md5 },
+    { "crc32", run_crc32 },
+    { "sha1", run_sha1 },
+    { "sha256", run_sha256 },
+    { "tee(membuf,sha256)", run_tee_membuf_sha256 },
+    { "buffered(null) write", run_buffered_write },
+    { "buffered(inbuf) read", run_buffered_read },
+    { "copy(membuf->membuf)", run_copy_membuf },
+    { "copy(inbuf->null)", run_copy_plain },
+#ifdef AVS_COMMONS_STREAM_WITH_FILE
+    { "file write", run_file_write },
+    { "file read", run_file_read },
+    { "buffered(file) read", run_buffered_file_read },
+#endif // AVS_COMMONS_STREAM_WITH_FILE
+#ifdef WITH_NETBUF
+    { "netbuf write", run_netbuf_write },
+    { "netbuf read", run_netbuf_read },
+#endif // WITH_NETBUF
+#ifdef AVS_COMMONS_WITH_AVS_HTTP
+    { "http chunked(membuf)", run_http_chunked },
+#    ifdef AVS_COMMONS_HTTP_WITH_ZLIB
+    { "http gzip(membuf)", run_http_gzip },
+#    endif // AVS_COMMONS_HTTP_WITH_ZLIB
+#endif     // AVS_COMMONS_WITH_AVS_HTTP
+};
+
+static int run_scenario(bench_t *bench, const scenario_t *scenario) {
+    bench->start = now();
+    int result = scenario->run(bench);
+    double elapsed = now() - bench->start;
+    if (result) {
+        printf("%-24s FAILED\n", scenario->name);
+        return -1;
+    }
+    char calls[32] = "-";
+    if (bench->calls) {
+        snprintf(calls, sizeof(calls), "%.5f",
+                 (double) bench->calls / (double) bench->payload_size);
+    }
+    char allocations[32] = "n/a";
+#ifdef AVS_COMMONS_UTILS_WITH_ALLOCATORS
+    snprintf(allocations, sizeof(allocations), "%zu", g_allocations);
+#endif // AVS_COMMONS_UTILS_WITH_ALLOCATORS
+    printf("%-24s %10.1f %12s %10s\n", scenario->name,
+           (double) bench->payload_size / elapsed / 1e6, calls, allocations);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    size_t payload_size =
+            (argc > 1 ? strtoul(argv[1], NULL, 0) : 16) * 1024 * 1024;
+    const char *chunk_sizes = argc > 2 ? argv[2] : "64,512,4096,65536";
+    const char *filter = argc > 3 ? argv[3] : NULL;
+    if (!payload_size) {
+        fprintf(stderr, "usage: %s [megabytes [chunk_sizes [filter]]]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char *tmpdir = getenv("TMPDIR");
+    char file_path[256];
+    snprintf(file_path, sizeof(file_path), "%s/avs_stream_throughput.tmp",
+             tmpdir ? tmpdir : "/tmp");
+    char *payload = generate_payload(payload_size);
+    if (!payload) {
+        fprintf(stderr, "could not prepare data\n");
+        return EXIT_FAILURE;
+    }
+#ifdef AVS_COMMONS_UTILS_WITH_ALLOCATORS
+    avs_memory_set_allocator(AVS_MEMORY_SUBSYSTEM_DEFAULT,
+                             &counting_allocator);
+#endif // AVS_COMMONS_UTILS_WITH_ALLOCATORS
+
+    int result = EXIT_SUCCESS;
+    const char *next = chunk_sizes;
+    while (*next) {
+        char *end;
+        size_t chunk_size = strtoul(next, &end, 0);
+        next = *end == ',' ? end + 1 : end;
+        char *chunk = chunk_size ? (char *) malloc(chunk_size) : NULL;
+        if (!chunk || (*end && *end != ',')) {
+            fprintf(stderr, "invalid chunk size list: %s\n", chunk_sizes);
+            free(chunk);
+            result = EXIT_FAILURE;
+            break;
+        }
+        bench_t bench = {
+            .payload = payload,
+            .payload_size = payload_size,
+            .chunk_size = chunk_size,
+            .chunk = chunk,
+            .file_path = file_path
+        };
+        printf("%zu MB payload, chunk size %zu B\n",
+               payload_size / (1024 * 1024), chunk_size);
+        printf("%-24s %10s %12s %10s\n", "stream", "MB/s", "calls/B",
+               "allocs");
+        for (size_t i = 0; i < AVS_ARRAY_SIZE(SCENARIOS); ++i) {
+            if ((!filter || strstr(SCENARIOS[i].name, filter))
+                    && run_scenario(&bench, &SCENARIOS[i])) {
+                result = EXIT_FAILURE;
+            }
+        }
+        printf("\n");
+        free(chunk);
+    }
+
+#ifdef AVS_COMMONS_UTILS_WITH_ALLOCATORS
+    avs_memory_set_allocator(AVS_MEMORY_SUBSYSTEM_DEFAULT, NULL);
+#endif // AVS_COMMONS_UTILS_WITH_ALLOCATORS
+    remove(file_path);
+    free(payload);
+    return result;
+}
@@ -0,0 +1,319 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVS_COMMONS_UTILS_ALLOCATOR_H
+#define AVS_COMMONS_UTILS_ALLOCATOR_H
+
+#include <avsystem/commons/avs_defs.h>
+
+#ifdef AVS_COMMONS_UTILS_WITH_ALLOCATORS
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+/**
+ * @file avs_allocator.h
+ *
+ * Pluggable memory allocators.
+ *
+ * When <c>AVS_COMMONS_UTILS_WITH_ALLOCATORS</c> is enabled, every block
+ * returned by @ref avs_malloc, @ref avs_calloc, @ref avs_realloc and the
+ * functions declared in this file remembers the allocator it has been obtained
+ * from, so @ref avs_free and @ref avs_realloc always return it to the right
+ * place, regardless of which allocator is currently installed.
+ *
+ * Allocators may be installed separately for the major subsystems of the
+ * library (see @ref avs_memory_subsystem_t), which makes it possible to bound
+ * memory usage of each of them, and to release all memory of a subsystem at
+ * once with @ref avs_arena_allocator_reset.
+ */
+
+struct avs_allocator_struct;
+typedef struct avs_allocator_struct avs_allocator_t;
+
+/**
+ * Implementation of this method allocates a block of memory.
+ *
+ * @param allocator Allocator to operate on.
+ *
+ * @param size      Number of bytes to allocate; never 0.
+ *
+ * @returns Pointer to a block of at least @p size bytes, aligned for storage
+ *          of any type, or NULL in case of error.
+ */
+typedef void *(*avs_allocator_alloc_t)(avs_allocator_t *allocator,
+                                       size_t size);
+
+/**
+ * Implementation of this method changes the size of a block of memory,
+ * with semantics of standard C <c>realloc()</c>.
+ *
+ * This method is optional. If not implemented, resizing is performed by
+ * allocating a new block, copying the data and freeing the old block.
+ *
+ * @param allocator Allocator to operate on.
+ *
+ * @param ptr       Block previously returned by the same allocator; never NULL.
+ *
+ * @param old_size  Size of the block, as passed to the call that allocated it.
+ *
+ * @param new_size  Requested new size of the block; never 0.
+ *
+ * @returns Pointer to the resized block, or NULL in case of error, in which
+ *          case the original block shall remain untouched.
+ */
+typedef void *(*avs_allocator_realloc_t)(avs_allocator_t *allocator,
+                                         void *ptr,
+                                         size_t old_size,
+                                         size_t new_size);
+
+/**
+ * Implementation of this method returns a block of memory to the allocator.
+ *
+ * @param allocator Allocator to operate on.
+ *
+ * @param ptr       Block previously returned by the same allocator; never NULL.
+ *
+ * @param size      Size of the block, as passed to the call that allocated it.
+ */
+typedef void (*avs_allocator_free_t)(avs_allocator_t *allocator,
+                                     void *ptr,
+                                     size_t size);
+
+typedef struct {
+    avs_allocator_alloc_t alloc_fn;
+    avs_allocator_realloc_t realloc_fn;
+    avs_allocator_free_t free_fn;
+} avs_allocator_v_table_t;
+
+/**
+ * Base type of all allocators. Custom allocators shall be structures that have
+ * this type as their first member.
+ */
+struct avs_allocator_struct {
+    const avs_allocator_v_table_t *vtable;
+};
+
+/**
+ * Subsystems of the library that may be configured to use distinct
+ * allocators.
+ */
+typedef enum {
+    /**
+     * Used by @ref avs_malloc, @ref avs_calloc and @ref avs_realloc called
+     * from outside of the other subsystems, and by the other subsystems that
+     * do not have an allocator configured.
+     */
+    AVS_MEMORY_SUBSYSTEM_DEFAULT,
+    /** Sockets and related objects of avs_net. */
+    AVS_MEMORY_SUBSYSTEM_NET,
+    /** HTTP clients and streams of avs_http. */
+    AVS_MEMORY_SUBSYSTEM_HTTP,
+    /** Contexts and buffers allocated by avs_persistence. */
+    AVS_MEMORY_SUBSYSTEM_PERSISTENCE,
+    /** Schedulers and jobs of avs_sched. */
+    AVS_MEMORY_SUBSYSTEM_SCHED,
+    AVS_MEMORY_SUBSYSTEM_COUNT_
+} avs_memory_subsystem_t;
+
+/**
+ * Returns an allocator that forwards to the system <c>malloc()</c>,
+ * <c>realloc()</c> and <c>free()</c>. It is thread-safe and is used by all
+ * subsystems by default.
+ */
+avs_allocator_t *avs_allocator_system(void);
+
+/**
+ * Installs an allocator that will be used for new allocations made by a given
+ * subsystem.
+ *
+ * Blocks that have already been allocated are not affected - they will be
+ * returned to the allocator that they have been obtained from. It is thus
+ * only safe to destroy an allocator after all blocks allocated from it have
+ * been freed (or, in case of arena allocators, are no longer used).
+ *
+ * This function is not thread-safe; it shall be called when no other thread
+ * may allocate memory through avs_commons, typically during initialization.
+ *
+ * @param subsystem Subsystem to configure.
+ *
+ * @param allocator Allocator to use, or NULL to revert to using the allocator
+ *                  configured for @ref AVS_MEMORY_SUBSYSTEM_DEFAULT (or the
+ *                  system allocator, if @p subsystem is the default one).
+ */
+void avs_memory_set_allocator(avs_memory_subsystem_t subsystem,
+                              avs_allocator_t *allocator);
+
+/**
+ * Returns the allocator used for new allocations made by a given subsystem.
+ * Never returns NULL.
+ */
+avs_allocator_t *avs_memory_get_allocator(avs_memory_subsystem_t subsystem);
+
+/**
+ * Allocates memory from a specific allocator. Semantics are the same as of
+ * @ref avs_malloc. The resulting block shall be freed using @ref avs_free.
+ */
+void *avs_allocator_malloc(avs_allocator_t *allocator, size_t size);
+
+/**
+ * Allocates zeroed memory from a specific allocator. Semantics are the same as
+ * of @ref avs_calloc. The resulting block shall be freed using @ref avs_free.
+ */
+void *avs_allocator_calloc(avs_allocator_t *allocator,
+                           size_t nmemb,
+                           size_t size);
+
+/**
+ * Resizes a block of memory. Semantics are the same as of @ref avs_realloc.
+ *
+ * @p allocator is only used if @p ptr is NULL. Otherwise, the block is always
+ * resized using the allocator that it has been obtained from.
+ */
+void *
+avs_allocator_realloc(avs_allocator_t *allocator, void *ptr, size_t size);
+
+/**
+ * Same as @ref avs_allocator_malloc, but attributes the allocation to @p tag
+ * for the purpose of statistics available when
+ * <c>AVS_COMMONS_UTILS_WITH_MEMORY_STATS</c> is enabled (see
+ * avs_memory_stats.h). Otherwise, @p tag is ignored.
+ *
+ * @p tag shall be NULL or point to a string with static storage duration.
+ */
+void *avs_allocator_malloc_tagged(avs_allocator_t *allocator,
+                                  size_t size,
+                                  const char *tag);
+
+/**
+ * Same as @ref avs_allocator_calloc, but attributes the allocation to @p tag.
+ * See @ref avs_allocator_malloc_tagged for details.
+ */
+void *avs_allocator_calloc_tagged(avs_allocator_t *allocator,
+                                  size_t nmemb,
+                                  size_t size,
+                                  const char *tag);
+
+/**
+ * Same as @ref avs_allocator_realloc, but if a new block needs to be allocated,
+ * attributes it to @p tag. See @ref avs_allocator_malloc_tagged for details.
+ */
+void *avs_allocator_realloc_tagged(avs_allocator_t *allocator,
+                                   void *ptr,
+                                   size_t size,
+                                   const char *tag);
+
+/**
+ * Creates a bump-pointer arena allocator.
+ *
+ * Memory is obtained from the @p backing allocator in chunks of
+ * @p chunk_size bytes (or larger, if a single allocation does not fit), and
+ * handed out sequentially. Freeing a block is a no-op, unless it is the most
+ * recently allocated one. All memory is released at once by
+ * @ref avs_arena_allocator_reset or @ref avs_arena_allocator_cleanup.
+ *
+ * Arena allocators are not thread-safe.
+ *
+ * @param out_arena  Pointer to a variable that will be set to the newly
+ *                   created allocator.
+ *
+ * @param backing    Allocator to obtain chunks from, or NULL to use
+ *                   @ref avs_allocator_system.
+ *
+ * @param chunk_size Preferred size of chunks requested from @p backing.
+ *
+ * @param max_size   Limit on the total size of chunks held by the arena, or 0
+ *                   for no limit. Allocations that would exceed it fail.
+ *
+ * @returns 0 for success, or -1 in case of error.
+ */
+int avs_arena_allocator_create(avs_allocator_t **out_arena,
+                               avs_allocator_t *backing,
+                               size_t chunk_size,
+                               size_t max_size);
+
+/**
+ * Invalidates all blocks allocated from an arena at once. The first chunk is
+ * retained for reuse; all other chunks are returned to the backing allocator.
+ */
+void avs_arena_allocator_reset(avs_allocator_t *arena);
+
+/**
+ * Destroys an arena allocator, returning all its memory to the backing
+ * allocator, and sets @p *arena_ptr to NULL.
+ */
+void avs_arena_allocator_cleanup(avs_allocator_t **arena_ptr);
+
+/**
+ * Returns the number of bytes currently handed out by an arena, including
+ * per-block overhead and alignment padding.
+ */
+size_t avs_arena_allocator_bytes_used(const avs_allocator_t *arena);
+
+/**
+ * Returns the total size of chunks currently held by an arena.
+ */
+size_t avs_arena_allocator_bytes_reserved(const avs_allocator_t *arena);
+
+/**
+ * Creates a size-class slab allocator.
+ *
+ * Requests are rounded up to a power of two and served from per-size-class
+ * free lists, which are refilled by carving slabs of @p slab_size bytes
+ * obtained from the @p backing allocator. Requests larger than
+ * @p max_block_size are forwarded to @p backing directly.
+ *
+ * Slabs are only returned to @p backing when the allocator is destroyed.
+ * Slab allocators are not thread-safe.
+ *
+ * @param out_slab       Pointer to a variable that will be set to the newly
+ *                       created allocator.
+ *
+ * @param backing        Allocator to obtain slabs from, or NULL to use
+ *                       @ref avs_allocator_system.
+ *
+ * @param slab_size      Size of slabs requested from @p backing.
+ *
+ * @param max_block_size Size of the largest size class. Shall not be larger
+ *                       than @p slab_size.
+ *
+ * @returns 0 for success, or -1 in case of error.
+ */
+int avs_slab_allocator_create(avs_allocator_t **out_slab,
+                              avs_allocator_t *backing,
+                              size_t slab_size,
+                              size_t max_block_size);
+
+/**
+ * Destroys a slab allocator, returning all slabs to the backing allocator, and
+ * sets @p *slab_ptr to NULL. Blocks larger than the largest size class that
+ * are still allocated are not affected.
+ */
+void avs_slab_allocator_cleanup(avs_allocator_t **slab_ptr);
+
+/**
+ * Returns the total size of slabs currently held by a slab allocator.
+ */
+size_t avs_slab_allocator_bytes_reserved(const avs_allocator_t *slab);
+
+#    ifdef __cplusplus
+}
+#    endif
+
+#endif // AVS_COMMONS_UTILS_WITH_ALLOCATORS
+
+#endif // AVS_COMMONS_UTILS_ALLOCATOR_H
@@ -69,9 +69,69 @@ typedef struct avs_buffer_struct avs_buffer_t;
  * Circular byte buffer object type.
  */
 
+/**
+ * Storage management strategy of a buffer object.
+ */
+typedef enum {
+    /**
+     * Data is always kept in a single contiguous region. Unread data is moved
+     * to the beginning of the storage whenever more free space is needed at the
+     * end. This is the mode used by @ref avs_buffer_create.
+     */
+    AVS_BUFFER_MODE_LINEAR,
+
+    /**
+     * Data may wrap around the end of the storage.
+     * @ref avs_buffer_append_bytes, @ref avs_buffer_fill_bytes,
+     * @ref avs_buffer_advance_ptr and @ref avs_buffer_consume_bytes never move
+     * any data.
+     *
+     * @ref avs_buffer_data and @ref avs_buffer_raw_insert_ptr still guarantee
+     * contiguous regions, so they may need to move the data if it (or the free
+     * space, respectively) wraps around at the time of calling.
+     */
+    AVS_BUFFER_MODE_CIRCULAR,
+
+    /**
+     * Same as @ref AVS_BUFFER_MODE_CIRCULAR, but the storage is mapped twice
+     * at adjacent virtual addresses, so that both data and free space are
+     * always contiguous and no function ever needs to move any data.
+     *
+     * Requires <c>AVS_COMMONS_BUFFER_WITH_MIRRORED_MAPPING</c>. The capacity is
+     * rounded up to a multiple of the system page size. If the mapping cannot
+     * be created, @ref AVS_BUFFER_MODE_CIRCULAR is used instead.
+     */
+    AVS_BUFFER_MODE_CIRCULAR_MIRRORED
+} avs_buffer_mode_t;
+
+/**
+ * Maximum number of spans that @ref avs_buffer_data_spans and
+ * @ref avs_buffer_free_spans may return.
+ */
+#define AVS_BUFFER_MAX_SPANS 2
+
+/**
+ * Read-only region of buffer memory, analogous to <c>struct iovec</c>.
+ */
+typedef struct {
+    const char *data;
+    size_t size;
+} avs_buffer_const_span_t;
+
+/**
+ * Writable region of buffer memory, analogous to <c>struct iovec</c>.
+ */
+typedef struct {
+    char *data;
+    size_t size;
+} avs_buffer_span_t;
+
 /**
  * Allocates a new buffer with a specified size (capacity).
  *
+ * Equivalent to calling @ref avs_buffer_create_with_mode with
+ * @ref AVS_BUFFER_MODE_LINEAR.
+ *
  * @param buffer Pointer to a variable which will be updated with the newly
  *               allocated buffer object.
  *
@@ -81,6 +141,63 @@ typedef struct avs_buffer_struct avs_buffer_t;
  */
 int avs_buffer_create(avs_buffer_t **buffer, size_t size);
 
+/**
+ * Allocates a new buffer with a specified size (capacity) and storage
+ * management strategy.
+ *
+ * @param buffer Pointer to a variable which will be updated with the newly
+ *               allocated buffer object.
+ *
+ * @param size   Desired capacity of the buffer, in bytes. Actual capacity may
+ *               be larger, see @ref AVS_BUFFER_MODE_CIRCULAR_MIRRORED.
+ *
+ * @param mode   Storage management strategy to use.
+ *
+ * @return 0 for success, or -1 in case of error.
+ */
+int avs_buffer_create_with_mode(avs_buffer_t **buffer,
+                                size_t size,
+                                avs_buffer_mode_t mode);
+
+/**
+ * Allocates a new buffer that may be shared between exactly two threads
+ * without any external locking: a single producer and a single consumer.
+ *
+ * The producer may only call @ref avs_buffer_space_left,
+ * @ref avs_buffer_free_spans, @ref avs_buffer_append_bytes,
+ * @ref avs_buffer_fill_bytes and @ref avs_buffer_advance_ptr. The consumer may
+ * only call @ref avs_buffer_data_size, @ref avs_buffer_data_spans and
+ * @ref avs_buffer_consume_bytes. Each side may also use
+ * @ref avs_buffer_capacity and @ref avs_buffer_mode. In
+ * @ref AVS_BUFFER_MODE_CIRCULAR_MIRRORED, @ref avs_buffer_raw_insert_ptr and
+ * @ref avs_buffer_data are also available to the producer and the consumer,
+ * respectively. Neither side ever moves any data.
+ *
+ * @ref avs_buffer_reset and @ref avs_buffer_free may only be called when the
+ * other side is known not to access the buffer.
+ *
+ * Requires <c>AVS_COMMONS_BUFFER_WITH_SPSC</c>.
+ *
+ * @param buffer Pointer to a variable which will be updated with the newly
+ *               allocated buffer object.
+ *
+ * @param size   Desired capacity of the buffer, in bytes.
+ *
+ * @param mode   Storage management strategy to use. Must be either
+ *               @ref AVS_BUFFER_MODE_CIRCULAR or
+ *               @ref AVS_BUFFER_MODE_CIRCULAR_MIRRORED. Note that the latter
+ *               may fall back to the former; check @ref avs_buffer_mode
+ *               before relying on the functions available only in the
+ *               mirrored mode.
+ *
+ * @return 0 for success, or -1 in case of error, including the case when
+ *         @p mode is @ref AVS_BUFFER_MODE_LINEAR or SPSC support is not
+ *         compiled in.
+ */
+int avs_buffer_create_spsc(avs_buffer_t **buffer,
+                           size_t size,
+                           avs_buffer_mode_t mode);
+
 /**
  * Destroys a buffer object, freeing any used resources.
  *
@@ -89,6 +206,16 @@ int avs_buffer_create(avs_buffer_t **buffer, size_t size);
  */
 void avs_buffer_free(avs_buffer_t **buffer);
 
+/**
+ * Returns the storage management strategy actually used by the buffer.
+ *
+ * @param buffer Buffer object to operate on.
+ *
+ * @return Mode of the buffer. It may differ from the one requested at creation
+ *         time if @ref AVS_BUFFER_MODE_CIRCULAR_MIRRORED was not available.
+ */
+avs_buffer_mode_t avs_buffer_mode(const avs_buffer_t *buffer);
+
 /**
  * Clears the buffer, making all its capacity available to data.
  *
@@ -137,6 +264,9 @@ size_t avs_buffer_space_left(const avs_buffer_t *buffer);
  * - @ref avs_buffer_fill_bytes
  * - @ref avs_buffer_raw_insert_ptr
  *
+ * In @ref AVS_BUFFER_MODE_CIRCULAR, calling this function may itself move the
+ * data if it wraps around the end of the storage.
+ *
  * @param buffer Buffer object to operate on.
  *
  * @return Pointer to a contiguous array of @ref avs_buffer_data_size bytes of
@@ -166,6 +296,51 @@ const char *avs_buffer_data(const avs_buffer_t *buffer);
  */
 char *avs_buffer_raw_insert_ptr(avs_buffer_t *buffer);
 
+/**
+ * Retrieves pointers to all consumable data in the buffer, as up to
+ * @ref AVS_BUFFER_MAX_SPANS regions that shall be processed in order.
+ *
+ * Unlike @ref avs_buffer_data, this function never moves any data. After
+ * processing some of the data, @ref avs_buffer_consume_bytes shall be called
+ * with the total number of processed bytes.
+ *
+ * The spans are invalidated by the same functions that invalidate the pointer
+ * returned by @ref avs_buffer_data.
+ *
+ * @param buffer    Buffer object to operate on.
+ *
+ * @param out_spans Array that will be filled with the data regions.
+ *
+ * @return Number of non-empty spans written to @p out_spans; 0 if the buffer
+ *         is empty.
+ */
+size_t avs_buffer_data_spans(
+        const avs_buffer_t *buffer,
+        avs_buffer_const_span_t out_spans[AVS_BUFFER_MAX_SPANS]);
+
+/**
+ * Retrieves pointers to all free space in the buffer, as up to
+ * @ref AVS_BUFFER_MAX_SPANS regions that shall be filled in order. This is
+ * useful for passing the buffer to scatter/gather I/O functions such as
+ * <c>readv()</c> or <c>recvmsg()</c>.
+ *
+ * After filling some of the space, @ref avs_buffer_advance_ptr shall be called
+ * with the total number of bytes filled.
+ *
+ * In @ref AVS_BUFFER_MODE_LINEAR, this function may move the data, the same as
+ * @ref avs_buffer_raw_insert_ptr, and always returns at most one span. In the
+ * circular modes, it never moves any data.
+ *
+ * @param buffer    Buffer object to operate on.
+ *
+ * @param out_spans Array that will be filled with the free regions.
+ *
+ * @return Number of non-empty spans written to @p out_spans; 0 if the buffer
+ *         is full.
+ */
+size_t avs_buffer_free_spans(avs_buffer_t *buffer,
+                             avs_buffer_span_t out_spans[AVS_BUFFER_MAX_SPANS]);
+
 /**
  * Marks some amount of data as consumed, freeing portion of the available
  * capacity.
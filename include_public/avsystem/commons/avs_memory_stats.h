@@ -0,0 +1,153 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVS_COMMONS_UTILS_MEMORY_STATS_H
+#define AVS_COMMONS_UTILS_MEMORY_STATS_H
+
+#include <avsystem/commons/avs_defs.h>
+
+#ifdef AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+/**
+ * @file avs_memory_stats.h
+ *
+ * Heap usage accounting.
+ *
+ * When <c>AVS_COMMONS_UTILS_WITH_MEMORY_STATS</c> is enabled, every allocation
+ * made through avs_malloc() and related functions is attributed to a tag.
+ * Allocations made by avs_commons itself are tagged with the name of the
+ * module that performed them (e.g. <c>"avs_net"</c>), the same as used in log
+ * messages. Allocations made by application code are attributed to
+ * @ref AVS_MEMORY_STATS_UNTAGGED, unless the <c>_tagged</c> allocation
+ * functions declared in avs_allocator.h are used. The library resolves its
+ * tags once per source file, while the <c>_tagged</c> functions look the tag
+ * up by name on each call.
+ *
+ * Counters are maintained with relaxed atomic operations, so each of them is
+ * accurate, but a set of counters retrieved at once is not necessarily a
+ * consistent snapshot if other threads allocate memory at the same time.
+ */
+
+/**
+ * Tag used for allocations made without one, and for tags that did not fit in
+ * the table of at most @ref AVS_MEMORY_STATS_MAX_TAGS entries.
+ */
+#    define AVS_MEMORY_STATS_UNTAGGED "(untagged)"
+
+/**
+ * Maximum number of distinct tags that are tracked separately, including
+ * @ref AVS_MEMORY_STATS_UNTAGGED.
+ */
+#    define AVS_MEMORY_STATS_MAX_TAGS 64
+
+/**
+ * Number of buckets in allocation size histograms. Bucket 0 counts allocations
+ * of up to 16 bytes, bucket <c>n</c> counts allocations larger than
+ * <c>8 << n</c> bytes and up to <c>16 << n</c> bytes, and the last bucket
+ * counts all allocations that do not fit in any other.
+ */
+#    define AVS_MEMORY_STATS_HISTOGRAM_BUCKETS 16
+
+typedef struct {
+    /** Tag that the statistics refer to; NULL for totals. */
+    const char *tag;
+    /** Number of bytes currently allocated. */
+    size_t live_bytes;
+    /**
+     * Highest value of @ref live_bytes since start or the last call to
+     * @ref avs_memory_stats_reset_peak.
+     */
+    size_t peak_bytes;
+    /** Number of blocks currently allocated. */
+    size_t live_allocations;
+    /** Number of allocations made since start. */
+    size_t total_allocations;
+    /** Allocations made since start, by requested size. */
+    size_t histogram[AVS_MEMORY_STATS_HISTOGRAM_BUCKETS];
+} avs_memory_stats_t;
+
+/**
+ * Retrieves statistics for a single tag.
+ *
+ * @param tag       Tag to query.
+ *
+ * @param out_stats Structure to fill.
+ *
+ * @returns 0 for success, or -1 if no allocations have ever been made with
+ *          @p tag.
+ */
+int avs_memory_stats_get(const char *tag, avs_memory_stats_t *out_stats);
+
+/**
+ * Retrieves statistics summed over all tags. Note that @ref peak_bytes is
+ * the sum of per-tag peaks, which is an upper bound of the actual peak.
+ */
+void avs_memory_stats_get_total(avs_memory_stats_t *out_stats);
+
+typedef void avs_memory_stats_handler_t(const avs_memory_stats_t *stats,
+                                        void *arg);
+
+/**
+ * Calls @p handler for each tag that has ever been used.
+ */
+void avs_memory_stats_foreach(avs_memory_stats_handler_t *handler, void *arg);
+
+/**
+ * Resets peak usage of each tag to its current usage.
+ */
+void avs_memory_stats_reset_peak(void);
+
+/**
+ * Requests that @ref avs_memory_stats_dump_due starts returning true once per
+ * @p period allocations, e.g. to log current statistics periodically.
+ *
+ * Nothing is ever called from within the allocation functions themselves; the
+ * allocator only counts allocations, and the application is expected to poll
+ * @ref avs_memory_stats_dump_due from a convenient place, such as its main
+ * loop.
+ *
+ * @param period Number of allocations between dumps; 0 disables the feature.
+ */
+void avs_memory_stats_set_dump_period(size_t period);
+
+/**
+ * Checks whether at least one period set using
+ * @ref avs_memory_stats_set_dump_period has elapsed since the last call that
+ * returned true.
+ *
+ * @returns true if statistics should be dumped now, false otherwise.
+ */
+bool avs_memory_stats_dump_due(void);
+
+/**
+ * Logs statistics of all tags as <c>avs_utils</c> INFO messages.
+ *
+ * It shall not be called from within a custom allocator, as logging may
+ * allocate memory.
+ */
+void avs_memory_stats_log(void);
+
+#    ifdef __cplusplus
+}
+#    endif
+
+#endif // AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+
+#endif // AVS_COMMONS_UTILS_MEMORY_STATS_H
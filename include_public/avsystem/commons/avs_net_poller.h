@@ -0,0 +1,166 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file avs_net_poller.h
+ */
+
+#ifndef AVS_COMMONS_NET_POLLER_H
+#define AVS_COMMONS_NET_POLLER_H
+
+#include <stddef.h>
+
+#include <avsystem/commons/avs_errno.h>
+#include <avsystem/commons/avs_socket.h>
+#include <avsystem/commons/avs_time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Object that waits for readiness of many sockets at once, so that a single
+ * thread can serve a large number of connections without blocking on any of
+ * them.
+ *
+ * On Linux, it is implemented using <c>epoll</c>, so the cost of waiting does
+ * not depend on the number of registered sockets. On other platforms,
+ * <c>poll()</c> is used instead.
+ */
+typedef struct avs_net_poller_struct avs_net_poller_t;
+
+/** The socket may be received from (or accepted on) without blocking. */
+#define AVS_NET_POLLER_READ (1 << 0)
+
+/** The socket may be sent to without blocking. */
+#define AVS_NET_POLLER_WRITE (1 << 1)
+
+/**
+ * An error or hangup condition occurred on the socket; the next operation on
+ * it will report it. It is always reported, regardless of the requested
+ * events.
+ */
+#define AVS_NET_POLLER_ERROR (1 << 2)
+
+typedef struct {
+    /** Socket that is ready. */
+    avs_net_socket_t *socket;
+
+    /** Value passed to @ref avs_net_poller_add for this socket. */
+    void *user_data;
+
+    /** Bit mask of <c>AVS_NET_POLLER_*</c> flags describing the readiness. */
+    int events;
+} avs_net_poller_event_t;
+
+/**
+ * Creates a new poller with no sockets registered.
+ *
+ * @param out_poller Pointer to a variable to store the created poller in. It
+ *                   shall be freed using @ref avs_net_poller_cleanup.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed; <c>AVS_ENOTSUP</c> if neither <c>epoll</c> nor
+ *          <c>poll()</c> is available.
+ */
+avs_error_t avs_net_poller_create(avs_net_poller_t **out_poller);
+
+/**
+ * Frees the poller and sets @p *poller to NULL. The registered sockets are not
+ * affected in any way.
+ */
+void avs_net_poller_cleanup(avs_net_poller_t **poller);
+
+/**
+ * Registers a socket in the poller.
+ *
+ * The system socket is retrieved using @ref avs_net_socket_get_system at this
+ * point, so the socket needs to be already bound, connected or accepted. If
+ * the system socket changes afterwards (e.g. the socket is closed and then
+ * connected again), it needs to be removed and added again.
+ *
+ * @param poller    Poller to operate on.
+ * @param socket    Socket to register. It must not be already registered, and
+ *                  must be removed from the poller before it is cleaned up.
+ * @param events    Bit mask of @ref AVS_NET_POLLER_READ and
+ *                  @ref AVS_NET_POLLER_WRITE to wait for.
+ * @param user_data Opaque value to report along with the socket's events.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+avs_error_t avs_net_poller_add(avs_net_poller_t *poller,
+                               avs_net_socket_t *socket,
+                               int events,
+                               void *user_data);
+
+/**
+ * Changes the set of events to wait for on a registered socket, e.g. to
+ * request @ref AVS_NET_POLLER_WRITE only while there is data to send.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed; <c>AVS_ENOENT</c> if the socket is not registered.
+ */
+avs_error_t avs_net_poller_modify(avs_net_poller_t *poller,
+                                  avs_net_socket_t *socket,
+                                  int events);
+
+/**
+ * Unregisters a socket from the poller.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed; <c>AVS_ENOENT</c> if the socket is not registered.
+ */
+avs_error_t avs_net_poller_remove(avs_net_poller_t *poller,
+                                  avs_net_socket_t *socket);
+
+/**
+ * Waits until at least one of the registered sockets is ready, and reports the
+ * ready sockets.
+ *
+ * Sockets that hold already received data in their internal buffers (see
+ * @ref AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA), e.g. (D)TLS sockets after a
+ * receive call that did not consume a whole decrypted record, are reported as
+ * readable without waiting. To avoid querying every registered socket, this is
+ * checked only for sockets that were reported as readable by the previous call
+ * and for the newly added ones.
+ *
+ * @param poller          Poller to operate on.
+ * @param timeout         Maximum time to wait. A zero duration only checks
+ *                        the current state; an invalid duration waits
+ *                        indefinitely.
+ * @param out_events      Array to store information about the ready sockets
+ *                        in. Each socket is reported at most once.
+ * @param max_events      Size of the @p out_events array; must not be 0. If
+ *                        more sockets are ready, the remaining ones will be
+ *                        reported by subsequent calls.
+ * @param out_event_count Set to the number of entries stored in
+ *                        @p out_events; 0 if the timeout expired.
+ *
+ * @returns @ref AVS_OK for success (including timeout), or an error condition
+ *          for which the operation failed.
+ */
+avs_error_t avs_net_poller_wait(avs_net_poller_t *poller,
+                                avs_time_duration_t timeout,
+                                avs_net_poller_event_t *out_events,
+                                size_t max_events,
+                                size_t *out_event_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AVS_COMMONS_NET_POLLER_H */
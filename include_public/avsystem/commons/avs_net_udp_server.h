@@ -0,0 +1,181 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file avs_net_udp_server.h
+ */
+
+#ifndef AVS_COMMONS_NET_UDP_SERVER_H
+#define AVS_COMMONS_NET_UDP_SERVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <avsystem/commons/avs_errno.h>
+#include <avsystem/commons/avs_socket.h>
+#include <avsystem/commons/avs_time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * UDP server that serves many peers using a single bound socket.
+ *
+ * Datagrams received on the server socket are demultiplexed by their source
+ * address into lightweight per-peer sockets, using a hash table. Unlike
+ * accepting UDP "connections" using @ref avs_net_socket_accept, this does not
+ * require creating, connecting and rebinding a system socket for each peer,
+ * and no datagrams are lost while a new peer is being accepted.
+ *
+ * Peer sockets behave like connected UDP sockets in the
+ * @ref AVS_NET_SOCKET_STATE_ACCEPTED state: @ref avs_net_socket_send and
+ * @ref avs_net_socket_receive exchange datagrams with the specific peer, and
+ * they can be decorated e.g. using @ref avs_net_dtls_socket_decorate_in_place
+ * to implement a DTLS server. They do not have system sockets of their own, so
+ * @ref avs_net_socket_get_system returns NULL for them.
+ *
+ * The server socket is read using @ref avs_net_socket_receive_batch. If that
+ * is not supported, datagrams are received one by one using
+ * @ref avs_net_socket_receive_from instead.
+ *
+ * Datagrams for each peer are queued in memory until received. The queues are
+ * bounded; datagrams that do not fit are dropped, just like the operating
+ * system does when the socket receive buffer is full.
+ *
+ * The server and its peer sockets are not thread-safe and shall be used from a
+ * single thread.
+ */
+typedef struct avs_net_udp_server_struct avs_net_udp_server_t;
+
+/**
+ * Creates a new UDP server, bound to the specified address.
+ *
+ * @param out_server    Pointer to a variable to store the created server in. It
+ *                      shall be freed using @ref avs_net_udp_server_cleanup.
+ * @param configuration Configuration of the server socket, as for
+ *                      @ref avs_net_udp_socket_create. May be NULL.
+ * @param localaddr     Local address to bind to; NULL to bind to all
+ *                      interfaces.
+ * @param port          Local port to bind to; NULL or "0" to use an ephemeral
+ *                      port.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+avs_error_t
+avs_net_udp_server_create(avs_net_udp_server_t **out_server,
+                          const avs_net_socket_configuration_t *configuration,
+                          const char *localaddr,
+                          const char *port);
+
+/**
+ * Closes the server socket, frees the server and sets @p *server to NULL.
+ *
+ * Peer sockets that have not been cleaned up yet are closed; they still need
+ * to be freed using @ref avs_net_socket_cleanup.
+ */
+void avs_net_udp_server_cleanup(avs_net_udp_server_t **server);
+
+/**
+ * Returns the bound socket used by the server. It may be used e.g. to query
+ * the local port, or to register the server in an @ref avs_net_poller_t. It
+ * shall not be used for sending or receiving data directly.
+ */
+avs_net_socket_t *avs_net_udp_server_socket(avs_net_udp_server_t *server);
+
+/**
+ * Returns the number of open peer sockets.
+ */
+size_t avs_net_udp_server_peer_count(avs_net_udp_server_t *server);
+
+/**
+ * Waits for a datagram from a new peer and creates a peer socket for it.
+ *
+ * Datagrams from already accepted peers that arrive in the meantime are queued
+ * in the respective peer sockets.
+ *
+ * @param server          Server to operate on.
+ * @param timeout         Maximum time to wait. A zero duration only checks the
+ *                        datagrams that are already received; an invalid
+ *                        duration waits indefinitely.
+ * @param out_peer_socket Pointer to a variable to store the new peer socket
+ *                        in. It shall be freed using
+ *                        @ref avs_net_socket_cleanup.
+ * @param user_data       Opaque pointer associated with the new peer socket,
+ *                        reported by @ref avs_net_udp_server_wait. It may be
+ *                        changed later using
+ *                        @ref avs_net_udp_server_set_user_data.
+ *
+ * @returns @ref AVS_OK for success, <c>AVS_ETIMEDOUT</c> if no new peer sent
+ *          anything before the timeout, or an error condition for which the
+ *          operation failed.
+ */
+avs_error_t avs_net_udp_server_accept(avs_net_udp_server_t *server,
+                                      avs_time_duration_t timeout,
+                                      avs_net_socket_t **out_peer_socket,
+                                      void *user_data);
+
+/**
+ * Changes the opaque pointer associated with a peer socket, e.g. one accepted
+ * by @ref avs_net_udp_server_wait, for which it is initially NULL.
+ *
+ * @param peer_socket Peer socket created by @ref avs_net_udp_server_accept or
+ *                    @ref avs_net_udp_server_wait.
+ * @param user_data   New value of the opaque pointer.
+ *
+ * @returns @ref AVS_OK for success, or <c>AVS_EINVAL</c> if @p peer_socket is
+ *          not a peer socket.
+ */
+avs_error_t avs_net_udp_server_set_user_data(avs_net_socket_t *peer_socket,
+                                             void *user_data);
+
+/**
+ * Waits until either any peer socket has a datagram ready to receive, or a
+ * datagram arrives from a new peer. This allows a single thread to serve all
+ * peers.
+ *
+ * A peer socket is reported when a datagram is queued for it, unless it has
+ * already been reported and not received from since. If it still has datagrams
+ * queued after a receive call, it will be reported again.
+ *
+ * @param server           Server to operate on.
+ * @param timeout          Maximum time to wait, as in
+ *                         @ref avs_net_udp_server_accept.
+ * @param out_socket       Pointer to a variable to store the ready socket in.
+ * @param out_is_new       Set to true if <c>*out_socket</c> is a newly
+ *                         accepted peer socket, which shall be freed using
+ *                         @ref avs_net_socket_cleanup; false if it is an
+ *                         already accepted one.
+ * @param out_user_data    Pointer to a variable to store the opaque pointer
+ *                         associated with <c>*out_socket</c> in; it is NULL
+ *                         for a newly accepted peer socket. May be NULL.
+ *
+ * @returns @ref AVS_OK for success, <c>AVS_ETIMEDOUT</c> if no datagrams
+ *          arrived before the timeout, or an error condition for which the
+ *          operation failed.
+ */
+avs_error_t avs_net_udp_server_wait(avs_net_udp_server_t *server,
+                                    avs_time_duration_t timeout,
+                                    avs_net_socket_t **out_socket,
+                                    bool *out_is_new,
+                                    void **out_user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AVS_COMMONS_NET_UDP_SERVER_H */
@@ -0,0 +1,203 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVS_COMMONS_UTILS_REFBUF_H
+#define AVS_COMMONS_UTILS_REFBUF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <avsystem/commons/avs_defs.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file avs_refbuf.h
+ *
+ * Reference-counted byte buffers.
+ *
+ * Unlike @ref avs_shared_buffer_t, which is a scratch area meant for exclusive
+ * use by one entity at a time, an @ref avs_refbuf_t may be referenced by any
+ * number of owners at once, each of which holds either a reference to the
+ * whole buffer, or a slice (@ref avs_refbuf_slice_t) of a part of it. The
+ * storage is freed when the last reference is dropped.
+ *
+ * If <c>AVS_COMMONS_HAVE_C11_STDATOMIC</c> is defined, reference counting is
+ * atomic, so references to the same buffer may be acquired and released from
+ * different threads. Otherwise, reference counting is NOT thread-safe, and all
+ * references to a given buffer (including those held by slices) shall be
+ * acquired and released from a single thread, or under a lock held by the
+ * caller.
+ *
+ * Data in a buffer that is referenced by more than one owner shall be treated
+ * as read-only, unless the owners agree on some other protocol.
+ */
+typedef struct avs_refbuf_struct avs_refbuf_t;
+
+/**
+ * Allocates a new reference-counted buffer. The buffer data and the reference
+ * count are allocated in a single block. The caller holds the only reference.
+ *
+ * @param size Size of the buffer, in bytes. Contents are uninitialized.
+ *
+ * @returns Newly created buffer, or NULL in case of an out-of-memory
+ *          condition.
+ */
+avs_refbuf_t *avs_refbuf_new(size_t size);
+
+/**
+ * Creates a reference-counted buffer that takes ownership of an existing
+ * memory block, without copying it. The caller holds the only reference.
+ *
+ * @param data Memory block allocated with @ref avs_malloc or a related
+ *             function. It will be freed with @ref avs_free when the last
+ *             reference is dropped. If this function fails, @p data is left
+ *             intact and is still owned by the caller.
+ *
+ * @param size Number of bytes of @p data that are accessible through the
+ *             buffer.
+ *
+ * @returns Newly created buffer, or NULL in case of an out-of-memory
+ *          condition.
+ */
+avs_refbuf_t *avs_refbuf_wrap(void *data, size_t size);
+
+/**
+ * Returns the pointer to data stored in the buffer.
+ */
+void *avs_refbuf_data(avs_refbuf_t *buf);
+
+/**
+ * Returns the size of the buffer.
+ */
+size_t avs_refbuf_size(const avs_refbuf_t *buf);
+
+/**
+ * Acquires an additional reference to @p buf. See the notes on thread safety
+ * above.
+ *
+ * @returns @p buf
+ */
+avs_refbuf_t *avs_refbuf_ref(avs_refbuf_t *buf);
+
+/**
+ * Releases a reference to the buffer pointed to by @p *buf_ptr, freeing it if
+ * it was the last one, and sets @p *buf_ptr to NULL. Does nothing if
+ * @p *buf_ptr is already NULL.
+ */
+void avs_refbuf_unref(avs_refbuf_t **buf_ptr);
+
+/**
+ * Checks whether the caller holds the only reference to @p buf. If so, it is
+ * safe to modify or reuse the buffer's data.
+ */
+bool avs_refbuf_is_unique(const avs_refbuf_t *buf);
+
+/**
+ * Releases the reference to a buffer created with @ref avs_refbuf_wrap and
+ * gives back ownership of the wrapped memory block, provided that it is the
+ * only reference. Otherwise, nothing happens.
+ *
+ * This allows code that lends its own memory to other owners to take it back
+ * without copying once all of them are done with it.
+ *
+ * @returns The memory block originally passed to @ref avs_refbuf_wrap, to be
+ *          freed with @ref avs_free; or NULL if there are other references to
+ *          the buffer, or it has been created with @ref avs_refbuf_new.
+ */
+void *avs_refbuf_unwrap(avs_refbuf_t **buf_ptr);
+
+/**
+ * A contiguous part of a reference-counted buffer. A valid slice holds one
+ * reference to @ref avs_refbuf_slice_t::buffer, so the data stays valid for as
+ * long as the slice is not released.
+ *
+ * Slices are small value types - they may be freely moved by assignment, but
+ * each slice that is not empty shall be released exactly once using
+ * @ref avs_refbuf_slice_release.
+ */
+typedef struct {
+    /** Buffer that the slice refers to; NULL for an empty slice. */
+    avs_refbuf_t *buffer;
+    /** Pointer to the first byte of the slice, within the buffer. */
+    const void *data;
+    /** Size of the slice, in bytes. */
+    size_t size;
+} avs_refbuf_slice_t;
+
+/**
+ * Initializer for an empty @ref avs_refbuf_slice_t, which does not need to be
+ * released.
+ */
+#define AVS_REFBUF_SLICE_EMPTY \
+    { NULL, NULL, 0 }
+
+/**
+ * Creates a slice of @p buf, acquiring a new reference to it.
+ *
+ * @param out_slice Variable to store the slice in. Previous contents are
+ *                  overwritten without being released.
+ *
+ * @param buf       Buffer to take the slice from.
+ *
+ * @param offset    Offset of the first byte of the slice within @p buf.
+ *
+ * @param size      Size of the slice.
+ *
+ * @returns 0 for success, or -1 if the requested range does not fit in
+ *          @p buf, in which case @p out_slice is set to an empty slice.
+ */
+int avs_refbuf_slice(avs_refbuf_slice_t *out_slice,
+                     avs_refbuf_t *buf,
+                     size_t offset,
+                     size_t size);
+
+/**
+ * Creates a slice of an existing slice, sharing its storage and acquiring a new
+ * reference to it.
+ *
+ * @param out_slice Variable to store the slice in. May be the same as
+ *                  @p slice, in which case the original slice is narrowed
+ *                  without changing the reference count.
+ *
+ * @param slice     Slice to take a part of.
+ *
+ * @param offset    Offset of the first byte of the new slice, relative to the
+ *                  beginning of @p slice.
+ *
+ * @param size      Size of the new slice.
+ *
+ * @returns 0 for success, or -1 if the requested range does not fit in
+ *          @p slice, in which case @p out_slice is not modified.
+ */
+int avs_refbuf_slice_sub(avs_refbuf_slice_t *out_slice,
+                         const avs_refbuf_slice_t *slice,
+                         size_t offset,
+                         size_t size);
+
+/**
+ * Releases the reference held by @p slice and sets it to an empty slice.
+ * Does nothing if @p slice is already empty.
+ */
+void avs_refbuf_slice_release(avs_refbuf_slice_t *slice);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AVS_COMMONS_UTILS_REFBUF_H */
@@ -37,6 +37,10 @@ extern "C" {
  * used in two different places, resulting in data corruption.
  *
  * For efficiency, the usage check is only performed in debug builds.
+ *
+ * Data that needs to be referenced by multiple owners at the same time, e.g.
+ * passed between stages of a processing pipeline without copying, shall be
+ * stored in reference-counted buffers declared in avs_refbuf.h instead.
  */
 typedef struct {
 #ifndef NDEBUG
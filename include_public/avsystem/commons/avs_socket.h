@@ -577,6 +577,47 @@ typedef enum {
      * socket or is not configured to use DANE, will yield an error.
      */
     AVS_NET_SOCKET_OPT_DANE_TLSA_ARRAY,
+
+    /**
+     * Used to check whether the socket holds some already received data in its
+     * internal buffers, e.g. decrypted (D)TLS records that have not been
+     * fully read yet. Such data may be received without waiting, even though
+     * the system socket is not reported as readable by <c>poll()</c> and
+     * similar functions. The value is read-only and passed in the <c>flag</c>
+     * field of the @ref avs_net_socket_opt_value_t union.
+     */
+    AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA,
+
+    /**
+     * Used to get or set whether the socket performs I/O optimistically. The
+     * value is passed in the <c>flag</c> field of the
+     * @ref avs_net_socket_opt_value_t union.
+     *
+     * If enabled (which is the default), send and receive operations are
+     * attempted immediately, and the socket only waits for readiness (e.g.
+     * using <c>poll()</c>) if the operation would block. This halves the number
+     * of system calls when data is already available. If disabled, the socket
+     * always waits for readiness first.
+     */
+    AVS_NET_SOCKET_OPT_OPTIMISTIC_IO,
+
+    /**
+     * Used to get the number of system calls issued by the socket for
+     * connecting, sending, receiving and waiting for readiness. It is intended
+     * for diagnostics and benchmarking. The value is read-only and passed in
+     * the <c>syscall_count</c> field of the @ref avs_net_socket_opt_value_t
+     * union.
+     */
+    AVS_NET_SOCKET_OPT_SYSCALL_COUNT,
+
+    /**
+     * Used to get the type of the socket, as passed to
+     * @ref avs_net_socket_create. Sockets that wrap another one, e.g. (D)TLS
+     * sockets, report their own type, not the type of the wrapped socket. The
+     * value is read-only and passed in the <c>socket_type</c> field of the
+     * @ref avs_net_socket_opt_value_t union.
+     */
+    AVS_NET_SOCKET_OPT_SOCKET_TYPE,
 } avs_net_socket_opt_key_t;
 
 typedef enum {
@@ -680,6 +721,8 @@ typedef union {
     bool flag;
     uint64_t bytes_sent;
     uint64_t bytes_received;
+    uint64_t syscall_count;
+    avs_net_socket_type_t socket_type;
     avs_net_socket_dane_tlsa_array_t dane_tlsa_array;
 } avs_net_socket_opt_value_t;
 
@@ -925,6 +968,174 @@ avs_error_t avs_net_socket_receive_from(avs_net_socket_t *socket,
                                         char *port,
                                         size_t port_size);
 
+/**
+ * A single datagram transferred using @ref avs_net_socket_send_batch or
+ * @ref avs_net_socket_receive_batch.
+ */
+typedef struct {
+    /**
+     * Datagram payload when sending, or buffer to store the received payload
+     * in when receiving.
+     */
+    void *buffer;
+
+    /**
+     * Payload length when sending, or number of bytes available in
+     * @ref avs_net_socket_datagram_t::buffer when receiving.
+     */
+    size_t buffer_length;
+
+    /**
+     * Set by @ref avs_net_socket_receive_batch to the number of bytes stored in
+     * @ref avs_net_socket_datagram_t::buffer. Ignored when sending.
+     */
+    size_t length;
+
+    /**
+     * Set by @ref avs_net_socket_receive_batch if the datagram did not fit in
+     * the buffer and has been truncated. Ignored when sending.
+     */
+    bool truncated;
+
+    /**
+     * Address of the sender when receiving, or the destination when sending.
+     * For sending through a connected socket, <c>peer.size</c> may be set to 0
+     * to use the connected remote address.
+     *
+     * The address is in the raw form used by the socket. Addresses received
+     * from a socket may be used to send replies through the same socket as-is;
+     * other addresses need to be resolved for the socket's address family,
+     * e.g. using @ref avs_net_addrinfo_resolve. Use
+     * @ref avs_net_resolved_endpoint_get_host_port to convert the address to
+     * text form.
+     */
+    avs_net_resolved_endpoint_t peer;
+} avs_net_socket_datagram_t;
+
+/**
+ * Sends multiple datagrams using a UDP @p socket, each to its own destination
+ * address.
+ *
+ * Where supported, the datagrams are passed to the operating system in batches
+ * (using <c>sendmmsg()</c> on Linux), so that sending many small datagrams
+ * does not cost a system call each. Otherwise, they are sent one by one.
+ *
+ * @param[in]  socket      Socket object to send data through.
+ * @param[in]  datagrams   Array of datagrams to send.
+ * @param[in]  count       Number of elements in @p datagrams .
+ * @param[out] out_sent    Number of datagrams that have been sent. On failure,
+ *                         the datagram at this index is the one that could not
+ *                         be sent.
+ *
+ * @returns @ref AVS_OK if all datagrams have been sent, or an error condition
+ *          for which the operation failed. <c>avs_errno(AVS_ENOTSUP)</c> is
+ *          returned for socket types other than UDP.
+ */
+avs_error_t
+avs_net_socket_send_batch(avs_net_socket_t *socket,
+                          const avs_net_socket_datagram_t *datagrams,
+                          size_t count,
+                          size_t *out_sent);
+
+/**
+ * Receives multiple datagrams from a UDP @p socket.
+ *
+ * Waits for the first datagram up to the time specified by the
+ * @ref AVS_NET_SOCKET_OPT_RECV_TIMEOUT option. After that, receives as many
+ * datagrams as are already queued, up to @p count, without further waiting.
+ *
+ * Where supported, the datagrams are received from the operating system in
+ * batches (using <c>recvmmsg()</c> on Linux), so that receiving many small
+ * datagrams does not cost a system call each. Otherwise, they are received one
+ * by one.
+ *
+ * Datagrams that do not fit in their buffers are truncated and marked by the
+ * @ref avs_net_socket_datagram_t::truncated flag, but do not cause an error.
+ *
+ * WARNING: If recvmsg() is not available, datagrams are reported as truncated
+ * if they are exactly as long as their buffers.
+ *
+ * @param[in]    socket       Socket object to read data from.
+ * @param[inout] datagrams    Array of datagram descriptors. The
+ *                            <c>buffer</c> and <c>buffer_length</c> fields
+ *                            shall be set before calling; all other fields are
+ *                            filled for each received datagram.
+ * @param[in]    count        Number of elements in @p datagrams .
+ * @param[out]   out_received Number of datagrams that have been received and
+ *                            stored in the initial elements of @p datagrams .
+ *
+ * @returns @ref AVS_OK if at least one datagram has been received, or an error
+ *          condition for which the operation failed; in particular,
+ *          <c>avs_errno(AVS_ETIMEDOUT)</c> if no datagram arrived in time.
+ *          <c>avs_errno(AVS_ENOTSUP)</c> is returned for socket types other
+ *          than UDP.
+ */
+avs_error_t avs_net_socket_receive_batch(avs_net_socket_t *socket,
+                                         avs_net_socket_datagram_t *datagrams,
+                                         size_t count,
+                                         size_t *out_received);
+
+/**
+ * A single buffer passed to @ref avs_net_socket_sendv.
+ */
+typedef struct {
+    const void *data;
+    size_t size;
+} avs_net_socket_iovec_t;
+
+/**
+ * Maximum number of buffers that @ref avs_net_socket_sendv accepts for
+ * datagram sockets. Stream sockets accept any number of buffers.
+ */
+#define AVS_NET_SOCKET_SENDV_MAX_IOV 16
+
+/**
+ * Sends data gathered from multiple buffers, as if they were concatenated and
+ * passed to @ref avs_net_socket_send - in particular, for UDP sockets, all the
+ * buffers form a single datagram.
+ *
+ * Where supported, the buffers are passed to the operating system in a single
+ * call (<c>sendmsg()</c>), without copying them together first.
+ *
+ * @param socket    Socket object to send data through.
+ * @param iov       Array of buffers to send, in order.
+ * @param iov_count Number of elements in @p iov . For datagram sockets, it
+ *                  shall not exceed @ref AVS_NET_SOCKET_SENDV_MAX_IOV.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed. <c>avs_errno(AVS_ENOTSUP)</c> is returned, without
+ *          sending anything, if the socket does not support vectored sends;
+ *          this is the case e.g. for (D)TLS sockets. Callers are expected to
+ *          fall back to @ref avs_net_socket_send in that case.
+ */
+avs_error_t avs_net_socket_sendv(avs_net_socket_t *socket,
+                                 const avs_net_socket_iovec_t *iov,
+                                 size_t iov_count);
+
+/**
+ * Sends as much data as can be sent immediately, without waiting for the
+ * socket to become writable.
+ *
+ * For stream sockets, this performs at most one attempt, which may send only a
+ * part of the data. For datagram sockets, either the whole datagram is sent,
+ * or nothing is.
+ *
+ * @param socket         Socket object to send data through.
+ * @param buffer         Data to send.
+ * @param buffer_length  Number of bytes to send.
+ * @param out_bytes_sent Set to the number of bytes actually sent.
+ *
+ * @returns @ref AVS_OK for success, <c>avs_errno(AVS_EAGAIN)</c> if nothing
+ *          could be sent without blocking, <c>avs_errno(AVS_ENOTSUP)</c> if
+ *          the socket does not support non-blocking sends (this is the case
+ *          e.g. for (D)TLS sockets), or an error condition for which the
+ *          operation failed.
+ */
+avs_error_t avs_net_socket_send_nonblock(avs_net_socket_t *socket,
+                                         const void *buffer,
+                                         size_t buffer_length,
+                                         size_t *out_bytes_sent);
+
 /**
  * Binds @p socket to specified local @p address and @p port .
  *
@@ -90,6 +90,29 @@ typedef avs_error_t (*avs_net_socket_set_opt_t)(
         avs_net_socket_opt_key_t option_key,
         avs_net_socket_opt_value_t option_value);
 
+typedef avs_error_t (*avs_net_socket_send_batch_t)(
+        avs_net_socket_t *socket,
+        const avs_net_socket_datagram_t *datagrams,
+        size_t count,
+        size_t *out_sent);
+
+typedef avs_error_t (*avs_net_socket_receive_batch_t)(
+        avs_net_socket_t *socket,
+        avs_net_socket_datagram_t *datagrams,
+        size_t count,
+        size_t *out_received);
+
+typedef avs_error_t (*avs_net_socket_sendv_t)(
+        avs_net_socket_t *socket,
+        const avs_net_socket_iovec_t *iov,
+        size_t iov_count);
+
+typedef avs_error_t (*avs_net_socket_send_nonblock_t)(
+        avs_net_socket_t *socket,
+        const void *buffer,
+        size_t buffer_length,
+        size_t *out_bytes_sent);
+
 typedef struct {
     avs_net_socket_connect_t connect;
     avs_net_socket_decorate_t decorate;
@@ -111,6 +134,10 @@ typedef struct {
     avs_net_socket_get_local_port_t get_local_port;
     avs_net_socket_get_opt_t get_opt;
     avs_net_socket_set_opt_t set_opt;
+    avs_net_socket_send_batch_t send_batch;
+    avs_net_socket_receive_batch_t receive_batch;
+    avs_net_socket_sendv_t sendv;
+    avs_net_socket_send_nonblock_t send_nonblock;
 } avs_net_socket_v_table_t;
 
 #ifdef __cplusplus
@@ -24,6 +24,7 @@
 
 #include <avsystem/commons/avs_defs.h>
 #include <avsystem/commons/avs_errno.h>
+#include <avsystem/commons/avs_refbuf.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -109,6 +110,46 @@ avs_error_t avs_stream_write(avs_stream_t *stream,
                              const void *buffer,
                              size_t buffer_length);
 
+/**
+ * Element of a gather list passed to @ref avs_stream_writev, analogous to
+ * <c>struct iovec</c>.
+ */
+typedef struct {
+    const void *data;
+    size_t size;
+} avs_stream_const_iovec_t;
+
+/**
+ * Element of a scatter list passed to @ref avs_stream_readv, analogous to
+ * <c>struct iovec</c>.
+ */
+typedef struct {
+    void *data;
+    size_t size;
+} avs_stream_iovec_t;
+
+/**
+ * Writes data from multiple buffers, in order, as if @ref avs_stream_write was
+ * called for each of them, but in a single operation.
+ *
+ * Streams that implement @ref AVS_STREAM_V_TABLE_EXTENSION_VECTORED (buffered,
+ * netbuf and file streams) handle the whole list at once, e.g. by copying
+ * small elements into a single outgoing buffer instead of flushing between
+ * them. For other streams, @ref avs_stream_write is called in a loop.
+ *
+ * @param stream    Stream to write data to.
+ * @param iov       Array of buffers to write. Elements with zero size are
+ *                  allowed.
+ * @param iov_count Number of elements in @p iov.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed. In case of error, an unspecified part of the data
+ *          may have been written.
+ */
+avs_error_t avs_stream_writev(avs_stream_t *stream,
+                              const avs_stream_const_iovec_t *iov,
+                              size_t iov_count);
+
 /**
  * Finishes the message written onto stream by calling
  * @ref avs_stream_vtable_t#finish_message. The underlying stream may freely
@@ -130,6 +171,9 @@ avs_error_t avs_stream_finish_message(avs_stream_t *stream);
  *
  * Format specifiers are the same as @ref printf format specifiers.
  *
+ * If the stream supports @ref avs_stream_reserve, the message is formatted
+ * directly into the stream's internal buffer, without any intermediate copy.
+ *
  * @param stream    Stream to operate on.
  * @param msg       Message format string.
  * @param ...       Message format string arguments (as in @ref printf).
@@ -199,6 +243,145 @@ avs_error_t avs_stream_read(avs_stream_t *stream,
                             void *buffer,
                             size_t buffer_length);
 
+/**
+ * Reads data into multiple buffers, filling them in order. Like
+ * @ref avs_stream_read, this function may read less data than would fit in all
+ * of the buffers; the next buffer is only filled if all the previous ones are
+ * full.
+ *
+ * Streams that implement @ref AVS_STREAM_V_TABLE_EXTENSION_VECTORED (buffered,
+ * netbuf and file streams) handle the whole list at once. For other streams,
+ * @ref avs_stream_read is called for consecutive buffers until one of them is
+ * not filled completely or the message is finished.
+ *
+ * @param stream               Stream to operate on.
+ * @param out_bytes_read       Pointer to a variable where the total amount of
+ *                             read bytes will be written, or NULL.
+ * @param out_message_finished Same as for @ref avs_stream_read.
+ * @param iov                  Array of buffers to fill.
+ * @param iov_count            Number of elements in @p iov.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+avs_error_t avs_stream_readv(avs_stream_t *stream,
+                             size_t *out_bytes_read,
+                             bool *out_message_finished,
+                             const avs_stream_iovec_t *iov,
+                             size_t iov_count);
+
+/**
+ * Reads up to @p max_length bytes from the stream, returning them as a slice of
+ * a reference-counted buffer instead of copying them into a buffer provided by
+ * the caller.
+ *
+ * If the stream implements @ref AVS_STREAM_V_TABLE_EXTENSION_SLICE (e.g. the
+ * membuf stream does), the slice refers directly to the stream's internal
+ * storage and no data is copied. Otherwise, a new buffer of @p max_length bytes
+ * is allocated and filled using @ref avs_stream_read, so @p max_length shall be
+ * reasonably small in that case.
+ *
+ * The slice stays valid regardless of any further operations on the stream,
+ * including its destruction, until it is released with
+ * @ref avs_refbuf_slice_release.
+ *
+ * @param stream               Stream to operate on.
+ * @param out_slice            Variable to store the slice in. If no bytes have
+ *                             been read, or on error, it is set to an empty
+ *                             slice. Previous contents are overwritten without
+ *                             being released.
+ * @param out_message_finished Same as for @ref avs_stream_read.
+ * @param max_length           Maximum number of bytes to read.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+avs_error_t avs_stream_read_slice(avs_stream_t *stream,
+                                  avs_refbuf_slice_t *out_slice,
+                                  bool *out_message_finished,
+                                  size_t max_length);
+
+/**
+ * Provides direct access to data buffered inside the stream, without copying
+ * it to a buffer provided by the caller. After processing some or all of the
+ * data, @ref avs_stream_consume shall be called to mark it as read.
+ *
+ * If no data is buffered, the stream may perform I/O to fetch some, blocking if
+ * necessary, in the same way as @ref avs_stream_read.
+ *
+ * The returned pointer is valid until the next call to any function on the
+ * stream other than @ref avs_stream_consume.
+ *
+ * Supported by the membuf, inbuf, buffered and netbuf streams.
+ *
+ * @param stream               Stream to operate on.
+ * @param out_data             Pointer to a variable that will be set to the
+ *                             address of the readable data.
+ * @param out_size             Pointer to a variable that will be set to the
+ *                             number of readable bytes. It is 0 only if the end
+ *                             of message has been reached.
+ * @param out_message_finished Pointer to a variable that will be set to whether
+ *                             reading all of the returned data finishes the
+ *                             logical message (see @ref avs_stream_read), or
+ *                             NULL.
+ *
+ * @returns @ref AVS_OK for success, <c>AVS_ENOTSUP</c> if the stream does not
+ *          support direct access, or an error condition for which the
+ *          operation failed.
+ */
+avs_error_t avs_stream_peek_contiguous(avs_stream_t *stream,
+                                       const void **out_data,
+                                       size_t *out_size,
+                                       bool *out_message_finished);
+
+/**
+ * Marks @p size bytes of data returned by @ref avs_stream_peek_contiguous as
+ * read.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+avs_error_t avs_stream_consume(avs_stream_t *stream, size_t size);
+
+/**
+ * Provides direct access to free space inside the stream, so that data can be
+ * produced in place instead of being passed to @ref avs_stream_write. After
+ * filling some or all of the space, @ref avs_stream_commit shall be called to
+ * actually write the data.
+ *
+ * The stream may flush previously written data or grow its storage to make
+ * room. The returned pointer is valid until the next call to any function on
+ * the stream other than @ref avs_stream_commit.
+ *
+ * Supported by the membuf, outbuf, buffered and netbuf streams.
+ *
+ * @param stream    Stream to operate on.
+ * @param size_hint Number of bytes that the caller would like to write. The
+ *                  stream may return a larger or smaller block.
+ * @param out_data  Pointer to a variable that will be set to the address of the
+ *                  free space.
+ * @param out_size  Pointer to a variable that will be set to the size of the
+ *                  free space. It may be 0 if the stream cannot currently
+ *                  accept any more data.
+ *
+ * @returns @ref AVS_OK for success, <c>AVS_ENOTSUP</c> if the stream does not
+ *          support direct access, or an error condition for which the
+ *          operation failed.
+ */
+avs_error_t avs_stream_reserve(avs_stream_t *stream,
+                               size_t size_hint,
+                               void **out_data,
+                               size_t *out_size);
+
+/**
+ * Writes @p size bytes placed at the beginning of the block returned by
+ * @ref avs_stream_reserve.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+avs_error_t avs_stream_commit(avs_stream_t *stream, size_t size);
+
 /**
  * Attempts to read EXACTLY @p buffer_length bytes from the underlying stream
  * by calling @ref avs_stream_read (possibly multiple times).
@@ -367,6 +550,11 @@ avs_error_t avs_stream_peekline(avs_stream_t *stream,
  * @p output_stream, until <c>*out_message_finished</c> is true on the input
  * stream or an error occurs.
  *
+ * If @p input_stream supports @ref avs_stream_peek_contiguous, or
+ * @p output_stream supports @ref avs_stream_reserve, data is copied directly
+ * between the internal buffers of the streams instead of through an
+ * intermediate buffer.
+ *
  * NOTE: @ref avs_stream_finish_message is NOT called on the output stream, so
  * you need to call it manually if needed.
  *
@@ -376,6 +564,49 @@ avs_error_t avs_stream_peekline(avs_stream_t *stream,
 avs_error_t avs_stream_copy(avs_stream_t *output_stream,
                             avs_stream_t *input_stream);
 
+/**
+ * Copies a message from one stream to another, just like
+ * @ref avs_stream_copy, but allows controlling the intermediate buffer and
+ * reports the amount of data copied.
+ *
+ * If both streams are backed by file descriptors (e.g. they were created with
+ * @ref avs_stream_file_create_fd) and <c>AVS_COMMONS_STREAM_WITH_SENDFILE</c>
+ * is enabled, the data is transferred between the descriptors without passing
+ * it through user space at all.
+ *
+ * Otherwise, if neither stream exposes its internal buffer, the data is passed
+ * through an intermediate buffer:
+ * - if @p buffer is not NULL, it is used as such;
+ * - if @p buffer is NULL, a buffer is allocated on the heap. It starts small
+ *   and is grown up to @p buffer_size bytes as long as reads from
+ *   @p input_stream fill it completely, so that fast streams are copied in
+ *   large blocks, and slow ones do not waste memory.
+ *
+ * If @p output_stream supports @ref avs_stream_reserve, @p buffer_size is also
+ * used as the size hint for it.
+ *
+ * NOTE: @ref avs_stream_finish_message is NOT called on the output stream, so
+ * you need to call it manually if needed.
+ *
+ * @param output_stream    Stream to write the data to.
+ * @param input_stream     Stream to read the data from.
+ * @param buffer           Buffer to use for copying, or NULL.
+ * @param buffer_size      Size of @p buffer, or maximum size of the buffer to
+ *                         allocate if @p buffer is NULL. Must not be 0.
+ * @param out_bytes_copied If not NULL, set to the number of bytes written to
+ *                         @p output_stream, also if an error occurred.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which either the
+ *          read or the write operation failed; <c>AVS_EINVAL</c> if
+ *          @p buffer_size is 0 and <c>AVS_ENOMEM</c> if the buffer could not
+ *          be allocated.
+ */
+avs_error_t avs_stream_copy_buffer(avs_stream_t *output_stream,
+                                   avs_stream_t *input_stream,
+                                   void *buffer,
+                                   size_t buffer_size,
+                                   size_t *out_bytes_copied);
+
 /**
  * Resets stream state (which is something highly dependend on the stream
  * implementation) by calling @ref avs_stream_v_table#reset method .
@@ -426,6 +657,85 @@ bool avs_stream_nonblock_read_ready(avs_stream_t *stream);
  */
 size_t avs_stream_nonblock_write_ready(avs_stream_t *stream);
 
+/**
+ * Reads data from the stream without waiting for external I/O.
+ *
+ * Streams that implement the NONBLOCK_IO extension handle this natively. For
+ * other streams that support the NONBLOCK extension, this is equivalent to
+ * calling @ref avs_stream_read if @ref avs_stream_nonblock_read_ready returns
+ * true.
+ *
+ * @param stream               Stream to read data from.
+ * @param out_bytes_read       Pointer to a variable where the amount of read
+ *                             bytes will be written. May be NULL.
+ * @param out_message_finished Pointer to a variable where information about
+ *                             message state will be stored. May be NULL.
+ * @param buffer               Pointer to a memory block where the read data
+ *                             will be stored.
+ * @param buffer_length        Maximum number of bytes to read.
+ *
+ * @returns
+ * - @ref AVS_OK for success
+ * - <c>AVS_EAGAIN</c> if the read would block; nothing has been read from the
+ *   stream in that case
+ * - <c>AVS_ENOTSUP</c> if the stream does not support non-blocking operation
+ * - any other error condition for which the read failed
+ */
+avs_error_t avs_stream_read_nonblock(avs_stream_t *stream,
+                                     size_t *out_bytes_read,
+                                     bool *out_message_finished,
+                                     void *buffer,
+                                     size_t buffer_length);
+
+/**
+ * Writes as much data as possible to the stream without waiting for external
+ * I/O.
+ *
+ * Streams that implement the NONBLOCK_IO extension handle this natively. For
+ * other streams that support the NONBLOCK extension, this is equivalent to
+ * calling @ref avs_stream_write_some with the amount of data limited to what
+ * @ref avs_stream_nonblock_write_ready returns.
+ *
+ * @param stream            Stream to write data to.
+ * @param buffer            Data to write.
+ * @param inout_data_length Pointer to a variable that on input contains the
+ *                          number of bytes to write, and on successful return
+ *                          is set to the number of bytes actually written.
+ *
+ * @returns
+ * - @ref AVS_OK for success, in which case at least one byte has been written
+ *   (unless @p *inout_data_length was 0)
+ * - <c>AVS_EAGAIN</c> if no data can be accepted without blocking; the stream
+ *   has not been modified in that case, and @ref avs_stream_flush may be used
+ *   once the underlying transport is ready for writing
+ * - <c>AVS_ENOTSUP</c> if the stream does not support non-blocking operation
+ * - any other error condition for which the write failed
+ */
+avs_error_t avs_stream_write_some_nonblock(avs_stream_t *stream,
+                                           const void *buffer,
+                                           size_t *inout_data_length);
+
+/**
+ * Optional method on streams that support the NONBLOCK_IO extension. Passes
+ * any data buffered in the stream on to the underlying transport, without
+ * finishing the logical message.
+ *
+ * It is intended to be called after the transport has been reported as ready
+ * for writing, e.g. by an <c>epoll</c>-based event loop. Streams that can do so
+ * pass on only as much data as the transport accepts without blocking; others
+ * may wait for the transport to accept all of it.
+ *
+ * @param stream Stream to operate on.
+ *
+ * @returns
+ * - @ref AVS_OK if all buffered data has been passed on
+ * - <c>AVS_EAGAIN</c> if some data (possibly none) has been passed on, but the
+ *   rest remains buffered until the transport is ready for writing again
+ * - <c>AVS_ENOTSUP</c> if the stream does not support this operation
+ * - any other error condition for which the operation failed
+ */
+avs_error_t avs_stream_flush(avs_stream_t *stream);
+
 /**
  * Optional method on streams that support the OFFSET extension. Writes stream
  * cursor absolute position to @p out_offset. On error @p out_offset remains
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVS_COMMONS_STREAM_ASYNC_H
+#define AVS_COMMONS_STREAM_ASYNC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <avsystem/commons/avs_stream.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file avs_stream_async.h
+ *
+ * Completion-based asynchronous operations on streams, driven by an external
+ * event loop.
+ *
+ * An @ref avs_stream_async_t object wraps a stream that supports non-blocking
+ * operation (see @ref avs_stream_read_nonblock and
+ * @ref avs_stream_write_some_nonblock). At most one read and one write may be
+ * pending on it at any given time. The event loop is expected to:
+ *
+ * - call @ref avs_stream_async_process with no ready events after starting
+ *   operations from outside of a completion handler,
+ * - wait for the events returned by @ref avs_stream_async_wanted_events on
+ *   the system socket underlying the stream (which, for network streams, may
+ *   be obtained using <c>avs_stream_net_getsock()</c> and
+ *   <c>avs_net_socket_get_system()</c>),
+ * - call @ref avs_stream_async_process with the events that were reported.
+ *
+ * Completion handlers are only ever called from within
+ * @ref avs_stream_async_process. They may start new operations, which will be
+ * attempted before that call returns, and they may call
+ * @ref avs_stream_async_cleanup.
+ */
+typedef struct avs_stream_async_struct avs_stream_async_t;
+
+/** The underlying transport is ready for reading. */
+#define AVS_STREAM_ASYNC_EVENT_READ 0x01
+
+/** The underlying transport is ready for writing. */
+#define AVS_STREAM_ASYNC_EVENT_WRITE 0x02
+
+/**
+ * Handler called when a read operation completes.
+ *
+ * @param async            Object the operation has been started on.
+ * @param err              Result of the read operation; never
+ *                         <c>AVS_EAGAIN</c>.
+ * @param bytes_read       Number of bytes stored in the buffer passed to
+ *                         @ref avs_stream_async_read.
+ * @param message_finished Whether the end of message has been reached.
+ * @param arg              Opaque argument passed to
+ *                         @ref avs_stream_async_read.
+ */
+typedef void avs_stream_async_read_handler_t(avs_stream_async_t *async,
+                                             avs_error_t err,
+                                             size_t bytes_read,
+                                             bool message_finished,
+                                             void *arg);
+
+/**
+ * Handler called when a write operation completes, i.e. when all the data has
+ * been accepted by the stream (and the message has been finished, if
+ * requested), or an error occurred.
+ *
+ * @param async Object the operation has been started on.
+ * @param err   Result of the write operation.
+ * @param arg   Opaque argument passed to @ref avs_stream_async_write.
+ */
+typedef void avs_stream_async_write_handler_t(avs_stream_async_t *async,
+                                              avs_error_t err,
+                                              void *arg);
+
+/**
+ * Creates an asynchronous operation context for a stream.
+ *
+ * @param stream Stream to operate on. It is not owned by the created object
+ *               and shall outlive it.
+ *
+ * @returns Newly created object, or NULL in case of an out-of-memory condition.
+ */
+avs_stream_async_t *avs_stream_async_new(avs_stream_t *stream);
+
+/**
+ * Destroys an asynchronous operation context and sets @p *async_ptr to NULL.
+ * Pending operations are abandoned without calling their handlers. The
+ * underlying stream is not closed.
+ *
+ * May be called from within a completion handler, in which case the object
+ * is freed after the handler returns.
+ */
+void avs_stream_async_cleanup(avs_stream_async_t **async_ptr);
+
+/**
+ * Returns the stream passed to @ref avs_stream_async_new.
+ */
+avs_stream_t *avs_stream_async_stream(avs_stream_async_t *async);
+
+/**
+ * Starts an asynchronous read operation. At most @p buffer_length bytes will be
+ * read into @p buffer, which shall stay valid until the handler is called or
+ * the object is destroyed.
+ *
+ * @returns 0 for success, or -1 if a read operation is already pending.
+ */
+int avs_stream_async_read(avs_stream_async_t *async,
+                          void *buffer,
+                          size_t buffer_length,
+                          avs_stream_async_read_handler_t *handler,
+                          void *arg);
+
+/**
+ * Starts an asynchronous write operation. @p data shall stay valid until the
+ * handler is called or the object is destroyed.
+ *
+ * @param finish_message If true, @ref avs_stream_finish_message will be called
+ *                       on the stream after all the data has been written.
+ *
+ * @returns 0 for success, or -1 if a write operation is already pending.
+ */
+int avs_stream_async_write(avs_stream_async_t *async,
+                           const void *data,
+                           size_t data_length,
+                           bool finish_message,
+                           avs_stream_async_write_handler_t *handler,
+                           void *arg);
+
+/**
+ * Returns a bit mask of <c>AVS_STREAM_ASYNC_EVENT_*</c> values that the event
+ * loop shall wait for before calling @ref avs_stream_async_process again. Zero
+ * is returned if no operation is waiting for external I/O.
+ */
+unsigned avs_stream_async_wanted_events(avs_stream_async_t *async);
+
+/**
+ * Makes as much progress as possible on the pending operations without
+ * blocking, calling completion handlers for the ones that complete.
+ *
+ * @param async        Object to operate on.
+ * @param ready_events Bit mask of <c>AVS_STREAM_ASYNC_EVENT_*</c> values that
+ *                     have been reported for the underlying transport.
+ *                     Buffered data is only pushed to the transport (which
+ *                     might otherwise block) if
+ *                     @ref AVS_STREAM_ASYNC_EVENT_WRITE is set.
+ */
+void avs_stream_async_process(avs_stream_async_t *async, unsigned ready_events);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AVS_COMMONS_STREAM_ASYNC_H */
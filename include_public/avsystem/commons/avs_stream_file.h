@@ -75,6 +75,26 @@ avs_error_t avs_stream_file_seek(avs_stream_t *stream,
 
 #define AVS_STREAM_FILE_READ 0x01
 #define AVS_STREAM_FILE_WRITE 0x02
+/**
+ * Flag that may be combined with @ref AVS_STREAM_FILE_READ (but not with
+ * @ref AVS_STREAM_FILE_WRITE) to access the file through a read-only memory
+ * mapping instead of stdio. Reads and peeks are then plain memory accesses,
+ * @ref avs_stream_file_length and @ref avs_stream_file_seek do not perform any
+ * I/O, and the file contents can be passed on without copying using
+ * @ref avs_stream_peek_contiguous and @ref avs_stream_consume, which also makes
+ * @ref avs_stream_copy write straight from the mapping.
+ *
+ * The mapping covers the file as it was when the stream was created. The file
+ * shall not be truncated while the stream is open - on most platforms,
+ * accessing a part of the mapping that is no longer backed by the file raises
+ * <c>SIGBUS</c>.
+ *
+ * If memory mapping is not supported by the platform (see
+ * <c>AVS_COMMONS_STREAM_WITH_FILE_MMAP</c>) or fails for a specific file
+ * (e.g. because it is not a regular file), a regular read-only stdio stream is
+ * created instead.
+ */
+#define AVS_STREAM_FILE_MAPPED 0x04
 typedef struct avs_file_stream_struct avs_stream_file_t;
 /**
  * Creates a new file-stream. If file referred by @p path does not exist and
@@ -99,11 +119,91 @@ typedef struct avs_file_stream_struct avs_stream_file_t;
  *                      is written
  * @param path          path to the file
  * @param mode          combination of @ref AVS_STREAM_FILE_READ,
- *                                     @ref AVS_STREAM_FILE_WRITE
+ *                                     @ref AVS_STREAM_FILE_WRITE, or
+ *                      @ref AVS_STREAM_FILE_READ | @ref AVS_STREAM_FILE_MAPPED
  * @return pointer to the new file stream, NULL on error
  */
 avs_stream_t *avs_stream_file_create(const char *path, uint8_t mode);
 
+/**
+ * Default size of the internal buffer of streams created with
+ * @ref avs_stream_file_create_fd.
+ */
+#define AVS_STREAM_FILE_FD_DEFAULT_BUFFER_SIZE (64 * 1024)
+
+/**
+ * Configuration of a file stream created with @ref avs_stream_file_create_fd.
+ * A zero-initialized structure selects the default settings.
+ */
+typedef struct {
+    /**
+     * Size of the read-ahead or write-behind buffer. Data is transferred to and
+     * from the file in blocks of this size, and writes or reads of at least
+     * that size bypass the buffer altogether (unless
+     * @ref avs_stream_file_fd_config_t::direct_io is used).
+     * If 0, @ref AVS_STREAM_FILE_FD_DEFAULT_BUFFER_SIZE is used.
+     */
+    size_t buffer_size;
+
+    /**
+     * Set to true to bypass the operating system's page cache using
+     * <c>O_DIRECT</c>. The buffer is then aligned and sized according to the
+     * file system requirements, and all transfers are done in whole blocks,
+     * except for the final, incomplete block of a file being written.
+     *
+     * In write mode, @ref avs_stream_file_seek is then only allowed to offsets
+     * that are multiples of the file system block size.
+     *
+     * If the platform or the file system does not support direct I/O, regular
+     * buffered I/O is silently used instead.
+     */
+    bool direct_io;
+
+    /**
+     * Set to true to make @ref avs_stream_finish_message and closing the stream
+     * a durability point - after flushing the buffer, data is synchronized to
+     * the storage device using <c>fdatasync()</c> (or <c>fsync()</c> if the
+     * former is unavailable).
+     */
+    bool sync_on_finish;
+
+    /**
+     * Expected final length of a file being written. If nonzero, storage for
+     * that many bytes is reserved up front using <c>posix_fallocate()</c>,
+     * which reduces fragmentation and makes out-of-space conditions detectable
+     * early. If less data is eventually written, the file is truncated to the
+     * actual length when the stream is closed. Ignored in read mode.
+     */
+    avs_off_t preallocate_length;
+} avs_stream_file_fd_config_t;
+
+/**
+ * Creates a new file stream that operates directly on a POSIX file
+ * descriptor, without stdio. Compared to @ref avs_stream_file_create, it gives
+ * control over the buffer size, page cache usage and durability of written
+ * data, which makes it suitable for writing large persistence snapshots.
+ *
+ * Unlike @ref avs_stream_file_create, the file can be opened either for
+ * reading or for writing, but not both. @ref avs_stream_peek can only look as
+ * far ahead as the buffer size allows, and fails with <c>AVS_ENOBUFS</c>
+ * otherwise.
+ *
+ * This function is only defined if <c>AVS_COMMONS_STREAM_WITH_FILE_FD</c> is
+ * enabled.
+ *
+ * @param path   Path to the file. In write mode, the file is created if it
+ *               does not exist, or truncated otherwise.
+ * @param mode   Either @ref AVS_STREAM_FILE_READ or @ref AVS_STREAM_FILE_WRITE.
+ * @param config Stream configuration. May be NULL, in which case the defaults
+ *               are used.
+ *
+ * @returns Pointer to the new file stream, or NULL on error.
+ */
+avs_stream_t *
+avs_stream_file_create_fd(const char *path,
+                          uint8_t mode,
+                          const avs_stream_file_fd_config_t *config);
+
 #ifdef __cplusplus
 }
 #endif
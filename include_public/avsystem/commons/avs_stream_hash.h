@@ -0,0 +1,80 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVS_COMMONS_STREAM_HASH_H
+#define AVS_COMMONS_STREAM_HASH_H
+
+#include <avsystem/commons/avs_stream.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file avs_stream_hash.h
+ *
+ * Streams calculating checksums and cryptographic hashes of the data written
+ * to them.
+ *
+ * All of these streams follow the same contract as the stream created by
+ * @ref avs_stream_md5_create :
+ *
+ * - <c>avs_stream_write</c> feeds data to the hash function,
+ *
+ * - <c>avs_stream_finish_message</c> finalizes the calculation; further writes
+ *   fail with <c>AVS_EBADF</c> until the digest is read or the stream is reset,
+ *
+ * - <c>avs_stream_read</c> returns the digest; once it has been read entirely,
+ *   the end of message is reported and the stream is reset, so that it can be
+ *   used to hash another message,
+ *
+ * - <c>avs_stream_reset</c> discards any data written so far.
+ *
+ * SHA-1 and SHA-256 are calculated using the configured crypto backend
+ * (OpenSSL or mbed TLS) if there is one, or a built-in implementation
+ * otherwise.
+ */
+
+/** Size of the CRC32 digest, in bytes. */
+#define AVS_STREAM_CRC32_LENGTH 4
+
+/** Size of the SHA-1 digest, in bytes. */
+#define AVS_STREAM_SHA1_LENGTH 20
+
+/** Size of the SHA-256 digest, in bytes. */
+#define AVS_STREAM_SHA256_LENGTH 32
+
+/**
+ * Creates a stream calculating the CRC-32 checksum (as used by zlib, PNG and
+ * IEEE 802.3). The digest is the checksum value in network byte order.
+ */
+avs_stream_t *avs_stream_crc32_create(void);
+
+/**
+ * Creates a stream calculating the SHA-1 hash.
+ */
+avs_stream_t *avs_stream_sha1_create(void);
+
+/**
+ * Creates a stream calculating the SHA-256 hash.
+ */
+avs_stream_t *avs_stream_sha256_create(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AVS_COMMONS_STREAM_HASH_H */
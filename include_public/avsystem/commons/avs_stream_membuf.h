@@ -93,6 +93,36 @@ typedef struct avs_stream_membuf_struct avs_stream_membuf_t;
  */
 avs_stream_t *avs_stream_membuf_create(void);
 
+/**
+ * Creates a new in-memory bidirectional stream that stores data in a list of
+ * separately allocated chunks of fixed size, instead of a single contiguous
+ * buffer.
+ *
+ * Writing to such stream never moves data that has already been written, and
+ * chunks are freed as soon as all of their data has been read, so large
+ * payloads can be buffered without the copying and transient memory overhead
+ * of reallocating a contiguous buffer.
+ *
+ * All operations supported by streams created with
+ * @ref avs_stream_membuf_create are available, with the following differences:
+ *
+ * - @ref avs_stream_peek_contiguous only returns data stored in the first
+ *   chunk, and @ref avs_stream_reserve returns free space in the current chunk
+ *   only, so neither of them ever returns more than @p chunk_size bytes.
+ *
+ * - @ref avs_stream_membuf_ensure_free_bytes preallocates additional chunks,
+ *   and @ref avs_stream_membuf_fit frees them if they have not been used.
+ *
+ * - @ref avs_stream_membuf_take_ownership copies all the unread data into a
+ *   newly allocated buffer and frees all the chunks.
+ *
+ * @param chunk_size Size of each chunk, in bytes; shall not be 0.
+ *
+ * @return NULL in case of an error, pointer to the newly allocated
+ *         stream otherwise
+ */
+avs_stream_t *avs_stream_membuf_create_chunked(size_t chunk_size);
+
 #ifdef __cplusplus
 }
 #endif
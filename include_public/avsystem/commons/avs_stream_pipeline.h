@@ -0,0 +1,94 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVS_COMMONS_STREAM_PIPELINE_H
+#define AVS_COMMONS_STREAM_PIPELINE_H
+
+#include <stddef.h>
+
+#include <avsystem/commons/avs_stream.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file avs_stream_pipeline.h
+ *
+ * Read-side chains of filter streams.
+ *
+ * A <em>filter</em> is a stream that accepts input data through
+ * @ref avs_stream_write_some and makes the transformed data available through
+ * @ref avs_stream_read. Calling @ref avs_stream_finish_message on a filter
+ * signals the end of input; the filter shall then report the end of message
+ * on read once all of its output has been consumed. A read that returns no
+ * data and does not finish the message means that the filter needs more input.
+ */
+
+/**
+ * Creates a read-only stream that pulls data from @p source through a chain of
+ * filters: data read from @p source is written to <c>filters[0]</c>, data read
+ * from <c>filters[0]</c> is written to <c>filters[1]</c>, and so on. Reading
+ * from the pipeline returns data read from the last filter. Data is only
+ * pulled through the chain when the last filter has no data ready.
+ *
+ * Data is passed between stages without intermediate copies where possible:
+ * if a filter supports @ref avs_stream_reserve, the previous stage is read
+ * directly into the filter's internal storage. Otherwise, the data goes
+ * through an intermediate buffer of @p buffer_size bytes. All intermediate
+ * buffers are allocated along with the pipeline itself, in a single block, and
+ * are never reallocated.
+ *
+ * <c>avs_stream_t</c> methods are implemented as follows:
+ *
+ * - <c>avs_stream_read</c> - reads data from the last filter, pulling more
+ *   data through the chain until some is available, the end of message is
+ *   reached, or an error occurs.
+ *
+ * - <c>avs_stream_peek</c> - peeks the last filter, pulling more data through
+ *   the chain if necessary. The range of possible offsets is limited by the
+ *   amount of data the last filter is able to buffer; <c>AVS_ENOBUFS</c> is
+ *   returned if it is exceeded.
+ *
+ * - <c>avs_stream_nonblock_read_ready</c> - returns true if data is available
+ *   in the last filter, or can be pulled through the chain without reading
+ *   from @p source when it is not ready.
+ *
+ * - <c>avs_stream_cleanup</c> - closes all the filters, from the last one to
+ *   the first one, and then @p source.
+ *
+ * @param source       Stream to read the input data from.
+ * @param filters      Array of filter streams.
+ * @param filter_count Number of elements in @p filters; shall be at least 1.
+ * @param buffer_size  Size of intermediate buffers used for filters that do
+ *                     not support @ref avs_stream_reserve; shall not be 0 if
+ *                     there are any such filters.
+ *
+ * @returns Newly created pipeline stream, or NULL in case of error. On
+ *          success, ownership of @p source and all the @p filters is
+ *          transferred to the pipeline. On failure, they are left intact and
+ *          are still owned by the caller.
+ */
+avs_stream_t *avs_stream_pipeline_create(avs_stream_t *source,
+                                         avs_stream_t *const *filters,
+                                         size_t filter_count,
+                                         size_t buffer_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AVS_COMMONS_STREAM_PIPELINE_H */
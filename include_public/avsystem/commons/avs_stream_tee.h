@@ -0,0 +1,69 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVS_COMMONS_STREAM_TEE_H
+#define AVS_COMMONS_STREAM_TEE_H
+
+#include <stddef.h>
+
+#include <avsystem/commons/avs_stream.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Creates a write-only stream that forwards all data written to it to each of
+ * the @p sinks, so that e.g. a download may be stored in a file and hashed in
+ * a single pass. The same buffer is passed to all sinks; no data is copied by
+ * the tee stream itself.
+ *
+ * <c>avs_stream_t</c> methods are implemented as follows:
+ *
+ * - <c>avs_stream_write_some</c> - writes data to the first sink with
+ *   <c>avs_stream_write_some</c>, and then writes exactly the amount of data
+ *   accepted by it to all the other sinks with <c>avs_stream_write</c>. Thus,
+ *   the first sink decides about short writes, and all sinks always receive
+ *   the same data.
+ *
+ * - <c>avs_stream_writev</c>, <c>avs_stream_finish_message</c>,
+ *   <c>avs_stream_reset</c> - calls the respective function on each sink, even
+ *   if some of them fail, so that a failure of one sink does not leave the
+ *   others incomplete.
+ *
+ * - <c>avs_stream_cleanup</c> - frees the tee stream itself. The sinks are
+ *   <strong>not</strong> closed, so that e.g. results of hashing streams can be
+ *   read afterwards; they shall be cleaned up by the caller.
+ *
+ * If writing to any of the sinks fails, the first error encountered is
+ * returned. In that case, data may have already been written to some of the
+ * sinks.
+ *
+ * @param sinks      Array of streams to forward the data to. The array is
+ *                   copied, but the streams shall remain valid for the
+ *                   lifetime of the tee stream.
+ * @param sink_count Number of elements in @p sinks; shall be at least 1.
+ *
+ * @returns Newly created tee stream, or NULL in case of error.
+ */
+avs_stream_t *avs_stream_tee_create(avs_stream_t *const *sinks,
+                                    size_t sink_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AVS_COMMONS_STREAM_TEE_H */
@@ -200,6 +200,54 @@ typedef struct {
     avs_stream_nonblock_write_ready_t write_ready;
 } avs_stream_v_table_extension_nonblock_t;
 
+#define AVS_STREAM_V_TABLE_EXTENSION_NONBLOCK_IO 0x4E42494FUL /* "NBIO" */
+
+/**
+ * @ref avs_stream_read_nonblock implementation callback type.
+ *
+ * Works like @ref avs_stream_read_t, but never waits for external I/O. If no
+ * data can be returned immediately and the end of message has not been
+ * reached, fails with <c>AVS_EAGAIN</c>, without consuming any data.
+ *
+ * @p out_bytes_read and @p out_message_finished are never NULL.
+ */
+typedef avs_error_t (*avs_stream_read_nonblock_t)(avs_stream_t *stream,
+                                                  size_t *out_bytes_read,
+                                                  bool *out_message_finished,
+                                                  void *buffer,
+                                                  size_t buffer_length);
+
+/**
+ * @ref avs_stream_write_some_nonblock implementation callback type.
+ *
+ * Works like @ref avs_stream_write_some_t, but only accepts as much data as can
+ * be stored without waiting for external I/O. If no data can be accepted at
+ * all, fails with <c>AVS_EAGAIN</c>, without changing the state of the stream.
+ */
+typedef avs_error_t (*avs_stream_write_some_nonblock_t)(
+        avs_stream_t *stream, const void *buffer, size_t *inout_data_length);
+
+/**
+ * @ref avs_stream_flush implementation callback type.
+ *
+ * Passes the data buffered in the stream on to the underlying transport, so
+ * that @ref avs_stream_write_some_nonblock_t can accept more data. Unlike
+ * @ref avs_stream_finish_message_t, it does not finish the logical message.
+ *
+ * It is meant to be called after an event loop reported the transport as ready
+ * for writing. The implementation should pass on only as much data as the
+ * transport accepts without blocking, and fail with <c>AVS_EAGAIN</c> if any
+ * data remains buffered; it may wait for the transport instead if it cannot
+ * send partial data.
+ */
+typedef avs_error_t (*avs_stream_flush_t)(avs_stream_t *stream);
+
+typedef struct {
+    avs_stream_read_nonblock_t read;
+    avs_stream_write_some_nonblock_t write_some;
+    avs_stream_flush_t flush;
+} avs_stream_v_table_extension_nonblock_io_t;
+
 #define AVS_STREAM_V_TABLE_EXTENSION_OFFSET 0x4F464653UL /* "OFFS" */
 
 /**
@@ -222,6 +270,223 @@ typedef struct {
     avs_stream_offset_t offset;
 } avs_stream_v_table_extension_offset_t;
 
+#define AVS_STREAM_V_TABLE_EXTENSION_SLICE 0x534C4943UL /* "SLIC" */
+
+/**
+ * @ref avs_stream_read_slice implementation callback type.
+ *
+ * Reads up to @p max_length bytes from the stream without copying them, by
+ * returning a slice of a reference-counted buffer that the stream uses as its
+ * storage. The implementation shall not modify or free the memory covered by
+ * the slice for as long as other references to the buffer exist.
+ *
+ * @param stream               Stream to operate on.
+ * @param out_slice            Variable to store the slice in. It is initialized
+ *                             to an empty slice by the caller.
+ * @param out_message_finished Same as for @ref avs_stream_read_t, may be NULL.
+ * @param max_length           Maximum number of bytes to read.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+typedef avs_error_t (*avs_stream_read_slice_t)(avs_stream_t *stream,
+                                               avs_refbuf_slice_t *out_slice,
+                                               bool *out_message_finished,
+                                               size_t max_length);
+
+typedef struct {
+    avs_stream_read_slice_t read_slice;
+} avs_stream_v_table_extension_slice_t;
+
+#define AVS_STREAM_V_TABLE_EXTENSION_VECTORED 0x56454354UL /* "VECT" */
+
+/**
+ * @ref avs_stream_writev implementation callback type.
+ *
+ * Writes all data from @p iov, in order. Unlike @ref avs_stream_write_some_t,
+ * short writes are not allowed - if not all data can be written, an error
+ * shall be returned (<c>AVS_EMSGSIZE</c> if there was no other failure).
+ *
+ * @param stream    Stream to operate on.
+ * @param iov       Array of buffers to write.
+ * @param iov_count Number of elements in @p iov.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+typedef avs_error_t (*avs_stream_writev_t)(avs_stream_t *stream,
+                                           const avs_stream_const_iovec_t *iov,
+                                           size_t iov_count);
+
+/**
+ * @ref avs_stream_readv implementation callback type.
+ *
+ * Reads data into buffers from @p iov, in order, with the same semantics as
+ * @ref avs_stream_read_t - in particular, it may read less data than
+ * requested.
+ *
+ * @param stream               Stream to operate on.
+ * @param out_bytes_read       Total number of bytes read. Never NULL.
+ * @param out_message_finished Same as for @ref avs_stream_read_t. Never NULL.
+ * @param iov                  Array of buffers to fill.
+ * @param iov_count            Number of elements in @p iov.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+typedef avs_error_t (*avs_stream_readv_t)(avs_stream_t *stream,
+                                          size_t *out_bytes_read,
+                                          bool *out_message_finished,
+                                          const avs_stream_iovec_t *iov,
+                                          size_t iov_count);
+
+/**
+ * Either function may be NULL if the stream does not support the respective
+ * direction, in which case a generic implementation is used.
+ */
+typedef struct {
+    avs_stream_writev_t writev;
+    avs_stream_readv_t readv;
+} avs_stream_v_table_extension_vectored_t;
+
+#define AVS_STREAM_V_TABLE_EXTENSION_ZEROCOPY 0x5A435059UL /* "ZCPY" */
+
+/**
+ * @ref avs_stream_peek_contiguous implementation callback type.
+ *
+ * Returns a pointer to the largest contiguous block of readable data that the
+ * stream keeps in its internal storage. If no data is available, the
+ * implementation shall try to fetch some, blocking if necessary, in the same
+ * way as @ref avs_stream_read_t would.
+ *
+ * The returned pointer shall stay valid until the next call to any function
+ * on the stream other than @ref avs_stream_consume_t.
+ *
+ * @param stream               Stream to operate on.
+ * @param out_data             Set to the address of the readable data.
+ * @param out_size             Set to the number of readable bytes; 0 only if
+ *                             the end of message has been reached.
+ * @param out_message_finished Set to whether consuming all of the returned data
+ *                             would finish the logical message, with the same
+ *                             meaning as for @ref avs_stream_read_t. Never
+ *                             NULL.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+typedef avs_error_t (*avs_stream_peek_contiguous_t)(avs_stream_t *stream,
+                                                    const void **out_data,
+                                                    size_t *out_size,
+                                                    bool *out_message_finished);
+
+/**
+ * @ref avs_stream_consume implementation callback type.
+ *
+ * Marks @p size bytes of data returned by the last call to
+ * @ref avs_stream_peek_contiguous_t as read.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed; in particular, <c>AVS_EINVAL</c> if @p size is
+ *          larger than the amount of data available.
+ */
+typedef avs_error_t (*avs_stream_consume_t)(avs_stream_t *stream, size_t size);
+
+/**
+ * @ref avs_stream_reserve implementation callback type.
+ *
+ * Returns a pointer to a contiguous block of free space in the stream's
+ * internal storage, that the caller may fill with data and then pass it to
+ * the stream with @ref avs_stream_commit_t. The implementation may flush
+ * previously written data or grow its storage to make room.
+ *
+ * The returned pointer shall stay valid until the next call to any function
+ * on the stream other than @ref avs_stream_commit_t.
+ *
+ * @param stream    Stream to operate on.
+ * @param size_hint Number of bytes that the caller would like to write. The
+ *                  implementation may return a larger or smaller block.
+ * @param out_data  Set to the address of the free space.
+ * @param out_size  Set to the size of the free space. It may be 0 if the stream
+ *                  cannot currently accept any data, with the same meaning as
+ *                  a short write of 0 bytes.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+typedef avs_error_t (*avs_stream_reserve_t)(avs_stream_t *stream,
+                                            size_t size_hint,
+                                            void **out_data,
+                                            size_t *out_size);
+
+/**
+ * @ref avs_stream_commit implementation callback type.
+ *
+ * Marks @p size bytes at the beginning of the block returned by the last call
+ * to @ref avs_stream_reserve_t as written, with the same effect as if they were
+ * passed to @ref avs_stream_write_some_t.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed; in particular, <c>AVS_EINVAL</c> if @p size is
+ *          larger than the reserved block.
+ */
+typedef avs_error_t (*avs_stream_commit_t)(avs_stream_t *stream, size_t size);
+
+/**
+ * Either pair of functions may be NULL if the stream does not support the
+ * respective direction.
+ */
+typedef struct {
+    avs_stream_peek_contiguous_t peek_contiguous;
+    avs_stream_consume_t consume;
+    avs_stream_reserve_t reserve;
+    avs_stream_commit_t commit;
+} avs_stream_v_table_extension_zerocopy_t;
+
+#define AVS_STREAM_V_TABLE_EXTENSION_FD 0x46444553UL /* "FDES" */
+
+/**
+ * Returns the operating system file descriptor that backs the stream, so that
+ * data may be transferred directly between descriptors (e.g. using
+ * <c>sendfile()</c>) without copying it through user space.
+ *
+ * If @p for_writing is true, the implementation shall first flush any data
+ * buffered for writing, so that the descriptor reflects all data written to
+ * the stream so far.
+ *
+ * @param stream      Stream to operate on.
+ * @param for_writing Whether the descriptor will be written to (true) or read
+ *                    from (false).
+ * @param out_fd      Set to the file descriptor.
+ * @param out_offset  Set to the absolute offset at which the next operation
+ *                    shall be performed, or -1 if the current position of the
+ *                    descriptor shall be used.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed; in particular, <c>AVS_ENOTSUP</c> if the stream
+ *          cannot currently be accessed through the descriptor.
+ */
+typedef avs_error_t (*avs_stream_fd_get_t)(avs_stream_t *stream,
+                                           bool for_writing,
+                                           int *out_fd,
+                                           avs_off_t *out_offset);
+
+/**
+ * Informs the stream that @p length bytes were transferred through the
+ * descriptor returned by @ref avs_stream_fd_get_t, starting at the returned
+ * offset, so that it can update its position.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+typedef avs_error_t (*avs_stream_fd_advance_t)(avs_stream_t *stream,
+                                               bool for_writing,
+                                               size_t length);
+
+typedef struct {
+    avs_stream_fd_get_t get_fd;
+    avs_stream_fd_advance_t advance;
+} avs_stream_v_table_extension_fd_t;
+
 #ifdef __cplusplus
 }
 #endif
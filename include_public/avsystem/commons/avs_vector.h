@@ -64,6 +64,17 @@ typedef struct avs_vector_desc_struct avs_vector_desc_t;
  */
 typedef int (*avs_vector_comparator_func_t)(const void *a, const void *b);
 
+/**
+ * Predicate type for @ref AVS_VECTOR_REMOVE_IF.
+ *
+ * @param elem      Pointer to the element being examined.
+ * @param arg       Opaque argument passed to @ref AVS_VECTOR_REMOVE_IF.
+ *
+ * @return A non-zero value if @p elem shall be removed from the vector, zero
+ *         otherwise.
+ */
+typedef int (*avs_vector_predicate_func_t)(void *elem, void *arg);
+
 /**
  * @name Internal functions
  *
@@ -80,6 +91,10 @@ void avs_vector_delete__(void ***ptr);
 int avs_vector_push__(void ***ptr, const void *elemptr);
 void *avs_vector_pop__(void ***ptr);
 void *avs_vector_remove__(void ***ptr, size_t index);
+void *avs_vector_swap_remove__(void ***ptr, size_t index);
+size_t avs_vector_remove_if__(void ***ptr,
+                              avs_vector_predicate_func_t pred,
+                              void *arg);
 
 size_t avs_vector_size__(void **ptr);
 size_t avs_vector_capacity__(void **ptr);
@@ -224,6 +239,9 @@ static inline T *avs_vector_back_impl__(AVS_VECTOR(T) vec) {
  * returned by this function. It is valid as long as NO MODYFING OPERATION is
  * performed on the vector. Returned pointer MUST NOT be freed by the user.
  *
+ * Order of the remaining elements is preserved. This operation does not
+ * allocate any memory.
+ *
  * @param vecptr    Pointer to the initialized AVS_VECTOR.
  * @param index     Position of the element to be removed.
  * @return pointer to the element being removed, or NULL if the vector size is
@@ -243,6 +261,50 @@ static inline T *avs_vector_remove_impl__(AVS_VECTOR(T) *vecptr, size_t index) {
                                                           (index)))
 #endif
 
+/**
+ * Works like @ref AVS_VECTOR_REMOVE_AT, except that the removed element is
+ * swapped with the last one instead of shifting all subsequent elements. This
+ * means that order of the remaining elements is NOT preserved - the element
+ * previously at the last position is now at position @p index.
+ *
+ * @param vecptr    Pointer to the initialized AVS_VECTOR.
+ * @param index     Position of the element to be removed.
+ * @return pointer to the element being removed, or NULL if the vector size is
+ *         0.
+ * Time complexity: O(1)
+ */
+#ifdef __cplusplus
+template <typename T>
+static inline T *avs_vector_swap_remove_impl__(AVS_VECTOR(T) *vecptr,
+                                               size_t index) {
+    return (T *) avs_vector_swap_remove__((void ***) vecptr, index);
+}
+#    define AVS_VECTOR_SWAP_REMOVE_AT(vecptr, index) \
+        (avs_vector_swap_remove_impl__((vecptr), (index)))
+#else
+#    define AVS_VECTOR_SWAP_REMOVE_AT(vecptr, index)            \
+        ((AVS_TYPEOF_PTR(**(vecptr))) avs_vector_swap_remove__( \
+                (void ***) (vecptr), (index)))
+#endif
+
+/**
+ * Removes all elements for which @p pred returns a non-zero value, preserving
+ * order of the remaining elements. The vector is compacted in a single pass.
+ *
+ * Removed elements are overwritten, so @p pred is the last place where they
+ * can be accessed - it may release any resources owned by the element before
+ * returning non-zero.
+ *
+ * @param vecptr    Pointer to the initialized AVS_VECTOR.
+ * @param pred      Predicate of type @ref avs_vector_predicate_func_t.
+ * @param arg       Opaque argument passed to each call of @p pred.
+ * @return Number of removed elements.
+ *
+ * Time complexity: O(n * predicate time)
+ */
+#define AVS_VECTOR_REMOVE_IF(vecptr, pred, arg) \
+    (avs_vector_remove_if__((void ***) (vecptr), (pred), (arg)))
+
 /**
  * Equivalent to AVS_VECTOR_REMOVE_AT(max(AVS_VECTOR_SIZE(*vecptr)-1, 0))
  *
@@ -56,6 +56,39 @@
 #    error "AVS_COMMONS_WITH_AVS_STREAM is required for AVS_COMMONS_STREAM_WITH_FILE"
 #endif
 
+#if defined(AVS_COMMONS_UTILS_WITH_ALLOCATORS) \
+        && !defined(AVS_COMMONS_UTILS_WITH_STANDARD_ALLOCATOR)
+#    error "AVS_COMMONS_UTILS_WITH_STANDARD_ALLOCATOR is required for AVS_COMMONS_UTILS_WITH_ALLOCATORS"
+#endif
+
+#if defined(AVS_COMMONS_UTILS_WITH_MEMORY_STATS) \
+        && !defined(AVS_COMMONS_UTILS_WITH_ALLOCATORS)
+#    error "AVS_COMMONS_UTILS_WITH_ALLOCATORS is required for AVS_COMMONS_UTILS_WITH_MEMORY_STATS"
+#endif
+
+// Sources of subsystems that may be configured to use a dedicated allocator
+// are compiled with AVS_MEMORY_SUBSYSTEM defined to the appropriate
+// avs_memory_subsystem_t value. Route their allocations to that allocator.
+// avs_free() does not need that, as each block remembers its allocator.
+// If memory statistics are enabled, avs_x_log_config.h further redefines these
+// macros to tag allocations with MODULE_NAME.
+#if defined(AVS_COMMONS_UTILS_WITH_ALLOCATORS) && defined(AVS_MEMORY_SUBSYSTEM) \
+        && !defined(AVS_UTILS_ALLOCATOR_C)
+#    include <avsystem/commons/avs_allocator.h>
+#    include <avsystem/commons/avs_memory.h>
+
+#    define avs_malloc(Size)                                                 \
+        avs_allocator_malloc(avs_memory_get_allocator(AVS_MEMORY_SUBSYSTEM), \
+                             (Size))
+#    define avs_calloc(Nmemb, Size)                                          \
+        avs_allocator_calloc(avs_memory_get_allocator(AVS_MEMORY_SUBSYSTEM), \
+                             (Nmemb), (Size))
+#    define avs_realloc(Ptr, Size)                                            \
+        avs_allocator_realloc(avs_memory_get_allocator(AVS_MEMORY_SUBSYSTEM), \
+                              (Ptr), (Size))
+#endif // defined(AVS_COMMONS_UTILS_WITH_ALLOCATORS) &&
+       // defined(AVS_MEMORY_SUBSYSTEM)
+
 // Backwards compatibility with configuration macros that are no longer current
 #ifdef AVS_COMMONS_NET_WITH_X509
 #    warning \
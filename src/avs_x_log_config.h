@@ -61,3 +61,47 @@
 #    endif
 
 #endif
+
+#if defined(AVS_COMMONS_UTILS_WITH_MEMORY_STATS) \
+        && !defined(AVS_UTILS_ALLOCATOR_C)
+// Attribute allocations made by the including source to MODULE_NAME. The
+// statistics slot is looked up once per translation unit, so that allocating
+// memory does not involve comparing tag strings.
+#    ifndef AVS_X_LOG_CONFIG_MEMORY_STATS
+#        define AVS_X_LOG_CONFIG_MEMORY_STATS
+
+#        include <stdatomic.h>
+
+#        include <avsystem/commons/avs_defs.h>
+
+#        include "utils/avs_memory_stats_module.h"
+
+static inline struct avs_memory_stats_slot_struct *
+_avs_memory_stats_module_slot(void) {
+    static atomic_uintptr_t cache;
+    return _avs_memory_stats_cached_slot(&cache,
+                                         AVS_QUOTE_MACRO(MODULE_NAME));
+}
+
+#        ifdef AVS_MEMORY_SUBSYSTEM
+#            define _AVS_MEMORY_SUBSYSTEM_ID ((int) AVS_MEMORY_SUBSYSTEM)
+#        else // AVS_MEMORY_SUBSYSTEM
+#            define _AVS_MEMORY_SUBSYSTEM_ID _AVS_MEMORY_SUBSYSTEM_NONE
+#        endif // AVS_MEMORY_SUBSYSTEM
+
+#        undef avs_malloc
+#        undef avs_calloc
+#        undef avs_realloc
+#        define avs_malloc(Size)                                               \
+            _avs_memory_malloc_in_slot(_AVS_MEMORY_SUBSYSTEM_ID, (Size),       \
+                                       _avs_memory_stats_module_slot())
+#        define avs_calloc(Nmemb, Size)                                        \
+            _avs_memory_calloc_in_slot(_AVS_MEMORY_SUBSYSTEM_ID, (Nmemb),      \
+                                       (Size), _avs_memory_stats_module_slot())
+#        define avs_realloc(Ptr, Size)                                         \
+            _avs_memory_realloc_in_slot(_AVS_MEMORY_SUBSYSTEM_ID, (Ptr),       \
+                                        (Size),                                \
+                                        _avs_memory_stats_module_slot())
+#    endif // AVS_X_LOG_CONFIG_MEMORY_STATS
+#endif // defined(AVS_COMMONS_UTILS_WITH_MEMORY_STATS) &&
+       // !defined(AVS_UTILS_ALLOCATOR_C)
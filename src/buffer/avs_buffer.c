@@ -18,7 +18,10 @@
 
 #ifdef AVS_COMMONS_WITH_AVS_BUFFER
 
+#    include <assert.h>
+#    include <stdbool.h>
 #    include <stddef.h>
+#    include <stdint.h>
 #    include <stdlib.h>
 #    include <string.h>
 
@@ -26,40 +29,181 @@
 #    include <avsystem/commons/avs_defs.h>
 #    include <avsystem/commons/avs_memory.h>
 
+#    ifdef AVS_COMMONS_BUFFER_WITH_SPSC
+#        include <stdatomic.h>
+#    endif // AVS_COMMONS_BUFFER_WITH_SPSC
+
+#    include "avs_buffer_mirrored_mapping.h"
+
 #    define MODULE_NAME avs_buffer
 #    include <avs_x_log_config.h>
 
 VISIBILITY_SOURCE_BEGIN
 
+/**
+ * In AVS_BUFFER_MODE_LINEAR, <c>begin</c> and <c>end</c> are plain offsets
+ * into <c>storage</c>, and <c>begin <= end <= capacity</c> always holds.
+ *
+ * In circular modes, <c>begin</c> and <c>end</c> are positions in range
+ * [0, 2 * capacity), which allows distinguishing a full buffer from an empty
+ * one without any additional state. Actual offset into <c>storage</c> is the
+ * position modulo capacity.
+ *
+ * In SPSC buffers, <c>end</c> is only ever written by the producer and
+ * <c>begin</c> only by the consumer. Each side publishes its index with release
+ * semantics after it is done with the memory it gives up, and loads the other
+ * side's index with acquire semantics before touching the memory it gains.
+ */
+#    ifdef AVS_COMMONS_BUFFER_WITH_SPSC
+typedef atomic_size_t buffer_position_t;
+#    else  // AVS_COMMONS_BUFFER_WITH_SPSC
+typedef size_t buffer_position_t;
+#    endif // AVS_COMMONS_BUFFER_WITH_SPSC
+
 struct avs_buffer_struct {
     size_t capacity;
-    char *begin;
-    char *end;
+    avs_buffer_mode_t mode;
+    bool spsc;
+    char *storage;
+    buffer_position_t begin;
+    buffer_position_t end;
     union {
         char data[1]; /* variable length */
         avs_max_align_t align;
     } data;
 };
 
+static inline size_t load_position(const avs_buffer_t *buffer,
+                                   const buffer_position_t *pos) {
+#    ifdef AVS_COMMONS_BUFFER_WITH_SPSC
+    if (buffer->spsc) {
+        return atomic_load_explicit(pos, memory_order_acquire);
+    }
+    return atomic_load_explicit(pos, memory_order_relaxed);
+#    else  // AVS_COMMONS_BUFFER_WITH_SPSC
+    (void) buffer;
+    return *pos;
+#    endif // AVS_COMMONS_BUFFER_WITH_SPSC
+}
+
+static inline void
+store_position(avs_buffer_t *buffer, buffer_position_t *pos, size_t value) {
+#    ifdef AVS_COMMONS_BUFFER_WITH_SPSC
+    if (buffer->spsc) {
+        atomic_store_explicit(pos, value, memory_order_release);
+    } else {
+        atomic_store_explicit(pos, value, memory_order_relaxed);
+    }
+#    else  // AVS_COMMONS_BUFFER_WITH_SPSC
+    (void) buffer;
+    *pos = value;
+#    endif // AVS_COMMONS_BUFFER_WITH_SPSC
+}
+
+static inline size_t get_begin(const avs_buffer_t *buffer) {
+    return load_position(buffer, &buffer->begin);
+}
+
+static inline size_t get_end(const avs_buffer_t *buffer) {
+    return load_position(buffer, &buffer->end);
+}
+
+static size_t position_to_offset(const avs_buffer_t *buffer, size_t pos) {
+    if (buffer->mode == AVS_BUFFER_MODE_LINEAR || pos < buffer->capacity) {
+        return pos;
+    }
+    return pos - buffer->capacity;
+}
+
+static size_t advance_position(const avs_buffer_t *buffer,
+                               size_t pos,
+                               size_t n) {
+    assert(n <= buffer->capacity);
+    if (buffer->mode == AVS_BUFFER_MODE_LINEAR) {
+        return pos + n;
+    }
+    return pos >= 2 * buffer->capacity - n ? pos + n - 2 * buffer->capacity
+                                           : pos + n;
+}
+
 size_t avs_buffer_space_left(const avs_buffer_t *buffer) {
     return buffer->capacity - avs_buffer_data_size(buffer);
 }
 
 static size_t space_left_without_moving(const avs_buffer_t *buffer) {
-    return buffer->capacity - (size_t) (buffer->end - buffer->data.data);
+    size_t end_offset;
+    switch (buffer->mode) {
+    case AVS_BUFFER_MODE_LINEAR:
+        return buffer->capacity - get_end(buffer);
+    case AVS_BUFFER_MODE_CIRCULAR:
+        end_offset = position_to_offset(buffer, get_end(buffer));
+        return AVS_MIN(avs_buffer_space_left(buffer),
+                       buffer->capacity - end_offset);
+    case AVS_BUFFER_MODE_CIRCULAR_MIRRORED:
+        break;
+    }
+    return avs_buffer_space_left(buffer);
 }
 
 void avs_buffer_reset(avs_buffer_t *buffer) {
-    buffer->begin = buffer->data.data;
-    buffer->end = buffer->data.data;
+    store_position(buffer, &buffer->begin, 0);
+    store_position(buffer, &buffer->end, 0);
 }
 
 int avs_buffer_create(avs_buffer_t **buffer_ptr, size_t capacity) {
-    *buffer_ptr = (avs_buffer_t *) avs_malloc(offsetof(avs_buffer_t, data)
-                                              + capacity);
+    return avs_buffer_create_with_mode(buffer_ptr, capacity,
+                                       AVS_BUFFER_MODE_LINEAR);
+}
+
+static avs_buffer_t *create_mirrored(size_t capacity) {
+    avs_buffer_t *buffer;
+    char *storage;
+    if (!(buffer = (avs_buffer_t *) avs_malloc(offsetof(avs_buffer_t, data)))) {
+        return NULL;
+    }
+    if (!(storage = (char *) _avs_buffer_mirrored_mapping_create(&capacity))) {
+        LOG(DEBUG, _("mirrored mapping unavailable, falling back to plain "
+                     "circular buffer"));
+        avs_free(buffer);
+        return NULL;
+    }
+    buffer->capacity = capacity;
+    buffer->mode = AVS_BUFFER_MODE_CIRCULAR_MIRRORED;
+    buffer->spsc = false;
+    buffer->storage = storage;
+    return buffer;
+}
+
+int avs_buffer_create_with_mode(avs_buffer_t **buffer_ptr,
+                                size_t capacity,
+                                avs_buffer_mode_t mode) {
+    *buffer_ptr = NULL;
+    if (mode != AVS_BUFFER_MODE_LINEAR && capacity > SIZE_MAX / 2) {
+        LOG(ERROR, _("buffer capacity too large"));
+        return -1;
+    }
+    if (mode == AVS_BUFFER_MODE_CIRCULAR_MIRRORED) {
+        *buffer_ptr = create_mirrored(capacity);
+    }
+    if (!*buffer_ptr) {
+        if (mode == AVS_BUFFER_MODE_CIRCULAR_MIRRORED) {
+            mode = AVS_BUFFER_MODE_CIRCULAR;
+        }
+        if ((*buffer_ptr = (avs_buffer_t *) avs_malloc(
+                     offsetof(avs_buffer_t, data) + capacity))) {
+            (*buffer_ptr)->capacity = capacity;
+            (*buffer_ptr)->mode = mode;
+            (*buffer_ptr)->spsc = false;
+            (*buffer_ptr)->storage = (*buffer_ptr)->data.data;
+        }
+    }
     if (*buffer_ptr) {
-        (*buffer_ptr)->capacity = capacity;
+#    ifdef AVS_COMMONS_BUFFER_WITH_SPSC
+        atomic_init(&(*buffer_ptr)->begin, 0);
+        atomic_init(&(*buffer_ptr)->end, 0);
+#    else  // AVS_COMMONS_BUFFER_WITH_SPSC
         avs_buffer_reset(*buffer_ptr);
+#    endif // AVS_COMMONS_BUFFER_WITH_SPSC
         return 0;
     } else {
         LOG(ERROR, _("cannot allocate buffer"));
@@ -67,35 +211,111 @@ int avs_buffer_create(avs_buffer_t **buffer_ptr, size_t capacity) {
     }
 }
 
+int avs_buffer_create_spsc(avs_buffer_t **buffer_ptr,
+                           size_t capacity,
+                           avs_buffer_mode_t mode) {
+#    ifdef AVS_COMMONS_BUFFER_WITH_SPSC
+    if (mode == AVS_BUFFER_MODE_LINEAR) {
+        *buffer_ptr = NULL;
+        LOG(ERROR, _("SPSC buffers require a circular mode"));
+        return -1;
+    }
+    if (avs_buffer_create_with_mode(buffer_ptr, capacity, mode)) {
+        return -1;
+    }
+    (*buffer_ptr)->spsc = true;
+    return 0;
+#    else  // AVS_COMMONS_BUFFER_WITH_SPSC
+    (void) capacity;
+    (void) mode;
+    *buffer_ptr = NULL;
+    LOG(ERROR, _("SPSC buffer support is not compiled in"));
+    return -1;
+#    endif // AVS_COMMONS_BUFFER_WITH_SPSC
+}
+
 void avs_buffer_free(avs_buffer_t **buffer) {
+    if (*buffer && (*buffer)->mode == AVS_BUFFER_MODE_CIRCULAR_MIRRORED) {
+        _avs_buffer_mirrored_mapping_destroy((*buffer)->storage,
+                                             (*buffer)->capacity);
+    }
     avs_free(*buffer);
     *buffer = NULL;
 }
 
+avs_buffer_mode_t avs_buffer_mode(const avs_buffer_t *buffer) {
+    return buffer->mode;
+}
+
+static size_t data_size_between(const avs_buffer_t *buffer,
+                                size_t begin,
+                                size_t end) {
+    if (end >= begin) {
+        return end - begin;
+    } else {
+        return end + 2 * buffer->capacity - begin;
+    }
+}
+
 size_t avs_buffer_data_size(const avs_buffer_t *buffer) {
-    return (size_t) (buffer->end - buffer->begin);
+    return data_size_between(buffer, get_begin(buffer), get_end(buffer));
 }
 
 size_t avs_buffer_capacity(const avs_buffer_t *buffer) {
     return buffer->capacity;
 }
 
-const char *avs_buffer_data(const avs_buffer_t *buffer) {
-    return buffer->begin;
+static void reverse_bytes(char *first, char *last) {
+    while (first < last) {
+        char tmp = *first;
+        *first++ = *--last;
+        *last = tmp;
+    }
 }
 
 static void defragment_buffer(avs_buffer_t *buffer) {
-    if (buffer->begin != buffer->data.data) {
-        size_t used = avs_buffer_data_size(buffer);
-        memmove(buffer->data.data, buffer->begin, used);
-        buffer->end = buffer->data.data + used;
-        buffer->begin = buffer->data.data;
+    size_t begin_offset = position_to_offset(buffer, get_begin(buffer));
+    size_t used = avs_buffer_data_size(buffer);
+    /* moving data touches both the producer's and the consumer's parts of the
+     * storage; avs_buffer.h documents the calls that are forbidden because of
+     * that in SPSC buffers */
+    assert(!buffer->spsc);
+    if (begin_offset == 0) {
+        return;
     }
+    if (begin_offset + used <= buffer->capacity) {
+        memmove(buffer->storage, buffer->storage + begin_offset, used);
+    } else {
+        /* data wraps around - rotate the whole storage in place */
+        reverse_bytes(buffer->storage, buffer->storage + begin_offset);
+        reverse_bytes(buffer->storage + begin_offset,
+                      buffer->storage + buffer->capacity);
+        reverse_bytes(buffer->storage, buffer->storage + buffer->capacity);
+    }
+    store_position(buffer, &buffer->begin, 0);
+    store_position(buffer, &buffer->end, used);
+}
+
+const char *avs_buffer_data(const avs_buffer_t *buffer) {
+    size_t begin_offset = position_to_offset(buffer, get_begin(buffer));
+    if (buffer->mode == AVS_BUFFER_MODE_CIRCULAR
+            && begin_offset + avs_buffer_data_size(buffer)
+                           > buffer->capacity) {
+        /* Buffer objects are always allocated on the heap by
+         * avs_buffer_create_with_mode(), so casting away const is safe. */
+        defragment_buffer((avs_buffer_t *) (intptr_t) buffer);
+        begin_offset = 0;
+    }
+    return buffer->storage + begin_offset;
 }
 
 char *avs_buffer_raw_insert_ptr(avs_buffer_t *buffer) {
-    defragment_buffer(buffer);
-    return buffer->end;
+    if (buffer->mode == AVS_BUFFER_MODE_LINEAR
+            || space_left_without_moving(buffer)
+                           < avs_buffer_space_left(buffer)) {
+        defragment_buffer(buffer);
+    }
+    return buffer->storage + position_to_offset(buffer, get_end(buffer));
 }
 
 int avs_buffer_consume_bytes(avs_buffer_t *buffer, size_t bytes_count) {
@@ -103,25 +323,83 @@ int avs_buffer_consume_bytes(avs_buffer_t *buffer, size_t bytes_count) {
         LOG(ERROR, _("not enough data"));
         return -1;
     }
-    buffer->begin += bytes_count;
+    store_position(buffer, &buffer->begin,
+                   advance_position(buffer, get_begin(buffer), bytes_count));
 
     return 0;
 }
 
+/**
+ * Returns pointer at which @p count bytes may be written, and fills
+ * @p out_first_chunk with the number of bytes that can be written there
+ * contiguously. Any remaining bytes shall be written at the beginning of the
+ * storage. Moves data if necessary in linear mode.
+ */
+static char *
+prepare_write(avs_buffer_t *buffer, size_t count, size_t *out_first_chunk) {
+    if (buffer->mode == AVS_BUFFER_MODE_LINEAR
+            && count > space_left_without_moving(buffer)) {
+        defragment_buffer(buffer);
+    }
+    *out_first_chunk = AVS_MIN(count, space_left_without_moving(buffer));
+    return buffer->storage + position_to_offset(buffer, get_end(buffer));
+}
+
+size_t avs_buffer_data_spans(
+        const avs_buffer_t *buffer,
+        avs_buffer_const_span_t out_spans[AVS_BUFFER_MAX_SPANS]) {
+    size_t begin = get_begin(buffer);
+    size_t size = data_size_between(buffer, begin, get_end(buffer));
+    size_t begin_offset = position_to_offset(buffer, begin);
+    if (!size) {
+        return 0;
+    }
+    out_spans[0].data = buffer->storage + begin_offset;
+    if (buffer->mode != AVS_BUFFER_MODE_CIRCULAR
+            || begin_offset + size <= buffer->capacity) {
+        out_spans[0].size = size;
+        return 1;
+    }
+    out_spans[0].size = buffer->capacity - begin_offset;
+    out_spans[1].data = buffer->storage;
+    out_spans[1].size = size - out_spans[0].size;
+    return 2;
+}
+
+size_t
+avs_buffer_free_spans(avs_buffer_t *buffer,
+                      avs_buffer_span_t out_spans[AVS_BUFFER_MAX_SPANS]) {
+    size_t space_left = avs_buffer_space_left(buffer);
+    size_t first_chunk;
+    if (!space_left) {
+        return 0;
+    }
+    out_spans[0].data = prepare_write(buffer, space_left, &first_chunk);
+    out_spans[0].size = first_chunk;
+    if (first_chunk == space_left) {
+        return 1;
+    }
+    out_spans[1].data = buffer->storage;
+    out_spans[1].size = space_left - first_chunk;
+    return 2;
+}
+
 int avs_buffer_append_bytes(avs_buffer_t *buffer,
                             const void *data,
                             size_t data_length) {
     if (data_length > avs_buffer_space_left(buffer)) {
         LOG(ERROR, _("buffer too small"));
         return -1;
-    } else {
-        if (data_length > space_left_without_moving(buffer)) {
-            defragment_buffer(buffer);
-        }
-        memcpy(buffer->end, data, data_length);
-        buffer->end += data_length;
-        return 0;
+    } else if (data_length > 0) {
+        size_t first_chunk;
+        char *insert_ptr = prepare_write(buffer, data_length, &first_chunk);
+        memcpy(insert_ptr, data, first_chunk);
+        memcpy(buffer->storage, (const char *) data + first_chunk,
+               data_length - first_chunk);
+        store_position(buffer, &buffer->end,
+                       advance_position(buffer, get_end(buffer), data_length));
     }
+    return 0;
 }
 
 int avs_buffer_advance_ptr(avs_buffer_t *buffer, size_t n) {
@@ -129,10 +407,12 @@ int avs_buffer_advance_ptr(avs_buffer_t *buffer, size_t n) {
         LOG(ERROR, _("position out of bounds"));
         return -1;
     } else {
-        if (n > space_left_without_moving(buffer)) {
+        if (buffer->mode == AVS_BUFFER_MODE_LINEAR
+                && n > space_left_without_moving(buffer)) {
             defragment_buffer(buffer);
         }
-        buffer->end += n;
+        store_position(buffer, &buffer->end,
+                       advance_position(buffer, get_end(buffer), n));
         return 0;
     }
 }
@@ -140,14 +420,15 @@ int avs_buffer_advance_ptr(avs_buffer_t *buffer, size_t n) {
 int avs_buffer_fill_bytes(avs_buffer_t *buffer, int value, size_t bytes_count) {
     if (bytes_count > avs_buffer_space_left(buffer)) {
         return -1;
-    } else {
-        if (bytes_count > space_left_without_moving(buffer)) {
-            defragment_buffer(buffer);
-        }
-        memset(buffer->end, value, bytes_count);
-        buffer->end += bytes_count;
-        return 0;
+    } else if (bytes_count > 0) {
+        size_t first_chunk;
+        char *insert_ptr = prepare_write(buffer, bytes_count, &first_chunk);
+        memset(insert_ptr, value, first_chunk);
+        memset(buffer->storage, value, bytes_count - first_chunk);
+        store_position(buffer, &buffer->end,
+                       advance_position(buffer, get_end(buffer), bytes_count));
     }
+    return 0;
 }
 
 #    ifdef AVS_UNIT_TESTING
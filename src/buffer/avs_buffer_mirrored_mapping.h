@@ -0,0 +1,48 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVS_COMMONS_BUFFER_MIRRORED_MAPPING_H
+#define AVS_COMMONS_BUFFER_MIRRORED_MAPPING_H
+
+#include <stddef.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+#ifdef AVS_COMMONS_BUFFER_WITH_MIRRORED_MAPPING
+/**
+ * Maps a memory region of at least @p *inout_size bytes twice, at two adjacent
+ * virtual addresses, so that writing at <c>ptr[i]</c> is visible at
+ * <c>ptr[i + *inout_size]</c> and vice versa.
+ *
+ * @param inout_size Requested size of the region. On success, it is updated
+ *                   with the actual size, rounded up to the page size.
+ *
+ * @returns Pointer to the beginning of the mapping, or NULL in case of error.
+ */
+void *_avs_buffer_mirrored_mapping_create(size_t *inout_size);
+
+/**
+ * Releases a mapping created with @ref _avs_buffer_mirrored_mapping_create.
+ */
+void _avs_buffer_mirrored_mapping_destroy(void *mapping, size_t size);
+#else // AVS_COMMONS_BUFFER_WITH_MIRRORED_MAPPING
+#    define _avs_buffer_mirrored_mapping_create(...) NULL
+#    define _avs_buffer_mirrored_mapping_destroy(...) ((void) 0)
+#endif // AVS_COMMONS_BUFFER_WITH_MIRRORED_MAPPING
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* AVS_COMMONS_BUFFER_MIRRORED_MAPPING_H */
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/avs_commons_config.h>
+
+#if defined(AVS_COMMONS_WITH_AVS_BUFFER) \
+        && defined(AVS_COMMONS_BUFFER_WITH_MIRRORED_MAPPING)
+
+#    define _GNU_SOURCE // for memfd_create()
+
+#    include <avs_commons_posix_init.h>
+
+#    include <stdint.h>
+
+#    include <sys/mman.h>
+
+#    include "../../avs_buffer_mirrored_mapping.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+void *_avs_buffer_mirrored_mapping_create(size_t *inout_size) {
+    long page_size = sysconf(_SC_PAGESIZE);
+    size_t size;
+    int fd;
+    char *result = NULL;
+
+    if (page_size <= 0 || *inout_size == 0
+            || *inout_size > SIZE_MAX / 2 - (size_t) page_size) {
+        return NULL;
+    }
+    size = (*inout_size + (size_t) page_size - 1) / (size_t) page_size
+           * (size_t) page_size;
+
+    if ((fd = memfd_create("avs_buffer", MFD_CLOEXEC)) < 0) {
+        return NULL;
+    }
+    if (!ftruncate(fd, (off_t) size)) {
+        // reserve address space for both views first, then overlay them
+        void *base = mmap(NULL, 2 * size, PROT_NONE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base != MAP_FAILED) {
+            result = (char *) base;
+            if (mmap(result, size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_FIXED, fd, 0)
+                            == MAP_FAILED
+                    || mmap(result + size, size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_FIXED, fd, 0)
+                                   == MAP_FAILED) {
+                munmap(base, 2 * size);
+                result = NULL;
+            }
+        }
+    }
+    close(fd);
+    if (result) {
+        *inout_size = size;
+    }
+    return result;
+}
+
+void _avs_buffer_mirrored_mapping_destroy(void *mapping, size_t size) {
+    munmap(mapping, 2 * size);
+}
+
+#endif // defined(AVS_COMMONS_WITH_AVS_BUFFER) &&
+       // defined(AVS_COMMONS_BUFFER_WITH_MIRRORED_MAPPING)
@@ -26,6 +26,7 @@
 
 #    include <avs_commons_poison.h>
 
+#    include <assert.h>
 #    include <errno.h>
 #    include <stdint.h>
 #    include <stdio.h>
@@ -53,6 +54,9 @@ typedef struct {
     int flush;
     size_t input_buffer_size;
     size_t output_buffer_size;
+    /* offset of the first unread byte in the output buffer; unread data spans
+     * up to zlib.next_out */
+    size_t output_offset;
     uint8_t data[];
 } zlib_stream_t;
 
@@ -92,9 +96,9 @@ static avs_error_t compressor_flush(zlib_stream_t *stream) {
             get_zlib_msg(stream));
         return err;
     }
-    memmove(GET_INPUT_BUFFER(stream), stream->zlib.next_in,
-            stream->zlib.avail_in);
-    stream->zlib.next_in = GET_INPUT_BUFFER(stream);
+    if (!stream->zlib.avail_in) {
+        stream->zlib.next_in = GET_INPUT_BUFFER(stream);
+    }
     return AVS_OK;
 }
 
@@ -116,9 +120,9 @@ static avs_error_t decompressor_flush(zlib_stream_t *stream) {
             get_zlib_msg(stream));
         return err;
     }
-    memmove(GET_INPUT_BUFFER(stream), stream->zlib.next_in,
-            stream->zlib.avail_in);
-    stream->zlib.next_in = GET_INPUT_BUFFER(stream);
+    if (!stream->zlib.avail_in) {
+        stream->zlib.next_in = GET_INPUT_BUFFER(stream);
+    }
     return AVS_OK;
 }
 
@@ -126,6 +130,44 @@ static zlib_flush_func_holder_t decompressor_flush_holder = {
     decompressor_flush
 };
 
+static size_t input_space_left(const zlib_stream_t *stream) {
+    return stream->input_buffer_size
+           - (size_t) (stream->zlib.next_in - GET_INPUT_BUFFER(stream))
+           - stream->zlib.avail_in;
+}
+
+/* Makes room for at least size bytes of input, if possible. Data left
+ * unprocessed in the input buffer is only moved when really necessary. */
+static avs_error_t make_input_space(zlib_stream_t *stream, size_t size) {
+    if (size > input_space_left(stream)) {
+        avs_error_t err = zlib_stream_flush(stream);
+        if (avs_is_err(err)) {
+            return err;
+        }
+        if (size > input_space_left(stream)
+                && stream->zlib.next_in != GET_INPUT_BUFFER(stream)) {
+            memmove(GET_INPUT_BUFFER(stream), stream->zlib.next_in,
+                    stream->zlib.avail_in);
+            stream->zlib.next_in = GET_INPUT_BUFFER(stream);
+        }
+    }
+    return AVS_OK;
+}
+
+static size_t output_available(const zlib_stream_t *stream) {
+    return stream->output_buffer_size - stream->zlib.avail_out
+           - stream->output_offset;
+}
+
+static void output_consumed(zlib_stream_t *stream, size_t size) {
+    stream->output_offset += size;
+    if (!output_available(stream)) {
+        stream->output_offset = 0;
+        stream->zlib.avail_out = (unsigned) stream->output_buffer_size;
+        stream->zlib.next_out = GET_OUTPUT_BUFFER(stream);
+    }
+}
+
 static avs_error_t zlib_stream_write_some(avs_stream_t *stream_,
                                           const void *data,
                                           size_t *inout_data_length) {
@@ -134,23 +176,44 @@ static avs_error_t zlib_stream_write_some(avs_stream_t *stream_,
         LOG(ERROR, _("Stream finished"));
         return avs_errno(AVS_EBADF);
     }
-    if (*inout_data_length
-            > stream->input_buffer_size - stream->zlib.avail_in) {
-        avs_error_t err = zlib_stream_flush(stream);
-        if (avs_is_err(err)) {
-            return err;
-        }
-    }
-    if (*inout_data_length
-            > stream->input_buffer_size - stream->zlib.avail_in) {
-        *inout_data_length = stream->input_buffer_size - stream->zlib.avail_in;
+    avs_error_t err = make_input_space(stream, *inout_data_length);
+    if (avs_is_err(err)) {
+        return err;
     }
+    *inout_data_length = AVS_MIN(*inout_data_length, input_space_left(stream));
     memcpy(stream->zlib.next_in + stream->zlib.avail_in, data,
            *inout_data_length);
     stream->zlib.avail_in += (unsigned) *inout_data_length;
     return zlib_stream_flush(stream);
 }
 
+static avs_error_t zlib_stream_reserve(avs_stream_t *stream_,
+                                       size_t size_hint,
+                                       void **out_data,
+                                       size_t *out_size) {
+    zlib_stream_t *stream = (zlib_stream_t *) stream_;
+    if (stream->error == Z_STREAM_END || stream->flush != Z_NO_FLUSH) {
+        LOG(ERROR, _("Stream finished"));
+        return avs_errno(AVS_EBADF);
+    }
+    avs_error_t err = make_input_space(stream, size_hint);
+    if (avs_is_err(err)) {
+        return err;
+    }
+    *out_data = stream->zlib.next_in + stream->zlib.avail_in;
+    *out_size = input_space_left(stream);
+    return AVS_OK;
+}
+
+static avs_error_t zlib_stream_commit(avs_stream_t *stream_, size_t size) {
+    zlib_stream_t *stream = (zlib_stream_t *) stream_;
+    if (size > input_space_left(stream)) {
+        return avs_errno(AVS_EINVAL);
+    }
+    stream->zlib.avail_in += (unsigned) size;
+    return zlib_stream_flush(stream);
+}
+
 static size_t zlib_stream_nonblock_write_ready(avs_stream_t *stream_) {
     zlib_stream_t *stream = (zlib_stream_t *) stream_;
     if (stream->zlib.avail_in > 0 && avs_is_err(zlib_stream_flush(stream))) {
@@ -171,29 +234,39 @@ static avs_error_t zlib_stream_read(avs_stream_t *stream_,
                                     void *buffer,
                                     size_t buffer_length) {
     zlib_stream_t *stream = (zlib_stream_t *) stream_;
-    size_t ready_bytes =
-            AVS_MIN(buffer_length,
-                    stream->output_buffer_size - stream->zlib.avail_out);
+    size_t ready_bytes = AVS_MIN(buffer_length, output_available(stream));
     size_t bytes_read = 0;
     if (out_message_finished) {
         *out_message_finished = false;
     }
     if (ready_bytes) {
-        memcpy(buffer, GET_OUTPUT_BUFFER(stream), ready_bytes);
-        memmove(GET_OUTPUT_BUFFER(stream),
-                GET_OUTPUT_BUFFER(stream) + ready_bytes,
-                (stream->output_buffer_size - stream->zlib.avail_out)
-                        - ready_bytes);
-        stream->zlib.avail_out += (unsigned) ready_bytes;
+        memcpy(buffer, GET_OUTPUT_BUFFER(stream) + stream->output_offset,
+               ready_bytes);
+        output_consumed(stream, ready_bytes);
         bytes_read += ready_bytes;
     }
     if (bytes_read < buffer_length && stream->error != Z_STREAM_END) {
-        unsigned avail_out_orig = stream->zlib.avail_out;
-        stream->zlib.next_out = ((uint8_t *) buffer) + bytes_read;
-        stream->zlib.avail_out = (unsigned) (buffer_length - bytes_read);
-        zlib_stream_flush(stream);
-        bytes_read = buffer_length - stream->zlib.avail_out;
-        stream->zlib.avail_out = avail_out_orig;
+        /* the output buffer is empty at this point */
+        assert(!stream->output_offset);
+        if (buffer_length - bytes_read >= stream->output_buffer_size) {
+            /* large reads are processed directly into the caller's buffer */
+            unsigned avail_out_orig = stream->zlib.avail_out;
+            stream->zlib.next_out = ((uint8_t *) buffer) + bytes_read;
+            stream->zlib.avail_out = (unsigned) (buffer_length - bytes_read);
+            zlib_stream_flush(stream);
+            bytes_read = buffer_length - stream->zlib.avail_out;
+            stream->zlib.avail_out = avail_out_orig;
+        } else {
+            /* small ones go through the output buffer, as zlib is much
+             * less efficient when producing output in small pieces */
+            zlib_stream_flush(stream);
+            ready_bytes = AVS_MIN(buffer_length - bytes_read,
+                                  output_available(stream));
+            memcpy((uint8_t *) buffer + bytes_read, GET_OUTPUT_BUFFER(stream),
+                   ready_bytes);
+            output_consumed(stream, ready_bytes);
+            bytes_read += ready_bytes;
+        }
     }
     if (out_bytes_read) {
         *out_bytes_read = bytes_read;
@@ -233,14 +306,26 @@ zlib_stream_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
         LOG(ERROR, _("cannot peek - buffer is too small"));
         return avs_errno(AVS_ENOBUFS);
     }
-    if (stream->zlib.avail_out + offset >= stream->output_buffer_size) {
+    if (offset >= output_available(stream)) {
+        if (stream->output_offset) {
+            /* make room for more output */
+            size_t available = output_available(stream);
+            memmove(GET_OUTPUT_BUFFER(stream),
+                    GET_OUTPUT_BUFFER(stream) + stream->output_offset,
+                    available);
+            stream->output_offset = 0;
+            stream->zlib.avail_out =
+                    (unsigned) (stream->output_buffer_size - available);
+            stream->zlib.next_out = GET_OUTPUT_BUFFER(stream) + available;
+        }
         avs_error_t err = zlib_stream_flush(stream);
         if (avs_is_err(err)) {
             return err;
         }
     }
-    if (stream->zlib.avail_out + offset < stream->output_buffer_size) {
-        *out_value = ((char *) GET_OUTPUT_BUFFER(stream))[offset];
+    if (offset < output_available(stream)) {
+        *out_value = ((char *) GET_OUTPUT_BUFFER(
+                stream))[stream->output_offset + offset];
         return AVS_OK;
     } else {
         return AVS_EOF;
@@ -252,6 +337,7 @@ static void reset_fields(zlib_stream_t *stream) {
     stream->zlib.avail_out = (unsigned int) stream->output_buffer_size;
     stream->zlib.next_in = GET_INPUT_BUFFER(stream);
     stream->zlib.next_out = GET_OUTPUT_BUFFER(stream);
+    stream->output_offset = 0;
     stream->flush = 0;
     stream->error = Z_OK;
 }
@@ -310,6 +396,10 @@ static const avs_stream_v_table_extension_t zlib_vtable_extensions[] = {
       &(avs_stream_v_table_extension_nonblock_t[]){
               { zlib_stream_nonblock_read_ready,
                 zlib_stream_nonblock_write_ready } }[0] },
+    { AVS_STREAM_V_TABLE_EXTENSION_ZEROCOPY,
+      &(avs_stream_v_table_extension_zerocopy_t[]){
+              { .reserve = zlib_stream_reserve,
+                .commit = zlib_stream_commit } }[0] },
     AVS_STREAM_V_TABLE_EXTENSION_NULL
 };
 
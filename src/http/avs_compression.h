@@ -82,6 +82,10 @@ typedef enum {
  *   was previously written for the compression algorith to produce the desired
  *   amount of compressed data.
  *
+ * - <c>avs_stream_reserve</c> / <c>avs_stream_commit</c> - equivalent to
+ *   <c>avs_stream_write</c>, but give access to the free part of the input
+ *   buffer, so that data can be read directly into it.
+ *
  * - <c>avs_stream_reset</c> - clears the buffers and the state of the
  *   compression algorithm, allowing to compress a new stream.
  */
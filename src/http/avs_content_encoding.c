@@ -18,8 +18,7 @@
 
 #ifdef AVS_COMMONS_WITH_AVS_HTTP
 
-#    include <avsystem/commons/avs_memory.h>
-#    include <avsystem/commons/avs_stream_v_table.h>
+#    include <avsystem/commons/avs_stream_pipeline.h>
 
 #    include "avs_client.h"
 #    include "avs_compression.h"
@@ -34,178 +33,13 @@ VISIBILITY_SOURCE_BEGIN
         ((size_t) (HTTP_CONTENT_CODING_OUT_BUF_FACTOR     \
                    * (double) (BufferSizes)->content_coding_input))
 
-typedef struct {
-    const avs_stream_v_table_t *const vtable;
-    avs_stream_t *backend;
-    avs_stream_t *decoder;
-    const avs_http_buffer_sizes_t *buffer_sizes;
-} decoding_stream_t;
-
-static avs_error_t decode_more_data_with_buffer(decoding_stream_t *stream,
-                                                void *buffer,
-                                                size_t buffer_length,
-                                                bool *out_no_more_data) {
-    size_t bytes_read;
-    avs_error_t err = avs_stream_read(stream->backend, &bytes_read,
-                                      out_no_more_data, buffer, buffer_length);
-    if (avs_is_err(err)) {
-        return err;
-    }
-    if ((bytes_read > 0
-         && avs_is_err((err = avs_stream_write(stream->decoder, buffer,
-                                               bytes_read))))
-            || (*out_no_more_data
-                && avs_is_err((err = avs_stream_finish_message(
-                                       stream->decoder))))) {
-        return err;
-    }
-    return AVS_OK;
-}
-
-static avs_error_t decode_more_data(decoding_stream_t *stream,
-                                    void *temporary_buffer,
-                                    size_t buffer_length,
-                                    bool *out_no_more_data) {
-    if (buffer_length >= stream->buffer_sizes->content_coding_min_input) {
-        return decode_more_data_with_buffer(stream, temporary_buffer,
-                                            buffer_length, out_no_more_data);
-    } else {
-        char *internal_buffer = (char *) avs_malloc(
-                stream->buffer_sizes->content_coding_min_input);
-        if (!internal_buffer) {
-            return avs_errno(AVS_ENOMEM);
-        }
-        avs_error_t err = decode_more_data_with_buffer(
-                stream, internal_buffer,
-                stream->buffer_sizes->content_coding_min_input,
-                out_no_more_data);
-        avs_free(internal_buffer);
-        return err;
-    }
-}
-
-static avs_error_t decoding_read(avs_stream_t *stream_,
-                                 size_t *out_bytes_read,
-                                 bool *out_message_finished,
-                                 void *buffer,
-                                 size_t buffer_length) {
-    decoding_stream_t *stream = (decoding_stream_t *) stream_;
-    bool no_more_data = false;
-    size_t bytes_read = 0;
-    bool message_finished = false;
-    if (!out_bytes_read) {
-        out_bytes_read = &bytes_read;
-    }
-    if (!out_message_finished) {
-        out_message_finished = &message_finished;
-    }
-    while (true) {
-        /* try reading remaining data from decoder */
-        avs_error_t err =
-                avs_stream_read(stream->decoder, out_bytes_read,
-                                out_message_finished, buffer, buffer_length);
-        if (avs_is_err(err)) {
-            return err;
-        } else if (*out_bytes_read > 0 || *out_message_finished) {
-            return AVS_OK;
-        }
-        // no_more_data signifies that the underlying stream with *encoded*
-        // (compressed) data has been read to the end - but not necessarily
-        // decoded; i.e. we have received all the data from the network,
-        // buffered it, but not all the data resulting from decompression has
-        // been read yet. In that case, the avs_stream_read() above shall be
-        // enough for reading everything. If we reach here, it means that there
-        // is an error in the decoder implementation.
-        assert(!no_more_data);
-        // read and decode
-        // buffer is used here only as temporary storage;
-        // stored data is not used after return from decode_more_data()
-        err = decode_more_data(stream, buffer, buffer_length, &no_more_data);
-        if (avs_is_err(err)) {
-            return err;
-        }
-    }
-}
-
-static bool decoding_nonblock_read_ready(avs_stream_t *stream_) {
-    decoding_stream_t *stream = (decoding_stream_t *) stream_;
-    bool no_more_data = false;
-    avs_error_t err;
-    while (avs_is_eof(
-            (err = avs_stream_peek(stream->decoder, 0, &(char) { 0 })))) {
-        if (!avs_stream_nonblock_read_ready(stream->backend)) {
-            return false;
-        }
-        // this will allocate a temporary buffer inside
-        if (avs_is_err(decode_more_data(stream, NULL, 0, &no_more_data))) {
-            return false;
-        }
-        if (no_more_data) {
-            return true;
-        }
-    }
-    return avs_is_ok(err);
-}
-
-static avs_error_t
-decoding_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
-    decoding_stream_t *stream = (decoding_stream_t *) stream_;
-    bool no_more_data = false;
-    avs_error_t err;
-    while (avs_is_eof(
-                   (err = avs_stream_peek(stream->decoder, offset, out_value)))
-           && !no_more_data) {
-        // this will allocate a temporary buffer inside
-        if (avs_is_err(
-                    (err = decode_more_data(stream, NULL, 0, &no_more_data)))) {
-            break;
-        }
-    }
-    return err;
-}
-
-static avs_error_t decoding_close(avs_stream_t *stream_) {
-    decoding_stream_t *stream = (decoding_stream_t *) stream_;
-    avs_error_t decoder_err, backend_err;
-    if (avs_is_err((decoder_err = avs_stream_cleanup(&stream->decoder)))) {
-        LOG(ERROR, _("failed to close decoder stream"));
-    }
-    if (avs_is_err((backend_err = avs_stream_cleanup(&stream->backend)))) {
-        LOG(ERROR, _("failed to close backend stream"));
-    }
-    return avs_is_ok(decoder_err) ? backend_err : decoder_err;
-}
-
-static const avs_stream_v_table_t decoding_vtable = {
-    .read = decoding_read,
-    .peek = decoding_peek,
-    .close = decoding_close,
-    &(avs_stream_v_table_extension_t[]){
-            { AVS_STREAM_V_TABLE_EXTENSION_NONBLOCK,
-              &(avs_stream_v_table_extension_nonblock_t[])
-                      {
-                          {
-                              .read_ready = decoding_nonblock_read_ready
-                          }
-                      }[0] },
-            AVS_STREAM_V_TABLE_EXTENSION_NULL }[0]
-};
-
 avs_stream_t *
 _avs_http_decoding_stream_create(avs_stream_t *backend,
                                  avs_stream_t *decoder,
                                  const avs_http_buffer_sizes_t *buffer_sizes) {
-    decoding_stream_t *retval =
-            (decoding_stream_t *) avs_malloc(sizeof(*retval));
     LOG(TRACE, _("create_decoding_stream"));
-    if (retval) {
-        *(const avs_stream_v_table_t **) (intptr_t) &retval->vtable =
-                &decoding_vtable;
-        retval->backend = backend;
-        retval->decoder = decoder;
-        retval->buffer_sizes = buffer_sizes;
-    }
-    return (avs_stream_t *) retval;
+    return avs_stream_pipeline_create(backend, &decoder, 1,
+                                      buffer_sizes->content_coding_min_input);
 }
 
 int _avs_http_content_decoder_create(
@@ -26,23 +26,13 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
  * decoding, using a stream with semantics as described for
  * @ref _avs_http_create_decompressor.
  *
- * <c>avs_stream_t</c> methods are implemented as follows:
- *
- * - <c>avs_stream_read</c> - attempts to read some data from the <c>decoder</c>
- *   stream. If nothing could be read and the stream is not finished, it calls
- *   the "decode more data" procedure. This logic is repeated until there is
- *   data available, the <c>decoder</c> stream reports end of data, or an error
- *   occurs.
- *
- * - <c>avs_stream_peek</c> - calls <c>avs_stream_peek()</c> on the
- *   <c>decoder</c> stream. If it fails, attempts to call the "decode more data"
- *   procedure and retry.
- *
- * The "decode more data" procedure mentioned above attempts to read some data
- * from the <c>backend</c> stream. The read data is then written to the
- * <c>decoder</c> stream, and - if the read on <c>backend</c> reported
- * end-of-data, <c>avs_stream_finish_message()</c> is also called on the
- * <c>decoder</c> stream.
+ * This is a single-filter stream pipeline - see
+ * @ref avs_stream_pipeline_create for details. Data read from the
+ * <c>backend</c> stream is written to the <c>decoder</c> stream, and - once the
+ * read on <c>backend</c> reports end-of-data - the message is finished on the
+ * <c>decoder</c> stream. The decompressor supports
+ * <c>avs_stream_reserve()</c>, so the backend stream is read directly into its
+ * input buffer.
  */
 avs_stream_t *
 _avs_http_decoding_stream_create(avs_stream_t *backend,
@@ -33,6 +33,9 @@
 #    endif
 #    include <assert.h>
 
+#    define MODULE_NAME avs_list
+#    include <avs_x_log_config.h>
+
 VISIBILITY_SOURCE_BEGIN
 
 void *avs_list_adjust_allocated_ptr__(void *allocated) {
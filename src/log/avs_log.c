@@ -32,6 +32,9 @@
 #        include <avsystem/commons/avs_mutex.h>
 #    endif // AVS_COMMONS_WITH_AVS_COMPAT_THREADING
 
+#    define MODULE_NAME avs_log
+#    include <avs_x_log_config.h>
+
 VISIBILITY_SOURCE_BEGIN
 
 static void default_log_handler(avs_log_level_t level,
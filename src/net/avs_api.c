@@ -179,6 +179,51 @@ avs_error_t avs_net_socket_receive_from(avs_net_socket_t *socket,
                                             port, port_size);
 }
 
+avs_error_t
+avs_net_socket_send_batch(avs_net_socket_t *socket,
+                          const avs_net_socket_datagram_t *datagrams,
+                          size_t count,
+                          size_t *out_sent) {
+    *out_sent = 0;
+    if (!socket->operations->send_batch) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    return socket->operations->send_batch(socket, datagrams, count, out_sent);
+}
+
+avs_error_t avs_net_socket_receive_batch(avs_net_socket_t *socket,
+                                         avs_net_socket_datagram_t *datagrams,
+                                         size_t count,
+                                         size_t *out_received) {
+    *out_received = 0;
+    if (!socket->operations->receive_batch) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    return socket->operations->receive_batch(socket, datagrams, count,
+                                             out_received);
+}
+
+avs_error_t avs_net_socket_sendv(avs_net_socket_t *socket,
+                                 const avs_net_socket_iovec_t *iov,
+                                 size_t iov_count) {
+    if (!socket->operations->sendv) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    return socket->operations->sendv(socket, iov, iov_count);
+}
+
+avs_error_t avs_net_socket_send_nonblock(avs_net_socket_t *socket,
+                                         const void *buffer,
+                                         size_t buffer_length,
+                                         size_t *out_bytes_sent) {
+    *out_bytes_sent = 0;
+    if (!socket->operations->send_nonblock) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    return socket->operations->send_nonblock(socket, buffer, buffer_length,
+                                             out_bytes_sent);
+}
+
 avs_error_t avs_net_socket_bind(avs_net_socket_t *socket,
                                 const char *address,
                                 const char *port) {
@@ -472,6 +517,82 @@ static avs_error_t receive_from_debug(avs_net_socket_t *debug_socket,
     return err;
 }
 
+static avs_error_t
+send_batch_debug(avs_net_socket_t *debug_socket,
+                 const avs_net_socket_datagram_t *datagrams,
+                 size_t count,
+                 size_t *out_sent) {
+    avs_error_t err = avs_net_socket_send_batch(
+            ((avs_net_socket_debug_t *) debug_socket)->socket, datagrams, count,
+            out_sent);
+    for (size_t i = 0; i < *out_sent; ++i) {
+        fprintf(communication_log, "\n-------SEND-BATCH-------\n");
+        fwrite(datagrams[i].buffer, 1, datagrams[i].buffer_length,
+               communication_log);
+        fprintf(communication_log, "\n--------SEND-END--------\n");
+    }
+    if (avs_is_err(err)) {
+        fprintf(communication_log, "\n---SEND-BATCH-FAILURE---\n");
+    }
+    fflush(communication_log);
+    return err;
+}
+
+static avs_error_t receive_batch_debug(avs_net_socket_t *debug_socket,
+                                       avs_net_socket_datagram_t *datagrams,
+                                       size_t count,
+                                       size_t *out_received) {
+    avs_error_t err = avs_net_socket_receive_batch(
+            ((avs_net_socket_debug_t *) debug_socket)->socket, datagrams,
+            count, out_received);
+    for (size_t i = 0; i < *out_received; ++i) {
+        fprintf(communication_log, "\n-------RECV-BATCH-------\n");
+        fwrite(datagrams[i].buffer, 1, datagrams[i].length, communication_log);
+        fprintf(communication_log, "\n--------RECV-END--------\n");
+    }
+    if (avs_is_err(err)) {
+        fprintf(communication_log, "\n---RECV-BATCH-FAILURE---\n");
+    }
+    fflush(communication_log);
+    return err;
+}
+
+static avs_error_t sendv_debug(avs_net_socket_t *debug_socket,
+                               const avs_net_socket_iovec_t *iov,
+                               size_t iov_count) {
+    avs_error_t err = avs_net_socket_sendv(
+            ((avs_net_socket_debug_t *) debug_socket)->socket, iov, iov_count);
+    if (avs_is_ok(err)) {
+        fprintf(communication_log, "\n----------SENDV----------\n");
+        for (size_t i = 0; i < iov_count; ++i) {
+            fwrite(iov[i].data, 1, iov[i].size, communication_log);
+        }
+        fprintf(communication_log, "\n--------SEND-END--------\n");
+    } else {
+        fprintf(communication_log, "\n------SENDV-FAILURE------\n");
+    }
+    fflush(communication_log);
+    return err;
+}
+
+static avs_error_t send_nonblock_debug(avs_net_socket_t *debug_socket,
+                                       const void *buffer,
+                                       size_t buffer_length,
+                                       size_t *out_bytes_sent) {
+    avs_error_t err = avs_net_socket_send_nonblock(
+            ((avs_net_socket_debug_t *) debug_socket)->socket, buffer,
+            buffer_length, out_bytes_sent);
+    if (*out_bytes_sent) {
+        fprintf(communication_log, "\n----------SEND----------\n");
+        fwrite(buffer, 1, *out_bytes_sent, communication_log);
+        fprintf(communication_log, "\n--------SEND-END--------\n");
+    } else if (avs_is_err(err)) {
+        fprintf(communication_log, "\n------SEND-FAILURE------\n");
+    }
+    fflush(communication_log);
+    return err;
+}
+
 static avs_error_t bind_debug(avs_net_socket_t *debug_socket,
                               const char *localaddr,
                               const char *port) {
@@ -652,7 +773,8 @@ static const avs_net_socket_v_table_t debug_vtable = {
     shutdown_debug,       cleanup_debug,     system_socket_debug,
     interface_name_debug, remote_host_debug, remote_hostname_debug,
     remote_port_debug,    local_host_debug,  local_port_debug,
-    get_opt_debug,        set_opt_debug
+    get_opt_debug,        set_opt_debug,     send_batch_debug,
+    receive_batch_debug,  sendv_debug,       send_nonblock_debug
 };
 
 static avs_error_t create_socket_debug(avs_net_socket_t **debug_socket,
@@ -0,0 +1,732 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#ifdef AVS_COMMONS_WITH_AVS_NET
+
+#    include <stddef.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_addrinfo.h>
+#    include <avsystem/commons/avs_list.h>
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_net_udp_server.h>
+#    include <avsystem/commons/avs_socket_v_table.h>
+#    include <avsystem/commons/avs_utils.h>
+
+#    include "avs_net_impl.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+/* number of datagrams received from the server socket in a single call */
+#    define UDP_SERVER_BATCH_SIZE 8
+/* large enough for any UDP datagram, so that nothing is truncated */
+#    define UDP_SERVER_BUFFER_SIZE 65536
+/* limits of datagrams queued for a single peer and for not yet accepted peers;
+ * anything above is dropped */
+#    define UDP_SERVER_MAX_QUEUED 32
+#    define UDP_SERVER_MAX_PENDING 64
+/* must be a power of two */
+#    define UDP_SERVER_INITIAL_BUCKETS 16
+
+typedef struct {
+    /* only used for datagrams from not yet accepted peers */
+    avs_net_resolved_endpoint_t peer;
+    size_t length;
+    char data[];
+} queued_datagram_t;
+
+typedef struct udp_server_peer_struct udp_server_peer_t;
+
+struct udp_server_peer_struct {
+    const avs_net_socket_v_table_t *const operations;
+    /* NULL after the socket is closed or the server is cleaned up */
+    avs_net_udp_server_t *server;
+    avs_net_resolved_endpoint_t endpoint;
+    void *user_data;
+    uint32_t hash;
+    udp_server_peer_t *next_in_bucket;
+    udp_server_peer_t *next_ready;
+    bool ready;
+    avs_net_socket_state_t state;
+    char remote_host[NET_MAX_HOSTNAME_SIZE];
+    char remote_port[NET_PORT_SIZE];
+    AVS_LIST(queued_datagram_t) queue;
+    size_t queue_length;
+    avs_time_duration_t recv_timeout;
+    uint64_t bytes_received;
+    uint64_t bytes_sent;
+};
+
+struct avs_net_udp_server_struct {
+    avs_net_socket_t *socket;
+    /* hash table of open peers, keyed by the remote endpoint */
+    udp_server_peer_t **buckets;
+    size_t bucket_count;
+    size_t peer_count;
+    /* FIFO of peers that have datagrams queued and have not been reported by
+     * avs_net_udp_server_wait() since */
+    udp_server_peer_t *ready_head;
+    udp_server_peer_t *ready_tail;
+    /* datagrams from peers that have not been accepted yet */
+    AVS_LIST(queued_datagram_t) pending;
+    size_t pending_length;
+    char *buffer;
+    avs_net_socket_datagram_t datagrams[UDP_SERVER_BATCH_SIZE];
+    /* set if the server socket does not implement batch operations, so that
+     * single datagram ones are used */
+    bool receive_batch_unsupported;
+    bool send_batch_unsupported;
+};
+
+static bool is_enotsup(avs_error_t err) {
+    return err.category == AVS_ERRNO_CATEGORY && err.code == AVS_ENOTSUP;
+}
+
+static uint32_t hash_endpoint(const avs_net_resolved_endpoint_t *endpoint) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < endpoint->size; ++i) {
+        hash ^= (uint8_t) endpoint->data.buf[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool endpoints_equal(const avs_net_resolved_endpoint_t *a,
+                            const avs_net_resolved_endpoint_t *b) {
+    return a->size == b->size && !memcmp(a->data.buf, b->data.buf, a->size);
+}
+
+static udp_server_peer_t *
+find_peer(avs_net_udp_server_t *server,
+          const avs_net_resolved_endpoint_t *endpoint,
+          uint32_t hash) {
+    udp_server_peer_t *peer =
+            server->buckets[hash & (server->bucket_count - 1)];
+    while (peer
+           && (peer->hash != hash
+               || !endpoints_equal(&peer->endpoint, endpoint))) {
+        peer = peer->next_in_bucket;
+    }
+    return peer;
+}
+
+static void grow_buckets(avs_net_udp_server_t *server) {
+    size_t new_count = 2 * server->bucket_count;
+    udp_server_peer_t **new_buckets = (udp_server_peer_t **) avs_calloc(
+            new_count, sizeof(udp_server_peer_t *));
+    if (!new_buckets) {
+        // not fatal; lookups just become slower
+        LOG(WARNING, _("could not grow peer hash table"));
+        return;
+    }
+    for (size_t i = 0; i < server->bucket_count; ++i) {
+        udp_server_peer_t *peer = server->buckets[i];
+        while (peer) {
+            udp_server_peer_t *next = peer->next_in_bucket;
+            udp_server_peer_t **bucket = &new_buckets[peer->hash
+                                                      & (new_count - 1)];
+            peer->next_in_bucket = *bucket;
+            *bucket = peer;
+            peer = next;
+        }
+    }
+    avs_free(server->buckets);
+    server->buckets = new_buckets;
+    server->bucket_count = new_count;
+}
+
+static void register_peer(avs_net_udp_server_t *server,
+                          udp_server_peer_t *peer) {
+    if (server->peer_count >= server->bucket_count) {
+        grow_buckets(server);
+    }
+    udp_server_peer_t **bucket =
+            &server->buckets[peer->hash & (server->bucket_count - 1)];
+    peer->next_in_bucket = *bucket;
+    *bucket = peer;
+    ++server->peer_count;
+}
+
+static void mark_ready(avs_net_udp_server_t *server, udp_server_peer_t *peer) {
+    if (peer->ready) {
+        return;
+    }
+    peer->ready = true;
+    peer->next_ready = NULL;
+    if (server->ready_tail) {
+        server->ready_tail->next_ready = peer;
+    } else {
+        server->ready_head = peer;
+    }
+    server->ready_tail = peer;
+}
+
+static udp_server_peer_t *pop_ready(avs_net_udp_server_t *server) {
+    udp_server_peer_t *peer;
+    while ((peer = server->ready_head)) {
+        if (!(server->ready_head = peer->next_ready)) {
+            server->ready_tail = NULL;
+        }
+        peer->ready = false;
+        // skip peers whose datagrams have been received in the meantime
+        if (peer->queue) {
+            return peer;
+        }
+    }
+    return NULL;
+}
+
+static void unregister_peer(avs_net_udp_server_t *server,
+                            udp_server_peer_t *peer) {
+    udp_server_peer_t **peer_ptr =
+            &server->buckets[peer->hash & (server->bucket_count - 1)];
+    while (*peer_ptr != peer) {
+        peer_ptr = &(*peer_ptr)->next_in_bucket;
+    }
+    *peer_ptr = peer->next_in_bucket;
+    --server->peer_count;
+
+    if (peer->ready) {
+        udp_server_peer_t *prev = NULL;
+        peer_ptr = &server->ready_head;
+        while (*peer_ptr != peer) {
+            prev = *peer_ptr;
+            peer_ptr = &prev->next_ready;
+        }
+        *peer_ptr = peer->next_ready;
+        if (server->ready_tail == peer) {
+            server->ready_tail = prev;
+        }
+        peer->ready = false;
+    }
+}
+
+static void detach_peer(udp_server_peer_t *peer,
+                        avs_net_socket_state_t new_state) {
+    if (peer->server) {
+        unregister_peer(peer->server, peer);
+        peer->server = NULL;
+    }
+    AVS_LIST_CLEAR(&peer->queue);
+    peer->queue_length = 0;
+    peer->state = new_state;
+}
+
+static void dispatch_datagram(avs_net_udp_server_t *server,
+                              const avs_net_socket_datagram_t *datagram) {
+    udp_server_peer_t *peer =
+            find_peer(server, &datagram->peer, hash_endpoint(&datagram->peer));
+    if (peer ? peer->queue_length >= UDP_SERVER_MAX_QUEUED
+             : server->pending_length >= UDP_SERVER_MAX_PENDING) {
+        LOG(DEBUG, _("queue full, dropping datagram"));
+        return;
+    }
+    AVS_LIST(queued_datagram_t) element = (AVS_LIST(queued_datagram_t))
+            AVS_LIST_NEW_BUFFER(offsetof(queued_datagram_t, data)
+                                + datagram->length);
+    if (!element) {
+        LOG(ERROR, _("out of memory, dropping datagram"));
+        return;
+    }
+    element->length = datagram->length;
+    memcpy(element->data, datagram->buffer, datagram->length);
+    if (peer) {
+        AVS_LIST_APPEND(&peer->queue, element);
+        ++peer->queue_length;
+        mark_ready(server, peer);
+    } else {
+        element->peer = datagram->peer;
+        AVS_LIST_APPEND(&server->pending, element);
+        ++server->pending_length;
+    }
+}
+
+/**
+ * Receives a single datagram into the first element of server->datagrams,
+ * for sockets that do not support avs_net_socket_receive_batch().
+ */
+static avs_error_t receive_single(avs_net_udp_server_t *server,
+                                  size_t *out_received) {
+    avs_net_socket_datagram_t *datagram = &server->datagrams[0];
+    char host[NET_MAX_HOSTNAME_SIZE];
+    char port[NET_PORT_SIZE];
+    *out_received = 0;
+    avs_error_t err = avs_net_socket_receive_from(
+            server->socket, &datagram->length, datagram->buffer,
+            datagram->buffer_length, host, sizeof(host), port, sizeof(port));
+    if (avs_is_err(err)) {
+        return err;
+    }
+    datagram->truncated = false;
+
+    // resolve the address the same way the socket would report it in
+    // a batch, so that it matches the endpoints of the peers
+    avs_net_socket_opt_value_t family = {
+        .addr_family = AVS_NET_AF_UNSPEC
+    };
+    (void) avs_net_socket_get_opt(server->socket,
+                                  AVS_NET_SOCKET_OPT_ADDR_FAMILY, &family);
+    avs_net_addrinfo_t *info = avs_net_addrinfo_resolve_ex(
+            AVS_NET_UDP_SOCKET, family.addr_family, host, port,
+            AVS_NET_ADDRINFO_RESOLVE_F_V4MAPPED, NULL);
+    if (!info || avs_net_addrinfo_next(info, &datagram->peer)) {
+        LOG(WARNING, _("could not resolve peer address, dropping datagram"));
+    } else {
+        *out_received = 1;
+    }
+    avs_net_addrinfo_delete(&info);
+    return AVS_OK;
+}
+
+/**
+ * Receives whatever is available on the server socket, waiting until
+ * @p deadline if there is nothing, and distributes it between peers.
+ */
+static avs_error_t receive_datagrams(avs_net_udp_server_t *server,
+                                     avs_time_monotonic_t deadline) {
+    avs_error_t err = avs_net_socket_set_opt(
+            server->socket, AVS_NET_SOCKET_OPT_RECV_TIMEOUT,
+            (avs_net_socket_opt_value_t) {
+                .recv_timeout = avs_time_monotonic_diff(
+                        deadline, avs_time_monotonic_now())
+            });
+    if (avs_is_err(err)) {
+        return err;
+    }
+    size_t received = 0;
+    if (!server->receive_batch_unsupported) {
+        err = avs_net_socket_receive_batch(server->socket, server->datagrams,
+                                           UDP_SERVER_BATCH_SIZE, &received);
+        if (is_enotsup(err)) {
+            LOG(DEBUG, _("batch receive not supported, receiving datagrams ")
+                               _("one by one"));
+            server->receive_batch_unsupported = true;
+        }
+    }
+    if (server->receive_batch_unsupported) {
+        err = receive_single(server, &received);
+    }
+    for (size_t i = 0; i < received; ++i) {
+        dispatch_datagram(server, &server->datagrams[i]);
+    }
+    return err;
+}
+
+static avs_error_t send_peer(avs_net_socket_t *socket,
+                             const void *buffer,
+                             size_t buffer_length) {
+    udp_server_peer_t *peer = (udp_server_peer_t *) socket;
+    if (!peer->server) {
+        return avs_errno(AVS_EBADF);
+    }
+    avs_net_socket_datagram_t datagram = {
+        .buffer = (void *) (intptr_t) buffer,
+        .buffer_length = buffer_length,
+        .peer = peer->endpoint
+    };
+    avs_error_t err = avs_errno(AVS_ENOTSUP);
+    if (!peer->server->send_batch_unsupported) {
+        size_t sent;
+        err = avs_net_socket_send_batch(peer->server->socket, &datagram, 1,
+                                        &sent);
+        if (is_enotsup(err)) {
+            peer->server->send_batch_unsupported = true;
+        }
+    }
+    if (peer->server->send_batch_unsupported) {
+        err = avs_net_socket_send_to(peer->server->socket, buffer,
+                                     buffer_length, peer->remote_host,
+                                     peer->remote_port);
+    }
+    if (avs_is_ok(err)) {
+        peer->bytes_sent += buffer_length;
+    }
+    return err;
+}
+
+static avs_error_t receive_peer(avs_net_socket_t *socket,
+                                size_t *out_bytes_received,
+                                void *buffer,
+                                size_t buffer_length) {
+    udp_server_peer_t *peer = (udp_server_peer_t *) socket;
+    *out_bytes_received = 0;
+    if (!peer->server) {
+        return avs_errno(AVS_EBADF);
+    }
+    avs_time_monotonic_t deadline =
+            avs_time_monotonic_add(avs_time_monotonic_now(),
+                                   peer->recv_timeout);
+    while (!peer->queue) {
+        avs_error_t err = receive_datagrams(peer->server, deadline);
+        if (avs_is_err(err)) {
+            return err;
+        }
+    }
+
+    AVS_LIST(queued_datagram_t) datagram = AVS_LIST_DETACH(&peer->queue);
+    --peer->queue_length;
+    *out_bytes_received = AVS_MIN(datagram->length, buffer_length);
+    memcpy(buffer, datagram->data, *out_bytes_received);
+    peer->bytes_received += *out_bytes_received;
+    avs_error_t err = datagram->length > buffer_length
+                              ? avs_errno(AVS_EMSGSIZE)
+                              : AVS_OK;
+    AVS_LIST_DELETE(&datagram);
+    if (peer->queue) {
+        // make sure the remaining datagrams are reported again
+        mark_ready(peer->server, peer);
+    }
+    return err;
+}
+
+static avs_error_t close_peer(avs_net_socket_t *socket) {
+    detach_peer((udp_server_peer_t *) socket, AVS_NET_SOCKET_STATE_CLOSED);
+    return AVS_OK;
+}
+
+static avs_error_t shutdown_peer(avs_net_socket_t *socket) {
+    detach_peer((udp_server_peer_t *) socket, AVS_NET_SOCKET_STATE_SHUTDOWN);
+    return AVS_OK;
+}
+
+static avs_error_t cleanup_peer(avs_net_socket_t **socket) {
+    detach_peer((udp_server_peer_t *) *socket, AVS_NET_SOCKET_STATE_CLOSED);
+    avs_free(*socket);
+    *socket = NULL;
+    return AVS_OK;
+}
+
+static avs_error_t
+interface_name_peer(avs_net_socket_t *socket,
+                    avs_net_socket_interface_name_t *if_name) {
+    udp_server_peer_t *peer = (udp_server_peer_t *) socket;
+    if (!peer->server) {
+        return avs_errno(AVS_EBADF);
+    }
+    return avs_net_socket_interface_name(peer->server->socket, if_name);
+}
+
+static avs_error_t copy_string(const udp_server_peer_t *peer,
+                               const char *value,
+                               char *out_buffer,
+                               size_t out_buffer_size) {
+    if (!peer->server) {
+        return avs_errno(AVS_EBADF);
+    }
+    if (avs_simple_snprintf(out_buffer, out_buffer_size, "%s", value) < 0) {
+        return avs_errno(AVS_ERANGE);
+    }
+    return AVS_OK;
+}
+
+static avs_error_t remote_host_peer(avs_net_socket_t *socket,
+                                    char *out_buffer,
+                                    size_t out_buffer_size) {
+    udp_server_peer_t *peer = (udp_server_peer_t *) socket;
+    return copy_string(peer, peer->remote_host, out_buffer, out_buffer_size);
+}
+
+static avs_error_t remote_port_peer(avs_net_socket_t *socket,
+                                    char *out_buffer,
+                                    size_t out_buffer_size) {
+    udp_server_peer_t *peer = (udp_server_peer_t *) socket;
+    return copy_string(peer, peer->remote_port, out_buffer, out_buffer_size);
+}
+
+static avs_error_t local_host_peer(avs_net_socket_t *socket,
+                                   char *out_buffer,
+                                   size_t out_buffer_size) {
+    udp_server_peer_t *peer = (udp_server_peer_t *) socket;
+    if (!peer->server) {
+        return avs_errno(AVS_EBADF);
+    }
+    return avs_net_socket_get_local_host(peer->server->socket, out_buffer,
+                                         out_buffer_size);
+}
+
+static avs_error_t local_port_peer(avs_net_socket_t *socket,
+                                   char *out_buffer,
+                                   size_t out_buffer_size) {
+    udp_server_peer_t *peer = (udp_server_peer_t *) socket;
+    if (!peer->server) {
+        return avs_errno(AVS_EBADF);
+    }
+    return avs_net_socket_get_local_port(peer->server->socket, out_buffer,
+                                         out_buffer_size);
+}
+
+static avs_error_t get_opt_peer(avs_net_socket_t *socket,
+                                avs_net_socket_opt_key_t option_key,
+                                avs_net_socket_opt_value_t *out_option_value) {
+    udp_server_peer_t *peer = (udp_server_peer_t *) socket;
+    switch (option_key) {
+    case AVS_NET_SOCKET_OPT_RECV_TIMEOUT:
+        out_option_value->recv_timeout = peer->recv_timeout;
+        return AVS_OK;
+    case AVS_NET_SOCKET_OPT_STATE:
+        out_option_value->state = peer->state;
+        return AVS_OK;
+    case AVS_NET_SOCKET_OPT_BYTES_SENT:
+        out_option_value->bytes_sent = peer->bytes_sent;
+        return AVS_OK;
+    case AVS_NET_SOCKET_OPT_BYTES_RECEIVED:
+        out_option_value->bytes_received = peer->bytes_received;
+        return AVS_OK;
+    case AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA:
+        out_option_value->flag = !!peer->queue;
+        return AVS_OK;
+    case AVS_NET_SOCKET_OPT_ADDR_FAMILY:
+    case AVS_NET_SOCKET_OPT_MTU:
+    case AVS_NET_SOCKET_OPT_INNER_MTU:
+        if (!peer->server) {
+            return avs_errno(AVS_EBADF);
+        }
+        return avs_net_socket_get_opt(peer->server->socket, option_key,
+                                      out_option_value);
+    default:
+        LOG(DEBUG,
+            _("get_opt_peer: unknown or unsupported option key: ")
+                    _("(avs_net_socket_opt_key_t) ") "%d",
+            (int) option_key);
+        return avs_errno(AVS_EINVAL);
+    }
+}
+
+static avs_error_t set_opt_peer(avs_net_socket_t *socket,
+                                avs_net_socket_opt_key_t option_key,
+                                avs_net_socket_opt_value_t option_value) {
+    udp_server_peer_t *peer = (udp_server_peer_t *) socket;
+    switch (option_key) {
+    case AVS_NET_SOCKET_OPT_RECV_TIMEOUT:
+        peer->recv_timeout = option_value.recv_timeout;
+        return AVS_OK;
+    default:
+        LOG(DEBUG,
+            _("set_opt_peer: unknown or unsupported option key: ")
+                    _("(avs_net_socket_opt_key_t) ") "%d",
+            (int) option_key);
+        return avs_errno(AVS_EINVAL);
+    }
+}
+
+static const avs_net_socket_v_table_t peer_vtable = {
+    .send = send_peer,
+    .receive = receive_peer,
+    .close = close_peer,
+    .shutdown = shutdown_peer,
+    .cleanup = cleanup_peer,
+    .get_interface_name = interface_name_peer,
+    .get_remote_host = remote_host_peer,
+    .get_remote_hostname = remote_host_peer,
+    .get_remote_port = remote_port_peer,
+    .get_local_host = local_host_peer,
+    .get_local_port = local_port_peer,
+    .get_opt = get_opt_peer,
+    .set_opt = set_opt_peer
+};
+
+static avs_error_t accept_pending(avs_net_udp_server_t *server,
+                                  avs_net_socket_t **out_peer_socket,
+                                  void *user_data) {
+    AVS_LIST(queued_datagram_t) first = AVS_LIST_DETACH(&server->pending);
+    --server->pending_length;
+
+    const avs_net_socket_v_table_t *const VTABLE_PTR = &peer_vtable;
+    udp_server_peer_t *peer =
+            (udp_server_peer_t *) avs_calloc(1, sizeof(udp_server_peer_t));
+    if (!peer) {
+        LOG(ERROR, _("out of memory"));
+        AVS_LIST_DELETE(&first);
+        return avs_errno(AVS_ENOMEM);
+    }
+    memcpy((void *) (intptr_t) &peer->operations, &VTABLE_PTR,
+           sizeof(VTABLE_PTR));
+    peer->endpoint = first->peer;
+    avs_error_t err = avs_net_resolved_endpoint_get_host_port(
+            &peer->endpoint, peer->remote_host, sizeof(peer->remote_host),
+            peer->remote_port, sizeof(peer->remote_port));
+    if (avs_is_err(err)) {
+        LOG(ERROR, _("could not get peer address"));
+        AVS_LIST_DELETE(&first);
+        avs_free(peer);
+        return err;
+    }
+    peer->server = server;
+    peer->user_data = user_data;
+    peer->hash = hash_endpoint(&peer->endpoint);
+    peer->state = AVS_NET_SOCKET_STATE_ACCEPTED;
+    peer->recv_timeout = AVS_NET_SOCKET_DEFAULT_RECV_TIMEOUT;
+    peer->queue = first;
+    peer->queue_length = 1;
+
+    // move any further datagrams from the same peer
+    AVS_LIST(queued_datagram_t) *datagram_ptr;
+    AVS_LIST(queued_datagram_t) helper;
+    AVS_LIST_DELETABLE_FOREACH_PTR(datagram_ptr, helper, &server->pending) {
+        if (endpoints_equal(&(*datagram_ptr)->peer, &peer->endpoint)) {
+            AVS_LIST(queued_datagram_t) datagram =
+                    AVS_LIST_DETACH(datagram_ptr);
+            --server->pending_length;
+            if (peer->queue_length < UDP_SERVER_MAX_QUEUED) {
+                AVS_LIST_APPEND(&peer->queue, datagram);
+                ++peer->queue_length;
+            } else {
+                AVS_LIST_DELETE(&datagram);
+            }
+        }
+    }
+
+    register_peer(server, peer);
+    *out_peer_socket = (avs_net_socket_t *) peer;
+    return AVS_OK;
+}
+
+avs_error_t
+avs_net_udp_server_create(avs_net_udp_server_t **out_server,
+                          const avs_net_socket_configuration_t *configuration,
+                          const char *localaddr,
+                          const char *port) {
+    avs_net_udp_server_t *server = (avs_net_udp_server_t *) avs_calloc(
+            1, sizeof(avs_net_udp_server_t));
+    if (!server
+            || !(server->buckets = (udp_server_peer_t **) avs_calloc(
+                         UDP_SERVER_INITIAL_BUCKETS,
+                         sizeof(udp_server_peer_t *)))
+            || !(server->buffer = (char *) avs_malloc(
+                         UDP_SERVER_BATCH_SIZE * UDP_SERVER_BUFFER_SIZE))) {
+        LOG(ERROR, _("out of memory"));
+        avs_net_udp_server_cleanup(&server);
+        return avs_errno(AVS_ENOMEM);
+    }
+    server->bucket_count = UDP_SERVER_INITIAL_BUCKETS;
+    for (size_t i = 0; i < UDP_SERVER_BATCH_SIZE; ++i) {
+        server->datagrams[i].buffer =
+                server->buffer + i * UDP_SERVER_BUFFER_SIZE;
+        server->datagrams[i].buffer_length = UDP_SERVER_BUFFER_SIZE;
+    }
+
+    avs_error_t err;
+    if (avs_is_err((err = avs_net_udp_socket_create(&server->socket,
+                                                    configuration)))
+            || avs_is_err((err = avs_net_socket_bind(server->socket,
+                                                     localaddr, port)))) {
+        LOG(ERROR, _("could not create server socket"));
+        avs_net_udp_server_cleanup(&server);
+        return err;
+    }
+    *out_server = server;
+    return AVS_OK;
+}
+
+void avs_net_udp_server_cleanup(avs_net_udp_server_t **server) {
+    if (!server || !*server) {
+        return;
+    }
+    // empty the ready list first, so that detaching peers does not need to
+    // search it
+    udp_server_peer_t *peer;
+    while ((peer = (*server)->ready_head)) {
+        (*server)->ready_head = peer->next_ready;
+        peer->ready = false;
+    }
+    if ((*server)->buckets) {
+        for (size_t i = 0; i < (*server)->bucket_count; ++i) {
+            while ((*server)->buckets[i]) {
+                detach_peer((*server)->buckets[i],
+                            AVS_NET_SOCKET_STATE_CLOSED);
+            }
+        }
+        avs_free((*server)->buckets);
+    }
+    AVS_LIST_CLEAR(&(*server)->pending);
+    avs_free((*server)->buffer);
+    avs_net_socket_cleanup(&(*server)->socket);
+    avs_free(*server);
+    *server = NULL;
+}
+
+avs_net_socket_t *avs_net_udp_server_socket(avs_net_udp_server_t *server) {
+    return server->socket;
+}
+
+size_t avs_net_udp_server_peer_count(avs_net_udp_server_t *server) {
+    return server->peer_count;
+}
+
+avs_error_t avs_net_udp_server_accept(avs_net_udp_server_t *server,
+                                      avs_time_duration_t timeout,
+                                      avs_net_socket_t **out_peer_socket,
+                                      void *user_data) {
+    avs_time_monotonic_t deadline =
+            avs_time_monotonic_add(avs_time_monotonic_now(), timeout);
+    while (!server->pending) {
+        avs_error_t err = receive_datagrams(server, deadline);
+        if (avs_is_err(err)) {
+            return err;
+        }
+    }
+    return accept_pending(server, out_peer_socket, user_data);
+}
+
+avs_error_t avs_net_udp_server_set_user_data(avs_net_socket_t *peer_socket,
+                                             void *user_data) {
+    if (*(const avs_net_socket_v_table_t *const *) peer_socket
+            != &peer_vtable) {
+        return avs_errno(AVS_EINVAL);
+    }
+    ((udp_server_peer_t *) peer_socket)->user_data = user_data;
+    return AVS_OK;
+}
+
+avs_error_t avs_net_udp_server_wait(avs_net_udp_server_t *server,
+                                    avs_time_duration_t timeout,
+                                    avs_net_socket_t **out_socket,
+                                    bool *out_is_new,
+                                    void **out_user_data) {
+    avs_time_monotonic_t deadline =
+            avs_time_monotonic_add(avs_time_monotonic_now(), timeout);
+    while (true) {
+        udp_server_peer_t *peer = pop_ready(server);
+        if (peer) {
+            *out_socket = (avs_net_socket_t *) peer;
+            *out_is_new = false;
+            if (out_user_data) {
+                *out_user_data = peer->user_data;
+            }
+            return AVS_OK;
+        }
+        if (server->pending) {
+            *out_is_new = true;
+            if (out_user_data) {
+                *out_user_data = NULL;
+            }
+            return accept_pending(server, out_socket, NULL);
+        }
+        avs_error_t err = receive_datagrams(server, deadline);
+        if (avs_is_err(err)) {
+            return err;
+        }
+    }
+}
+
+#    ifdef AVS_UNIT_TESTING
+#        include "tests/net/udp_server.c"
+#    endif // AVS_UNIT_TESTING
+
+#endif // AVS_COMMONS_WITH_AVS_NET
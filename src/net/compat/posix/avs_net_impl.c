@@ -21,6 +21,10 @@
 #if defined(AVS_COMMONS_WITH_AVS_NET) \
         && defined(AVS_COMMONS_NET_WITH_POSIX_AVS_SOCKET)
 
+#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_MMSG
+#        define _GNU_SOURCE // for recvmmsg() and sendmmsg()
+#    endif
+
 #    include <avs_commons_posix_init.h>
 
 #    include <errno.h>
@@ -149,6 +153,10 @@ connect_net(avs_net_socket_t *net_socket, const char *host, const char *port);
 static avs_error_t send_net(avs_net_socket_t *net_socket,
                             const void *buffer,
                             size_t buffer_length);
+static avs_error_t send_nonblock_net(avs_net_socket_t *net_socket,
+                                     const void *buffer,
+                                     size_t buffer_length,
+                                     size_t *out_bytes_sent);
 static avs_error_t send_to_net(avs_net_socket_t *socket,
                                const void *buffer,
                                size_t buffer_length,
@@ -167,6 +175,20 @@ static avs_error_t receive_from_net(avs_net_socket_t *net_socket,
                                     char *port,
                                     size_t port_size);
 static avs_error_t
+send_batch_net(avs_net_socket_t *net_socket,
+               const avs_net_socket_datagram_t *datagrams,
+               size_t count,
+               size_t *out_sent);
+static avs_error_t receive_batch_net(avs_net_socket_t *net_socket,
+                                     avs_net_socket_datagram_t *datagrams,
+                                     size_t count,
+                                     size_t *out_received);
+#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+static avs_error_t sendv_net(avs_net_socket_t *net_socket,
+                             const avs_net_socket_iovec_t *iov,
+                             size_t iov_count);
+#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+static avs_error_t
 bind_net(avs_net_socket_t *net_socket, const char *localaddr, const char *port);
 static avs_error_t accept_net(avs_net_socket_t *server_net_socket,
                               avs_net_socket_t *new_net_socket);
@@ -217,7 +239,13 @@ static const avs_net_socket_v_table_t net_vtable = {
     .get_local_host = local_host_net,
     .get_local_port = local_port_net,
     .get_opt = get_opt_net,
-    .set_opt = set_opt_net
+    .set_opt = set_opt_net,
+    .send_batch = send_batch_net,
+    .receive_batch = receive_batch_net,
+#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+    .sendv = sendv_net,
+#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+    .send_nonblock = send_nonblock_net
 };
 
 typedef struct {
@@ -231,8 +259,10 @@ typedef struct {
 
     uint64_t bytes_received;
     uint64_t bytes_sent;
+    uint64_t syscall_count;
 
     avs_time_duration_t recv_timeout;
+    bool optimistic_io;
 } net_socket_impl_t;
 
 #    if defined(AVS_COMMONS_NET_WITH_IPV4) && defined(AVS_COMMONS_NET_WITH_IPV6)
@@ -698,9 +728,10 @@ static avs_error_t wait_until_ready_internal(sockfd_t sockfd,
 #    endif
 }
 
-static avs_error_t wait_until_ready(const volatile sockfd_t *sockfd_ptr,
+static avs_error_t wait_until_ready(net_socket_impl_t *net_socket,
                                     avs_time_monotonic_t deadline,
                                     int flags) {
+    const volatile sockfd_t *sockfd_ptr = &net_socket->socket;
     avs_error_t error;
     do {
         sockfd_t sockfd = *sockfd_ptr;
@@ -710,6 +741,7 @@ static avs_error_t wait_until_ready(const volatile sockfd_t *sockfd_ptr,
             return avs_errno(AVS_EBADF);
         }
 
+        ++net_socket->syscall_count;
         error = wait_until_ready_internal(
                 sockfd,
                 avs_time_monotonic_diff(deadline, avs_time_monotonic_now()),
@@ -722,7 +754,35 @@ static avs_error_t wait_until_ready(const volatile sockfd_t *sockfd_ptr,
 
 typedef avs_error_t call_when_ready_cb_t(sockfd_t sockfd, void *arg);
 
-static avs_error_t call_when_ready(const volatile sockfd_t *sockfd_ptr,
+static bool is_eagain(avs_error_t error) {
+    // NOTE: Both EAGAIN and EWOULDBLOCK map onto AVS_EAGAIN. These constants
+    // are allowed to be equivalent, so we coerce them in avs_errno_t for
+    // simplicity.
+    return error.category == AVS_ERRNO_CATEGORY && error.code == AVS_EAGAIN;
+}
+
+static avs_error_t call_now(net_socket_impl_t *net_socket,
+                            avs_time_monotonic_t deadline,
+                            call_when_ready_cb_t *callback,
+                            void *callback_arg) {
+    const volatile sockfd_t *sockfd_ptr = &net_socket->socket;
+    avs_error_t error;
+    do {
+        sockfd_t sockfd = *sockfd_ptr;
+        if (sockfd == INVALID_SOCKET) {
+            // socket might have been closed in signal handler
+            // or something like this
+            error = avs_errno(AVS_EBADF);
+        } else {
+            ++net_socket->syscall_count;
+            error = callback(sockfd, callback_arg);
+        }
+    } while (error.category == AVS_ERRNO_CATEGORY && error.code == AVS_EINTR
+             && !avs_time_monotonic_before(deadline, avs_time_monotonic_now()));
+    return error;
+}
+
+static avs_error_t call_when_ready(net_socket_impl_t *net_socket,
                                    avs_time_duration_t timeout,
                                    int flags,
                                    call_when_ready_cb_t *callback,
@@ -730,29 +790,25 @@ static avs_error_t call_when_ready(const volatile sockfd_t *sockfd_ptr,
     avs_error_t error;
     avs_time_monotonic_t deadline =
             avs_time_monotonic_add(avs_time_monotonic_now(), timeout);
-    while (avs_is_ok((error = wait_until_ready(sockfd_ptr, deadline, flags)))) {
-        do {
-            sockfd_t sockfd = *sockfd_ptr;
-            if (sockfd == INVALID_SOCKET) {
-                // socket might have been closed in signal handler
-                // or something like this
-                error = avs_errno(AVS_EBADF);
-            } else {
-                error = callback(sockfd, callback_arg);
-            }
-        } while (error.category == AVS_ERRNO_CATEGORY && error.code == AVS_EINTR
-                 && !avs_time_monotonic_before(deadline,
-                                               avs_time_monotonic_now()));
-        if (error.category != AVS_ERRNO_CATEGORY || error.code != AVS_EAGAIN) {
+    if (net_socket->optimistic_io) {
+        // The system socket is non-blocking, so the operation may just be
+        // attempted; waiting is only necessary if it would block. This saves
+        // a poll() call whenever data is already queued or there is space in
+        // the send buffer.
+        error = call_now(net_socket, deadline, callback, callback_arg);
+        if (!is_eagain(error)) {
+            return error;
+        }
+    }
+    while (avs_is_ok((error = wait_until_ready(net_socket, deadline, flags)))) {
+        error = call_now(net_socket, deadline, callback, callback_arg);
+        if (!is_eagain(error)) {
             // AVS_EAGAIN might signify a false positive result from
             // wait_until_ready(); this might happen e.g. if poll() returned an
             // event when the kernel saw incoming data, but the data turned out
             // to have e.g. wrong checksum and were discarded later - this is
             // basically a spurious wakeup; in such case, try again;
             // otherwise, return.
-            // NOTE: Both EAGAIN and EWOULDBLOCK map onto AVS_EAGAIN. These
-            // constants are allowed to be equivalent, so we coerce them in
-            // avs_errno_t for simplicity.
             break;
         }
     }
@@ -760,8 +816,10 @@ static avs_error_t call_when_ready(const volatile sockfd_t *sockfd_ptr,
 }
 
 static avs_error_t
-connect_with_timeout(const volatile sockfd_t *sockfd_ptr,
+connect_with_timeout(net_socket_impl_t *net_socket,
                      const sockaddr_endpoint_union_t *endpoint) {
+    const volatile sockfd_t *sockfd_ptr = &net_socket->socket;
+    ++net_socket->syscall_count;
     if (connect(*sockfd_ptr, &endpoint->sockaddr_ep.addr,
                 endpoint->sockaddr_ep.header.size)
                     == -1
@@ -772,7 +830,7 @@ connect_with_timeout(const volatile sockfd_t *sockfd_ptr,
             avs_time_monotonic_add(avs_time_monotonic_now(),
                                    NET_CONNECT_TIMEOUT);
     avs_error_t err =
-            wait_until_ready(sockfd_ptr, deadline, AVS_POLLIN | AVS_POLLOUT);
+            wait_until_ready(net_socket, deadline, AVS_POLLIN | AVS_POLLOUT);
     if (avs_is_err(err)) {
         int error_code = 0;
         socklen_t length = sizeof(error_code);
@@ -1039,7 +1097,7 @@ try_connect_open_socket(net_socket_impl_t *net_socket,
                         const sockaddr_endpoint_union_t *address) {
     bool socket_is_stream = (net_socket->type == AVS_NET_TCP_SOCKET);
     avs_error_t err;
-    if (avs_is_err((err = connect_with_timeout(&net_socket->socket, address)))
+    if (avs_is_err((err = connect_with_timeout(net_socket, address)))
             || (socket_is_stream
                 && avs_is_err((err = send_net((avs_net_socket_t *) net_socket,
                                               NULL, 0))))) {
@@ -1192,7 +1250,7 @@ static avs_error_t send_net(avs_net_socket_t *net_socket_,
     /* send at least one datagram, even if zero-length - hence do..while */
     do {
         avs_error_t err =
-                call_when_ready(&net_socket->socket, NET_SEND_TIMEOUT,
+                call_when_ready(net_socket, NET_SEND_TIMEOUT,
                                 AVS_POLLOUT | AVS_POLLERR, send_internal, &arg);
         if (avs_is_err(err)) {
             LOG(ERROR, _("send failed"));
@@ -1219,6 +1277,123 @@ static avs_error_t send_net(avs_net_socket_t *net_socket_,
     }
 }
 
+static avs_error_t send_nonblock_net(avs_net_socket_t *net_socket_,
+                                     const void *buffer,
+                                     size_t buffer_length,
+                                     size_t *out_bytes_sent) {
+    net_socket_impl_t *net_socket = (net_socket_impl_t *) net_socket_;
+    send_internal_arg_t arg = {
+        .bytes_sent = 0,
+        .data = (const char *) buffer,
+        .data_length = buffer_length
+    };
+    /* the system socket is non-blocking, so a single attempt either sends
+     * some data or fails with AVS_EAGAIN */
+    avs_error_t err = call_now(net_socket, avs_time_monotonic_now(),
+                               send_internal, &arg);
+    if (avs_is_ok(err)) {
+        net_socket->bytes_sent += arg.bytes_sent;
+        *out_bytes_sent = arg.bytes_sent;
+    }
+    return err;
+}
+
+#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+typedef struct {
+    const avs_net_socket_iovec_t *iov;
+    size_t iov_count;
+    /* number of bytes of iov[0] that have already been sent */
+    size_t iov_offset;
+    size_t bytes_sent;
+} sendv_internal_arg_t;
+
+static avs_error_t sendv_internal(sockfd_t sockfd, void *arg_) {
+    sendv_internal_arg_t *arg = (sendv_internal_arg_t *) arg_;
+    struct iovec iovs[AVS_NET_SOCKET_SENDV_MAX_IOV];
+    size_t count = AVS_MIN(arg->iov_count, AVS_NET_SOCKET_SENDV_MAX_IOV);
+    struct msghdr msg;
+
+    memset(&msg, 0, sizeof(msg));
+    for (size_t i = 0; i < count; ++i) {
+        iovs[i].iov_base = (void *) (intptr_t) arg->iov[i].data;
+        iovs[i].iov_len = arg->iov[i].size;
+    }
+    if (count) {
+        iovs[0].iov_base = (char *) iovs[0].iov_base + arg->iov_offset;
+        iovs[0].iov_len -= arg->iov_offset;
+    }
+    msg.msg_iov = iovs;
+    msg.msg_iovlen = count;
+
+    ssize_t result = sendmsg(sockfd, &msg, MSG_NOSIGNAL);
+    if (result < 0) {
+        return failure_from_errno();
+    }
+    arg->bytes_sent = (size_t) result;
+    return AVS_OK;
+}
+
+static void sendv_advance(sendv_internal_arg_t *arg, size_t bytes) {
+    while (arg->iov_count && bytes >= arg->iov[0].size - arg->iov_offset) {
+        bytes -= arg->iov[0].size - arg->iov_offset;
+        arg->iov_offset = 0;
+        ++arg->iov;
+        --arg->iov_count;
+    }
+    arg->iov_offset += bytes;
+}
+
+static avs_error_t sendv_net(avs_net_socket_t *net_socket_,
+                             const avs_net_socket_iovec_t *iov,
+                             size_t iov_count) {
+    net_socket_impl_t *net_socket = (net_socket_impl_t *) net_socket_;
+    size_t total_length = 0;
+    for (size_t i = 0; i < iov_count; ++i) {
+        total_length += iov[i].size;
+    }
+    if (net_socket->type != AVS_NET_TCP_SOCKET
+            && iov_count > AVS_NET_SOCKET_SENDV_MAX_IOV) {
+        LOG(ERROR, _("too many buffers for a single datagram: ") "%lu",
+            (unsigned long) iov_count);
+        return avs_errno(AVS_EMSGSIZE);
+    }
+
+    sendv_internal_arg_t arg = {
+        .iov = iov,
+        .iov_count = iov_count,
+        .iov_offset = 0,
+        .bytes_sent = 0
+    };
+    size_t bytes_sent = 0;
+
+    /* send at least one datagram, even if zero-length - hence do..while */
+    do {
+        avs_error_t err = call_when_ready(net_socket, NET_SEND_TIMEOUT,
+                                          AVS_POLLOUT | AVS_POLLERR,
+                                          sendv_internal, &arg);
+        if (avs_is_err(err)) {
+            LOG(ERROR, _("sendv failed"));
+            return err;
+        } else if (total_length != 0 && arg.bytes_sent == 0) {
+            LOG(ERROR, _("sendv returned 0"));
+            break;
+        }
+        bytes_sent += arg.bytes_sent;
+        net_socket->bytes_sent += arg.bytes_sent;
+        sendv_advance(&arg, arg.bytes_sent);
+        /* call sendmsg() multiple times only if the socket is stream-oriented */
+    } while (net_socket->type == AVS_NET_TCP_SOCKET
+             && bytes_sent < total_length);
+
+    if (bytes_sent < total_length) {
+        LOG(ERROR, _("sending fail (") "%lu" _("/") "%lu" _(")"),
+            (unsigned long) bytes_sent, (unsigned long) total_length);
+        return avs_errno(AVS_EIO);
+    }
+    return AVS_OK;
+}
+#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+
 typedef struct {
     const void *data;
     size_t data_length;
@@ -1257,7 +1432,7 @@ static avs_error_t send_to_resolved(net_socket_impl_t *net_socket,
     };
 
     avs_error_t err =
-            call_when_ready(&net_socket->socket, NET_SEND_TIMEOUT,
+            call_when_ready(net_socket, NET_SEND_TIMEOUT,
                             AVS_POLLOUT | AVS_POLLERR, send_to_internal, &arg);
     net_socket->bytes_sent += arg.bytes_sent;
     return err;
@@ -1398,7 +1573,7 @@ static avs_error_t receive_net(avs_net_socket_t *net_socket_,
         .buffer_length = buffer_length
     };
     avs_error_t err =
-            call_when_ready(&net_socket->socket, net_socket->recv_timeout,
+            call_when_ready(net_socket, net_socket->recv_timeout,
                             AVS_POLLIN | AVS_POLLERR, recvfrom_internal, &arg);
     *out = arg.bytes_received;
     net_socket->bytes_received += arg.bytes_received;
@@ -1430,7 +1605,7 @@ static avs_error_t receive_from_net(avs_net_socket_t *net_socket_,
         .src_addr_length = &src_addr_length
     };
     avs_error_t err =
-            call_when_ready(&net_socket->socket, net_socket->recv_timeout,
+            call_when_ready(net_socket, net_socket->recv_timeout,
                             AVS_POLLIN | AVS_POLLERR, recvfrom_internal, &arg);
     net_socket->bytes_received += arg.bytes_received;
     *out = arg.bytes_received;
@@ -1448,6 +1623,222 @@ static avs_error_t receive_from_net(avs_net_socket_t *net_socket_,
     return err;
 }
 
+/* Maximum number of datagrams passed to a single recvmmsg() / sendmmsg() */
+#    define NET_BATCH_CHUNK_SIZE 32
+
+typedef struct {
+    const avs_net_socket_datagram_t *datagrams;
+    size_t count;
+    size_t sent;
+} send_batch_internal_arg_t;
+
+typedef struct {
+    avs_net_socket_datagram_t *datagrams;
+    size_t count;
+    size_t received;
+    bool drained;
+} recv_batch_internal_arg_t;
+
+#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_MMSG
+
+static avs_error_t send_batch_internal(sockfd_t sockfd, void *arg_) {
+    send_batch_internal_arg_t *arg = (send_batch_internal_arg_t *) arg_;
+    struct mmsghdr msgs[NET_BATCH_CHUNK_SIZE];
+    struct iovec iovs[NET_BATCH_CHUNK_SIZE];
+    size_t chunk_size = AVS_MIN(arg->count - arg->sent, NET_BATCH_CHUNK_SIZE);
+
+    memset(msgs, 0, chunk_size * sizeof(*msgs));
+    for (size_t i = 0; i < chunk_size; ++i) {
+        const avs_net_socket_datagram_t *datagram =
+                &arg->datagrams[arg->sent + i];
+        iovs[i].iov_base = datagram->buffer;
+        iovs[i].iov_len = datagram->buffer_length;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        if (datagram->peer.size) {
+            msgs[i].msg_hdr.msg_name =
+                    (void *) (intptr_t) datagram->peer.data.buf;
+            msgs[i].msg_hdr.msg_namelen = datagram->peer.size;
+        }
+    }
+
+    int result = sendmmsg(sockfd, msgs, (unsigned) chunk_size, MSG_NOSIGNAL);
+    if (result < 0) {
+        return failure_from_errno();
+    }
+    arg->sent += (size_t) result;
+    return AVS_OK;
+}
+
+static avs_error_t recv_batch_internal(sockfd_t sockfd, void *arg_) {
+    recv_batch_internal_arg_t *arg = (recv_batch_internal_arg_t *) arg_;
+    struct mmsghdr msgs[NET_BATCH_CHUNK_SIZE];
+    struct iovec iovs[NET_BATCH_CHUNK_SIZE];
+    size_t chunk_size =
+            AVS_MIN(arg->count - arg->received, NET_BATCH_CHUNK_SIZE);
+
+    memset(msgs, 0, chunk_size * sizeof(*msgs));
+    for (size_t i = 0; i < chunk_size; ++i) {
+        avs_net_socket_datagram_t *datagram =
+                &arg->datagrams[arg->received + i];
+        iovs[i].iov_base = datagram->buffer;
+        iovs[i].iov_len = datagram->buffer_length;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = datagram->peer.data.buf;
+        msgs[i].msg_hdr.msg_namelen =
+                (socklen_t) sizeof(datagram->peer.data.buf);
+    }
+
+    // the socket is non-blocking, so this returns the datagrams that are
+    // already queued, without waiting for the whole chunk to fill up
+    int result = recvmmsg(sockfd, msgs, (unsigned) chunk_size, 0, NULL);
+    if (result < 0) {
+        return failure_from_errno();
+    }
+    for (size_t i = 0; i < (size_t) result; ++i) {
+        avs_net_socket_datagram_t *datagram =
+                &arg->datagrams[arg->received + i];
+        datagram->length = msgs[i].msg_len;
+        datagram->truncated = !!(msgs[i].msg_hdr.msg_flags & MSG_TRUNC);
+        datagram->peer.size = (uint8_t) msgs[i].msg_hdr.msg_namelen;
+    }
+    arg->received += (size_t) result;
+    arg->drained = ((size_t) result < chunk_size);
+    return AVS_OK;
+}
+
+#    else /* AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_MMSG */
+
+static avs_error_t send_batch_internal(sockfd_t sockfd, void *arg_) {
+    send_batch_internal_arg_t *arg = (send_batch_internal_arg_t *) arg_;
+    const avs_net_socket_datagram_t *datagram = &arg->datagrams[arg->sent];
+    ssize_t result;
+    if (datagram->peer.size) {
+        const sockaddr_endpoint_union_t *peer =
+                (const sockaddr_endpoint_union_t *) &datagram->peer;
+        result = sendto(sockfd, datagram->buffer, datagram->buffer_length,
+                        MSG_NOSIGNAL, &peer->sockaddr_ep.addr,
+                        peer->sockaddr_ep.header.size);
+    } else {
+        result = send(sockfd, datagram->buffer, datagram->buffer_length,
+                      MSG_NOSIGNAL);
+    }
+    if (result < 0) {
+        return failure_from_errno();
+    } else if ((size_t) result != datagram->buffer_length) {
+        LOG(ERROR, _("send_batch fail (") "%lu" _("/") "%lu" _(")"),
+            (unsigned long) result, (unsigned long) datagram->buffer_length);
+        return avs_errno(AVS_EIO);
+    }
+    ++arg->sent;
+    return AVS_OK;
+}
+
+static avs_error_t recv_batch_internal(sockfd_t sockfd, void *arg_) {
+    recv_batch_internal_arg_t *arg = (recv_batch_internal_arg_t *) arg_;
+    avs_net_socket_datagram_t *datagram = &arg->datagrams[arg->received];
+    sockaddr_union_t src_addr;
+    socklen_t src_addr_length = 0;
+    recvfrom_internal_arg_t recv_arg = {
+        .socket_type = AVS_NET_UDP_SOCKET,
+        .buffer = datagram->buffer,
+        .buffer_length = datagram->buffer_length,
+        .src_addr = &src_addr,
+        .src_addr_length = &src_addr_length
+    };
+    avs_error_t err = recvfrom_internal(sockfd, &recv_arg);
+    bool truncated =
+            (err.category == AVS_ERRNO_CATEGORY && err.code == AVS_EMSGSIZE);
+    if (avs_is_err(err) && !truncated) {
+        return err;
+    }
+    size_t addr_size =
+            AVS_MIN((size_t) src_addr_length, sizeof(datagram->peer.data.buf));
+    memcpy(datagram->peer.data.buf, &src_addr, addr_size);
+    datagram->peer.size = (uint8_t) addr_size;
+    datagram->length = recv_arg.bytes_received;
+    datagram->truncated = truncated;
+    ++arg->received;
+    arg->drained = false;
+    return AVS_OK;
+}
+
+#    endif /* AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_MMSG */
+
+static avs_error_t
+send_batch_net(avs_net_socket_t *net_socket_,
+               const avs_net_socket_datagram_t *datagrams,
+               size_t count,
+               size_t *out_sent) {
+    net_socket_impl_t *net_socket = (net_socket_impl_t *) net_socket_;
+    if (net_socket->type != AVS_NET_UDP_SOCKET) {
+        LOG(ERROR, _("batch send is only supported for UDP sockets"));
+        return avs_errno(AVS_ENOTSUP);
+    }
+
+    send_batch_internal_arg_t arg = {
+        .datagrams = datagrams,
+        .count = count,
+        .sent = 0
+    };
+    avs_error_t err = AVS_OK;
+    while (avs_is_ok(err) && arg.sent < count) {
+        size_t sent_before = arg.sent;
+        err = call_when_ready(net_socket, NET_SEND_TIMEOUT,
+                              AVS_POLLOUT | AVS_POLLERR, send_batch_internal,
+                              &arg);
+        for (size_t i = sent_before; i < arg.sent; ++i) {
+            net_socket->bytes_sent += datagrams[i].buffer_length;
+        }
+    }
+    if (avs_is_err(err)) {
+        LOG(ERROR, _("send_batch failed after ") "%lu" _(" datagrams"),
+            (unsigned long) arg.sent);
+    }
+    *out_sent = arg.sent;
+    return err;
+}
+
+static avs_error_t receive_batch_net(avs_net_socket_t *net_socket_,
+                                     avs_net_socket_datagram_t *datagrams,
+                                     size_t count,
+                                     size_t *out_received) {
+    net_socket_impl_t *net_socket = (net_socket_impl_t *) net_socket_;
+    if (net_socket->type != AVS_NET_UDP_SOCKET) {
+        LOG(ERROR, _("batch receive is only supported for UDP sockets"));
+        return avs_errno(AVS_ENOTSUP);
+    }
+    if (!count) {
+        return AVS_OK;
+    }
+
+    recv_batch_internal_arg_t arg = {
+        .datagrams = datagrams,
+        .count = count,
+        .received = 0,
+        .drained = false
+    };
+    avs_error_t err =
+            call_when_ready(net_socket, net_socket->recv_timeout,
+                            AVS_POLLIN | AVS_POLLERR, recv_batch_internal,
+                            &arg);
+    // Some data have been received; collect whatever else is already queued,
+    // without waiting. Any error at this point (most likely AVS_EAGAIN) just
+    // ends the batch - a persistent one will be reported by the next call.
+    while (avs_is_ok(err) && !arg.drained && arg.received < count) {
+        ++net_socket->syscall_count;
+        if (avs_is_err(recv_batch_internal(net_socket->socket, &arg))) {
+            break;
+        }
+    }
+    for (size_t i = 0; i < arg.received; ++i) {
+        net_socket->bytes_received += datagrams[i].length;
+    }
+    *out_received = arg.received;
+    return err;
+}
+
 static avs_error_t create_listening_socket(net_socket_impl_t *net_socket,
                                            const struct sockaddr *addr,
                                            socklen_t addrlen) {
@@ -1579,7 +1970,7 @@ static avs_error_t peek_received_msg_host_port(net_socket_impl_t *net_socket,
                                                size_t port_size) {
     avs_error_t err;
     struct sockaddr addr;
-    (void) (avs_is_err((err = call_when_ready(&net_socket->socket,
+    (void) (avs_is_err((err = call_when_ready(net_socket,
                                               net_socket->recv_timeout,
                                               AVS_POLLIN | AVS_POLLERR,
                                               peek_internal, &addr)))
@@ -1664,7 +2055,7 @@ static avs_error_t accept_tcp(net_socket_impl_t *server_net_socket,
         .client_sockfd = INVALID_SOCKET
     };
     avs_error_t err;
-    if (avs_is_err((err = call_when_ready(&server_net_socket->socket,
+    if (avs_is_err((err = call_when_ready(server_net_socket,
                                           NET_ACCEPT_TIMEOUT,
                                           AVS_POLLIN | AVS_POLLERR,
                                           accept_internal, &arg)))) {
@@ -1776,6 +2167,7 @@ static avs_error_t create_net_socket(avs_net_socket_t **socket,
     net_socket->socket = INVALID_SOCKET;
     net_socket->type = socket_type;
     net_socket->recv_timeout = AVS_NET_SOCKET_DEFAULT_RECV_TIMEOUT;
+    net_socket->optimistic_io = true;
 
     *socket = (avs_net_socket_t *) net_socket;
 
@@ -1962,6 +2354,19 @@ static avs_error_t get_opt_net(avs_net_socket_t *net_socket_,
     case AVS_NET_SOCKET_OPT_BYTES_SENT:
         out_option_value->bytes_sent = net_socket->bytes_sent;
         return AVS_OK;
+    case AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA:
+        // all data is kept by the operating system
+        out_option_value->flag = false;
+        return AVS_OK;
+    case AVS_NET_SOCKET_OPT_OPTIMISTIC_IO:
+        out_option_value->flag = net_socket->optimistic_io;
+        return AVS_OK;
+    case AVS_NET_SOCKET_OPT_SYSCALL_COUNT:
+        out_option_value->syscall_count = net_socket->syscall_count;
+        return AVS_OK;
+    case AVS_NET_SOCKET_OPT_SOCKET_TYPE:
+        out_option_value->socket_type = net_socket->type;
+        return AVS_OK;
     default:
         LOG(DEBUG,
             _("get_opt_net: unknown or unsupported option key: ")
@@ -1979,6 +2384,9 @@ static avs_error_t set_opt_net(avs_net_socket_t *net_socket_,
     case AVS_NET_SOCKET_OPT_RECV_TIMEOUT:
         net_socket->recv_timeout = option_value.recv_timeout;
         return AVS_OK;
+    case AVS_NET_SOCKET_OPT_OPTIMISTIC_IO:
+        net_socket->optimistic_io = option_value.flag;
+        return AVS_OK;
     default:
         LOG(DEBUG,
             _("set_opt_net: unknown or unsupported option key: ")
@@ -0,0 +1,629 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _AVS_NEED_POSIX_SOCKET
+
+#include <avsystem/commons/avs_commons_config.h>
+
+#if defined(AVS_COMMONS_WITH_AVS_NET) \
+        && defined(AVS_COMMONS_NET_WITH_POSIX_AVS_SOCKET)
+
+#    include <avs_commons_posix_init.h>
+
+#    include <errno.h>
+#    include <limits.h>
+#    include <string.h>
+
+#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+#        include <sys/epoll.h>
+#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+
+#    include <avsystem/commons/avs_errno_map.h>
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_net_poller.h>
+
+#    include "avs_compat.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#    if defined(AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL) \
+            || defined(AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL)
+
+#        define AVS_NET_POLLER_REQUESTABLE \
+            (AVS_NET_POLLER_READ | AVS_NET_POLLER_WRITE)
+
+typedef struct {
+    avs_net_socket_t *socket;
+    void *user_data;
+    int events;
+    sockfd_t fd;
+    /* position in the poller's entries array */
+    size_t index;
+    /* set if the socket may hold buffered data, i.e. it has been just added
+     * or reported as readable by the last wait; to_check_index is then its
+     * position in the poller's to_check array */
+    bool check_buffered;
+    size_t to_check_index;
+    /* wait_counter value of the last wait call that reported the entry, and
+     * the index in the output array at which it was reported */
+    unsigned reported_in;
+    size_t reported_at;
+} poller_entry_t;
+
+struct avs_net_poller_struct {
+    /* entries are allocated separately, so that pointers to them remain valid
+     * when the array is reallocated */
+    poller_entry_t **entries;
+    size_t entry_count;
+    size_t capacity;
+    /* open addressing hash table of entries, keyed by the socket pointer, so
+     * that modify and remove do not need to scan the entries; its size is a
+     * power of two, twice the capacity of entries */
+    poller_entry_t **by_socket;
+    /* entries with check_buffered set; has the same capacity as entries */
+    poller_entry_t **to_check;
+    size_t to_check_count;
+    unsigned wait_counter;
+#        ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+    /* -1 if poll() is used instead */
+    int epoll_fd;
+    struct epoll_event *epoll_events;
+    size_t epoll_events_size;
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+#        ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    /* has the same capacity as entries; only used if epoll is not */
+    struct pollfd *pollfds;
+    /* index of the entry to start reporting from, so that sockets at the end
+     * of the array are not starved if there are more ready ones than fit in
+     * the output array */
+    size_t poll_start;
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+};
+
+static avs_error_t failure_from_errno(void) {
+    avs_errno_t err = avs_map_errno(errno);
+    return avs_errno(err ? err : AVS_UNKNOWN_ERROR);
+}
+
+static int timeout_to_ms(avs_time_duration_t timeout) {
+    int64_t timeout_ms;
+    if (avs_time_duration_to_scalar(&timeout_ms, AVS_TIME_MS, timeout)
+            || timeout_ms > INT_MAX) {
+        return -1;
+    }
+    return timeout_ms < 0 ? 0 : (int) timeout_ms;
+}
+
+static bool uses_epoll(const avs_net_poller_t *poller) {
+#        ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+    return poller->epoll_fd >= 0;
+#        else  // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+    (void) poller;
+    return false;
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+}
+
+static size_t socket_hash(const avs_net_socket_t *socket, size_t mask) {
+    // socket objects are aligned, so the lowest bits carry no information
+    return (size_t) (((uintptr_t) socket >> 4) * 2654435761u) & mask;
+}
+
+/* Returns the slot in by_socket that holds the entry for the socket, or the
+ * empty slot at which it shall be inserted. */
+static size_t find_slot(const avs_net_poller_t *poller,
+                        const avs_net_socket_t *socket) {
+    size_t mask = 2 * poller->capacity - 1;
+    size_t slot = socket_hash(socket, mask);
+    while (poller->by_socket[slot]
+           && poller->by_socket[slot]->socket != socket) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static poller_entry_t *find_entry(avs_net_poller_t *poller,
+                                  avs_net_socket_t *socket) {
+    return poller->capacity ? poller->by_socket[find_slot(poller, socket)]
+                            : NULL;
+}
+
+/* Empties the slot, moving back the following entries of the same probe
+ * sequence, so that they can still be found. */
+static void unlink_slot(avs_net_poller_t *poller, size_t slot) {
+    size_t mask = 2 * poller->capacity - 1;
+    poller->by_socket[slot] = NULL;
+    for (size_t next = (slot + 1) & mask; poller->by_socket[next];
+         next = (next + 1) & mask) {
+        poller_entry_t *entry = poller->by_socket[next];
+        size_t home = socket_hash(entry->socket, mask);
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            poller->by_socket[slot] = entry;
+            poller->by_socket[next] = NULL;
+            slot = next;
+        }
+    }
+}
+
+static void mark_to_check(avs_net_poller_t *poller, poller_entry_t *entry) {
+    if (!entry->check_buffered) {
+        entry->check_buffered = true;
+        entry->to_check_index = poller->to_check_count;
+        poller->to_check[poller->to_check_count++] = entry;
+    }
+}
+
+static avs_error_t ensure_capacity(avs_net_poller_t *poller) {
+    if (poller->entry_count < poller->capacity) {
+        return AVS_OK;
+    }
+    size_t new_capacity = poller->capacity ? 2 * poller->capacity : 16;
+    poller_entry_t **entries = (poller_entry_t **) avs_realloc(
+            poller->entries, new_capacity * sizeof(*entries));
+    if (!entries) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    poller->entries = entries;
+    poller_entry_t **to_check = (poller_entry_t **) avs_realloc(
+            poller->to_check, new_capacity * sizeof(*to_check));
+    if (!to_check) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    poller->to_check = to_check;
+#        ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    if (!uses_epoll(poller)) {
+        struct pollfd *pollfds = (struct pollfd *) avs_realloc(
+                poller->pollfds, new_capacity * sizeof(*pollfds));
+        if (!pollfds) {
+            return avs_errno(AVS_ENOMEM);
+        }
+        poller->pollfds = pollfds;
+    }
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    poller_entry_t **by_socket = (poller_entry_t **) avs_calloc(
+            2 * new_capacity, sizeof(*by_socket));
+    if (!by_socket) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    avs_free(poller->by_socket);
+    poller->by_socket = by_socket;
+    poller->capacity = new_capacity;
+    for (size_t i = 0; i < poller->entry_count; ++i) {
+        poller->by_socket[find_slot(poller, poller->entries[i]->socket)] =
+                poller->entries[i];
+    }
+    return AVS_OK;
+}
+
+#        ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+static uint32_t epoll_events_for(int events) {
+    return ((events & AVS_NET_POLLER_READ) ? (uint32_t) EPOLLIN : 0)
+           | ((events & AVS_NET_POLLER_WRITE) ? (uint32_t) EPOLLOUT : 0);
+}
+
+static avs_error_t
+epoll_control(avs_net_poller_t *poller, int op, poller_entry_t *entry) {
+    if (!uses_epoll(poller)) {
+        return AVS_OK;
+    }
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = epoll_events_for(entry->events);
+    event.data.ptr = entry;
+    return epoll_ctl(poller->epoll_fd, op, entry->fd, &event)
+                   ? failure_from_errno()
+                   : AVS_OK;
+}
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+
+static avs_error_t poller_create(avs_net_poller_t **out_poller,
+                                 bool use_epoll) {
+    avs_net_poller_t *poller =
+            (avs_net_poller_t *) avs_calloc(1, sizeof(avs_net_poller_t));
+    if (!poller) {
+        LOG(ERROR, _("out of memory"));
+        return avs_errno(AVS_ENOMEM);
+    }
+#        ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+    poller->epoll_fd = -1;
+    if (use_epoll && (poller->epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+        avs_error_t err = failure_from_errno();
+        LOG(ERROR, _("could not create epoll instance"));
+        avs_free(poller);
+        return err;
+    }
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+#        ifndef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    if (!use_epoll) {
+        LOG(ERROR, _("poll() is not available"));
+        avs_free(poller);
+        return avs_errno(AVS_ENOTSUP);
+    }
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    (void) use_epoll;
+    *out_poller = poller;
+    return AVS_OK;
+}
+
+avs_error_t avs_net_poller_create(avs_net_poller_t **out_poller) {
+#        ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+    return poller_create(out_poller, true);
+#        else  // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+    return poller_create(out_poller, false);
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+}
+
+void avs_net_poller_cleanup(avs_net_poller_t **poller) {
+    if (!poller || !*poller) {
+        return;
+    }
+    for (size_t i = 0; i < (*poller)->entry_count; ++i) {
+        avs_free((*poller)->entries[i]);
+    }
+    avs_free((*poller)->entries);
+    avs_free((*poller)->by_socket);
+    avs_free((*poller)->to_check);
+#        ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+    if (uses_epoll(*poller)) {
+        close((*poller)->epoll_fd);
+    }
+    avs_free((*poller)->epoll_events);
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+#        ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    avs_free((*poller)->pollfds);
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    avs_free(*poller);
+    *poller = NULL;
+}
+
+avs_error_t avs_net_poller_add(avs_net_poller_t *poller,
+                               avs_net_socket_t *socket,
+                               int events,
+                               void *user_data) {
+    if (events & ~AVS_NET_POLLER_REQUESTABLE) {
+        return avs_errno(AVS_EINVAL);
+    }
+    if (find_entry(poller, socket)) {
+        LOG(ERROR, _("socket already registered in the poller"));
+        return avs_errno(AVS_EEXIST);
+    }
+    const sockfd_t *fd_ptr =
+            (const sockfd_t *) avs_net_socket_get_system(socket);
+    if (!fd_ptr || *fd_ptr == INVALID_SOCKET) {
+        LOG(ERROR, _("socket is not open"));
+        return avs_errno(AVS_EBADF);
+    }
+    avs_error_t err = ensure_capacity(poller);
+    if (avs_is_err(err)) {
+        LOG(ERROR, _("out of memory"));
+        return err;
+    }
+    poller_entry_t *entry =
+            (poller_entry_t *) avs_calloc(1, sizeof(poller_entry_t));
+    if (!entry) {
+        LOG(ERROR, _("out of memory"));
+        return avs_errno(AVS_ENOMEM);
+    }
+    entry->socket = socket;
+    entry->user_data = user_data;
+    entry->events = events;
+    entry->fd = *fd_ptr;
+    entry->reported_in = poller->wait_counter - 1;
+#        ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+    if (avs_is_err((err = epoll_control(poller, EPOLL_CTL_ADD, entry)))) {
+        LOG(ERROR, _("could not register socket in epoll"));
+        avs_free(entry);
+        return err;
+    }
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+    entry->index = poller->entry_count;
+    poller->entries[poller->entry_count++] = entry;
+    poller->by_socket[find_slot(poller, socket)] = entry;
+    mark_to_check(poller, entry);
+    return AVS_OK;
+}
+
+avs_error_t avs_net_poller_modify(avs_net_poller_t *poller,
+                                  avs_net_socket_t *socket,
+                                  int events) {
+    if (events & ~AVS_NET_POLLER_REQUESTABLE) {
+        return avs_errno(AVS_EINVAL);
+    }
+    poller_entry_t *entry = find_entry(poller, socket);
+    if (!entry) {
+        return avs_errno(AVS_ENOENT);
+    }
+    int old_events = entry->events;
+    entry->events = events;
+#        ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+    avs_error_t err = epoll_control(poller, EPOLL_CTL_MOD, entry);
+    if (avs_is_err(err)) {
+        entry->events = old_events;
+        return err;
+    }
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+    if ((events & AVS_NET_POLLER_READ) && !(old_events & AVS_NET_POLLER_READ)) {
+        mark_to_check(poller, entry);
+    }
+    return AVS_OK;
+}
+
+avs_error_t avs_net_poller_remove(avs_net_poller_t *poller,
+                                  avs_net_socket_t *socket) {
+    if (!poller->capacity) {
+        return avs_errno(AVS_ENOENT);
+    }
+    size_t slot = find_slot(poller, socket);
+    poller_entry_t *entry = poller->by_socket[slot];
+    if (!entry) {
+        return avs_errno(AVS_ENOENT);
+    }
+#        ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+    if (uses_epoll(poller)) {
+        // the descriptor might have been already closed, which removes it
+        // from the epoll set automatically
+        (void) epoll_ctl(poller->epoll_fd, EPOLL_CTL_DEL, entry->fd, NULL);
+    }
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+    unlink_slot(poller, slot);
+    if (entry->check_buffered) {
+        poller_entry_t *moved = poller->to_check[--poller->to_check_count];
+        poller->to_check[entry->to_check_index] = moved;
+        moved->to_check_index = entry->to_check_index;
+    }
+    poller_entry_t *last = poller->entries[--poller->entry_count];
+    poller->entries[entry->index] = last;
+    last->index = entry->index;
+    avs_free(entry);
+    return AVS_OK;
+}
+
+static void report(avs_net_poller_t *poller,
+                   poller_entry_t *entry,
+                   int events,
+                   avs_net_poller_event_t *out_events,
+                   size_t *inout_count) {
+    if (events & AVS_NET_POLLER_READ) {
+        // the application will now receive some data, which might leave the
+        // rest of a decrypted record buffered
+        mark_to_check(poller, entry);
+    }
+    if (entry->reported_in == poller->wait_counter) {
+        out_events[entry->reported_at].events |= events;
+        return;
+    }
+    entry->reported_in = poller->wait_counter;
+    entry->reported_at = *inout_count;
+    out_events[*inout_count].socket = entry->socket;
+    out_events[*inout_count].user_data = entry->user_data;
+    out_events[*inout_count].events = events;
+    ++*inout_count;
+}
+
+/* Reports sockets that have data waiting in their internal buffers, which the
+ * system is not aware of. */
+static void report_buffered(avs_net_poller_t *poller,
+                            avs_net_poller_event_t *out_events,
+                            size_t max_events,
+                            size_t *inout_count) {
+    // report() puts the readable entries back on the list; each entry is
+    // re-added at most once, at a position that has been already processed
+    size_t count = poller->to_check_count;
+    poller->to_check_count = 0;
+    for (size_t i = 0; i < count; ++i) {
+        poller_entry_t *entry = poller->to_check[i];
+        entry->check_buffered = false;
+        avs_net_socket_opt_value_t value;
+        if (*inout_count >= max_events) {
+            // no room to report it now, check it next time
+            mark_to_check(poller, entry);
+        } else if ((entry->events & AVS_NET_POLLER_READ)
+                   && avs_is_ok(avs_net_socket_get_opt(
+                              entry->socket,
+                              AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA, &value))
+                   && value.flag) {
+            report(poller, entry, AVS_NET_POLLER_READ, out_events,
+                   inout_count);
+        }
+    }
+}
+
+#        ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+static int events_from_epoll(uint32_t events) {
+    return ((events & EPOLLIN) ? AVS_NET_POLLER_READ : 0)
+           | ((events & EPOLLOUT) ? AVS_NET_POLLER_WRITE : 0)
+           | ((events & (EPOLLERR | EPOLLHUP)) ? AVS_NET_POLLER_ERROR : 0);
+}
+
+static avs_error_t epoll_wait_events(avs_net_poller_t *poller,
+                                     int timeout_ms,
+                                     avs_net_poller_event_t *out_events,
+                                     size_t max_events,
+                                     size_t *inout_count) {
+    size_t space = AVS_MIN(max_events - *inout_count, (size_t) INT_MAX);
+    if (poller->epoll_events_size < space) {
+        struct epoll_event *epoll_events = (struct epoll_event *) avs_realloc(
+                poller->epoll_events, space * sizeof(*epoll_events));
+        if (!epoll_events) {
+            return avs_errno(AVS_ENOMEM);
+        }
+        poller->epoll_events = epoll_events;
+        poller->epoll_events_size = space;
+    }
+    int result =
+            epoll_wait(poller->epoll_fd, poller->epoll_events, (int) space,
+                       timeout_ms);
+    if (result < 0) {
+        return failure_from_errno();
+    }
+    for (int i = 0; i < result; ++i) {
+        report(poller, (poller_entry_t *) poller->epoll_events[i].data.ptr,
+               events_from_epoll(poller->epoll_events[i].events), out_events,
+               inout_count);
+    }
+    return AVS_OK;
+}
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+
+#        ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+static int events_from_poll(short events) {
+    return ((events & POLLIN) ? AVS_NET_POLLER_READ : 0)
+           | ((events & POLLOUT) ? AVS_NET_POLLER_WRITE : 0)
+           | ((events & (POLLERR | POLLHUP | POLLNVAL)) ? AVS_NET_POLLER_ERROR
+                                                       : 0);
+}
+
+static avs_error_t poll_wait_events(avs_net_poller_t *poller,
+                                    int timeout_ms,
+                                    avs_net_poller_event_t *out_events,
+                                    size_t max_events,
+                                    size_t *inout_count) {
+    for (size_t i = 0; i < poller->entry_count; ++i) {
+        const poller_entry_t *entry = poller->entries[i];
+        poller->pollfds[i].fd = entry->fd;
+        poller->pollfds[i].events =
+                (short) (((entry->events & AVS_NET_POLLER_READ) ? POLLIN : 0)
+                         | ((entry->events & AVS_NET_POLLER_WRITE) ? POLLOUT
+                                                                   : 0));
+        poller->pollfds[i].revents = 0;
+    }
+    if (poll(poller->pollfds, (nfds_t) poller->entry_count, timeout_ms) < 0) {
+        return failure_from_errno();
+    }
+    size_t count = poller->entry_count;
+    size_t start = count ? poller->poll_start % count : 0;
+    for (size_t i = 0; i < count && *inout_count < max_events; ++i) {
+        size_t index = (start + i) % count;
+        if (poller->pollfds[index].revents) {
+            report(poller, poller->entries[index],
+                   events_from_poll(poller->pollfds[index].revents),
+                   out_events, inout_count);
+            poller->poll_start = index + 1;
+        }
+    }
+    return AVS_OK;
+}
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+
+static avs_error_t system_wait(avs_net_poller_t *poller,
+                               int timeout_ms,
+                               avs_net_poller_event_t *out_events,
+                               size_t max_events,
+                               size_t *inout_count) {
+#        ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+    if (uses_epoll(poller)) {
+        return epoll_wait_events(poller, timeout_ms, out_events, max_events,
+                                 inout_count);
+    }
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL
+#        ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    return poll_wait_events(poller, timeout_ms, out_events, max_events,
+                            inout_count);
+#        else  // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    AVS_UNREACHABLE("poller without epoll requires poll()");
+    return avs_errno(AVS_ENOTSUP);
+#        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+}
+
+avs_error_t avs_net_poller_wait(avs_net_poller_t *poller,
+                                avs_time_duration_t timeout,
+                                avs_net_poller_event_t *out_events,
+                                size_t max_events,
+                                size_t *out_event_count) {
+    *out_event_count = 0;
+    if (!max_events) {
+        return avs_errno(AVS_EINVAL);
+    }
+    avs_time_monotonic_t deadline =
+            avs_time_monotonic_add(avs_time_monotonic_now(), timeout);
+    ++poller->wait_counter;
+    report_buffered(poller, out_events, max_events, out_event_count);
+    avs_error_t err = AVS_OK;
+    if (*out_event_count < max_events) {
+        do {
+            int timeout_ms =
+                    *out_event_count
+                            ? 0
+                            : timeout_to_ms(avs_time_monotonic_diff(
+                                      deadline, avs_time_monotonic_now()));
+            err = system_wait(poller, timeout_ms, out_events, max_events,
+                              out_event_count);
+        } while (err.category == AVS_ERRNO_CATEGORY && err.code == AVS_EINTR);
+    }
+    return err;
+}
+
+#        ifdef AVS_UNIT_TESTING
+#            include "tests/net/poller.c"
+#        endif // AVS_UNIT_TESTING
+
+#    else // defined(AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL) ||
+          // defined(AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL)
+
+avs_error_t avs_net_poller_create(avs_net_poller_t **out_poller) {
+    (void) out_poller;
+    LOG(ERROR, _("poller requires either epoll or poll()"));
+    return avs_errno(AVS_ENOTSUP);
+}
+
+void avs_net_poller_cleanup(avs_net_poller_t **poller) {
+    (void) poller;
+}
+
+avs_error_t avs_net_poller_add(avs_net_poller_t *poller,
+                               avs_net_socket_t *socket,
+                               int events,
+                               void *user_data) {
+    (void) poller;
+    (void) socket;
+    (void) events;
+    (void) user_data;
+    return avs_errno(AVS_ENOTSUP);
+}
+
+avs_error_t avs_net_poller_modify(avs_net_poller_t *poller,
+                                  avs_net_socket_t *socket,
+                                  int events) {
+    (void) poller;
+    (void) socket;
+    (void) events;
+    return avs_errno(AVS_ENOTSUP);
+}
+
+avs_error_t avs_net_poller_remove(avs_net_poller_t *poller,
+                                  avs_net_socket_t *socket) {
+    (void) poller;
+    (void) socket;
+    return avs_errno(AVS_ENOTSUP);
+}
+
+avs_error_t avs_net_poller_wait(avs_net_poller_t *poller,
+                                avs_time_duration_t timeout,
+                                avs_net_poller_event_t *out_events,
+                                size_t max_events,
+                                size_t *out_event_count) {
+    (void) poller;
+    (void) timeout;
+    (void) out_events;
+    (void) max_events;
+    *out_event_count = 0;
+    return avs_errno(AVS_ENOTSUP);
+}
+
+#    endif // defined(AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_EPOLL) ||
+           // defined(AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL)
+
+#endif // defined(AVS_COMMONS_WITH_AVS_NET) &&
+       // defined(AVS_COMMONS_NET_WITH_POSIX_AVS_SOCKET)
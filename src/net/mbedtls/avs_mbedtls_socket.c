@@ -163,6 +163,10 @@ static mbedtls_ssl_context *get_context(ssl_socket_t *socket) {
     return &socket->context;
 }
 
+static bool has_buffered_data(ssl_socket_t *socket) {
+    return mbedtls_ssl_get_bytes_avail(get_context(socket)) > 0;
+}
+
 #    ifdef AVS_COMMONS_NET_WITH_MBEDTLS_LOGS
 static void debug_mbedtls(
         void *ctx, int level, const char *file, int line, const char *str) {
@@ -989,6 +989,10 @@ static bool is_session_resumed(ssl_socket_t *socket) {
     return false;
 }
 
+static bool has_buffered_data(ssl_socket_t *socket) {
+    return SSL_pending(socket->ssl) > 0;
+}
+
 #    ifdef AVS_COMMONS_WITH_AVS_CRYPTO_PKI
 typedef struct {
     SSL_CTX *ctx;
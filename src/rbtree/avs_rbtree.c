@@ -23,6 +23,9 @@
 
 #    include <assert.h>
 
+#    define MODULE_NAME avs_rbtree
+#    include <avs_x_log_config.h>
+
 VISIBILITY_SOURCE_BEGIN
 
 enum rb_color { DETACHED = 0x50DD, RED = 0x50DE, BLACK = 0x50DF };
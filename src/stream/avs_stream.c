@@ -31,6 +31,8 @@
 #    include <avsystem/commons/avs_stream.h>
 #    include <avsystem/commons/avs_stream_v_table.h>
 
+#    include "avs_stream_fd_transfer.h"
+
 #    define MODULE_NAME avs_stream
 #    include <avs_x_log_config.h>
 
@@ -42,6 +44,10 @@ struct avs_stream_struct {
     const avs_stream_v_table_t *const vtable;
 };
 
+static bool is_enotsup(avs_error_t err) {
+    return err.category == AVS_ERRNO_CATEGORY && err.code == AVS_ENOTSUP;
+}
+
 avs_error_t avs_stream_write_some(avs_stream_t *stream,
                                   const void *buffer,
                                   size_t *inout_data_length) {
@@ -62,6 +68,32 @@ avs_error_t avs_stream_write(avs_stream_t *stream,
     return err;
 }
 
+static const avs_stream_v_table_extension_vectored_t *
+get_vectored(avs_stream_t *stream) {
+    return (const avs_stream_v_table_extension_vectored_t *)
+            avs_stream_v_table_find_extension(
+                    stream, AVS_STREAM_V_TABLE_EXTENSION_VECTORED);
+}
+
+avs_error_t avs_stream_writev(avs_stream_t *stream,
+                              const avs_stream_const_iovec_t *iov,
+                              size_t iov_count) {
+    const avs_stream_v_table_extension_vectored_t *ext = get_vectored(stream);
+    if (ext && ext->writev) {
+        return ext->writev(stream, iov, iov_count);
+    }
+    for (size_t i = 0; i < iov_count; ++i) {
+        if (iov[i].size) {
+            avs_error_t err =
+                    avs_stream_write(stream, iov[i].data, iov[i].size);
+            if (avs_is_err(err)) {
+                return err;
+            }
+        }
+    }
+    return AVS_OK;
+}
+
 avs_error_t avs_stream_finish_message(avs_stream_t *stream) {
     if (!stream->vtable->finish_message) {
         return avs_errno(AVS_ENOTSUP);
@@ -81,6 +113,117 @@ avs_error_t avs_stream_read(avs_stream_t *stream,
                                 buffer, buffer_length);
 }
 
+avs_error_t avs_stream_readv(avs_stream_t *stream,
+                             size_t *out_bytes_read,
+                             bool *out_message_finished,
+                             const avs_stream_iovec_t *iov,
+                             size_t iov_count) {
+    size_t bytes_read = 0;
+    bool message_finished = false;
+    avs_error_t err = AVS_OK;
+    const avs_stream_v_table_extension_vectored_t *ext = get_vectored(stream);
+    if (ext && ext->readv) {
+        err = ext->readv(stream, &bytes_read, &message_finished, iov,
+                         iov_count);
+    } else {
+        for (size_t i = 0; i < iov_count && !message_finished; ++i) {
+            if (!iov[i].size) {
+                continue;
+            }
+            size_t current_read = 0;
+            err = avs_stream_read(stream, &current_read, &message_finished,
+                                  iov[i].data, iov[i].size);
+            bytes_read += current_read;
+            if (avs_is_err(err) || current_read < iov[i].size) {
+                break;
+            }
+        }
+    }
+    if (out_bytes_read) {
+        *out_bytes_read = bytes_read;
+    }
+    if (out_message_finished) {
+        *out_message_finished = message_finished;
+    }
+    return err;
+}
+
+avs_error_t avs_stream_read_slice(avs_stream_t *stream,
+                                  avs_refbuf_slice_t *out_slice,
+                                  bool *out_message_finished,
+                                  size_t max_length) {
+    *out_slice = (avs_refbuf_slice_t) AVS_REFBUF_SLICE_EMPTY;
+    const avs_stream_v_table_extension_slice_t *ext =
+            (const avs_stream_v_table_extension_slice_t *)
+                    avs_stream_v_table_find_extension(
+                            stream, AVS_STREAM_V_TABLE_EXTENSION_SLICE);
+    if (ext) {
+        return ext->read_slice(stream, out_slice, out_message_finished,
+                               max_length);
+    }
+
+    avs_refbuf_t *buf = avs_refbuf_new(max_length);
+    if (!buf) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    size_t bytes_read;
+    avs_error_t err = avs_stream_read(stream, &bytes_read, out_message_finished,
+                                      avs_refbuf_data(buf), max_length);
+    if (avs_is_ok(err) && bytes_read) {
+        avs_refbuf_slice(out_slice, buf, 0, bytes_read);
+    }
+    avs_refbuf_unref(&buf);
+    return err;
+}
+
+static const avs_stream_v_table_extension_zerocopy_t *
+get_zerocopy(avs_stream_t *stream) {
+    return (const avs_stream_v_table_extension_zerocopy_t *)
+            avs_stream_v_table_find_extension(
+                    stream, AVS_STREAM_V_TABLE_EXTENSION_ZEROCOPY);
+}
+
+avs_error_t avs_stream_peek_contiguous(avs_stream_t *stream,
+                                       const void **out_data,
+                                       size_t *out_size,
+                                       bool *out_message_finished) {
+    const avs_stream_v_table_extension_zerocopy_t *ext = get_zerocopy(stream);
+    if (!ext || !ext->peek_contiguous) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    bool message_finished;
+    return ext->peek_contiguous(stream, out_data, out_size,
+                                out_message_finished ? out_message_finished
+                                                     : &message_finished);
+}
+
+avs_error_t avs_stream_consume(avs_stream_t *stream, size_t size) {
+    const avs_stream_v_table_extension_zerocopy_t *ext = get_zerocopy(stream);
+    if (!ext || !ext->consume) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    return ext->consume(stream, size);
+}
+
+avs_error_t avs_stream_reserve(avs_stream_t *stream,
+                               size_t size_hint,
+                               void **out_data,
+                               size_t *out_size) {
+    const avs_stream_v_table_extension_zerocopy_t *ext = get_zerocopy(stream);
+    if (!ext || !ext->reserve) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    return ext->reserve(stream, size_hint, out_data, out_size);
+}
+
+avs_error_t avs_stream_commit(avs_stream_t *stream, size_t size) {
+    const avs_stream_v_table_extension_zerocopy_t *ext = get_zerocopy(stream);
+    if (!ext || !ext->commit) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    return ext->commit(stream, size);
+}
+
 avs_error_t
 avs_stream_peek(avs_stream_t *stream, size_t offset, char *out_value) {
     if (!stream->vtable->peek) {
@@ -132,6 +275,49 @@ static avs_error_t try_write_fv(avs_stream_t *stream,
     return avs_stream_write(stream, buf, (size_t) retval);
 }
 
+#    ifndef va_copy
+#        define va_copy(dest, src) ((dest) = (src))
+#    endif
+
+/* Formats the data straight into the space reserved in the stream's internal
+ * buffer. Returns AVS_ENOBUFS without writing anything if the stream does not
+ * support that or cannot provide enough contiguous space. */
+static avs_error_t
+try_reserved_write_fv(avs_stream_t *stream, const char *msg, va_list args) {
+    const avs_stream_v_table_extension_zerocopy_t *ext = get_zerocopy(stream);
+    if (!ext || !ext->reserve || !ext->commit) {
+        return avs_errno(AVS_ENOBUFS);
+    }
+    // first guess: the formatted string is usually not much longer than the
+    // format itself; the reserved space is often larger anyway
+    size_t size_hint = strlen(msg) + 1;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        void *space;
+        size_t space_size;
+        avs_error_t err =
+                avs_stream_reserve(stream, size_hint, &space, &space_size);
+        if (avs_is_err(err)) {
+            return is_enotsup(err) ? avs_errno(AVS_ENOBUFS) : err;
+        }
+        if (!space_size) {
+            break;
+        }
+        va_list copy;
+        va_copy(copy, args);
+        int retval = vsnprintf((char *) space, space_size, msg, copy);
+        va_end(copy);
+        if (retval < 0) {
+            return avs_errno(AVS_EIO);
+        }
+        if ((size_t) retval < space_size) {
+            return avs_stream_commit(stream, (size_t) retval);
+        }
+        // truncated - ask for exactly as much space as needed
+        size_hint = (size_t) retval + 1;
+    }
+    return avs_errno(AVS_ENOBUFS);
+}
+
 static avs_error_t try_stack_write_fv(avs_stream_t *stream,
                                       const char *msg,
                                       va_list args,
@@ -154,10 +340,6 @@ static avs_error_t try_heap_write_fv(avs_stream_t *stream,
     return err;
 }
 
-#    ifndef va_copy
-#        define va_copy(dest, src) ((dest) = (src))
-#    endif
-
 avs_error_t
 avs_stream_write_fv(avs_stream_t *stream, const char *msg, va_list args) {
     avs_error_t err;
@@ -165,6 +347,12 @@ avs_stream_write_fv(avs_stream_t *stream, const char *msg, va_list args) {
     size_t buffer_size;
     va_list copy;
     va_copy(copy, args);
+    err = try_reserved_write_fv(stream, msg, copy);
+    va_end(copy);
+    if (err.category != AVS_ERRNO_CATEGORY || err.code != AVS_ENOBUFS) {
+        return err;
+    }
+    va_copy(copy, args);
     err = try_stack_write_fv(stream, msg, copy, &buffer_size);
     va_end(copy);
     while (err.category == AVS_ERRNO_CATEGORY && err.code == AVS_ENOBUFS
@@ -269,13 +457,14 @@ static avs_error_t consume_line_terminator(getline_provider_t *provider,
     return err;
 }
 
+/* Continues reading a line, of which *out_bytes_read characters may have
+ * already been stored in buffer. */
 static avs_error_t getline_helper(getline_provider_t *provider,
                                   size_t *out_bytes_read,
                                   bool *out_message_finished,
                                   char *buffer,
                                   size_t buffer_length) {
-    *out_bytes_read = 0;
-    assert(buffer_length > 0);
+    assert(*out_bytes_read < buffer_length);
     char tmp_char = '\0';
     char next_char;
     avs_error_t err = AVS_OK;
@@ -306,6 +495,70 @@ static avs_error_t getline_helper(getline_provider_t *provider,
     return err;
 }
 
+static const char *find_first_of_line_special(const char *data, size_t size) {
+    const char *result = (const char *) memchr(data, '\n', size);
+    const char *ptr;
+    if (result) {
+        size = (size_t) (result - data);
+    }
+    if ((ptr = (const char *) memchr(data, '\r', size))) {
+        size = (size_t) ((result = ptr) - data);
+    }
+    if ((ptr = (const char *) memchr(data, '\0', size))) {
+        result = ptr;
+    }
+    return result;
+}
+
+/* Fast path for getline_helper() - scans a block of data that the stream
+ * exposes through avs_stream_peek_contiguous(), copying up to space characters
+ * of the line into buffer.
+ *
+ * Returns true if the whole line, including its terminator, has been found.
+ * Otherwise, scanning stopped at a point that needs the per-character logic
+ * of getline_helper(), e.g. at the end of the block or at a '\0' character.
+ * In both cases, *out_scanned is set to the number of bytes of data that have
+ * been processed, and *out_copied to the number of bytes stored in buffer. */
+static bool getline_scan_block(const char *data,
+                               size_t size,
+                               char *buffer,
+                               size_t space,
+                               size_t *out_scanned,
+                               size_t *out_copied) {
+    size_t scanned = 0;
+    size_t copied = 0;
+    bool line_finished = false;
+    while (!line_finished && scanned < size && copied < space) {
+        size_t max_length = AVS_MIN(size - scanned, space - copied);
+        const char *special =
+                find_first_of_line_special(data + scanned, max_length);
+        size_t length =
+                special ? (size_t) (special - data) - scanned : max_length;
+        memcpy(buffer + copied, data + scanned, length);
+        copied += length;
+        scanned += length;
+        if (!special || *special == '\0') {
+            break;
+        } else if (*special == '\n') {
+            ++scanned;
+            line_finished = true;
+        } else if (scanned + 1 >= size) {
+            // '\r' at the end of the block, can't tell what follows
+            break;
+        } else if (data[scanned + 1] == '\n') {
+            scanned += 2;
+            line_finished = true;
+        } else {
+            // '\r' that is not followed by '\n' is a part of the line
+            buffer[copied++] = '\r';
+            ++scanned;
+        }
+    }
+    *out_scanned = scanned;
+    *out_copied = copied;
+    return line_finished;
+}
+
 typedef struct {
     getline_provider_t vtable;
     avs_stream_t *stream;
@@ -327,6 +580,47 @@ static avs_error_t getline_reader_peek_func(getline_provider_t *self_,
     return avs_stream_peek(self->stream, offset, out_value);
 }
 
+/* Reads the line straight from the stream's internal buffer, as long as it is
+ * possible. *out_line_finished is set to true if the whole line has been
+ * read. */
+static avs_error_t getline_contiguous(avs_stream_t *stream,
+                                      size_t *inout_bytes_read,
+                                      bool *out_message_finished,
+                                      char *buffer,
+                                      size_t buffer_length,
+                                      bool *out_line_finished) {
+    *out_line_finished = false;
+    while (*inout_bytes_read < buffer_length - 1) {
+        const void *data;
+        size_t size;
+        bool message_finished;
+        avs_error_t err = avs_stream_peek_contiguous(stream, &data, &size,
+                                                     &message_finished);
+        if (avs_is_err(err)) {
+            return is_enotsup(err) ? AVS_OK : err;
+        } else if (!size) {
+            // end of message - retrying through getch() would block or fail
+            *out_message_finished = message_finished;
+            return AVS_EOF;
+        }
+        size_t scanned;
+        size_t copied;
+        bool line_finished = getline_scan_block(
+                (const char *) data, size, buffer + *inout_bytes_read,
+                buffer_length - 1 - *inout_bytes_read, &scanned, &copied);
+        if (avs_is_err(avs_stream_consume(stream, scanned))) {
+            AVS_UNREACHABLE("consume failed for data returned by peek");
+        }
+        *inout_bytes_read += copied;
+        *out_message_finished = message_finished && scanned == size;
+        if (line_finished || scanned < size) {
+            *out_line_finished = line_finished;
+            return AVS_OK;
+        }
+    }
+    return AVS_OK;
+}
+
 avs_error_t avs_stream_getline(avs_stream_t *stream,
                                size_t *out_bytes_read,
                                bool *out_message_finished,
@@ -335,8 +629,24 @@ avs_error_t avs_stream_getline(avs_stream_t *stream,
     if (buffer_length == 0 || !buffer) {
         return avs_errno(AVS_EINVAL);
     }
-    size_t bytes_read;
-    bool message_finished;
+    size_t bytes_read = 0;
+    bool message_finished = false;
+    if (!out_bytes_read) {
+        out_bytes_read = &bytes_read;
+    }
+    if (!out_message_finished) {
+        out_message_finished = &message_finished;
+    }
+    *out_bytes_read = 0;
+    *out_message_finished = false;
+    bool line_finished;
+    avs_error_t err =
+            getline_contiguous(stream, out_bytes_read, out_message_finished,
+                               buffer, buffer_length, &line_finished);
+    if (avs_is_err(err) || line_finished) {
+        buffer[*out_bytes_read] = '\0';
+        return err;
+    }
     getline_reader_provider_t provider = {
         .vtable = {
             .getch = getline_reader_getch_func,
@@ -344,10 +654,8 @@ avs_error_t avs_stream_getline(avs_stream_t *stream,
         },
         .stream = stream
     };
-    return getline_helper(
-            &provider.vtable, out_bytes_read ? out_bytes_read : &bytes_read,
-            out_message_finished ? out_message_finished : &message_finished,
-            buffer, buffer_length);
+    return getline_helper(&provider.vtable, out_bytes_read,
+                          out_message_finished, buffer, buffer_length);
 }
 
 typedef struct {
@@ -388,6 +696,10 @@ avs_error_t avs_stream_peekline(avs_stream_t *stream,
         return avs_errno(AVS_EINVAL);
     }
     size_t bytes_peeked;
+    if (!out_bytes_peeked) {
+        out_bytes_peeked = &bytes_peeked;
+    }
+    *out_bytes_peeked = 0;
     getline_peeker_provider_t provider = {
         .vtable = {
             .getch = getline_peeker_getch_func,
@@ -396,38 +708,268 @@ avs_error_t avs_stream_peekline(avs_stream_t *stream,
         .stream = stream,
         .offset = offset
     };
-    avs_error_t err =
-            getline_helper(&provider.vtable,
-                           out_bytes_peeked ? out_bytes_peeked : &bytes_peeked,
-                           &(bool) { false }, buffer, buffer_length);
+
+    const void *data;
+    size_t size;
+    avs_error_t err = avs_stream_peek_contiguous(stream, &data, &size, NULL);
+    if (avs_is_ok(err) && !size) {
+        err = AVS_EOF;
+    }
+    if (avs_is_err(err) && !is_enotsup(err)) {
+        buffer[0] = '\0';
+        if (out_next_offset) {
+            *out_next_offset = offset;
+        }
+        return err;
+    }
+    if (avs_is_ok(err) && offset < size) {
+        // only the data that is already buffered can be peeked at this way
+        size_t scanned;
+        if (getline_scan_block((const char *) data + offset, size - offset,
+                               buffer, buffer_length - 1, &scanned,
+                               out_bytes_peeked)) {
+            buffer[*out_bytes_peeked] = '\0';
+            if (out_next_offset) {
+                *out_next_offset = offset + scanned;
+            }
+            return AVS_OK;
+        }
+        provider.offset += scanned;
+    }
+    err = getline_helper(&provider.vtable, out_bytes_peeked, &(bool) { false },
+                         buffer, buffer_length);
     if (out_next_offset) {
         *out_next_offset = provider.offset;
     }
     return err;
 }
 
-avs_error_t avs_stream_copy(avs_stream_t *output_stream,
-                            avs_stream_t *input_stream) {
-    char buf[AVS_STREAM_STACK_BUFFER_SIZE];
-    size_t bytes_read;
+/* Writes data to output_stream, filling its internal buffer directly if
+ * possible. */
+static avs_error_t
+copy_block(avs_stream_t *output_stream, const void *data, size_t size) {
+    while (size) {
+        void *space;
+        size_t space_size;
+        avs_error_t err =
+                avs_stream_reserve(output_stream, size, &space, &space_size);
+        if (avs_is_err(err) || !space_size) {
+            return is_enotsup(err) || avs_is_ok(err)
+                           ? avs_stream_write(output_stream, data, size)
+                           : err;
+        }
+        space_size = AVS_MIN(space_size, size);
+        memcpy(space, data, space_size);
+        if (avs_is_err((err = avs_stream_commit(output_stream, space_size)))) {
+            return err;
+        }
+        data = (const char *) data + space_size;
+        size -= space_size;
+    }
+    return AVS_OK;
+}
+
+/* Copies the data straight out of input_stream's internal buffer. Returns
+ * AVS_ENOTSUP without doing anything if that is not supported. */
+static avs_error_t copy_from_contiguous(avs_stream_t *output_stream,
+                                        avs_stream_t *input_stream,
+                                        size_t *inout_copied) {
     bool message_finished = false;
     while (!message_finished) {
+        const void *data;
+        size_t size;
         avs_error_t err;
+        if (avs_is_err((err = avs_stream_peek_contiguous(
+                                input_stream, &data, &size,
+                                &message_finished)))
+                || (size
+                    && (avs_is_err((err = copy_block(output_stream, data,
+                                                     size)))
+                        || avs_is_err((err = avs_stream_consume(input_stream,
+                                                                size)))))) {
+            return err;
+        }
+        if (!size && !message_finished) {
+            return avs_errno(AVS_EINVAL);
+        }
+        *inout_copied += size;
+    }
+    return AVS_OK;
+}
+
+/* Reads the data straight into output_stream's internal buffer. Returns
+ * AVS_ENOTSUP without doing anything if that is not supported. */
+static avs_error_t copy_to_reserved(avs_stream_t *output_stream,
+                                    avs_stream_t *input_stream,
+                                    size_t size_hint,
+                                    size_t *inout_copied) {
+    bool message_finished = false;
+    while (!message_finished) {
+        void *space;
+        size_t space_size;
+        size_t bytes_read;
+        avs_error_t err;
+        if (avs_is_err((err = avs_stream_reserve(output_stream, size_hint,
+                                                 &space, &space_size)))) {
+            return err;
+        }
+        if (!space_size) {
+            return avs_errno(AVS_EMSGSIZE);
+        }
         if (avs_is_err((err = avs_stream_read(input_stream, &bytes_read,
-                                              &message_finished, buf,
-                                              sizeof(buf))))
+                                              &message_finished, space,
+                                              space_size)))
                 || (bytes_read
-                    && avs_is_err((err = avs_stream_write(output_stream, buf,
-                                                          bytes_read))))) {
+                    && avs_is_err((err = avs_stream_commit(output_stream,
+                                                           bytes_read))))) {
             return err;
         }
         if (!bytes_read && !message_finished) {
             return avs_errno(AVS_EINVAL);
         }
+        *inout_copied += bytes_read;
     }
     return AVS_OK;
 }
 
+#    ifdef AVS_COMMONS_STREAM_WITH_SENDFILE
+static const avs_stream_v_table_extension_fd_t *get_fd(avs_stream_t *stream) {
+    return (const avs_stream_v_table_extension_fd_t *)
+            avs_stream_v_table_find_extension(stream,
+                                              AVS_STREAM_V_TABLE_EXTENSION_FD);
+}
+
+/* Transfers the data between the file descriptors that back both streams,
+ * without passing it through user space. Returns AVS_ENOTSUP if that is not
+ * possible, possibly after some data has already been copied. */
+static avs_error_t copy_through_fds(avs_stream_t *output_stream,
+                                    avs_stream_t *input_stream,
+                                    size_t *inout_copied) {
+    const avs_stream_v_table_extension_fd_t *output_ext =
+            get_fd(output_stream);
+    const avs_stream_v_table_extension_fd_t *input_ext = get_fd(input_stream);
+    if (!output_ext || !input_ext) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    while (true) {
+        int output_fd;
+        int input_fd;
+        avs_off_t output_offset;
+        avs_off_t input_offset;
+        size_t transferred;
+        avs_error_t err;
+        if (avs_is_err((err = output_ext->get_fd(output_stream, true,
+                                                 &output_fd, &output_offset)))
+                || avs_is_err((err = input_ext->get_fd(input_stream, false,
+                                                       &input_fd,
+                                                       &input_offset)))
+                || avs_is_err((err = _avs_stream_fd_transfer(
+                                       output_fd, output_offset, input_fd,
+                                       input_offset, SIZE_MAX, &transferred)))
+                || !transferred
+                || avs_is_err((err = input_ext->advance(input_stream, false,
+                                                        transferred)))
+                || avs_is_err((err = output_ext->advance(output_stream, true,
+                                                         transferred)))) {
+            return err;
+        }
+        *inout_copied += transferred;
+    }
+}
+#    endif // AVS_COMMONS_STREAM_WITH_SENDFILE
+
+/* Initial size of the buffer allocated by avs_stream_copy_buffer(); it grows
+ * up to the requested size if the reads keep filling it completely. */
+#    define COPY_HEAP_BUFFER_INITIAL_SIZE 4096
+
+static avs_error_t copy_through_buffer(avs_stream_t *output_stream,
+                                       avs_stream_t *input_stream,
+                                       char *buffer,
+                                       size_t max_size,
+                                       size_t *inout_copied) {
+    char *allocated = NULL;
+    size_t buffer_size = max_size;
+    if (!buffer) {
+        buffer_size = AVS_MIN(max_size, COPY_HEAP_BUFFER_INITIAL_SIZE);
+        if (!(buffer = allocated = (char *) avs_malloc(buffer_size))) {
+            LOG(ERROR, _("out of memory"));
+            return avs_errno(AVS_ENOMEM);
+        }
+    }
+    avs_error_t err = AVS_OK;
+    size_t bytes_read;
+    bool message_finished = false;
+    while (!message_finished) {
+        if (avs_is_err((err = avs_stream_read(input_stream, &bytes_read,
+                                              &message_finished, buffer,
+                                              buffer_size)))
+                || (bytes_read
+                    && avs_is_err((err = avs_stream_write(output_stream, buffer,
+                                                          bytes_read))))) {
+            break;
+        }
+        if (!bytes_read && !message_finished) {
+            err = avs_errno(AVS_EINVAL);
+            break;
+        }
+        *inout_copied += bytes_read;
+        if (allocated && bytes_read == buffer_size && buffer_size < max_size) {
+            // the input delivers more data per call than we can take, so
+            // grow the buffer; on failure, just keep using the current one
+            size_t new_size = buffer_size <= max_size / 2 ? 2 * buffer_size
+                                                          : max_size;
+            char *new_buffer = (char *) avs_realloc(allocated, new_size);
+            if (new_buffer) {
+                buffer = allocated = new_buffer;
+                buffer_size = new_size;
+            }
+        }
+    }
+    avs_free(allocated);
+    return err;
+}
+
+avs_error_t avs_stream_copy_buffer(avs_stream_t *output_stream,
+                                   avs_stream_t *input_stream,
+                                   void *buffer,
+                                   size_t buffer_size,
+                                   size_t *out_bytes_copied) {
+    size_t copied = 0;
+    if (!buffer_size) {
+        return avs_errno(AVS_EINVAL);
+    }
+    avs_error_t err = avs_errno(AVS_ENOTSUP);
+#    ifdef AVS_COMMONS_STREAM_WITH_SENDFILE
+    err = copy_through_fds(output_stream, input_stream, &copied);
+#    endif // AVS_COMMONS_STREAM_WITH_SENDFILE
+    const avs_stream_v_table_extension_zerocopy_t *input_ext =
+            get_zerocopy(input_stream);
+    if (is_enotsup(err) && input_ext && input_ext->peek_contiguous) {
+        err = copy_from_contiguous(output_stream, input_stream, &copied);
+    }
+    const avs_stream_v_table_extension_zerocopy_t *output_ext =
+            get_zerocopy(output_stream);
+    if (is_enotsup(err) && output_ext && output_ext->reserve) {
+        err = copy_to_reserved(output_stream, input_stream, buffer_size,
+                               &copied);
+    }
+    if (is_enotsup(err)) {
+        err = copy_through_buffer(output_stream, input_stream, (char *) buffer,
+                                  buffer_size, &copied);
+    }
+    if (out_bytes_copied) {
+        *out_bytes_copied = copied;
+    }
+    return err;
+}
+
+avs_error_t avs_stream_copy(avs_stream_t *output_stream,
+                            avs_stream_t *input_stream) {
+    char buf[AVS_STREAM_STACK_BUFFER_SIZE];
+    return avs_stream_copy_buffer(output_stream, input_stream, buf,
+                                  sizeof(buf), NULL);
+}
+
 const void *avs_stream_v_table_find_extension(avs_stream_t *stream,
                                               uint32_t id) {
     const avs_stream_v_table_extension_t *ext;
@@ -466,6 +1008,78 @@ size_t avs_stream_nonblock_write_ready(avs_stream_t *stream) {
     }
 }
 
+static const avs_stream_v_table_extension_nonblock_io_t *
+get_nonblock_io(avs_stream_t *stream) {
+    return (const avs_stream_v_table_extension_nonblock_io_t *)
+            avs_stream_v_table_find_extension(
+                    stream, AVS_STREAM_V_TABLE_EXTENSION_NONBLOCK_IO);
+}
+
+static bool has_nonblock(avs_stream_t *stream) {
+    return avs_stream_v_table_find_extension(
+                   stream, AVS_STREAM_V_TABLE_EXTENSION_NONBLOCK)
+           != NULL;
+}
+
+avs_error_t avs_stream_read_nonblock(avs_stream_t *stream,
+                                     size_t *out_bytes_read,
+                                     bool *out_message_finished,
+                                     void *buffer,
+                                     size_t buffer_length) {
+    size_t bytes_read = 0;
+    bool message_finished = false;
+    avs_error_t err;
+    const avs_stream_v_table_extension_nonblock_io_t *ext =
+            get_nonblock_io(stream);
+    if (ext && ext->read) {
+        err = ext->read(stream, &bytes_read, &message_finished, buffer,
+                        buffer_length);
+    } else if (!has_nonblock(stream)) {
+        err = avs_errno(AVS_ENOTSUP);
+    } else if (!avs_stream_nonblock_read_ready(stream)) {
+        err = avs_errno(AVS_EAGAIN);
+    } else {
+        err = avs_stream_read(stream, &bytes_read, &message_finished, buffer,
+                              buffer_length);
+    }
+    if (out_bytes_read) {
+        *out_bytes_read = bytes_read;
+    }
+    if (out_message_finished) {
+        *out_message_finished = message_finished;
+    }
+    return err;
+}
+
+avs_error_t avs_stream_write_some_nonblock(avs_stream_t *stream,
+                                           const void *buffer,
+                                           size_t *inout_data_length) {
+    const avs_stream_v_table_extension_nonblock_io_t *ext =
+            get_nonblock_io(stream);
+    if (ext && ext->write_some) {
+        return ext->write_some(stream, buffer, inout_data_length);
+    } else if (!has_nonblock(stream)) {
+        return avs_errno(AVS_ENOTSUP);
+    } else if (!*inout_data_length) {
+        return AVS_OK;
+    }
+    size_t ready = avs_stream_nonblock_write_ready(stream);
+    if (!ready) {
+        return avs_errno(AVS_EAGAIN);
+    }
+    *inout_data_length = AVS_MIN(*inout_data_length, ready);
+    return avs_stream_write_some(stream, buffer, inout_data_length);
+}
+
+avs_error_t avs_stream_flush(avs_stream_t *stream) {
+    const avs_stream_v_table_extension_nonblock_io_t *ext =
+            get_nonblock_io(stream);
+    if (!ext || !ext->flush) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    return ext->flush(stream);
+}
+
 avs_error_t avs_stream_offset(avs_stream_t *stream, avs_off_t *out_offset) {
     const avs_stream_v_table_extension_offset_t *ext =
             (const avs_stream_v_table_extension_offset_t *)
@@ -0,0 +1,246 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#ifdef AVS_COMMONS_WITH_AVS_STREAM
+
+#    include <assert.h>
+
+#    include <avsystem/commons/avs_errno.h>
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_stream_async.h>
+
+#    define MODULE_NAME avs_stream
+#    include <avs_x_log_config.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+struct avs_stream_async_struct {
+    avs_stream_t *stream;
+    unsigned wanted_events;
+    bool in_process;
+    bool cleanup_requested;
+
+    struct {
+        /* NULL if no read is pending */
+        avs_stream_async_read_handler_t *handler;
+        void *arg;
+        void *buffer;
+        size_t buffer_length;
+    } read;
+
+    struct {
+        /* NULL if no write is pending */
+        avs_stream_async_write_handler_t *handler;
+        void *arg;
+        const char *data;
+        size_t data_length;
+        bool finish_message;
+    } write;
+};
+
+avs_stream_async_t *avs_stream_async_new(avs_stream_t *stream) {
+    assert(stream);
+    avs_stream_async_t *async =
+            (avs_stream_async_t *) avs_calloc(1, sizeof(avs_stream_async_t));
+    if (!async) {
+        LOG(ERROR, _("out of memory"));
+        return NULL;
+    }
+    async->stream = stream;
+    return async;
+}
+
+void avs_stream_async_cleanup(avs_stream_async_t **async_ptr) {
+    if (*async_ptr) {
+        if ((*async_ptr)->in_process) {
+            (*async_ptr)->cleanup_requested = true;
+        } else {
+            avs_free(*async_ptr);
+        }
+        *async_ptr = NULL;
+    }
+}
+
+avs_stream_t *avs_stream_async_stream(avs_stream_async_t *async) {
+    return async->stream;
+}
+
+int avs_stream_async_read(avs_stream_async_t *async,
+                          void *buffer,
+                          size_t buffer_length,
+                          avs_stream_async_read_handler_t *handler,
+                          void *arg) {
+    assert(handler);
+    if (async->read.handler) {
+        LOG(ERROR, _("read already pending"));
+        return -1;
+    }
+    async->read.handler = handler;
+    async->read.arg = arg;
+    async->read.buffer = buffer;
+    async->read.buffer_length = buffer_length;
+    return 0;
+}
+
+int avs_stream_async_write(avs_stream_async_t *async,
+                           const void *data,
+                           size_t data_length,
+                           bool finish_message,
+                           avs_stream_async_write_handler_t *handler,
+                           void *arg) {
+    assert(handler);
+    if (async->write.handler) {
+        LOG(ERROR, _("write already pending"));
+        return -1;
+    }
+    async->write.handler = handler;
+    async->write.arg = arg;
+    async->write.data = (const char *) data;
+    async->write.data_length = data_length;
+    async->write.finish_message = finish_message;
+    return 0;
+}
+
+unsigned avs_stream_async_wanted_events(avs_stream_async_t *async) {
+    return async->wanted_events;
+}
+
+static bool is_eagain(avs_error_t err) {
+    return err.category == AVS_ERRNO_CATEGORY && err.code == AVS_EAGAIN;
+}
+
+static bool process_read(avs_stream_async_t *async) {
+    size_t bytes_read;
+    bool message_finished;
+    avs_error_t err = avs_stream_read_nonblock(
+            async->stream, &bytes_read, &message_finished, async->read.buffer,
+            async->read.buffer_length);
+    if (is_eagain(err)) {
+        async->wanted_events |= AVS_STREAM_ASYNC_EVENT_READ;
+        return false;
+    }
+    avs_stream_async_read_handler_t *handler = async->read.handler;
+    void *arg = async->read.arg;
+    async->read.handler = NULL;
+    handler(async, err, bytes_read, message_finished, arg);
+    return true;
+}
+
+static void advance_write(avs_stream_async_t *async, size_t bytes_written) {
+    assert(bytes_written <= async->write.data_length);
+    async->write.data += bytes_written;
+    async->write.data_length -= bytes_written;
+}
+
+/* Called when the stream cannot accept more data without blocking, but the
+ * transport has been reported as writable. */
+static avs_error_t push_buffered_data(avs_stream_async_t *async) {
+    avs_error_t err = avs_stream_flush(async->stream);
+    if (err.category == AVS_ERRNO_CATEGORY && err.code == AVS_ENOTSUP) {
+        /* No explicit flush available - a regular write_some() is the next
+         * best thing; it is not expected to block for long, as the transport
+         * is writable. */
+        size_t bytes_written = async->write.data_length;
+        if (avs_is_ok((err = avs_stream_write_some(async->stream,
+                                                   async->write.data,
+                                                   &bytes_written)))) {
+            advance_write(async, bytes_written);
+        }
+    }
+    return err;
+}
+
+static bool take_write_event(avs_stream_async_t *async,
+                             unsigned *ready_events) {
+    if (!(*ready_events & AVS_STREAM_ASYNC_EVENT_WRITE)) {
+        async->wanted_events |= AVS_STREAM_ASYNC_EVENT_WRITE;
+        return false;
+    }
+    /* Each reported event is used for at most one potentially blocking
+     * operation. */
+    *ready_events &= ~(unsigned) AVS_STREAM_ASYNC_EVENT_WRITE;
+    return true;
+}
+
+static bool process_write(avs_stream_async_t *async, unsigned *ready_events) {
+    bool progress = false;
+    avs_error_t err = AVS_OK;
+    while (async->write.data_length) {
+        size_t bytes_written = async->write.data_length;
+        err = avs_stream_write_some_nonblock(async->stream, async->write.data,
+                                             &bytes_written);
+        if (avs_is_ok(err) && bytes_written) {
+            advance_write(async, bytes_written);
+            progress = true;
+        } else if (avs_is_ok(err) || is_eagain(err)) {
+            if (!take_write_event(async, ready_events)) {
+                return progress;
+            }
+            progress = true;
+            err = push_buffered_data(async);
+            if (is_eagain(err)) {
+                /* some data is still buffered; the next write attempt will
+                 * tell whether to wait for another write event */
+                err = AVS_OK;
+            } else if (avs_is_err(err)) {
+                break;
+            }
+        } else {
+            break;
+        }
+    }
+    if (avs_is_ok(err) && async->write.finish_message) {
+        if (!take_write_event(async, ready_events)) {
+            return progress;
+        }
+        err = avs_stream_finish_message(async->stream);
+    }
+    avs_stream_async_write_handler_t *handler = async->write.handler;
+    void *arg = async->write.arg;
+    async->write.handler = NULL;
+    handler(async, err, arg);
+    return true;
+}
+
+void avs_stream_async_process(avs_stream_async_t *async,
+                              unsigned ready_events) {
+    assert(!async->in_process);
+    async->in_process = true;
+    bool progress;
+    do {
+        async->wanted_events = 0;
+        progress = false;
+        if (async->read.handler && process_read(async)) {
+            progress = true;
+        }
+        if (!async->cleanup_requested && async->write.handler
+                && process_write(async, &ready_events)) {
+            progress = true;
+        }
+    } while (progress && !async->cleanup_requested);
+    async->in_process = false;
+    if (async->cleanup_requested) {
+        avs_free(async);
+    }
+}
+
+#    ifdef AVS_UNIT_TESTING
+#        include "tests/stream/test_stream_async.c"
+#    endif
+
+#endif // AVS_COMMONS_WITH_AVS_STREAM
@@ -168,7 +168,10 @@ finish:
         *out_bytes_read = bytes_read;
     }
     if (out_message_finished) {
-        *out_message_finished = stream->message_finished;
+        *out_message_finished =
+                stream->message_finished
+                && (!stream->in_buffer
+                    || avs_buffer_data_size(stream->in_buffer) == 0);
     }
     return AVS_OK;
 }
@@ -264,13 +267,155 @@ static avs_error_t stream_buffered_reset(avs_stream_t *stream_) {
     return avs_stream_reset(stream->underlying_stream);
 }
 
+static avs_error_t
+stream_buffered_writev(avs_stream_t *stream_,
+                       const avs_stream_const_iovec_t *iov,
+                       size_t iov_count) {
+    buffered_stream_t *stream = (buffered_stream_t *) stream_;
+    if (!stream->out_buffer) {
+        return avs_stream_writev(stream->underlying_stream, iov, iov_count);
+    }
+    for (size_t i = 0; i < iov_count; ++i) {
+        avs_error_t err;
+        if (iov[i].size >= avs_buffer_capacity(stream->out_buffer)) {
+            // elements that would not fit anyway bypass the buffer
+            if (avs_is_err((err = finish_message(stream)))
+                    || avs_is_err((err = avs_stream_write(
+                                           stream->underlying_stream,
+                                           iov[i].data, iov[i].size)))) {
+                return err;
+            }
+        } else if (iov[i].size) {
+            size_t written = iov[i].size;
+            if (avs_is_err((err = stream_buffered_write_some(
+                                    stream_, iov[i].data, &written)))) {
+                return err;
+            }
+            if (written < iov[i].size) {
+                return avs_errno(AVS_EMSGSIZE);
+            }
+        }
+    }
+    return AVS_OK;
+}
+
+static avs_error_t stream_buffered_readv(avs_stream_t *stream_,
+                                         size_t *out_bytes_read,
+                                         bool *out_message_finished,
+                                         const avs_stream_iovec_t *iov,
+                                         size_t iov_count) {
+    buffered_stream_t *stream = (buffered_stream_t *) stream_;
+    if (!stream->in_buffer) {
+        return avs_stream_readv(stream->underlying_stream, out_bytes_read,
+                                out_message_finished, iov, iov_count);
+    }
+    if (avs_buffer_data_size(stream->in_buffer) == 0) {
+        avs_error_t err = fetch_data(stream, &(size_t) { 0 });
+        if (avs_is_err(err)) {
+            return err;
+        }
+    }
+    for (size_t i = 0;
+         i < iov_count && avs_buffer_data_size(stream->in_buffer) > 0;
+         ++i) {
+        size_t chunk =
+                AVS_MIN(avs_buffer_data_size(stream->in_buffer), iov[i].size);
+        if (chunk) {
+            memcpy(iov[i].data, avs_buffer_data(stream->in_buffer), chunk);
+            avs_buffer_consume_bytes(stream->in_buffer, chunk);
+            *out_bytes_read += chunk;
+        }
+    }
+    *out_message_finished = stream->message_finished
+                            && avs_buffer_data_size(stream->in_buffer) == 0;
+    return AVS_OK;
+}
+
+static avs_error_t stream_buffered_peek_contiguous(avs_stream_t *stream_,
+                                                   const void **out_data,
+                                                   size_t *out_size,
+                                                   bool *out_message_finished) {
+    buffered_stream_t *stream = (buffered_stream_t *) stream_;
+    if (!stream->in_buffer) {
+        return avs_stream_peek_contiguous(stream->underlying_stream, out_data,
+                                          out_size, out_message_finished);
+    }
+    if (avs_buffer_data_size(stream->in_buffer) == 0) {
+        avs_error_t err = fetch_data(stream, &(size_t) { 0 });
+        if (avs_is_err(err)) {
+            return err;
+        }
+    }
+    *out_data = avs_buffer_data(stream->in_buffer);
+    *out_size = avs_buffer_data_size(stream->in_buffer);
+    *out_message_finished = stream->message_finished;
+    return AVS_OK;
+}
+
+static avs_error_t stream_buffered_consume(avs_stream_t *stream_,
+                                           size_t size) {
+    buffered_stream_t *stream = (buffered_stream_t *) stream_;
+    if (!stream->in_buffer) {
+        return avs_stream_consume(stream->underlying_stream, size);
+    }
+    if (avs_buffer_consume_bytes(stream->in_buffer, size)) {
+        return avs_errno(AVS_EINVAL);
+    }
+    return AVS_OK;
+}
+
+static avs_error_t stream_buffered_reserve(avs_stream_t *stream_,
+                                           size_t size_hint,
+                                           void **out_data,
+                                           size_t *out_size) {
+    buffered_stream_t *stream = (buffered_stream_t *) stream_;
+    if (!stream->out_buffer) {
+        return avs_stream_reserve(stream->underlying_stream, size_hint,
+                                  out_data, out_size);
+    }
+    if (avs_buffer_space_left(stream->out_buffer) == 0) {
+        avs_error_t err = flush_data(stream, &(size_t) { 0 });
+        if (avs_is_err(err)) {
+            return err;
+        }
+    }
+    *out_data = avs_buffer_raw_insert_ptr(stream->out_buffer);
+    *out_size = avs_buffer_space_left(stream->out_buffer);
+    return AVS_OK;
+}
+
+static avs_error_t stream_buffered_commit(avs_stream_t *stream_,
+                                          size_t size) {
+    buffered_stream_t *stream = (buffered_stream_t *) stream_;
+    if (!stream->out_buffer) {
+        return avs_stream_commit(stream->underlying_stream, size);
+    }
+    if (avs_buffer_advance_ptr(stream->out_buffer, size)) {
+        return avs_errno(AVS_EINVAL);
+    }
+    return AVS_OK;
+}
+
 static const avs_stream_v_table_t buffered_stream_vtable = {
     .write_some = stream_buffered_write_some,
     .finish_message = stream_buffered_finish_message,
     .read = stream_buffered_read,
     .peek = stream_buffered_peek,
     .reset = stream_buffered_reset,
-    .close = stream_buffered_close
+    .close = stream_buffered_close,
+    .extension_list =
+            (const avs_stream_v_table_extension_t[]) {
+                    { AVS_STREAM_V_TABLE_EXTENSION_VECTORED,
+                      &(const avs_stream_v_table_extension_vectored_t) {
+                              stream_buffered_writev,
+                              stream_buffered_readv } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_ZEROCOPY,
+                      &(const avs_stream_v_table_extension_zerocopy_t) {
+                              stream_buffered_peek_contiguous,
+                              stream_buffered_consume,
+                              stream_buffered_reserve,
+                              stream_buffered_commit } },
+                    AVS_STREAM_V_TABLE_EXTENSION_NULL }
 };
 
 int avs_stream_buffered_create(avs_stream_t **inout_stream,
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVS_COMMONS_STREAM_FD_TRANSFER_H
+#define AVS_COMMONS_STREAM_FD_TRANSFER_H
+
+#include <stddef.h>
+
+#include <avsystem/commons/avs_errno.h>
+#include <avsystem/commons/avs_stream.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+#ifdef AVS_COMMONS_STREAM_WITH_SENDFILE
+/**
+ * Transfers up to @p max_length bytes from @p in_fd to @p out_fd inside the
+ * kernel, without copying them through user space. If @p out_fd is
+ * non-blocking (e.g. it is a socket), this waits for it to become writable.
+ *
+ * @param out_fd          Descriptor to write to.
+ * @param out_offset      Offset in @p out_fd to write at, or -1 to use the
+ *                        current position of the descriptor.
+ * @param in_fd           Descriptor to read from.
+ * @param in_offset       Offset in @p in_fd to read from, or -1 to use the
+ *                        current position of the descriptor. An explicit
+ *                        offset does not change the descriptor position.
+ * @param max_length      Maximum number of bytes to transfer.
+ * @param out_transferred Set to the number of bytes transferred; 0 means that
+ *                        the end of @p in_fd has been reached.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed; in particular, <c>AVS_ENOTSUP</c> if the
+ *          descriptors cannot be used for such transfer and nothing has been
+ *          transferred.
+ */
+avs_error_t _avs_stream_fd_transfer(int out_fd,
+                                    avs_off_t out_offset,
+                                    int in_fd,
+                                    avs_off_t in_offset,
+                                    size_t max_length,
+                                    size_t *out_transferred);
+#endif // AVS_COMMONS_STREAM_WITH_SENDFILE
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* AVS_COMMONS_STREAM_FD_TRANSFER_H */
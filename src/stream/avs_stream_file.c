@@ -31,6 +31,7 @@
 #    include <avsystem/commons/avs_stream_v_table.h>
 
 #    include "avs_stream_common.h"
+#    include "avs_stream_file_mapping.h"
 
 #    define MODULE_NAME avs_stream
 #    include <avs_x_log_config.h>
@@ -103,6 +104,46 @@ static avs_error_t stream_file_read(avs_stream_t *stream_,
     return AVS_OK;
 }
 
+/* stdio coalesces consecutive elements in the FILE buffer, so there is no need
+ * to mix in POSIX writev() on the underlying descriptor */
+static avs_error_t stream_file_writev(avs_stream_t *stream_,
+                                      const avs_stream_const_iovec_t *iov,
+                                      size_t iov_count) {
+    avs_stream_file_t *file = (avs_stream_file_t *) stream_;
+    if ((file->mode & AVS_STREAM_FILE_WRITE) == 0) {
+        return avs_errno(AVS_EBADF);
+    }
+    for (size_t i = 0; i < iov_count; ++i) {
+        if (fwrite(iov[i].data, 1, iov[i].size, file->fp) < iov[i].size) {
+            return avs_errno(ferror(file->fp) ? AVS_EIO : AVS_EMSGSIZE);
+        }
+    }
+    return AVS_OK;
+}
+
+static avs_error_t stream_file_readv(avs_stream_t *stream_,
+                                     size_t *out_bytes_read,
+                                     bool *out_message_finished,
+                                     const avs_stream_iovec_t *iov,
+                                     size_t iov_count) {
+    avs_stream_file_t *file = (avs_stream_file_t *) stream_;
+    if ((file->mode & AVS_STREAM_FILE_READ) == 0) {
+        return avs_errno(AVS_EBADF);
+    }
+    for (size_t i = 0; i < iov_count; ++i) {
+        size_t bytes_read = fread(iov[i].data, 1, iov[i].size, file->fp);
+        *out_bytes_read += bytes_read;
+        if (bytes_read < iov[i].size) {
+            break;
+        }
+    }
+    if (ferror(file->fp)) {
+        return avs_errno(AVS_EIO);
+    }
+    *out_message_finished = !!feof(file->fp);
+    return AVS_OK;
+}
+
 static avs_error_t
 stream_file_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
     avs_stream_file_t *file = (avs_stream_file_t *) stream_;
@@ -209,10 +250,173 @@ static const avs_stream_v_table_t file_stream_vtable = {
                     { AVS_STREAM_V_TABLE_EXTENSION_FILE,
                       &(const avs_stream_v_table_extension_file_t) {
                               stream_file_length, stream_file_seek } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_VECTORED,
+                      &(const avs_stream_v_table_extension_vectored_t) {
+                              stream_file_writev, stream_file_readv } },
                     AVS_STREAM_V_TABLE_EXTENSION_NULL }
 };
 
+#    ifdef AVS_COMMONS_STREAM_WITH_FILE_MMAP
+typedef struct {
+    const avs_stream_v_table_t *const vtable;
+    const char *data;
+    size_t size;
+    /* may be larger than size after seeking past the end of file, just like
+     * with stdio streams */
+    size_t offset;
+} mapped_file_stream_t;
+
+static size_t mapped_bytes_left(const mapped_file_stream_t *file) {
+    return file->offset < file->size ? file->size - file->offset : 0;
+}
+
+static avs_error_t stream_mapped_write_some(avs_stream_t *stream,
+                                            const void *buffer,
+                                            size_t *inout_data_length) {
+    (void) stream;
+    (void) buffer;
+    (void) inout_data_length;
+    return avs_errno(AVS_EBADF);
+}
+
+static avs_error_t stream_mapped_read(avs_stream_t *stream_,
+                                      size_t *out_bytes_read,
+                                      bool *out_message_finished,
+                                      void *buffer,
+                                      size_t buffer_length) {
+    mapped_file_stream_t *file = (mapped_file_stream_t *) stream_;
+    size_t bytes_read = AVS_MIN(mapped_bytes_left(file), buffer_length);
+    if (bytes_read) {
+        memcpy(buffer, file->data + file->offset, bytes_read);
+        file->offset += bytes_read;
+    }
+    if (out_bytes_read) {
+        *out_bytes_read = bytes_read;
+    }
+    if (out_message_finished) {
+        *out_message_finished = !mapped_bytes_left(file);
+    }
+    return AVS_OK;
+}
+
+static avs_error_t
+stream_mapped_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
+    mapped_file_stream_t *file = (mapped_file_stream_t *) stream_;
+    if (offset >= mapped_bytes_left(file)) {
+        return AVS_EOF;
+    }
+    *out_value = file->data[file->offset + offset];
+    return AVS_OK;
+}
+
+static avs_error_t stream_mapped_reset(avs_stream_t *stream_) {
+    ((mapped_file_stream_t *) stream_)->offset = 0;
+    return AVS_OK;
+}
+
+static avs_error_t stream_mapped_close(avs_stream_t *stream_) {
+    mapped_file_stream_t *file = (mapped_file_stream_t *) stream_;
+    _avs_stream_file_mapping_destroy(file->data, file->size);
+    return AVS_OK;
+}
+
+static avs_error_t stream_mapped_offset(avs_stream_t *stream_,
+                                        avs_off_t *out_offset) {
+    *out_offset = (avs_off_t) ((mapped_file_stream_t *) stream_)->offset;
+    return AVS_OK;
+}
+
+static avs_error_t stream_mapped_seek(avs_stream_t *stream_,
+                                      avs_off_t offset_from_start) {
+    if (offset_from_start < 0
+            || (uintmax_t) offset_from_start > (uintmax_t) SIZE_MAX) {
+        return avs_errno(AVS_ERANGE);
+    }
+    ((mapped_file_stream_t *) stream_)->offset = (size_t) offset_from_start;
+    return AVS_OK;
+}
+
+static avs_error_t stream_mapped_length(avs_stream_t *stream_,
+                                        avs_off_t *out_length) {
+    *out_length = (avs_off_t) ((mapped_file_stream_t *) stream_)->size;
+    return AVS_OK;
+}
+
+static avs_error_t stream_mapped_peek_contiguous(avs_stream_t *stream_,
+                                                 const void **out_data,
+                                                 size_t *out_size,
+                                                 bool *out_message_finished) {
+    mapped_file_stream_t *file = (mapped_file_stream_t *) stream_;
+    *out_size = mapped_bytes_left(file);
+    *out_data = *out_size ? file->data + file->offset : NULL;
+    *out_message_finished = true;
+    return AVS_OK;
+}
+
+static avs_error_t stream_mapped_consume(avs_stream_t *stream_, size_t size) {
+    mapped_file_stream_t *file = (mapped_file_stream_t *) stream_;
+    if (size > mapped_bytes_left(file)) {
+        return avs_errno(AVS_EINVAL);
+    }
+    file->offset += size;
+    return AVS_OK;
+}
+
+static const avs_stream_v_table_t mapped_file_stream_vtable = {
+    .write_some = stream_mapped_write_some,
+    .read = stream_mapped_read,
+    .peek = stream_mapped_peek,
+    .reset = stream_mapped_reset,
+    .close = stream_mapped_close,
+    .finish_message = _avs_stream_empty_finish_message,
+    .extension_list =
+            (const avs_stream_v_table_extension_t[]) {
+                    { AVS_STREAM_V_TABLE_EXTENSION_OFFSET,
+                      &(const avs_stream_v_table_extension_offset_t) {
+                              stream_mapped_offset } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_FILE,
+                      &(const avs_stream_v_table_extension_file_t) {
+                              stream_mapped_length, stream_mapped_seek } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_ZEROCOPY,
+                      &(const avs_stream_v_table_extension_zerocopy_t) {
+                              .peek_contiguous = stream_mapped_peek_contiguous,
+                              .consume = stream_mapped_consume } },
+                    AVS_STREAM_V_TABLE_EXTENSION_NULL }
+};
+
+static avs_stream_t *create_mapped(const char *path) {
+    mapped_file_stream_t *file = (mapped_file_stream_t *) avs_calloc(
+            1, sizeof(mapped_file_stream_t));
+    if (!file) {
+        LOG(ERROR, _("out of memory"));
+        return NULL;
+    }
+    avs_error_t err =
+            _avs_stream_file_mapping_create(path, (const void **) &file->data,
+                                            &file->size);
+    if (avs_is_err(err)) {
+        LOG(DEBUG, _("could not map ") "%s" _(", falling back to stdio"),
+            path);
+        avs_free(file);
+        return NULL;
+    }
+    const void *vtable = &mapped_file_stream_vtable;
+    memcpy((void *) (intptr_t) &file->vtable, &vtable, sizeof(void *));
+    return (avs_stream_t *) file;
+}
+#    endif // AVS_COMMONS_STREAM_WITH_FILE_MMAP
+
 avs_stream_t *avs_stream_file_create(const char *path, uint8_t mode) {
+    if (mode == (AVS_STREAM_FILE_READ | AVS_STREAM_FILE_MAPPED)) {
+#    ifdef AVS_COMMONS_STREAM_WITH_FILE_MMAP
+        avs_stream_t *stream = create_mapped(path);
+        if (stream) {
+            return stream;
+        }
+#    endif // AVS_COMMONS_STREAM_WITH_FILE_MMAP
+        mode = AVS_STREAM_FILE_READ;
+    }
+
     avs_stream_file_t *file =
             (avs_stream_file_t *) avs_calloc(1, sizeof(avs_stream_file_t));
     const void *vtable = &file_stream_vtable;
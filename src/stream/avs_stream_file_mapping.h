@@ -0,0 +1,51 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVS_COMMONS_STREAM_FILE_MAPPING_H
+#define AVS_COMMONS_STREAM_FILE_MAPPING_H
+
+#include <stddef.h>
+
+#include <avsystem/commons/avs_errno.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+#ifdef AVS_COMMONS_STREAM_WITH_FILE_MMAP
+/**
+ * Maps the whole contents of the regular file at @p path into memory for
+ * reading, and advises the system that it will be accessed sequentially.
+ *
+ * @param path     Path to the file.
+ * @param out_data Set to the address of the mapping. May be set to NULL if the
+ *                 file is empty.
+ * @param out_size Set to the size of the file.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+avs_error_t _avs_stream_file_mapping_create(const char *path,
+                                            const void **out_data,
+                                            size_t *out_size);
+
+/**
+ * Releases a mapping created with @ref _avs_stream_file_mapping_create.
+ */
+void _avs_stream_file_mapping_destroy(const void *data, size_t size);
+#endif // AVS_COMMONS_STREAM_WITH_FILE_MMAP
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* AVS_COMMONS_STREAM_FILE_MAPPING_H */
@@ -73,10 +73,37 @@ inbuf_stream_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
     return AVS_OK;
 }
 
+static avs_error_t inbuf_stream_peek_contiguous(avs_stream_t *stream_,
+                                                const void **out_data,
+                                                size_t *out_size,
+                                                bool *out_message_finished) {
+    avs_stream_inbuf_t *stream = (avs_stream_inbuf_t *) stream_;
+    assert(stream->buffer_offset <= stream->buffer_size);
+    *out_data = (const char *) stream->buffer + stream->buffer_offset;
+    *out_size = stream->buffer_size - stream->buffer_offset;
+    *out_message_finished = true;
+    return AVS_OK;
+}
+
+static avs_error_t inbuf_stream_consume(avs_stream_t *stream_, size_t size) {
+    avs_stream_inbuf_t *stream = (avs_stream_inbuf_t *) stream_;
+    if (size > stream->buffer_size - stream->buffer_offset) {
+        return avs_errno(AVS_EINVAL);
+    }
+    stream->buffer_offset += size;
+    return AVS_OK;
+}
+
 static const avs_stream_v_table_t inbuf_stream_vtable = {
     .peek = inbuf_stream_peek,
     .read = inbuf_stream_read,
-    .extension_list = AVS_STREAM_V_TABLE_NO_EXTENSIONS
+    .extension_list =
+            (const avs_stream_v_table_extension_t[]) {
+                    { AVS_STREAM_V_TABLE_EXTENSION_ZEROCOPY,
+                      &(const avs_stream_v_table_extension_zerocopy_t) {
+                              .peek_contiguous = inbuf_stream_peek_contiguous,
+                              .consume = inbuf_stream_consume } },
+                    AVS_STREAM_V_TABLE_EXTENSION_NULL }
 };
 
 const avs_stream_inbuf_t AVS_STREAM_INBUF_STATIC_INITIALIZER = {
@@ -26,6 +26,7 @@
 
 #    include <avsystem/commons/avs_errno.h>
 #    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_refbuf.h>
 #    include <avsystem/commons/avs_stream_membuf.h>
 #    include <avsystem/commons/avs_stream_v_table.h>
 
@@ -42,6 +43,9 @@ struct avs_stream_membuf_struct {
     size_t buffer_size;
     size_t index_write;
     size_t index_read;
+    /* if not NULL, wraps buffer, parts of which have been handed out as
+     * slices by stream_membuf_read_slice() */
+    avs_refbuf_t *lent;
 };
 
 avs_error_t avs_stream_membuf_ensure_free_bytes(avs_stream_t *stream,
@@ -80,6 +84,33 @@ avs_error_t avs_stream_membuf_take_ownership(avs_stream_t *stream,
     return avs_errno(AVS_ENOTSUP);
 }
 
+/* Needs to be called before any operation that moves or frees the buffer, or
+ * may overwrite data that has already been read. If there are no slices of the
+ * buffer left, it is taken back. Otherwise, it is left to the slices, and the
+ * unread data, if any, is copied to a new buffer. */
+static avs_error_t reclaim_membuf(avs_stream_membuf_t *stream) {
+    if (!stream->lent) {
+        return AVS_OK;
+    }
+    if (avs_refbuf_unwrap(&stream->lent)) {
+        return AVS_OK;
+    }
+    size_t used = stream->index_write - stream->index_read;
+    char *new_buffer = NULL;
+    if (used) {
+        if (!(new_buffer = (char *) avs_malloc(used))) {
+            return avs_errno(AVS_ENOMEM);
+        }
+        memcpy(new_buffer, &stream->buffer[stream->index_read], used);
+    }
+    avs_refbuf_unref(&stream->lent);
+    stream->buffer = new_buffer;
+    stream->buffer_size = used;
+    stream->index_write = used;
+    stream->index_read = 0;
+    return AVS_OK;
+}
+
 static void defragment_membuf(avs_stream_membuf_t *stream) {
     if (stream->index_read) {
         size_t used = stream->index_write - stream->index_read;
@@ -102,6 +133,36 @@ static avs_error_t realloc_membuf(avs_stream_membuf_t *stream,
     return AVS_OK;
 }
 
+/* Makes room for writing size bytes, if possible. Fails only if there is no
+ * free space at all. */
+static avs_error_t make_room(avs_stream_membuf_t *stream, size_t size) {
+    if (stream->buffer_size < stream->index_write + size
+            && avs_is_ok(reclaim_membuf(stream))) {
+        defragment_membuf(stream);
+    }
+    if (stream->buffer_size < stream->index_write + size) {
+        avs_error_t err = reclaim_membuf(stream);
+        if (avs_is_ok(err)) {
+            err = realloc_membuf(stream, 2 * stream->buffer_size + size);
+        }
+        if (avs_is_err(err) && stream->buffer_size == stream->index_write) {
+            return err;
+        }
+        assert(stream->buffer);
+    }
+    return AVS_OK;
+}
+
+static void consume_membuf(avs_stream_membuf_t *stream, size_t size) {
+    stream->index_read += size;
+    assert(stream->index_read <= stream->index_write);
+    if (stream->index_read == stream->index_write
+            && avs_is_ok(reclaim_membuf(stream))) {
+        stream->index_read = 0;
+        stream->index_write = 0;
+    }
+}
+
 static avs_error_t stream_membuf_write_some(avs_stream_t *stream_,
                                             const void *buffer,
                                             size_t *inout_data_length) {
@@ -109,21 +170,12 @@ static avs_error_t stream_membuf_write_some(avs_stream_t *stream_,
     if (*inout_data_length == 0) {
         return AVS_OK;
     }
-    if (stream->buffer_size < stream->index_write + *inout_data_length) {
-        defragment_membuf(stream);
-    }
-    if (stream->buffer_size < stream->index_write + *inout_data_length) {
-        avs_error_t err =
-                realloc_membuf(stream,
-                               2 * stream->buffer_size + *inout_data_length);
-        if (avs_is_err(err)) {
-            *inout_data_length = stream->buffer_size - stream->index_write;
-            if (*inout_data_length == 0) {
-                return err;
-            }
-        }
-        assert(stream->buffer);
+    avs_error_t err = make_room(stream, *inout_data_length);
+    if (avs_is_err(err)) {
+        return err;
     }
+    *inout_data_length = AVS_MIN(*inout_data_length,
+                                 stream->buffer_size - stream->index_write);
     memcpy(stream->buffer + stream->index_write, buffer, *inout_data_length);
     stream->index_write += *inout_data_length;
     return AVS_OK;
@@ -150,12 +202,75 @@ static avs_error_t stream_membuf_read(avs_stream_t *stream_,
     if (bytes_read) {
         assert(buffer);
         memcpy(buffer, stream->buffer + stream->index_read, bytes_read);
-        stream->index_read += bytes_read;
-        if (stream->index_read == stream->index_write) {
-            stream->index_read = 0;
-            stream->index_write = 0;
-        }
+        consume_membuf(stream, bytes_read);
+    }
+    return AVS_OK;
+}
+
+static avs_error_t stream_membuf_read_slice(avs_stream_t *stream_,
+                                            avs_refbuf_slice_t *out_slice,
+                                            bool *out_message_finished,
+                                            size_t max_length) {
+    avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
+    assert(stream->index_read <= stream->index_write);
+    size_t bytes_left = stream->index_write - stream->index_read;
+    size_t bytes_read = AVS_MIN(bytes_left, max_length);
+    if (out_message_finished) {
+        *out_message_finished = (bytes_read == bytes_left);
+    }
+    if (!bytes_read) {
+        return AVS_OK;
+    }
+    if (!stream->lent
+            && !(stream->lent = avs_refbuf_wrap(stream->buffer,
+                                                stream->buffer_size))) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    avs_refbuf_slice(out_slice, stream->lent, stream->index_read, bytes_read);
+    consume_membuf(stream, bytes_read);
+    return AVS_OK;
+}
+
+static avs_error_t stream_membuf_peek_contiguous(avs_stream_t *stream_,
+                                                 const void **out_data,
+                                                 size_t *out_size,
+                                                 bool *out_message_finished) {
+    avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
+    *out_data = stream->buffer + stream->index_read;
+    *out_size = stream->index_write - stream->index_read;
+    *out_message_finished = true;
+    return AVS_OK;
+}
+
+static avs_error_t stream_membuf_consume(avs_stream_t *stream_, size_t size) {
+    avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
+    if (size > stream->index_write - stream->index_read) {
+        return avs_errno(AVS_EINVAL);
     }
+    consume_membuf(stream, size);
+    return AVS_OK;
+}
+
+static avs_error_t stream_membuf_reserve(avs_stream_t *stream_,
+                                         size_t size_hint,
+                                         void **out_data,
+                                         size_t *out_size) {
+    avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
+    avs_error_t err = make_room(stream, AVS_MAX(size_hint, 1));
+    if (avs_is_err(err)) {
+        return err;
+    }
+    *out_data = stream->buffer + stream->index_write;
+    *out_size = stream->buffer_size - stream->index_write;
+    return AVS_OK;
+}
+
+static avs_error_t stream_membuf_commit(avs_stream_t *stream_, size_t size) {
+    avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
+    if (size > stream->buffer_size - stream->index_write) {
+        return avs_errno(AVS_EINVAL);
+    }
+    stream->index_write += size;
     return AVS_OK;
 }
 
@@ -171,6 +286,9 @@ stream_membuf_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
 
 static avs_error_t stream_membuf_reset(avs_stream_t *stream_) {
     avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
+    /* with no unread data, reclaiming cannot fail */
+    stream->index_read = stream->index_write;
+    reclaim_membuf(stream);
     stream->index_read = 0;
     stream->index_write = 0;
     return AVS_OK;
@@ -178,7 +296,11 @@ static avs_error_t stream_membuf_reset(avs_stream_t *stream_) {
 
 static avs_error_t stream_membuf_close(avs_stream_t *stream_) {
     avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
-    avs_free(stream->buffer);
+    if (stream->lent) {
+        avs_refbuf_unref(&stream->lent);
+    } else {
+        avs_free(stream->buffer);
+    }
     stream->buffer = NULL;
     stream->buffer_size = 0;
     stream->index_read = 0;
@@ -201,6 +323,10 @@ static avs_error_t stream_membuf_offset(avs_stream_t *stream_,
 static avs_error_t stream_membuf_ensure_free_bytes(avs_stream_t *stream_,
                                                    size_t additional_size) {
     avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
+    avs_error_t err = reclaim_membuf(stream);
+    if (avs_is_err(err)) {
+        return err;
+    }
     defragment_membuf(stream);
     if (additional_size > SIZE_MAX - stream->index_write) {
         return avs_errno(AVS_ENOMEM);
@@ -213,6 +339,10 @@ static avs_error_t stream_membuf_ensure_free_bytes(avs_stream_t *stream_,
 
 static avs_error_t stream_membuf_fit(avs_stream_t *stream_) {
     avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
+    avs_error_t err = reclaim_membuf(stream);
+    if (avs_is_err(err)) {
+        return err;
+    }
     defragment_membuf(stream);
     size_t max_index = stream->index_write;
     if (stream->buffer_size > max_index) {
@@ -225,6 +355,10 @@ static avs_error_t stream_membuf_take_ownership(avs_stream_t *stream_,
                                                 void **out_ptr,
                                                 size_t *out_size) {
     avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
+    avs_error_t err = reclaim_membuf(stream);
+    if (avs_is_err(err)) {
+        return err;
+    }
     stream_membuf_fit(stream_);
     *out_ptr = (void *) stream->buffer;
     if (out_size) {
@@ -253,6 +387,15 @@ static const avs_stream_v_table_t membuf_stream_vtable = {
                               stream_membuf_ensure_free_bytes,
                               stream_membuf_fit,
                               stream_membuf_take_ownership } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_SLICE,
+                      &(const avs_stream_v_table_extension_slice_t) {
+                              stream_membuf_read_slice } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_ZEROCOPY,
+                      &(const avs_stream_v_table_extension_zerocopy_t) {
+                              stream_membuf_peek_contiguous,
+                              stream_membuf_consume,
+                              stream_membuf_reserve,
+                              stream_membuf_commit } },
                     AVS_STREAM_V_TABLE_EXTENSION_NULL }
 };
 
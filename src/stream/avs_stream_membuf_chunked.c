@@ -0,0 +1,383 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#ifdef AVS_COMMONS_WITH_AVS_STREAM
+
+#    include <assert.h>
+#    include <stddef.h>
+#    include <string.h>
+
+#    include <limits.h>
+
+#    include <avsystem/commons/avs_errno.h>
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_stream_membuf.h>
+#    include <avsystem/commons/avs_stream_v_table.h>
+
+#    include "avs_stream_common.h"
+
+#    define MODULE_NAME avs_stream
+#    include <avs_x_log_config.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+typedef struct membuf_chunk_struct {
+    struct membuf_chunk_struct *next;
+    char data[];
+} membuf_chunk_t;
+
+/* Unread data spans the chunks from head to write_chunk: it starts at
+ * index_read in head, all chunks in between are full, and it ends at
+ * index_write in write_chunk. Chunks after write_chunk are empty spares,
+ * preallocated by avs_stream_membuf_ensure_free_bytes(). */
+typedef struct {
+    const avs_stream_v_table_t *const vtable;
+    size_t chunk_size;
+    membuf_chunk_t *head;
+    membuf_chunk_t *write_chunk;
+    size_t index_read;
+    size_t index_write;
+    /* number of unread bytes */
+    size_t size;
+} membuf_chunked_t;
+
+static membuf_chunk_t *new_chunk(membuf_chunked_t *stream) {
+    membuf_chunk_t *chunk = (membuf_chunk_t *) avs_malloc(
+            offsetof(membuf_chunk_t, data) + stream->chunk_size);
+    if (chunk) {
+        chunk->next = NULL;
+    }
+    return chunk;
+}
+
+static void free_chunks(membuf_chunk_t *chunk) {
+    while (chunk) {
+        membuf_chunk_t *next = chunk->next;
+        avs_free(chunk);
+        chunk = next;
+    }
+}
+
+static size_t write_space(const membuf_chunked_t *stream) {
+    return stream->write_chunk ? stream->chunk_size - stream->index_write : 0;
+}
+
+static size_t head_available(const membuf_chunked_t *stream) {
+    if (!stream->head) {
+        return 0;
+    }
+    return (stream->head == stream->write_chunk ? stream->index_write
+                                                : stream->chunk_size)
+           - stream->index_read;
+}
+
+/* Moves on to the next chunk for writing, allocating it if necessary. Shall
+ * only be called when there is no space left in the current one. */
+static avs_error_t next_write_chunk(membuf_chunked_t *stream) {
+    assert(!write_space(stream));
+    if (!stream->write_chunk) {
+        assert(!stream->head);
+        if (!(stream->head = new_chunk(stream))) {
+            return avs_errno(AVS_ENOMEM);
+        }
+        stream->write_chunk = stream->head;
+        stream->index_read = 0;
+    } else {
+        if (!stream->write_chunk->next
+                && !(stream->write_chunk->next = new_chunk(stream))) {
+            return avs_errno(AVS_ENOMEM);
+        }
+        stream->write_chunk = stream->write_chunk->next;
+    }
+    stream->index_write = 0;
+    return AVS_OK;
+}
+
+static void consume_chunked(membuf_chunked_t *stream, size_t size) {
+    assert(size <= stream->size);
+    while (size) {
+        size_t consumed = AVS_MIN(size, head_available(stream));
+        stream->index_read += consumed;
+        stream->size -= consumed;
+        size -= consumed;
+        if (stream->index_read == stream->chunk_size
+                && stream->head != stream->write_chunk) {
+            membuf_chunk_t *next = stream->head->next;
+            avs_free(stream->head);
+            stream->head = next;
+            stream->index_read = 0;
+        }
+    }
+    if (!stream->size && stream->head == stream->write_chunk) {
+        /* the last chunk is kept and reused from the beginning */
+        stream->index_read = 0;
+        stream->index_write = 0;
+    }
+}
+
+static avs_error_t stream_chunked_write_some(avs_stream_t *stream_,
+                                             const void *buffer,
+                                             size_t *inout_data_length) {
+    membuf_chunked_t *stream = (membuf_chunked_t *) stream_;
+    size_t written = 0;
+    while (written < *inout_data_length) {
+        if (!write_space(stream)) {
+            avs_error_t err = next_write_chunk(stream);
+            if (avs_is_err(err)) {
+                if (!written) {
+                    return err;
+                }
+                break;
+            }
+        }
+        size_t chunk_written =
+                AVS_MIN(*inout_data_length - written, write_space(stream));
+        memcpy(stream->write_chunk->data + stream->index_write,
+               (const char *) buffer + written, chunk_written);
+        stream->index_write += chunk_written;
+        stream->size += chunk_written;
+        written += chunk_written;
+    }
+    *inout_data_length = written;
+    return AVS_OK;
+}
+
+static avs_error_t stream_chunked_read(avs_stream_t *stream_,
+                                       size_t *out_bytes_read,
+                                       bool *out_message_finished,
+                                       void *buffer,
+                                       size_t buffer_length) {
+    membuf_chunked_t *stream = (membuf_chunked_t *) stream_;
+    if (!buffer && buffer_length) {
+        return avs_errno(AVS_EINVAL);
+    }
+    size_t bytes_read = 0;
+    while (bytes_read < buffer_length && stream->size) {
+        size_t chunk_read =
+                AVS_MIN(buffer_length - bytes_read, head_available(stream));
+        memcpy((char *) buffer + bytes_read,
+               stream->head->data + stream->index_read, chunk_read);
+        consume_chunked(stream, chunk_read);
+        bytes_read += chunk_read;
+    }
+    if (out_bytes_read) {
+        *out_bytes_read = bytes_read;
+    }
+    if (out_message_finished) {
+        *out_message_finished = !stream->size;
+    }
+    return AVS_OK;
+}
+
+static avs_error_t
+stream_chunked_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
+    membuf_chunked_t *stream = (membuf_chunked_t *) stream_;
+    if (offset >= stream->size) {
+        return AVS_EOF;
+    }
+    /* all chunks but the first and the last one are full */
+    const membuf_chunk_t *chunk = stream->head;
+    size_t index = stream->index_read + offset;
+    while (index >= stream->chunk_size) {
+        index -= stream->chunk_size;
+        chunk = chunk->next;
+    }
+    *out_value = chunk->data[index];
+    return AVS_OK;
+}
+
+static avs_error_t stream_chunked_peek_contiguous(avs_stream_t *stream_,
+                                                  const void **out_data,
+                                                  size_t *out_size,
+                                                  bool *out_message_finished) {
+    membuf_chunked_t *stream = (membuf_chunked_t *) stream_;
+    *out_data = stream->head ? stream->head->data + stream->index_read : NULL;
+    *out_size = head_available(stream);
+    *out_message_finished = (*out_size == stream->size);
+    return AVS_OK;
+}
+
+static avs_error_t stream_chunked_consume(avs_stream_t *stream_, size_t size) {
+    membuf_chunked_t *stream = (membuf_chunked_t *) stream_;
+    if (size > stream->size) {
+        return avs_errno(AVS_EINVAL);
+    }
+    consume_chunked(stream, size);
+    return AVS_OK;
+}
+
+static avs_error_t stream_chunked_reserve(avs_stream_t *stream_,
+                                          size_t size_hint,
+                                          void **out_data,
+                                          size_t *out_size) {
+    (void) size_hint;
+    membuf_chunked_t *stream = (membuf_chunked_t *) stream_;
+    if (!write_space(stream)) {
+        avs_error_t err = next_write_chunk(stream);
+        if (avs_is_err(err)) {
+            return err;
+        }
+    }
+    *out_data = stream->write_chunk->data + stream->index_write;
+    *out_size = write_space(stream);
+    return AVS_OK;
+}
+
+static avs_error_t stream_chunked_commit(avs_stream_t *stream_, size_t size) {
+    membuf_chunked_t *stream = (membuf_chunked_t *) stream_;
+    if (size > write_space(stream)) {
+        return avs_errno(AVS_EINVAL);
+    }
+    stream->index_write += size;
+    stream->size += size;
+    return AVS_OK;
+}
+
+static avs_error_t stream_chunked_reset(avs_stream_t *stream_) {
+    membuf_chunked_t *stream = (membuf_chunked_t *) stream_;
+    if (stream->head) {
+        free_chunks(stream->head->next);
+        stream->head->next = NULL;
+        stream->write_chunk = stream->head;
+    }
+    stream->index_read = 0;
+    stream->index_write = 0;
+    stream->size = 0;
+    return AVS_OK;
+}
+
+static avs_error_t stream_chunked_close(avs_stream_t *stream_) {
+    membuf_chunked_t *stream = (membuf_chunked_t *) stream_;
+    free_chunks(stream->head);
+    stream->head = NULL;
+    stream->write_chunk = NULL;
+    stream->index_read = 0;
+    stream->index_write = 0;
+    stream->size = 0;
+    return AVS_OK;
+}
+
+static avs_error_t stream_chunked_offset(avs_stream_t *stream_,
+                                         avs_off_t *out_offset) {
+    membuf_chunked_t *stream = (membuf_chunked_t *) stream_;
+    if (stream->size > LONG_MAX) {
+        return avs_errno(AVS_E2BIG);
+    }
+    *out_offset = (avs_off_t) stream->size;
+    return AVS_OK;
+}
+
+static avs_error_t stream_chunked_ensure_free_bytes(avs_stream_t *stream_,
+                                                    size_t additional_size) {
+    membuf_chunked_t *stream = (membuf_chunked_t *) stream_;
+    size_t space = write_space(stream);
+    membuf_chunk_t **last_ptr =
+            stream->write_chunk ? &stream->write_chunk->next : &stream->head;
+    while (space < additional_size) {
+        if (!*last_ptr) {
+            if (!(*last_ptr = new_chunk(stream))) {
+                return avs_errno(AVS_ENOMEM);
+            }
+            if (!stream->write_chunk) {
+                stream->write_chunk = *last_ptr;
+                stream->index_read = 0;
+                stream->index_write = 0;
+            }
+        }
+        space += stream->chunk_size;
+        last_ptr = &(*last_ptr)->next;
+    }
+    return AVS_OK;
+}
+
+static avs_error_t stream_chunked_fit(avs_stream_t *stream_) {
+    membuf_chunked_t *stream = (membuf_chunked_t *) stream_;
+    if (!stream->size) {
+        return stream_chunked_close(stream_);
+    }
+    free_chunks(stream->write_chunk->next);
+    stream->write_chunk->next = NULL;
+    return AVS_OK;
+}
+
+static avs_error_t stream_chunked_take_ownership(avs_stream_t *stream_,
+                                                 void **out_ptr,
+                                                 size_t *out_size) {
+    membuf_chunked_t *stream = (membuf_chunked_t *) stream_;
+    size_t size = stream->size;
+    char *buffer = NULL;
+    if (size && !(buffer = (char *) avs_malloc(size))) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    stream_chunked_read(stream_, NULL, NULL, buffer, size);
+    assert(!stream->size);
+    stream_chunked_close(stream_);
+    *out_ptr = buffer;
+    if (out_size) {
+        *out_size = size;
+    }
+    return AVS_OK;
+}
+
+static const avs_stream_v_table_t membuf_chunked_vtable = {
+    .write_some = stream_chunked_write_some,
+    .read = stream_chunked_read,
+    .peek = stream_chunked_peek,
+    .reset = stream_chunked_reset,
+    .finish_message = _avs_stream_empty_finish_message,
+    .close = stream_chunked_close,
+    .extension_list =
+            (const avs_stream_v_table_extension_t[]) {
+                    { AVS_STREAM_V_TABLE_EXTENSION_OFFSET,
+                      &(const avs_stream_v_table_extension_offset_t) {
+                              stream_chunked_offset } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_MEMBUF,
+                      &(const avs_stream_v_table_extension_membuf_t) {
+                              stream_chunked_ensure_free_bytes,
+                              stream_chunked_fit,
+                              stream_chunked_take_ownership } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_ZEROCOPY,
+                      &(const avs_stream_v_table_extension_zerocopy_t) {
+                              stream_chunked_peek_contiguous,
+                              stream_chunked_consume,
+                              stream_chunked_reserve,
+                              stream_chunked_commit } },
+                    AVS_STREAM_V_TABLE_EXTENSION_NULL }
+};
+
+avs_stream_t *avs_stream_membuf_create_chunked(size_t chunk_size) {
+    if (!chunk_size) {
+        LOG(ERROR, _("chunk size must not be 0"));
+        return NULL;
+    }
+    membuf_chunked_t *stream =
+            (membuf_chunked_t *) avs_calloc(1, sizeof(membuf_chunked_t));
+    if (!stream) {
+        return NULL;
+    }
+    *(const avs_stream_v_table_t **) (intptr_t) &stream->vtable =
+            &membuf_chunked_vtable;
+    stream->chunk_size = chunk_size;
+    return (avs_stream_t *) stream;
+}
+
+#    ifdef AVS_UNIT_TESTING
+#        include "tests/stream/test_stream_membuf_chunked.c"
+#    endif
+
+#endif // AVS_COMMONS_WITH_AVS_STREAM
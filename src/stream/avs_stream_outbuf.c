@@ -66,6 +66,32 @@ static avs_error_t outbuf_stream_offset(avs_stream_t *stream,
     return AVS_OK;
 }
 
+static avs_error_t outbuf_stream_reserve(avs_stream_t *stream_,
+                                         size_t size_hint,
+                                         void **out_data,
+                                         size_t *out_size) {
+    (void) size_hint;
+    avs_stream_outbuf_t *stream = (avs_stream_outbuf_t *) stream_;
+    if (stream->message_finished) {
+        return avs_errno(AVS_EBADF);
+    }
+    *out_data = (char *) stream->buffer + stream->buffer_offset;
+    *out_size = stream->buffer_size - stream->buffer_offset;
+    return AVS_OK;
+}
+
+static avs_error_t outbuf_stream_commit(avs_stream_t *stream_, size_t size) {
+    avs_stream_outbuf_t *stream = (avs_stream_outbuf_t *) stream_;
+    if (stream->message_finished) {
+        return avs_errno(AVS_EBADF);
+    }
+    if (size > stream->buffer_size - stream->buffer_offset) {
+        return avs_errno(AVS_EINVAL);
+    }
+    stream->buffer_offset += size;
+    return AVS_OK;
+}
+
 static const avs_stream_v_table_t outbuf_stream_vtable = {
     .reset = outbuf_stream_reset,
     .write_some = outbuf_stream_write_some,
@@ -75,6 +101,10 @@ static const avs_stream_v_table_t outbuf_stream_vtable = {
                     { AVS_STREAM_V_TABLE_EXTENSION_OFFSET,
                       &(const avs_stream_v_table_extension_offset_t) {
                               outbuf_stream_offset } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_ZEROCOPY,
+                      &(const avs_stream_v_table_extension_zerocopy_t) {
+                              .reserve = outbuf_stream_reserve,
+                              .commit = outbuf_stream_commit } },
                     AVS_STREAM_V_TABLE_EXTENSION_NULL }
 };
 
@@ -0,0 +1,380 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#ifdef AVS_COMMONS_WITH_AVS_STREAM
+
+#    include <assert.h>
+#    include <stdint.h>
+
+#    include <avsystem/commons/avs_errno.h>
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_stream_pipeline.h>
+#    include <avsystem/commons/avs_stream_v_table.h>
+
+#    define MODULE_NAME avs_stream
+#    include <avs_x_log_config.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+typedef enum {
+    /* stage 0 - the source, not fed by the pipeline */
+    FEED_NONE,
+    /* previous stage is read directly into space reserved in this one */
+    FEED_RESERVE,
+    /* data peeked from the source is written to this stage */
+    FEED_PEEK,
+    /* previous stage is read into the intermediate buffer, which is then
+     * written to this stage */
+    FEED_BUFFER
+} feed_mode_t;
+
+typedef struct {
+    avs_stream_t *stream;
+    feed_mode_t feed_mode;
+    /* only used in FEED_BUFFER mode; points into the pipeline's allocation */
+    char *buffer;
+    size_t buffer_begin;
+    size_t buffer_end;
+    /* previous stage has reported the end of message */
+    bool input_finished;
+    /* avs_stream_finish_message() has been called on this stage */
+    bool finish_sent;
+} pipeline_stage_t;
+
+typedef struct {
+    const avs_stream_v_table_t *const vtable;
+    size_t buffer_size;
+    size_t stage_count;
+    pipeline_stage_t stages[];
+} pipeline_t;
+
+static avs_error_t stage_read(pipeline_t *pipeline,
+                              size_t index,
+                              size_t *out_bytes_read,
+                              bool *out_message_finished,
+                              void *buffer,
+                              size_t buffer_length);
+
+static avs_error_t feed_reserve(pipeline_t *pipeline, size_t index) {
+    pipeline_stage_t *stage = &pipeline->stages[index];
+    void *space;
+    size_t space_size;
+    size_t bytes_read;
+    avs_error_t err = avs_stream_reserve(stage->stream, pipeline->buffer_size,
+                                         &space, &space_size);
+    if (avs_is_err(err)) {
+        return err;
+    } else if (!space_size) {
+        /* only possible if the filter's output needs to be read first */
+        return avs_errno(AVS_ENOBUFS);
+    }
+    if (avs_is_err((err = stage_read(pipeline, index - 1, &bytes_read,
+                                     &stage->input_finished, space,
+                                     space_size)))) {
+        return err;
+    }
+    return avs_stream_commit(stage->stream, bytes_read);
+}
+
+static avs_error_t feed_peek(pipeline_t *pipeline, size_t index) {
+    assert(index == 1);
+    pipeline_stage_t *stage = &pipeline->stages[index];
+    avs_stream_t *source = pipeline->stages[0].stream;
+    const void *data;
+    size_t size;
+    bool message_finished;
+    avs_error_t err = avs_stream_peek_contiguous(source, &data, &size,
+                                                 &message_finished);
+    if (avs_is_err(err)) {
+        return err;
+    }
+    size_t bytes_written = size;
+    if (size
+            && (avs_is_err((err = avs_stream_write_some(
+                                    stage->stream, data, &bytes_written)))
+                || avs_is_err((err = avs_stream_consume(source,
+                                                        bytes_written))))) {
+        return err;
+    }
+    if (size && !bytes_written) {
+        return avs_errno(AVS_ENOBUFS);
+    }
+    /* message_finished refers to the state after consuming all the data */
+    stage->input_finished = (message_finished && bytes_written == size);
+    return AVS_OK;
+}
+
+static avs_error_t feed_buffer(pipeline_t *pipeline, size_t index) {
+    pipeline_stage_t *stage = &pipeline->stages[index];
+    avs_error_t err;
+    if (stage->buffer_begin == stage->buffer_end) {
+        size_t bytes_read;
+        if (avs_is_err((err = stage_read(pipeline, index - 1, &bytes_read,
+                                         &stage->input_finished, stage->buffer,
+                                         pipeline->buffer_size)))) {
+            return err;
+        }
+        stage->buffer_begin = 0;
+        stage->buffer_end = bytes_read;
+    }
+    size_t bytes_to_write = stage->buffer_end - stage->buffer_begin;
+    size_t bytes_written = bytes_to_write;
+    if (!bytes_to_write
+            || avs_is_err((err = avs_stream_write_some(
+                                   stage->stream,
+                                   stage->buffer + stage->buffer_begin,
+                                   &bytes_written)))) {
+        return err;
+    }
+    stage->buffer_begin += bytes_written;
+    return bytes_written ? AVS_OK : avs_errno(AVS_ENOBUFS);
+}
+
+/* Passes some data from stage index - 1 to stage index. */
+static avs_error_t feed_stage(pipeline_t *pipeline, size_t index) {
+    assert(index > 0 && index < pipeline->stage_count);
+    pipeline_stage_t *stage = &pipeline->stages[index];
+    if (stage->input_finished && stage->buffer_begin == stage->buffer_end) {
+        if (stage->finish_sent) {
+            LOG(ERROR,
+                _("filter ") "%u" _(" did not finish the message after end of "
+                                    "input"),
+                (unsigned) (index - 1));
+            return avs_errno(AVS_EIO);
+        }
+        stage->finish_sent = true;
+        return avs_stream_finish_message(stage->stream);
+    }
+    switch (stage->feed_mode) {
+    case FEED_RESERVE:
+        return feed_reserve(pipeline, index);
+    case FEED_PEEK:
+        return feed_peek(pipeline, index);
+    case FEED_BUFFER:
+        return feed_buffer(pipeline, index);
+    default:
+        AVS_UNREACHABLE("invalid feed mode");
+        return avs_errno(AVS_EINVAL);
+    }
+}
+
+static avs_error_t stage_read(pipeline_t *pipeline,
+                              size_t index,
+                              size_t *out_bytes_read,
+                              bool *out_message_finished,
+                              void *buffer,
+                              size_t buffer_length) {
+    while (true) {
+        avs_error_t err =
+                avs_stream_read(pipeline->stages[index].stream, out_bytes_read,
+                                out_message_finished, buffer, buffer_length);
+        if (avs_is_err(err) || *out_bytes_read || *out_message_finished
+                || !index) {
+            return err;
+        }
+        if (avs_is_err((err = feed_stage(pipeline, index)))) {
+            return err;
+        }
+    }
+}
+
+static avs_error_t pipeline_read(avs_stream_t *stream_,
+                                 size_t *out_bytes_read,
+                                 bool *out_message_finished,
+                                 void *buffer,
+                                 size_t buffer_length) {
+    pipeline_t *pipeline = (pipeline_t *) stream_;
+    size_t bytes_read;
+    bool message_finished;
+    return stage_read(pipeline, pipeline->stage_count - 1,
+                      out_bytes_read ? out_bytes_read : &bytes_read,
+                      out_message_finished ? out_message_finished
+                                           : &message_finished,
+                      buffer, buffer_length);
+}
+
+static bool input_exhausted(pipeline_t *pipeline) {
+    const pipeline_stage_t *last =
+            &pipeline->stages[pipeline->stage_count - 1];
+    return last->finish_sent;
+}
+
+static avs_error_t
+pipeline_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
+    pipeline_t *pipeline = (pipeline_t *) stream_;
+    avs_stream_t *last = pipeline->stages[pipeline->stage_count - 1].stream;
+    avs_error_t err;
+    while (avs_is_eof((err = avs_stream_peek(last, offset, out_value)))
+           && !input_exhausted(pipeline)) {
+        if (avs_is_err((err = feed_stage(pipeline,
+                                         pipeline->stage_count - 1)))) {
+            break;
+        }
+    }
+    return err;
+}
+
+static bool has_buffered_input(pipeline_t *pipeline) {
+    for (size_t i = 1; i < pipeline->stage_count; ++i) {
+        const pipeline_stage_t *stage = &pipeline->stages[i];
+        if (stage->buffer_begin != stage->buffer_end
+                || (stage->input_finished && !stage->finish_sent)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool pipeline_nonblock_read_ready(avs_stream_t *stream_) {
+    pipeline_t *pipeline = (pipeline_t *) stream_;
+    avs_stream_t *last = pipeline->stages[pipeline->stage_count - 1].stream;
+    avs_error_t err;
+    while (avs_is_eof((err = avs_stream_peek(last, 0, &(char) { 0 })))) {
+        if (input_exhausted(pipeline)) {
+            /* end of message can be read without blocking */
+            return true;
+        }
+        if (!has_buffered_input(pipeline)
+                && !avs_stream_nonblock_read_ready(
+                           pipeline->stages[0].stream)) {
+            return false;
+        }
+        if (avs_is_err(feed_stage(pipeline, pipeline->stage_count - 1))) {
+            return false;
+        }
+    }
+    return avs_is_ok(err);
+}
+
+static avs_error_t pipeline_close(avs_stream_t *stream_) {
+    pipeline_t *pipeline = (pipeline_t *) stream_;
+    avs_error_t err = AVS_OK;
+    for (size_t i = pipeline->stage_count; i-- > 0;) {
+        avs_error_t stage_err = avs_stream_cleanup(&pipeline->stages[i].stream);
+        if (avs_is_err(stage_err)) {
+            LOG(ERROR, _("failed to close pipeline stage ") "%u",
+                (unsigned) i);
+            if (avs_is_ok(err)) {
+                err = stage_err;
+            }
+        }
+    }
+    return err;
+}
+
+static const avs_stream_v_table_t pipeline_vtable = {
+    .read = pipeline_read,
+    .peek = pipeline_peek,
+    .close = pipeline_close,
+    .extension_list =
+            (const avs_stream_v_table_extension_t[]) {
+                    { AVS_STREAM_V_TABLE_EXTENSION_NONBLOCK,
+                      &(const avs_stream_v_table_extension_nonblock_t) {
+                              .read_ready = pipeline_nonblock_read_ready } },
+                    AVS_STREAM_V_TABLE_EXTENSION_NULL }
+};
+
+static feed_mode_t select_feed_mode(size_t index,
+                                    avs_stream_t *previous,
+                                    avs_stream_t *stream) {
+    const avs_stream_v_table_extension_zerocopy_t *stream_zerocopy =
+            (const avs_stream_v_table_extension_zerocopy_t *)
+                    avs_stream_v_table_find_extension(
+                            stream, AVS_STREAM_V_TABLE_EXTENSION_ZEROCOPY);
+    if (stream_zerocopy && stream_zerocopy->reserve
+            && stream_zerocopy->commit) {
+        return FEED_RESERVE;
+    }
+    /* Filters never fetch data on their own, so peek_contiguous() would not
+     * work as expected on them - only the source may be peeked. */
+    const avs_stream_v_table_extension_zerocopy_t *previous_zerocopy =
+            (const avs_stream_v_table_extension_zerocopy_t *)
+                    avs_stream_v_table_find_extension(
+                            previous, AVS_STREAM_V_TABLE_EXTENSION_ZEROCOPY);
+    if (index == 1 && previous_zerocopy && previous_zerocopy->peek_contiguous
+            && previous_zerocopy->consume) {
+        return FEED_PEEK;
+    }
+    return FEED_BUFFER;
+}
+
+avs_stream_t *avs_stream_pipeline_create(avs_stream_t *source,
+                                         avs_stream_t *const *filters,
+                                         size_t filter_count,
+                                         size_t buffer_size) {
+    assert(source);
+    if (!filter_count || filter_count >= SIZE_MAX / sizeof(pipeline_stage_t)) {
+        LOG(ERROR, _("invalid number of filters"));
+        return NULL;
+    }
+    const size_t stage_count = filter_count + 1;
+    size_t buffer_count = 0;
+    for (size_t i = 1; i < stage_count; ++i) {
+        assert(filters[i - 1]);
+        if (select_feed_mode(i, i > 1 ? filters[i - 2] : source,
+                             filters[i - 1])
+                == FEED_BUFFER) {
+            ++buffer_count;
+        }
+    }
+    if (buffer_count && !buffer_size) {
+        LOG(ERROR, _("intermediate buffer size cannot be zero"));
+        return NULL;
+    }
+
+    size_t stages_size = stage_count * sizeof(pipeline_stage_t);
+    size_t header_size = sizeof(pipeline_t) + stages_size;
+    if (buffer_count && buffer_size > (SIZE_MAX - header_size) / buffer_count) {
+        LOG(ERROR, _("intermediate buffers too large"));
+        return NULL;
+    }
+    pipeline_t *pipeline = (pipeline_t *) avs_calloc(
+            1, header_size + buffer_count * buffer_size);
+    if (!pipeline) {
+        LOG(ERROR, _("out of memory"));
+        return NULL;
+    }
+    *(const avs_stream_v_table_t **) (intptr_t) &pipeline->vtable =
+            &pipeline_vtable;
+    pipeline->buffer_size = buffer_size;
+    pipeline->stage_count = stage_count;
+
+    char *next_buffer = (char *) pipeline + header_size;
+    for (size_t i = 0; i < stage_count; ++i) {
+        pipeline_stage_t *stage = &pipeline->stages[i];
+        if (i) {
+            stage->stream = filters[i - 1];
+            stage->feed_mode = select_feed_mode(
+                    i, pipeline->stages[i - 1].stream, stage->stream);
+        } else {
+            stage->stream = source;
+            stage->feed_mode = FEED_NONE;
+        }
+        if (stage->feed_mode == FEED_BUFFER) {
+            stage->buffer = next_buffer;
+            next_buffer += buffer_size;
+        }
+    }
+    return (avs_stream_t *) pipeline;
+}
+
+#    ifdef AVS_UNIT_TESTING
+#        include "tests/stream/test_stream_pipeline.c"
+#    endif
+
+#endif // AVS_COMMONS_WITH_AVS_STREAM
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#ifdef AVS_COMMONS_WITH_AVS_STREAM
+
+#    include <stddef.h>
+#    include <stdint.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_stream_tee.h>
+#    include <avsystem/commons/avs_stream_v_table.h>
+
+#    define MODULE_NAME avs_stream
+#    include <avs_x_log_config.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+typedef struct {
+    const avs_stream_v_table_t *const vtable;
+    size_t sink_count;
+    avs_stream_t *sinks[];
+} tee_stream_t;
+
+static avs_error_t tee_write_some(avs_stream_t *stream_,
+                                  const void *buffer,
+                                  size_t *inout_data_length) {
+    tee_stream_t *stream = (tee_stream_t *) stream_;
+    avs_error_t err = avs_stream_write_some(stream->sinks[0], buffer,
+                                            inout_data_length);
+    for (size_t i = 1; avs_is_ok(err) && i < stream->sink_count; ++i) {
+        err = avs_stream_write(stream->sinks[i], buffer, *inout_data_length);
+    }
+    return err;
+}
+
+static avs_error_t tee_writev(avs_stream_t *stream_,
+                              const avs_stream_const_iovec_t *iov,
+                              size_t iov_count) {
+    tee_stream_t *stream = (tee_stream_t *) stream_;
+    avs_error_t err = AVS_OK;
+    for (size_t i = 0; i < stream->sink_count; ++i) {
+        avs_error_t sink_err =
+                avs_stream_writev(stream->sinks[i], iov, iov_count);
+        if (avs_is_ok(err)) {
+            err = sink_err;
+        }
+    }
+    return err;
+}
+
+static avs_error_t tee_finish_message(avs_stream_t *stream_) {
+    tee_stream_t *stream = (tee_stream_t *) stream_;
+    avs_error_t err = AVS_OK;
+    for (size_t i = 0; i < stream->sink_count; ++i) {
+        avs_error_t sink_err = avs_stream_finish_message(stream->sinks[i]);
+        if (avs_is_ok(err)) {
+            err = sink_err;
+        }
+    }
+    return err;
+}
+
+static avs_error_t tee_reset(avs_stream_t *stream_) {
+    tee_stream_t *stream = (tee_stream_t *) stream_;
+    avs_error_t err = AVS_OK;
+    for (size_t i = 0; i < stream->sink_count; ++i) {
+        avs_error_t sink_err = avs_stream_reset(stream->sinks[i]);
+        if (avs_is_ok(err)) {
+            err = sink_err;
+        }
+    }
+    return err;
+}
+
+static const avs_stream_v_table_t tee_vtable = {
+    .write_some = tee_write_some,
+    .finish_message = tee_finish_message,
+    .reset = tee_reset,
+    .extension_list =
+            (const avs_stream_v_table_extension_t[]) {
+                    { AVS_STREAM_V_TABLE_EXTENSION_VECTORED,
+                      &(const avs_stream_v_table_extension_vectored_t) {
+                              .writev = tee_writev } },
+                    AVS_STREAM_V_TABLE_EXTENSION_NULL }
+};
+
+avs_stream_t *avs_stream_tee_create(avs_stream_t *const *sinks,
+                                    size_t sink_count) {
+    if (!sink_count) {
+        LOG(ERROR, _("at least one sink is required"));
+        return NULL;
+    }
+    if (sink_count > (SIZE_MAX - offsetof(tee_stream_t, sinks))
+                             / sizeof(*sinks)) {
+        LOG(ERROR, _("too many sinks"));
+        return NULL;
+    }
+    tee_stream_t *stream = (tee_stream_t *) avs_calloc(
+            1, offsetof(tee_stream_t, sinks) + sink_count * sizeof(*sinks));
+    if (!stream) {
+        LOG(ERROR, _("out of memory"));
+        return NULL;
+    }
+    *(const avs_stream_v_table_t **) (intptr_t) &stream->vtable = &tee_vtable;
+    stream->sink_count = sink_count;
+    memcpy(stream->sinks, sinks, sink_count * sizeof(*sinks));
+    return (avs_stream_t *) stream;
+}
+
+#    ifdef AVS_UNIT_TESTING
+#        include "tests/stream/test_stream_tee.c"
+#    endif
+
+#endif // AVS_COMMONS_WITH_AVS_STREAM
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/avs_commons_config.h>
+
+#if defined(AVS_COMMONS_WITH_AVS_STREAM) \
+        && defined(AVS_COMMONS_STREAM_WITH_SENDFILE)
+
+#    include <avs_commons_posix_init.h>
+
+#    include <errno.h>
+
+#    include <sys/sendfile.h>
+
+#    include <avsystem/commons/avs_errno_map.h>
+
+#    include "../../avs_stream_fd_transfer.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+/* Linux never transfers more than this in a single sendfile() call */
+#    define MAX_SENDFILE_CHUNK 0x7ffff000
+
+/* How long to wait for a non-blocking output descriptor (e.g. a socket) to
+ * become writable; the same as the send timeout of avs_net sockets */
+#    define WRITE_TIMEOUT_MS 30000
+
+static avs_error_t errno_to_error(void) {
+    if (errno == EINVAL || errno == ENOSYS || errno == ESPIPE) {
+        // sendfile() does not support this kind of descriptors
+        return avs_errno(AVS_ENOTSUP);
+    }
+    avs_errno_t err = avs_map_errno(errno);
+    return avs_errno(err ? err : AVS_UNKNOWN_ERROR);
+}
+
+avs_error_t _avs_stream_fd_transfer(int out_fd,
+                                    avs_off_t out_offset,
+                                    int in_fd,
+                                    avs_off_t in_offset,
+                                    size_t max_length,
+                                    size_t *out_transferred) {
+    *out_transferred = 0;
+    if (out_offset >= 0 && lseek(out_fd, (off_t) out_offset, SEEK_SET) < 0) {
+        return errno_to_error();
+    }
+    off_t offset = (off_t) in_offset;
+    ssize_t result;
+    while ((result = sendfile(out_fd, in_fd, in_offset >= 0 ? &offset : NULL,
+                              AVS_MIN(max_length, MAX_SENDFILE_CHUNK)))
+           < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            struct pollfd pollfd = {
+                .fd = out_fd,
+                .events = POLLOUT
+            };
+            int poll_result;
+            do {
+                poll_result = poll(&pollfd, 1, WRITE_TIMEOUT_MS);
+            } while (poll_result < 0 && errno == EINTR);
+            if (poll_result == 0) {
+                return avs_errno(AVS_ETIMEDOUT);
+            } else if (poll_result < 0) {
+                return errno_to_error();
+            }
+        } else if (errno != EINTR) {
+            return errno_to_error();
+        }
+    }
+    *out_transferred = (size_t) result;
+    return AVS_OK;
+}
+
+#endif // defined(AVS_COMMONS_WITH_AVS_STREAM) &&
+       // defined(AVS_COMMONS_STREAM_WITH_SENDFILE)
@@ -0,0 +1,599 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/avs_commons_config.h>
+
+#if defined(AVS_COMMONS_WITH_AVS_STREAM) \
+        && defined(AVS_COMMONS_STREAM_WITH_FILE) \
+        && defined(AVS_COMMONS_STREAM_WITH_FILE_FD)
+
+#    define _GNU_SOURCE // for O_DIRECT
+
+#    include <avs_commons_posix_init.h>
+
+#    include <errno.h>
+#    include <stdint.h>
+#    include <string.h>
+
+#    include <sys/stat.h>
+
+#    include <avsystem/commons/avs_errno_map.h>
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_stream_file.h>
+#    include <avsystem/commons/avs_stream_v_table.h>
+
+#    define MODULE_NAME avs_stream
+#    include <avs_x_log_config.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+/* used if the file system does not report its preferred alignment */
+#    define DEFAULT_DIRECT_IO_ALIGNMENT 4096
+#    define MIN_DIRECT_IO_ALIGNMENT 512
+
+typedef struct {
+    const avs_stream_v_table_t *const vtable;
+    int fd;
+    uint8_t mode;
+    bool direct_io;
+    bool sync_on_finish;
+    /* set after a read returned less data than requested; cleared by seeking,
+     * just like the stdio end-of-file indicator */
+    bool eof;
+    /* memory block that contains the buffer, possibly larger than
+     * buffer_size to allow for aligning it */
+    void *allocated_buffer;
+    char *buffer;
+    size_t buffer_size;
+    /* 1 if direct_io is not used */
+    size_t alignment;
+    /* file offset that corresponds to buffer[0]; always a multiple of
+     * alignment */
+    avs_off_t buffer_offset;
+    /* number of valid bytes in buffer - read from the file in read mode,
+     * or not yet written to the file in write mode */
+    size_t buffer_fill;
+    /* read mode only: position of the cursor relative to buffer[0]; may be
+     * larger than buffer_fill after seeking */
+    size_t read_pos;
+    /* write mode only: end of the data written so far, including buffer */
+    avs_off_t data_end;
+    avs_off_t preallocated_length;
+} fd_file_stream_t;
+
+static avs_error_t errno_to_error(void) {
+    avs_errno_t err = avs_map_errno(errno);
+    return avs_errno(err ? err : AVS_UNKNOWN_ERROR);
+}
+
+static size_t round_down(size_t value, size_t alignment) {
+    return value / alignment * alignment;
+}
+
+static avs_error_t
+pwrite_all(int fd, const char *data, size_t size, avs_off_t offset) {
+    while (size) {
+        ssize_t result = pwrite(fd, data, size, (off_t) offset);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno_to_error();
+        }
+        data += result;
+        size -= (size_t) result;
+        offset += (avs_off_t) result;
+    }
+    return AVS_OK;
+}
+
+/* A short read means end of file - note that with O_DIRECT, a read that would
+ * continue from an unaligned offset is not even possible. */
+static avs_error_t pread_once(int fd,
+                              char *data,
+                              size_t size,
+                              avs_off_t offset,
+                              size_t *out_bytes_read) {
+    ssize_t result;
+    do {
+        result = pread(fd, data, size, (off_t) offset);
+    } while (result < 0 && errno == EINTR);
+    if (result < 0) {
+        return errno_to_error();
+    }
+    *out_bytes_read = (size_t) result;
+    return AVS_OK;
+}
+
+static avs_error_t sync_data(int fd) {
+#    if defined(_POSIX_SYNCHRONIZED_IO) && _POSIX_SYNCHRONIZED_IO > 0
+    int result = fdatasync(fd);
+#    else  // defined(_POSIX_SYNCHRONIZED_IO) && _POSIX_SYNCHRONIZED_IO > 0
+    int result = fsync(fd);
+#    endif // defined(_POSIX_SYNCHRONIZED_IO) && _POSIX_SYNCHRONIZED_IO > 0
+    return result ? errno_to_error() : AVS_OK;
+}
+
+#    ifdef O_DIRECT
+/* Direct I/O can only transfer whole blocks, so the final part of the file is
+ * written through the page cache instead. */
+static avs_error_t write_unaligned_tail(fd_file_stream_t *stream) {
+    int flags = fcntl(stream->fd, F_GETFL);
+    if (flags < 0 || fcntl(stream->fd, F_SETFL, flags & ~O_DIRECT)) {
+        return errno_to_error();
+    }
+    avs_error_t err = pwrite_all(stream->fd, stream->buffer,
+                                 stream->buffer_fill, stream->buffer_offset);
+    if (fcntl(stream->fd, F_SETFL, flags) && avs_is_ok(err)) {
+        err = errno_to_error();
+    }
+    return err;
+}
+#    endif // O_DIRECT
+
+/* Writes out the buffered data. With direct I/O, an incomplete block at the
+ * end is kept in the buffer, so that it can be rewritten as a whole once more
+ * data arrives; if final is true, it is additionally written through the page
+ * cache, so that the file contents are complete. */
+static avs_error_t flush_buffer(fd_file_stream_t *stream, bool final) {
+    size_t aligned = round_down(stream->buffer_fill, stream->alignment);
+    avs_error_t err = pwrite_all(stream->fd, stream->buffer, aligned,
+                                 stream->buffer_offset);
+    if (avs_is_err(err)) {
+        return err;
+    }
+    stream->buffer_fill -= aligned;
+    memmove(stream->buffer, stream->buffer + aligned, stream->buffer_fill);
+    stream->buffer_offset += (avs_off_t) aligned;
+#    ifdef O_DIRECT
+    if (final && stream->buffer_fill) {
+        err = write_unaligned_tail(stream);
+    }
+#    else  // O_DIRECT
+    (void) final;
+#    endif // O_DIRECT
+    return err;
+}
+
+static avs_error_t stream_fd_write_some(avs_stream_t *stream_,
+                                        const void *buffer,
+                                        size_t *inout_data_length) {
+    fd_file_stream_t *stream = (fd_file_stream_t *) stream_;
+    if (!(stream->mode & AVS_STREAM_FILE_WRITE)) {
+        return avs_errno(AVS_EBADF);
+    }
+    const char *data = (const char *) buffer;
+    size_t left = *inout_data_length;
+    avs_error_t err = AVS_OK;
+    while (avs_is_ok(err) && left) {
+        if (!stream->direct_io && !stream->buffer_fill
+                && left >= stream->buffer_size) {
+            // the block would fill the whole buffer anyway
+            if (avs_is_ok((err = pwrite_all(stream->fd, data, left,
+                                            stream->buffer_offset)))) {
+                stream->buffer_offset += (avs_off_t) left;
+                left = 0;
+            }
+        } else {
+            size_t chunk =
+                    AVS_MIN(left, stream->buffer_size - stream->buffer_fill);
+            memcpy(stream->buffer + stream->buffer_fill, data, chunk);
+            stream->buffer_fill += chunk;
+            data += chunk;
+            left -= chunk;
+            if (stream->buffer_fill == stream->buffer_size) {
+                err = flush_buffer(stream, false);
+            }
+        }
+    }
+    stream->data_end =
+            AVS_MAX(stream->data_end,
+                    stream->buffer_offset + (avs_off_t) stream->buffer_fill);
+    *inout_data_length -= left;
+    return err;
+}
+
+static avs_error_t stream_fd_finish_message(avs_stream_t *stream_) {
+    fd_file_stream_t *stream = (fd_file_stream_t *) stream_;
+    if (!(stream->mode & AVS_STREAM_FILE_WRITE)) {
+        return AVS_OK;
+    }
+    avs_error_t err = flush_buffer(stream, true);
+    if (avs_is_ok(err) && stream->sync_on_finish) {
+        err = sync_data(stream->fd);
+    }
+    return err;
+}
+
+static size_t bytes_buffered(const fd_file_stream_t *stream) {
+    return stream->read_pos < stream->buffer_fill
+                   ? stream->buffer_fill - stream->read_pos
+                   : 0;
+}
+
+/* Drops the data before the read cursor, and fills the rest of the buffer with
+ * data read from the file. */
+static avs_error_t read_more(fd_file_stream_t *stream) {
+    // after a short read, only whole blocks may be kept with direct I/O
+    stream->buffer_fill = round_down(stream->buffer_fill, stream->alignment);
+    size_t discard = round_down(AVS_MIN(stream->read_pos, stream->buffer_fill),
+                                stream->alignment);
+    stream->buffer_fill -= discard;
+    memmove(stream->buffer, stream->buffer + discard, stream->buffer_fill);
+    stream->buffer_offset += (avs_off_t) discard;
+    stream->read_pos -= discard;
+
+    size_t space = stream->buffer_size - stream->buffer_fill;
+    size_t bytes_read;
+    avs_error_t err = AVS_OK;
+    if (space
+            && avs_is_ok((err = pread_once(
+                                  stream->fd,
+                                  stream->buffer + stream->buffer_fill, space,
+                                  stream->buffer_offset
+                                          + (avs_off_t) stream->buffer_fill,
+                                  &bytes_read)))) {
+        stream->eof = (bytes_read < space);
+        stream->buffer_fill += bytes_read;
+    }
+    return err;
+}
+
+static avs_error_t stream_fd_read(avs_stream_t *stream_,
+                                  size_t *out_bytes_read,
+                                  bool *out_message_finished,
+                                  void *buffer,
+                                  size_t buffer_length) {
+    fd_file_stream_t *stream = (fd_file_stream_t *) stream_;
+    if (!(stream->mode & AVS_STREAM_FILE_READ)) {
+        return avs_errno(AVS_EBADF);
+    }
+    char *out = (char *) buffer;
+    size_t total = 0;
+    avs_error_t err = AVS_OK;
+    while (avs_is_ok(err) && total < buffer_length) {
+        size_t available = bytes_buffered(stream);
+        if (available) {
+            size_t chunk = AVS_MIN(available, buffer_length - total);
+            memcpy(out + total, stream->buffer + stream->read_pos, chunk);
+            stream->read_pos += chunk;
+            total += chunk;
+        } else if (stream->eof) {
+            break;
+        } else if (!stream->direct_io
+                   && buffer_length - total >= stream->buffer_size) {
+            // read large blocks straight into the caller's buffer
+            avs_off_t offset =
+                    stream->buffer_offset + (avs_off_t) stream->read_pos;
+            size_t bytes_read;
+            if (avs_is_ok((err = pread_once(stream->fd, out + total,
+                                            buffer_length - total, offset,
+                                            &bytes_read)))) {
+                stream->eof = (bytes_read < buffer_length - total);
+                stream->buffer_offset = offset + (avs_off_t) bytes_read;
+                stream->buffer_fill = 0;
+                stream->read_pos = 0;
+                total += bytes_read;
+            }
+        } else {
+            err = read_more(stream);
+        }
+    }
+    if (out_bytes_read) {
+        *out_bytes_read = total;
+    }
+    if (out_message_finished) {
+        *out_message_finished = stream->eof && !bytes_buffered(stream);
+    }
+    return err;
+}
+
+static avs_error_t
+stream_fd_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
+    fd_file_stream_t *stream = (fd_file_stream_t *) stream_;
+    if (!(stream->mode & AVS_STREAM_FILE_READ)) {
+        return avs_errno(AVS_EBADF);
+    }
+    while (offset >= bytes_buffered(stream)) {
+        if (stream->eof) {
+            return AVS_EOF;
+        }
+        size_t available = bytes_buffered(stream);
+        avs_error_t err = read_more(stream);
+        if (avs_is_err(err)) {
+            return err;
+        }
+        if (!stream->eof && bytes_buffered(stream) <= available) {
+            LOG(ERROR, _("cannot peek - offset exceeds the buffer size"));
+            return avs_errno(AVS_ENOBUFS);
+        }
+    }
+    *out_value = stream->buffer[stream->read_pos + offset];
+    return AVS_OK;
+}
+
+static avs_error_t stream_fd_offset(avs_stream_t *stream_,
+                                    avs_off_t *out_offset) {
+    fd_file_stream_t *stream = (fd_file_stream_t *) stream_;
+    *out_offset = stream->buffer_offset
+                  + (avs_off_t) ((stream->mode & AVS_STREAM_FILE_WRITE)
+                                         ? stream->buffer_fill
+                                         : stream->read_pos);
+    return AVS_OK;
+}
+
+static avs_error_t stream_fd_seek(avs_stream_t *stream_,
+                                  avs_off_t offset_from_start) {
+    fd_file_stream_t *stream = (fd_file_stream_t *) stream_;
+    if (offset_from_start < 0) {
+        return avs_errno(AVS_ERANGE);
+    }
+    if (stream->mode & AVS_STREAM_FILE_WRITE) {
+        if ((size_t) offset_from_start % stream->alignment) {
+            LOG(ERROR, _("cannot seek to an unaligned offset with direct I/O"));
+            return avs_errno(AVS_EINVAL);
+        }
+        avs_error_t err = flush_buffer(stream, true);
+        if (avs_is_err(err)) {
+            return err;
+        }
+        stream->buffer_fill = 0;
+        stream->buffer_offset = offset_from_start;
+    } else if (offset_from_start >= stream->buffer_offset
+               && offset_from_start - stream->buffer_offset
+                          <= (avs_off_t) stream->buffer_fill) {
+        stream->read_pos =
+                (size_t) (offset_from_start - stream->buffer_offset);
+    } else {
+        stream->buffer_offset = (avs_off_t) round_down(
+                (size_t) offset_from_start, stream->alignment);
+        stream->buffer_fill = 0;
+        stream->read_pos =
+                (size_t) (offset_from_start - stream->buffer_offset);
+    }
+    stream->eof = false;
+    return AVS_OK;
+}
+
+static avs_error_t stream_fd_length(avs_stream_t *stream_,
+                                    avs_off_t *out_length) {
+    fd_file_stream_t *stream = (fd_file_stream_t *) stream_;
+    if (stream->mode & AVS_STREAM_FILE_WRITE) {
+        // the file may have been preallocated, so its size is not reliable
+        *out_length = stream->data_end;
+        return AVS_OK;
+    }
+    struct stat st;
+    if (fstat(stream->fd, &st)) {
+        return errno_to_error();
+    }
+    *out_length = (avs_off_t) st.st_size;
+    return AVS_OK;
+}
+
+static avs_error_t stream_fd_get_fd(avs_stream_t *stream_,
+                                    bool for_writing,
+                                    int *out_fd,
+                                    avs_off_t *out_offset) {
+    fd_file_stream_t *stream = (fd_file_stream_t *) stream_;
+    if (!(stream->mode
+          & (for_writing ? AVS_STREAM_FILE_WRITE : AVS_STREAM_FILE_READ))) {
+        return avs_errno(AVS_EBADF);
+    }
+    if (stream->direct_io) {
+        // transfers would not be aligned
+        return avs_errno(AVS_ENOTSUP);
+    }
+    if (for_writing) {
+        avs_error_t err = flush_buffer(stream, true);
+        if (avs_is_err(err)) {
+            return err;
+        }
+    }
+    *out_fd = stream->fd;
+    return stream_fd_offset(stream_, out_offset);
+}
+
+static avs_error_t
+stream_fd_advance(avs_stream_t *stream_, bool for_writing, size_t length) {
+    fd_file_stream_t *stream = (fd_file_stream_t *) stream_;
+    avs_off_t offset;
+    avs_error_t err = stream_fd_offset(stream_, &offset);
+    if (avs_is_err(err)) {
+        return err;
+    }
+    if (!for_writing) {
+        return stream_fd_seek(stream_, offset + (avs_off_t) length);
+    }
+    // get_fd flushed the buffer, so there is nothing to keep in it
+    stream->buffer_offset = offset + (avs_off_t) length;
+    stream->data_end = AVS_MAX(stream->data_end, stream->buffer_offset);
+    return AVS_OK;
+}
+
+static avs_error_t stream_fd_reset(avs_stream_t *stream) {
+    return stream_fd_seek(stream, 0);
+}
+
+static avs_error_t stream_fd_close(avs_stream_t *stream_) {
+    fd_file_stream_t *stream = (fd_file_stream_t *) stream_;
+    avs_error_t err = AVS_OK;
+    if (stream->mode & AVS_STREAM_FILE_WRITE) {
+        err = flush_buffer(stream, true);
+        if (avs_is_ok(err) && stream->preallocated_length > stream->data_end
+                && ftruncate(stream->fd, (off_t) stream->data_end)) {
+            err = errno_to_error();
+        }
+        if (avs_is_ok(err) && stream->sync_on_finish) {
+            err = sync_data(stream->fd);
+        }
+    }
+    if (close(stream->fd) && avs_is_ok(err)) {
+        err = errno_to_error();
+    }
+    avs_free(stream->allocated_buffer);
+    return err;
+}
+
+static const avs_stream_v_table_t fd_file_stream_vtable = {
+    .write_some = stream_fd_write_some,
+    .finish_message = stream_fd_finish_message,
+    .read = stream_fd_read,
+    .peek = stream_fd_peek,
+    .reset = stream_fd_reset,
+    .close = stream_fd_close,
+    .extension_list =
+            (const avs_stream_v_table_extension_t[]) {
+                    { AVS_STREAM_V_TABLE_EXTENSION_OFFSET,
+                      &(const avs_stream_v_table_extension_offset_t) {
+                              stream_fd_offset } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_FILE,
+                      &(const avs_stream_v_table_extension_file_t) {
+                              stream_fd_length, stream_fd_seek } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_FD,
+                      &(const avs_stream_v_table_extension_fd_t) {
+                              stream_fd_get_fd, stream_fd_advance } },
+                    AVS_STREAM_V_TABLE_EXTENSION_NULL }
+};
+
+static int open_file(const char *path, int flags, bool *inout_direct_io) {
+#    ifdef O_DIRECT
+    if (*inout_direct_io) {
+        int fd = open(path, flags | O_DIRECT, 0666);
+        if (fd >= 0 || errno != EINVAL) {
+            return fd;
+        }
+        LOG(WARNING,
+            _("direct I/O not supported for ") "%s" _(", using buffered I/O"),
+            path);
+    }
+#    else  // O_DIRECT
+    if (*inout_direct_io) {
+        LOG(WARNING, _("direct I/O not supported on this platform"));
+    }
+#    endif // O_DIRECT
+    *inout_direct_io = false;
+    return open(path, flags, 0666);
+}
+
+static size_t direct_io_alignment(int fd) {
+    long result = -1;
+#    ifdef _PC_REC_XFER_ALIGN
+    result = fpathconf(fd, _PC_REC_XFER_ALIGN);
+#    else  // _PC_REC_XFER_ALIGN
+    (void) fd;
+#    endif // _PC_REC_XFER_ALIGN
+    if (result <= 0) {
+        return DEFAULT_DIRECT_IO_ALIGNMENT;
+    }
+    return AVS_MAX((size_t) result, MIN_DIRECT_IO_ALIGNMENT);
+}
+
+static int allocate_buffer(fd_file_stream_t *stream, size_t requested_size) {
+    if (!requested_size) {
+        requested_size = AVS_STREAM_FILE_FD_DEFAULT_BUFFER_SIZE;
+    }
+    if (requested_size > SIZE_MAX - 2 * stream->alignment) {
+        return -1;
+    }
+    stream->buffer_size = round_down(requested_size + stream->alignment - 1,
+                                     stream->alignment);
+    if (!(stream->allocated_buffer = avs_malloc(stream->buffer_size
+                                                + stream->alignment - 1))) {
+        return -1;
+    }
+    uintptr_t misalignment =
+            (uintptr_t) stream->allocated_buffer % stream->alignment;
+    stream->buffer = (char *) stream->allocated_buffer
+                     + (misalignment ? stream->alignment - misalignment : 0);
+    return 0;
+}
+
+static void preallocate(fd_file_stream_t *stream, avs_off_t length) {
+#    if defined(_POSIX_ADVISORY_INFO) && _POSIX_ADVISORY_INFO > 0
+    // posix_fallocate() returns the error code instead of setting errno
+    int result = posix_fallocate(stream->fd, 0, (off_t) length);
+    if (result) {
+        LOG(WARNING, _("could not preallocate file, error ") "%d", result);
+    } else {
+        stream->preallocated_length = length;
+    }
+#    else  // defined(_POSIX_ADVISORY_INFO) && _POSIX_ADVISORY_INFO > 0
+    (void) stream;
+    (void) length;
+    LOG(DEBUG, _("file preallocation not supported on this platform"));
+#    endif // defined(_POSIX_ADVISORY_INFO) && _POSIX_ADVISORY_INFO > 0
+}
+
+avs_stream_t *
+avs_stream_file_create_fd(const char *path,
+                          uint8_t mode,
+                          const avs_stream_file_fd_config_t *config) {
+    static const avs_stream_file_fd_config_t DEFAULT_CONFIG = { 0 };
+    if (!config) {
+        config = &DEFAULT_CONFIG;
+    }
+    int flags;
+    if (mode == AVS_STREAM_FILE_READ) {
+        flags = O_RDONLY;
+    } else if (mode == AVS_STREAM_FILE_WRITE) {
+        flags = O_WRONLY | O_CREAT | O_TRUNC;
+    } else {
+        LOG(ERROR, _("unsupported file stream mode: ") "%d", (int) mode);
+        return NULL;
+    }
+    if (config->preallocate_length < 0) {
+        LOG(ERROR, _("invalid preallocation length"));
+        return NULL;
+    }
+
+    fd_file_stream_t *stream =
+            (fd_file_stream_t *) avs_calloc(1, sizeof(fd_file_stream_t));
+    if (!stream) {
+        LOG(ERROR, _("out of memory"));
+        return NULL;
+    }
+    const void *vtable = &fd_file_stream_vtable;
+    memcpy((void *) (intptr_t) &stream->vtable, &vtable, sizeof(void *));
+    stream->mode = mode;
+    stream->sync_on_finish = config->sync_on_finish;
+    stream->direct_io = config->direct_io;
+    if ((stream->fd = open_file(path, flags, &stream->direct_io)) < 0) {
+        LOG(ERROR, _("could not open ") "%s", path);
+        avs_free(stream);
+        return NULL;
+    }
+    stream->alignment = stream->direct_io ? direct_io_alignment(stream->fd) : 1;
+    if (allocate_buffer(stream, config->buffer_size)) {
+        LOG(ERROR, _("could not allocate buffer"));
+        close(stream->fd);
+        avs_free(stream);
+        return NULL;
+    }
+    if (mode == AVS_STREAM_FILE_WRITE && config->preallocate_length > 0) {
+        preallocate(stream, config->preallocate_length);
+    }
+#    if defined(_POSIX_ADVISORY_INFO) && _POSIX_ADVISORY_INFO > 0
+    if (mode == AVS_STREAM_FILE_READ && !stream->direct_io) {
+        (void) posix_fadvise(stream->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+#    endif // defined(_POSIX_ADVISORY_INFO) && _POSIX_ADVISORY_INFO > 0
+    return (avs_stream_t *) stream;
+}
+
+#endif // defined(AVS_COMMONS_WITH_AVS_STREAM) &&
+       // defined(AVS_COMMONS_STREAM_WITH_FILE) &&
+       // defined(AVS_COMMONS_STREAM_WITH_FILE_FD)
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/avs_commons_config.h>
+
+#if defined(AVS_COMMONS_WITH_AVS_STREAM) \
+        && defined(AVS_COMMONS_STREAM_WITH_FILE) \
+        && defined(AVS_COMMONS_STREAM_WITH_FILE_MMAP)
+
+#    include <avs_commons_posix_init.h>
+
+#    include <errno.h>
+#    include <stdint.h>
+
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+
+#    include <avsystem/commons/avs_errno_map.h>
+
+#    include "../../avs_stream_file_mapping.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+static avs_error_t errno_to_error(void) {
+    avs_errno_t err = avs_map_errno(errno);
+    return avs_errno(err ? err : AVS_UNKNOWN_ERROR);
+}
+
+avs_error_t _avs_stream_file_mapping_create(const char *path,
+                                            const void **out_data,
+                                            size_t *out_size) {
+    struct stat st;
+    avs_error_t err = AVS_OK;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return errno_to_error();
+    }
+    if (fstat(fd, &st)) {
+        err = errno_to_error();
+    } else if (!S_ISREG(st.st_mode)) {
+        // pipes, devices etc. cannot be reliably mapped
+        err = avs_errno(AVS_ENODEV);
+    } else if (st.st_size < 0 || (uintmax_t) st.st_size > SIZE_MAX) {
+        err = avs_errno(AVS_EFBIG);
+    } else if (st.st_size == 0) {
+        // mmap() does not accept zero-length mappings
+        *out_data = NULL;
+        *out_size = 0;
+    } else {
+        void *data =
+                mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            err = errno_to_error();
+        } else {
+#    ifdef POSIX_MADV_SEQUENTIAL
+            // this is only a hint, so failure is not an error
+            (void) posix_madvise(data, (size_t) st.st_size,
+                                 POSIX_MADV_SEQUENTIAL);
+#    endif // POSIX_MADV_SEQUENTIAL
+            *out_data = data;
+            *out_size = (size_t) st.st_size;
+        }
+    }
+    // the mapping stays valid after closing the descriptor
+    close(fd);
+    return err;
+}
+
+void _avs_stream_file_mapping_destroy(const void *data, size_t size) {
+    if (size) {
+        munmap((void *) (intptr_t) data, size);
+    }
+}
+
+#endif // defined(AVS_COMMONS_WITH_AVS_STREAM) &&
+       // defined(AVS_COMMONS_STREAM_WITH_FILE) &&
+       // defined(AVS_COMMONS_STREAM_WITH_FILE_MMAP)
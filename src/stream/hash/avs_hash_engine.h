@@ -0,0 +1,47 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVS_HASH_ENGINE_H
+#define AVS_HASH_ENGINE_H
+
+#include <avsystem/commons/avs_errno.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/* Longest digest of all the supported algorithms. */
+#define AVS_HASH_MAX_DIGEST_LENGTH 32
+
+/* Hash algorithm implementation, operating on a context of context_size bytes
+ * that is zero-initialized before the first call to init(). */
+typedef struct {
+    size_t digest_size;
+    size_t context_size;
+    /* starts a new calculation */
+    avs_error_t (*init)(void *context);
+    avs_error_t (*update)(void *context, const void *data, size_t size);
+    /* writes digest_size bytes to out_digest */
+    avs_error_t (*finish)(void *context, unsigned char *out_digest);
+    /* releases resources acquired by init(); may be NULL */
+    void (*cleanup)(void *context);
+} avs_hash_engine_t;
+
+extern const avs_hash_engine_t _AVS_HASH_ENGINE_CRC32;
+extern const avs_hash_engine_t _AVS_HASH_ENGINE_SHA1;
+extern const avs_hash_engine_t _AVS_HASH_ENGINE_SHA256;
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* AVS_HASH_ENGINE_H */
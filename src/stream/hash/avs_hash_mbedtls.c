@@ -0,0 +1,118 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#if defined(AVS_COMMONS_WITH_AVS_STREAM) && defined(AVS_COMMONS_WITH_MBEDTLS)
+
+#    include <mbedtls/sha1.h>
+#    include <mbedtls/sha256.h>
+#    include <mbedtls/version.h>
+
+#    include <avsystem/commons/avs_stream_hash.h>
+
+#    include "avs_hash_engine.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#    if MBEDTLS_VERSION_NUMBER < 0x02070000
+// Mbed TLS <2.7.0 do not have int-returning variants at all, emulate them
+#        define mbedtls_sha1_starts(...) (mbedtls_sha1_starts(__VA_ARGS__), 0)
+#        define mbedtls_sha1_update(...) (mbedtls_sha1_update(__VA_ARGS__), 0)
+#        define mbedtls_sha1_finish(...) (mbedtls_sha1_finish(__VA_ARGS__), 0)
+#        define mbedtls_sha256_starts(...) \
+            (mbedtls_sha256_starts(__VA_ARGS__), 0)
+#        define mbedtls_sha256_update(...) \
+            (mbedtls_sha256_update(__VA_ARGS__), 0)
+#        define mbedtls_sha256_finish(...) \
+            (mbedtls_sha256_finish(__VA_ARGS__), 0)
+#    elif MBEDTLS_VERSION_NUMBER < 0x03000000
+// Since Mbed TLS 2.7 until 3.0, these functions were called mbedtls_*_ret
+#        define mbedtls_sha1_starts mbedtls_sha1_starts_ret
+#        define mbedtls_sha1_update mbedtls_sha1_update_ret
+#        define mbedtls_sha1_finish mbedtls_sha1_finish_ret
+#        define mbedtls_sha256_starts mbedtls_sha256_starts_ret
+#        define mbedtls_sha256_update mbedtls_sha256_update_ret
+#        define mbedtls_sha256_finish mbedtls_sha256_finish_ret
+#    endif // MBEDTLS_VERSION_NUMBER
+
+static avs_error_t result_to_error(int result) {
+    return avs_errno(result ? AVS_ENOBUFS : AVS_NO_ERROR);
+}
+
+static avs_error_t sha1_init(void *context) {
+    mbedtls_sha1_init((mbedtls_sha1_context *) context);
+    return result_to_error(
+            mbedtls_sha1_starts((mbedtls_sha1_context *) context));
+}
+
+static avs_error_t sha1_update(void *context, const void *data, size_t size) {
+    return result_to_error(mbedtls_sha1_update(
+            (mbedtls_sha1_context *) context, (const unsigned char *) data,
+            size));
+}
+
+static avs_error_t sha1_finish(void *context, unsigned char *out_digest) {
+    return result_to_error(
+            mbedtls_sha1_finish((mbedtls_sha1_context *) context, out_digest));
+}
+
+static void sha1_cleanup(void *context) {
+    mbedtls_sha1_free((mbedtls_sha1_context *) context);
+}
+
+static avs_error_t sha256_init(void *context) {
+    mbedtls_sha256_init((mbedtls_sha256_context *) context);
+    return result_to_error(
+            mbedtls_sha256_starts((mbedtls_sha256_context *) context, 0));
+}
+
+static avs_error_t
+sha256_update(void *context, const void *data, size_t size) {
+    return result_to_error(mbedtls_sha256_update(
+            (mbedtls_sha256_context *) context, (const unsigned char *) data,
+            size));
+}
+
+static avs_error_t sha256_finish(void *context, unsigned char *out_digest) {
+    return result_to_error(mbedtls_sha256_finish(
+            (mbedtls_sha256_context *) context, out_digest));
+}
+
+static void sha256_cleanup(void *context) {
+    mbedtls_sha256_free((mbedtls_sha256_context *) context);
+}
+
+const avs_hash_engine_t _AVS_HASH_ENGINE_SHA1 = {
+    .digest_size = AVS_STREAM_SHA1_LENGTH,
+    .context_size = sizeof(mbedtls_sha1_context),
+    .init = sha1_init,
+    .update = sha1_update,
+    .finish = sha1_finish,
+    .cleanup = sha1_cleanup
+};
+
+const avs_hash_engine_t _AVS_HASH_ENGINE_SHA256 = {
+    .digest_size = AVS_STREAM_SHA256_LENGTH,
+    .context_size = sizeof(mbedtls_sha256_context),
+    .init = sha256_init,
+    .update = sha256_update,
+    .finish = sha256_finish,
+    .cleanup = sha256_cleanup
+};
+
+#endif // defined(AVS_COMMONS_WITH_AVS_STREAM) &&
+       // defined(AVS_COMMONS_WITH_MBEDTLS)
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#if defined(AVS_COMMONS_WITH_AVS_STREAM) && defined(AVS_COMMONS_WITH_OPENSSL)
+
+#    include <openssl/evp.h>
+
+#    include <avsystem/commons/avs_stream_hash.h>
+
+#    include "avs_hash_engine.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+typedef struct {
+    EVP_MD_CTX *ctx;
+} openssl_hash_context_t;
+
+static avs_error_t openssl_init(void *context, const EVP_MD *md) {
+    openssl_hash_context_t *ctx = (openssl_hash_context_t *) context;
+    if (!(ctx->ctx = EVP_MD_CTX_new())) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    // EVP_DigestInit_ex() returns 1 on success.
+    return EVP_DigestInit_ex(ctx->ctx, md, NULL) ? AVS_OK : avs_errno(AVS_EIO);
+}
+
+static avs_error_t sha1_init(void *context) {
+    return openssl_init(context, EVP_sha1());
+}
+
+static avs_error_t sha256_init(void *context) {
+    return openssl_init(context, EVP_sha256());
+}
+
+static avs_error_t
+openssl_update(void *context, const void *data, size_t size) {
+    openssl_hash_context_t *ctx = (openssl_hash_context_t *) context;
+    return EVP_DigestUpdate(ctx->ctx, data, size) ? AVS_OK
+                                                  : avs_errno(AVS_EIO);
+}
+
+static avs_error_t openssl_finish(void *context, unsigned char *out_digest) {
+    openssl_hash_context_t *ctx = (openssl_hash_context_t *) context;
+    return EVP_DigestFinal_ex(ctx->ctx, out_digest, NULL) ? AVS_OK
+                                                          : avs_errno(AVS_EIO);
+}
+
+static void openssl_cleanup(void *context) {
+    EVP_MD_CTX_free(((openssl_hash_context_t *) context)->ctx);
+}
+
+const avs_hash_engine_t _AVS_HASH_ENGINE_SHA1 = {
+    .digest_size = AVS_STREAM_SHA1_LENGTH,
+    .context_size = sizeof(openssl_hash_context_t),
+    .init = sha1_init,
+    .update = openssl_update,
+    .finish = openssl_finish,
+    .cleanup = openssl_cleanup
+};
+
+const avs_hash_engine_t _AVS_HASH_ENGINE_SHA256 = {
+    .digest_size = AVS_STREAM_SHA256_LENGTH,
+    .context_size = sizeof(openssl_hash_context_t),
+    .init = sha256_init,
+    .update = openssl_update,
+    .finish = openssl_finish,
+    .cleanup = openssl_cleanup
+};
+
+#endif // defined(AVS_COMMONS_WITH_AVS_STREAM) &&
+       // defined(AVS_COMMONS_WITH_OPENSSL)
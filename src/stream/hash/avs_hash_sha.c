@@ -0,0 +1,271 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#if defined(AVS_COMMONS_WITH_AVS_STREAM) && !defined(AVS_COMMONS_WITH_OPENSSL) \
+        && !defined(AVS_COMMONS_WITH_MBEDTLS)
+
+#    include <stdint.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_stream_hash.h>
+
+#    include "avs_hash_engine.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+/* Built-in SHA-1 and SHA-256 implementations, as specified in FIPS 180-4. */
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;
+    unsigned char block[64];
+} sha_context_t;
+
+typedef void sha_transform_t(uint32_t *state, const unsigned char *block);
+
+static uint32_t get_be32(const unsigned char *data) {
+    return ((uint32_t) data[0] << 24) | ((uint32_t) data[1] << 16)
+           | ((uint32_t) data[2] << 8) | (uint32_t) data[3];
+}
+
+static void put_be32(uint32_t value, unsigned char *data) {
+    data[0] = (unsigned char) (value >> 24);
+    data[1] = (unsigned char) (value >> 16);
+    data[2] = (unsigned char) (value >> 8);
+    data[3] = (unsigned char) value;
+}
+
+#    define ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#    define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha_update(sha_context_t *ctx,
+                       sha_transform_t *transform,
+                       const unsigned char *data,
+                       size_t size) {
+    size_t used = (size_t) (ctx->length % 64);
+    ctx->length += size;
+    if (used) {
+        size_t chunk = AVS_MIN(size, 64 - used);
+        memcpy(ctx->block + used, data, chunk);
+        if (used + chunk < 64) {
+            return;
+        }
+        transform(ctx->state, ctx->block);
+        data += chunk;
+        size -= chunk;
+    }
+    /* full blocks are processed directly from the caller's buffer */
+    while (size >= 64) {
+        transform(ctx->state, data);
+        data += 64;
+        size -= 64;
+    }
+    memcpy(ctx->block, data, size);
+}
+
+static void sha_finish(sha_context_t *ctx,
+                       sha_transform_t *transform,
+                       unsigned char *out_digest,
+                       size_t digest_words) {
+    size_t used = (size_t) (ctx->length % 64);
+    uint64_t bits = ctx->length * 8;
+    ctx->block[used++] = 0x80;
+    if (used > 56) {
+        memset(ctx->block + used, 0, 64 - used);
+        transform(ctx->state, ctx->block);
+        used = 0;
+    }
+    memset(ctx->block + used, 0, 56 - used);
+    put_be32((uint32_t) (bits >> 32), ctx->block + 56);
+    put_be32((uint32_t) bits, ctx->block + 60);
+    transform(ctx->state, ctx->block);
+    for (size_t i = 0; i < digest_words; ++i) {
+        put_be32(ctx->state[i], out_digest + 4 * i);
+    }
+}
+
+static void sha1_transform(uint32_t *state, const unsigned char *block) {
+    uint32_t w[16];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = get_be32(block + 4 * i);
+    }
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
+    for (int i = 0; i < 80; ++i) {
+        if (i >= 16) {
+            uint32_t x = w[(i + 13) & 15] ^ w[(i + 8) & 15] ^ w[(i + 2) & 15]
+                         ^ w[i & 15];
+            w[i & 15] = ROTL(x, 1);
+        }
+        uint32_t f;
+        uint32_t k;
+        if (i < 20) {
+            f = d ^ (b & (c ^ d));
+            k = 0x5a827999UL;
+        } else if (i < 40) {
+            f = b ^ c ^ d;
+            k = 0x6ed9eba1UL;
+        } else if (i < 60) {
+            f = (b & c) | (d & (b | c));
+            k = 0x8f1bbcdcUL;
+        } else {
+            f = b ^ c ^ d;
+            k = 0xca62c1d6UL;
+        }
+        uint32_t t = ROTL(a, 5) + f + e + k + w[i & 15];
+        e = d;
+        d = c;
+        c = ROTL(b, 30);
+        b = a;
+        a = t;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+static const uint32_t SHA256_K[64] = {
+    0x428a2f98UL, 0x71374491UL, 0xb5c0fbcfUL, 0xe9b5dba5UL, 0x3956c25bUL,
+    0x59f111f1UL, 0x923f82a4UL, 0xab1c5ed5UL, 0xd807aa98UL, 0x12835b01UL,
+    0x243185beUL, 0x550c7dc3UL, 0x72be5d74UL, 0x80deb1feUL, 0x9bdc06a7UL,
+    0xc19bf174UL, 0xe49b69c1UL, 0xefbe4786UL, 0x0fc19dc6UL, 0x240ca1ccUL,
+    0x2de92c6fUL, 0x4a7484aaUL, 0x5cb0a9dcUL, 0x76f988daUL, 0x983e5152UL,
+    0xa831c66dUL, 0xb00327c8UL, 0xbf597fc7UL, 0xc6e00bf3UL, 0xd5a79147UL,
+    0x06ca6351UL, 0x14292967UL, 0x27b70a85UL, 0x2e1b2138UL, 0x4d2c6dfcUL,
+    0x53380d13UL, 0x650a7354UL, 0x766a0abbUL, 0x81c2c92eUL, 0x92722c85UL,
+    0xa2bfe8a1UL, 0xa81a664bUL, 0xc24b8b70UL, 0xc76c51a3UL, 0xd192e819UL,
+    0xd6990624UL, 0xf40e3585UL, 0x106aa070UL, 0x19a4c116UL, 0x1e376c08UL,
+    0x2748774cUL, 0x34b0bcb5UL, 0x391c0cb3UL, 0x4ed8aa4aUL, 0x5b9cca4fUL,
+    0x682e6ff3UL, 0x748f82eeUL, 0x78a5636fUL, 0x84c87814UL, 0x8cc70208UL,
+    0x90befffaUL, 0xa4506cebUL, 0xbef9a3f7UL, 0xc67178f2UL
+};
+
+static void sha256_transform(uint32_t *state, const unsigned char *block) {
+    uint32_t w[16];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = get_be32(block + 4 * i);
+    }
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
+    uint32_t f = state[5];
+    uint32_t g = state[6];
+    uint32_t h = state[7];
+    for (int i = 0; i < 64; ++i) {
+        if (i >= 16) {
+            uint32_t w15 = w[(i + 1) & 15];
+            uint32_t w2 = w[(i + 14) & 15];
+            uint32_t s0 = ROTR(w15, 7) ^ ROTR(w15, 18) ^ (w15 >> 3);
+            uint32_t s1 = ROTR(w2, 17) ^ ROTR(w2, 19) ^ (w2 >> 10);
+            w[i & 15] += s0 + w[(i + 9) & 15] + s1;
+        }
+        uint32_t t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25))
+                      + (g ^ (e & (f ^ g))) + SHA256_K[i] + w[i & 15];
+        uint32_t t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22))
+                      + ((a & b) | (c & (a | b)));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+static avs_error_t sha1_init(void *context) {
+    static const uint32_t INITIAL_STATE[] = { 0x67452301UL, 0xefcdab89UL,
+                                              0x98badcfeUL, 0x10325476UL,
+                                              0xc3d2e1f0UL };
+    sha_context_t *ctx = (sha_context_t *) context;
+    memcpy(ctx->state, INITIAL_STATE, sizeof(INITIAL_STATE));
+    ctx->length = 0;
+    return AVS_OK;
+}
+
+static avs_error_t sha1_update(void *context, const void *data, size_t size) {
+    sha_update((sha_context_t *) context, sha1_transform,
+               (const unsigned char *) data, size);
+    return AVS_OK;
+}
+
+static avs_error_t sha1_finish(void *context, unsigned char *out_digest) {
+    sha_finish((sha_context_t *) context, sha1_transform, out_digest,
+               AVS_STREAM_SHA1_LENGTH / 4);
+    return AVS_OK;
+}
+
+static avs_error_t sha256_init(void *context) {
+    static const uint32_t INITIAL_STATE[] = {
+        0x6a09e667UL, 0xbb67ae85UL, 0x3c6ef372UL, 0xa54ff53aUL,
+        0x510e527fUL, 0x9b05688cUL, 0x1f83d9abUL, 0x5be0cd19UL
+    };
+    sha_context_t *ctx = (sha_context_t *) context;
+    memcpy(ctx->state, INITIAL_STATE, sizeof(INITIAL_STATE));
+    ctx->length = 0;
+    return AVS_OK;
+}
+
+static avs_error_t
+sha256_update(void *context, const void *data, size_t size) {
+    sha_update((sha_context_t *) context, sha256_transform,
+               (const unsigned char *) data, size);
+    return AVS_OK;
+}
+
+static avs_error_t sha256_finish(void *context, unsigned char *out_digest) {
+    sha_finish((sha_context_t *) context, sha256_transform, out_digest,
+               AVS_STREAM_SHA256_LENGTH / 4);
+    return AVS_OK;
+}
+
+const avs_hash_engine_t _AVS_HASH_ENGINE_SHA1 = {
+    .digest_size = AVS_STREAM_SHA1_LENGTH,
+    .context_size = sizeof(sha_context_t),
+    .init = sha1_init,
+    .update = sha1_update,
+    .finish = sha1_finish
+};
+
+const avs_hash_engine_t _AVS_HASH_ENGINE_SHA256 = {
+    .digest_size = AVS_STREAM_SHA256_LENGTH,
+    .context_size = sizeof(sha_context_t),
+    .init = sha256_init,
+    .update = sha256_update,
+    .finish = sha256_finish
+};
+
+#endif // defined(AVS_COMMONS_WITH_AVS_STREAM) &&
+       // !defined(AVS_COMMONS_WITH_OPENSSL) &&
+       // !defined(AVS_COMMONS_WITH_MBEDTLS)
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#ifdef AVS_COMMONS_WITH_AVS_STREAM
+
+#    include <stddef.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_stream_hash.h>
+#    include <avsystem/commons/avs_stream_v_table.h>
+
+#    include "avs_hash_engine.h"
+
+#    define MODULE_NAME avs_stream
+#    include <avs_x_log_config.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+typedef struct {
+    const avs_stream_v_table_t *const vtable;
+    const avs_hash_engine_t *engine;
+    unsigned char result[AVS_HASH_MAX_DIGEST_LENGTH];
+    /* equal to engine->digest_size while data is being accepted; reset to 0
+     * when the digest is calculated and advanced as it is being read */
+    size_t out_ptr;
+    avs_max_align_t context[];
+} hash_stream_t;
+
+static bool is_finalized(const hash_stream_t *stream) {
+    return stream->out_ptr < stream->engine->digest_size;
+}
+
+static void cleanup_context(hash_stream_t *stream) {
+    if (stream->engine->cleanup) {
+        stream->engine->cleanup(stream->context);
+    }
+    memset(stream->context, 0, stream->engine->context_size);
+}
+
+static avs_error_t hash_reset(avs_stream_t *stream_) {
+    hash_stream_t *stream = (hash_stream_t *) stream_;
+    cleanup_context(stream);
+    stream->out_ptr = stream->engine->digest_size;
+    return stream->engine->init(stream->context);
+}
+
+static avs_error_t
+hash_write_some(avs_stream_t *stream_, const void *buffer, size_t *len) {
+    hash_stream_t *stream = (hash_stream_t *) stream_;
+    if (is_finalized(stream)) {
+        return avs_errno(AVS_EBADF);
+    }
+    return stream->engine->update(stream->context, buffer, *len);
+}
+
+static avs_error_t hash_finish_message(avs_stream_t *stream_) {
+    hash_stream_t *stream = (hash_stream_t *) stream_;
+    if (is_finalized(stream)) {
+        return AVS_OK;
+    }
+    avs_error_t err = stream->engine->finish(stream->context, stream->result);
+    if (avs_is_ok(err)) {
+        stream->out_ptr = 0;
+    }
+    return err;
+}
+
+static avs_error_t hash_read(avs_stream_t *stream_,
+                             size_t *out_bytes_read,
+                             bool *out_message_finished,
+                             void *buffer,
+                             size_t buffer_length) {
+    hash_stream_t *stream = (hash_stream_t *) stream_;
+    size_t bytes_read = AVS_MIN(buffer_length,
+                                stream->engine->digest_size - stream->out_ptr);
+    memcpy(buffer, stream->result + stream->out_ptr, bytes_read);
+    stream->out_ptr += bytes_read;
+    if (out_bytes_read) {
+        *out_bytes_read = bytes_read;
+    }
+    bool message_finished = !is_finalized(stream);
+    if (out_message_finished) {
+        *out_message_finished = message_finished;
+    }
+    return message_finished ? hash_reset(stream_) : AVS_OK;
+}
+
+static avs_error_t hash_close(avs_stream_t *stream_) {
+    cleanup_context((hash_stream_t *) stream_);
+    return AVS_OK;
+}
+
+static const avs_stream_v_table_t hash_vtable = {
+    .write_some = hash_write_some,
+    .finish_message = hash_finish_message,
+    .read = hash_read,
+    .reset = hash_reset,
+    .close = hash_close,
+    AVS_STREAM_V_TABLE_NO_EXTENSIONS
+};
+
+static avs_stream_t *hash_stream_create(const avs_hash_engine_t *engine) {
+    hash_stream_t *stream = (hash_stream_t *) avs_calloc(
+            1, offsetof(hash_stream_t, context) + engine->context_size);
+    if (!stream) {
+        return NULL;
+    }
+    *(const avs_stream_v_table_t **) (intptr_t) &stream->vtable = &hash_vtable;
+    stream->engine = engine;
+    stream->out_ptr = engine->digest_size;
+    if (avs_is_err(engine->init(stream->context))) {
+        LOG(ERROR, _("could not initialize hash context"));
+        cleanup_context(stream);
+        avs_free(stream);
+        return NULL;
+    }
+    return (avs_stream_t *) stream;
+}
+
+avs_stream_t *avs_stream_crc32_create(void) {
+    return hash_stream_create(&_AVS_HASH_ENGINE_CRC32);
+}
+
+avs_stream_t *avs_stream_sha1_create(void) {
+    return hash_stream_create(&_AVS_HASH_ENGINE_SHA1);
+}
+
+avs_stream_t *avs_stream_sha256_create(void) {
+    return hash_stream_create(&_AVS_HASH_ENGINE_SHA256);
+}
+
+#    ifdef AVS_UNIT_TESTING
+#        include "tests/stream/test_stream_hash.c"
+#    endif
+
+#endif // AVS_COMMONS_WITH_AVS_STREAM
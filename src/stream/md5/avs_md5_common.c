@@ -75,4 +75,8 @@ void _avs_stream_md5_common_reset(avs_stream_md5_common_t *stream) {
     stream->out_ptr = MD5_LENGTH;
 }
 
+#    ifdef AVS_UNIT_TESTING
+#        include "tests/stream/test_stream_md5.c"
+#    endif
+
 #endif // AVS_COMMONS_WITH_AVS_STREAM
@@ -27,19 +27,37 @@
 
 #    include "avs_md5_common.h"
 
+#    define MODULE_NAME avs_stream
+#    include <avs_x_log_config.h>
+
 VISIBILITY_SOURCE_BEGIN
 
 typedef struct {
     avs_stream_md5_common_t common;
+    uint32_t state[4];
     uint32_t bits[2];
     unsigned char in[64];
 } md5_stream_t;
 
+#    ifndef AVS_COMMONS_BIG_ENDIAN
+static void load_block(uint32_t out[16], const unsigned char *block) {
+    /* MD5 words are little-endian, so they can be loaded as-is; memcpy()
+     * compiles to plain loads and is safe regardless of alignment */
+    memcpy(out, block, 64);
+}
+#    else  // AVS_COMMONS_BIG_ENDIAN
 static uint32_t getu32(const unsigned char *addr) {
     return (((((uint32_t) addr[3] << 8) | addr[2]) << 8) | addr[1]) << 8
            | addr[0];
 }
 
+static void load_block(uint32_t out[16], const unsigned char *block) {
+    for (int i = 0; i < 16; ++i) {
+        out[i] = getu32(block + 4 * i);
+    }
+}
+#    endif // AVS_COMMONS_BIG_ENDIAN
+
 static void putu32(uint32_t data, unsigned char *addr) {
     addr[0] = (unsigned char) data;
     addr[1] = (unsigned char) (data >> 8);
@@ -67,19 +85,17 @@ static void putu32(uint32_t data, unsigned char *addr) {
  * reflect the addition of 16 longwords of new data.  MD5Update blocks
  * the data and converts bytes into longwords for this routine.
  */
-static void avs_md5_transform(unsigned char buf[MD5_LENGTH],
+static void avs_md5_transform(uint32_t state[4],
                               const unsigned char inraw[64]) {
-    register uint32_t old_a, old_b, old_c, old_d, a, b, c, d;
+    uint32_t a, b, c, d;
     uint32_t in[16];
-    int i;
 
-    for (i = 0; i < 16; ++i)
-        in[i] = getu32(inraw + 4 * i);
+    load_block(in, inraw);
 
-    a = old_a = getu32(buf);
-    b = old_b = getu32(buf + 4);
-    c = old_c = getu32(buf + 8);
-    d = old_d = getu32(buf + 12);
+    a = state[0];
+    b = state[1];
+    c = state[2];
+    d = state[3];
 
     MD5STEP(F1, a, b, c, d, in[0] + 0xd76aa478, 7);
     MD5STEP(F1, d, a, b, c, in[1] + 0xe8c7b756, 12);
@@ -149,10 +165,10 @@ static void avs_md5_transform(unsigned char buf[MD5_LENGTH],
     MD5STEP(F4, c, d, a, b, in[2] + 0x2ad7d2bb, 15);
     MD5STEP(F4, b, c, d, a, in[9] + 0xeb86d391, 21);
 
-    putu32(a + old_a, buf);
-    putu32(b + old_b, buf + 4);
-    putu32(c + old_c, buf + 8);
-    putu32(d + old_d, buf + 12);
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
 }
 
 /*
@@ -160,15 +176,13 @@ static void avs_md5_transform(unsigned char buf[MD5_LENGTH],
  * initialization constants.
  */
 static avs_error_t avs_md5_reset(avs_stream_t *stream) {
-    static const unsigned char INITIAL_DATA[] = { 0x01, 0x23, 0x45, 0x67,
-                                                  0x89, 0xAB, 0xCD, 0xEF,
-                                                  0xFE, 0xDC, 0xBA, 0x98,
-                                                  0x76, 0x54, 0x32, 0x10 };
-
     md5_stream_t *ctx = (md5_stream_t *) stream;
 
     memset(ctx->in, 0, sizeof(ctx->in));
-    memcpy(ctx->common.result, INITIAL_DATA, sizeof(ctx->common.result));
+    ctx->state[0] = 0x67452301;
+    ctx->state[1] = 0xefcdab89;
+    ctx->state[2] = 0x98badcfe;
+    ctx->state[3] = 0x10325476;
     memset(ctx->bits, 0, sizeof(ctx->bits));
 
     _avs_stream_md5_common_reset(&ctx->common);
@@ -199,7 +213,7 @@ static avs_error_t avs_md5_finish(avs_stream_t *stream) {
     if (count < 8) {
         /* Two lots of padding:  Pad the first block to 64 bytes */
         memset(p, 0, count);
-        avs_md5_transform(ctx->common.result, ctx->in);
+        avs_md5_transform(ctx->state, ctx->in);
 
         /* Now fill the next block with 56 bytes */
         memset(ctx->in, 0, 56);
@@ -212,7 +226,10 @@ static avs_error_t avs_md5_finish(avs_stream_t *stream) {
     putu32(ctx->bits[0], ctx->in + 56);
     putu32(ctx->bits[1], ctx->in + 60);
 
-    avs_md5_transform(ctx->common.result, ctx->in);
+    avs_md5_transform(ctx->state, ctx->in);
+    for (int i = 0; i < 4; ++i) {
+        putu32(ctx->state[i], ctx->common.result + 4 * i);
+    }
     _avs_stream_md5_common_finalize(&ctx->common);
 
     /* In case it's sensitive */
@@ -255,7 +272,7 @@ avs_md5_update(avs_stream_t *stream, const void *buf_, size_t *len) {
             return AVS_OK;
         }
         memcpy(p, buf, t);
-        avs_md5_transform(ctx->common.result, ctx->in);
+        avs_md5_transform(ctx->state, ctx->in);
         buf += t;
         remaining -= t;
     }
@@ -263,8 +280,7 @@ avs_md5_update(avs_stream_t *stream, const void *buf_, size_t *len) {
     /* Process data in 64-byte chunks */
 
     while (remaining >= 64) {
-        memcpy(ctx->in, buf, 64);
-        avs_md5_transform(ctx->common.result, ctx->in);
+        avs_md5_transform(ctx->state, (const unsigned char *) buf);
         buf += 64;
         remaining -= 64;
     }
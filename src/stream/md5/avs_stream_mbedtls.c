@@ -28,6 +28,9 @@
 
 #    include "avs_md5_common.h"
 
+#    define MODULE_NAME avs_stream
+#    include <avs_x_log_config.h>
+
 VISIBILITY_SOURCE_BEGIN
 
 #    if MBEDTLS_VERSION_NUMBER < 0x02070000
@@ -27,6 +27,9 @@
 
 #    include "avs_md5_common.h"
 
+#    define MODULE_NAME avs_stream
+#    include <avs_x_log_config.h>
+
 VISIBILITY_SOURCE_BEGIN
 
 typedef struct {
@@ -20,6 +20,7 @@
         && defined(AVS_COMMONS_WITH_AVS_BUFFER) \
         && defined(AVS_COMMONS_WITH_AVS_NET)
 
+#    include <assert.h>
 #    include <stdio.h>
 #    include <string.h>
 
@@ -46,6 +47,8 @@ typedef struct buffered_netstream_struct {
 } buffered_netstream_t;
 
 static avs_error_t out_buffer_flush(buffered_netstream_t *stream) {
+    /* the whole buffer is sent in a single call, so that it is never split
+     * into multiple datagrams; avs_buffer_data() makes the data contiguous */
     avs_error_t err =
             avs_net_socket_send(stream->socket,
                                 avs_buffer_data(stream->out_buffer),
@@ -85,12 +88,17 @@ static void return_data_from_buffer(avs_buffer_t *in_buffer,
                                     size_t *out_bytes_read,
                                     void *buffer,
                                     size_t buffer_length) {
-    *out_bytes_read = avs_buffer_data_size(in_buffer);
-    if (buffer_length < *out_bytes_read) {
-        *out_bytes_read = buffer_length;
+    avs_buffer_const_span_t spans[AVS_BUFFER_MAX_SPANS];
+    size_t span_count = avs_buffer_data_spans(in_buffer, spans);
+    size_t i;
+
+    *out_bytes_read = 0;
+    for (i = 0; i < span_count && *out_bytes_read < buffer_length; ++i) {
+        size_t chunk =
+                AVS_MIN(spans[i].size, buffer_length - *out_bytes_read);
+        memcpy((char *) buffer + *out_bytes_read, spans[i].data, chunk);
+        *out_bytes_read += chunk;
     }
-
-    memcpy(buffer, avs_buffer_data(in_buffer), *out_bytes_read);
     if (avs_buffer_consume_bytes(in_buffer, *out_bytes_read)) {
         AVS_UNREACHABLE();
     }
@@ -191,7 +199,10 @@ static avs_error_t buffered_netstream_read(avs_stream_t *stream_,
     return AVS_OK;
 }
 
-static avs_error_t try_recv_nonblock(buffered_netstream_t *stream) {
+/* Returns AVS_EAGAIN if there is no data that could be received immediately;
+ * *out_bytes_read == 0 means that the connection has been closed. */
+static avs_error_t try_recv_nonblock(buffered_netstream_t *stream,
+                                     size_t *out_bytes_read) {
     avs_net_socket_opt_value_t old_recv_timeout;
     const avs_net_socket_opt_value_t zero_timeout = {
         .recv_timeout = AVS_TIME_DURATION_ZERO
@@ -210,11 +221,10 @@ static avs_error_t try_recv_nonblock(buffered_netstream_t *stream) {
         return err;
     }
 
-    size_t bytes_read;
-    err = in_buffer_read_some(stream, &bytes_read);
+    err = in_buffer_read_some(stream, out_bytes_read);
     if (err.category == AVS_ERRNO_CATEGORY && err.code == AVS_ETIMEDOUT) {
-        // nothing to read - this is expected, ignore
-        err = AVS_OK;
+        // nothing to read - this is expected
+        err = avs_errno(AVS_EAGAIN);
     }
 
     avs_error_t restore_err = avs_net_socket_set_opt(
@@ -244,10 +254,72 @@ static bool buffered_netstream_nonblock_read_ready(avs_stream_t *stream_) {
      * something from the socket with timeout set to 0 before telling the
      * caller nonblock read is not possible.
      */
-    return avs_is_ok(try_recv_nonblock(stream))
+    return avs_is_ok(try_recv_nonblock(stream, &(size_t) { 0 }))
            && avs_buffer_data_size(stream->in_buffer) > 0;
 }
 
+static avs_error_t buffered_netstream_read_nonblock(avs_stream_t *stream_,
+                                                    size_t *out_bytes_read,
+                                                    bool *out_message_finished,
+                                                    void *buffer,
+                                                    size_t buffer_length) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    if (avs_buffer_data_size(stream->in_buffer) == 0) {
+        size_t bytes_received;
+        avs_error_t err = try_recv_nonblock(stream, &bytes_received);
+        if (avs_is_err(err)) {
+            return err;
+        } else if (bytes_received == 0) {
+            *out_message_finished = true;
+            return AVS_OK;
+        }
+    }
+    return_data_from_buffer(stream->in_buffer, out_bytes_read, buffer,
+                            buffer_length);
+    return AVS_OK;
+}
+
+static avs_error_t
+buffered_netstream_write_some_nonblock(avs_stream_t *stream_,
+                                       const void *data,
+                                       size_t *inout_data_length) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    size_t space_left = avs_buffer_space_left(stream->out_buffer);
+    if (*inout_data_length && !space_left) {
+        return avs_errno(AVS_EAGAIN);
+    }
+    *inout_data_length = AVS_MIN(*inout_data_length, space_left);
+    if (avs_buffer_append_bytes(stream->out_buffer, data,
+                                *inout_data_length)) {
+        AVS_UNREACHABLE("append failed even though there was enough space");
+    }
+    return AVS_OK;
+}
+
+static avs_error_t buffered_netstream_flush(avs_stream_t *stream_) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    if (avs_buffer_data_size(stream->out_buffer) == 0) {
+        return AVS_OK;
+    }
+    size_t bytes_sent;
+    avs_error_t err = avs_net_socket_send_nonblock(
+            stream->socket, avs_buffer_data(stream->out_buffer),
+            avs_buffer_data_size(stream->out_buffer), &bytes_sent);
+    if (err.category == AVS_ERRNO_CATEGORY && err.code == AVS_ENOTSUP) {
+        /* e.g. (D)TLS sockets cannot send partial records without blocking;
+         * the transport is expected to be writable, so just send everything */
+        return out_buffer_flush(stream);
+    }
+    if (avs_buffer_consume_bytes(stream->out_buffer, bytes_sent)) {
+        AVS_UNREACHABLE("sent more data than there was in the buffer");
+    }
+    if (avs_is_ok(err) && avs_buffer_data_size(stream->out_buffer) > 0) {
+        /* the rest will be sent when the transport becomes writable again */
+        err = avs_errno(AVS_EAGAIN);
+    }
+    return err;
+}
+
 static avs_error_t
 buffered_netstream_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
     buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
@@ -263,7 +335,14 @@ buffered_netstream_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
                 return AVS_EOF;
             }
         }
-        *out_value = avs_buffer_data(stream->in_buffer)[offset];
+        avs_buffer_const_span_t spans[AVS_BUFFER_MAX_SPANS];
+        size_t span_count = avs_buffer_data_spans(stream->in_buffer, spans);
+        size_t i;
+        for (i = 0; i < span_count && offset >= spans[i].size; ++i) {
+            offset -= spans[i].size;
+        }
+        assert(i < span_count);
+        *out_value = spans[i].data[offset];
         return AVS_OK;
     } else {
         LOG(ERROR, _("cannot peek - buffer is too small"));
@@ -285,7 +364,7 @@ static avs_error_t buffered_netstream_close(avs_stream_t *stream_) {
         err = avs_net_socket_shutdown(stream->socket);
     }
     avs_net_socket_cleanup(&stream->socket);
-    avs_free(stream->in_buffer);
+    avs_buffer_free(&stream->in_buffer);
     avs_buffer_free(&stream->out_buffer);
     return err;
 }
@@ -301,6 +380,234 @@ static avs_error_t buffered_netstream_setsock(avs_stream_t *stream_,
     return AVS_OK;
 }
 
+static avs_error_t writev_each(avs_stream_t *stream,
+                               const avs_stream_const_iovec_t *iov,
+                               size_t iov_count) {
+    for (size_t i = 0; i < iov_count; ++i) {
+        if (iov[i].size) {
+            size_t data_length = iov[i].size;
+            avs_error_t err = buffered_netstream_write_some(stream, iov[i].data,
+                                                            &data_length);
+            if (avs_is_err(err)) {
+                return err;
+            }
+        }
+    }
+    return AVS_OK;
+}
+
+static avs_error_t sendv_chunk(buffered_netstream_t *stream,
+                               const avs_net_socket_iovec_t *msg_iov,
+                               size_t *inout_msg_iov_count) {
+    avs_error_t err =
+            avs_net_socket_sendv(stream->socket, msg_iov, *inout_msg_iov_count);
+    if (avs_is_ok(err)) {
+        /* out_buffer contents, if any, were always part of the first chunk */
+        avs_buffer_reset(stream->out_buffer);
+        *inout_msg_iov_count = 0;
+    }
+    return err;
+}
+
+static avs_error_t
+buffered_netstream_writev(avs_stream_t *stream_,
+                          const avs_stream_const_iovec_t *iov,
+                          size_t iov_count) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    size_t total_size = 0;
+    for (size_t i = 0; i < iov_count; ++i) {
+        total_size += iov[i].size;
+    }
+    if (total_size < avs_buffer_space_left(stream->out_buffer)) {
+        return writev_each(stream_, iov, iov_count);
+    }
+
+    /* send the buffered data together with the new data, without copying
+     * either, in as few socket calls as possible */
+    avs_net_socket_iovec_t msg_iov[AVS_NET_SOCKET_SENDV_MAX_IOV];
+    size_t msg_iov_count = 0;
+    avs_buffer_const_span_t spans[AVS_BUFFER_MAX_SPANS];
+    size_t span_count = avs_buffer_data_spans(stream->out_buffer, spans);
+    for (size_t i = 0; i < span_count; ++i) {
+        msg_iov[msg_iov_count].data = spans[i].data;
+        msg_iov[msg_iov_count].size = spans[i].size;
+        ++msg_iov_count;
+    }
+
+    bool first_chunk = true;
+    avs_error_t err = AVS_OK;
+    for (size_t i = 0; avs_is_ok(err) && i < iov_count; ++i) {
+        if (!iov[i].size) {
+            continue;
+        }
+        if (msg_iov_count == AVS_ARRAY_SIZE(msg_iov)) {
+            if (avs_is_err((err = sendv_chunk(stream, msg_iov,
+                                              &msg_iov_count)))) {
+                break;
+            }
+            first_chunk = false;
+        }
+        msg_iov[msg_iov_count].data = iov[i].data;
+        msg_iov[msg_iov_count].size = iov[i].size;
+        ++msg_iov_count;
+    }
+    if (avs_is_ok(err)) {
+        err = sendv_chunk(stream, msg_iov, &msg_iov_count);
+    }
+    if (first_chunk && err.category == AVS_ERRNO_CATEGORY
+            && err.code == AVS_ENOTSUP) {
+        /* the socket does not support vectored sends, e.g. (D)TLS; nothing
+         * has been sent yet, so fall back to sending each buffer separately */
+        return writev_each(stream_, iov, iov_count);
+    }
+    return err;
+}
+
+#    ifdef AVS_COMMONS_STREAM_WITH_SENDFILE
+static avs_error_t buffered_netstream_get_fd(avs_stream_t *stream_,
+                                             bool for_writing,
+                                             int *out_fd,
+                                             avs_off_t *out_offset) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    avs_net_socket_opt_value_t socket_type;
+    const int *fd_ptr;
+    /* writing directly to the descriptor of e.g. a TLS socket would bypass
+     * the encryption, so only plain TCP sockets qualify */
+    if (avs_is_err(avs_net_socket_get_opt(stream->socket,
+                                          AVS_NET_SOCKET_OPT_SOCKET_TYPE,
+                                          &socket_type))
+            || socket_type.socket_type != AVS_NET_TCP_SOCKET
+            || !(fd_ptr = (const int *) avs_net_socket_get_system(
+                         stream->socket))
+            || *fd_ptr < 0) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    if (for_writing) {
+        avs_error_t err;
+        if (avs_buffer_data_size(stream->out_buffer)
+                && avs_is_err((err = out_buffer_flush(stream)))) {
+            return err;
+        }
+    } else if (avs_buffer_data_size(stream->in_buffer)) {
+        /* the buffered data needs to be read through the stream first */
+        return avs_errno(AVS_ENOTSUP);
+    }
+    *out_fd = *fd_ptr;
+    *out_offset = -1;
+    return AVS_OK;
+}
+
+static avs_error_t buffered_netstream_fd_advance(avs_stream_t *stream,
+                                                 bool for_writing,
+                                                 size_t length) {
+    /* the descriptor is used at its current position, and nothing is
+     * buffered, so there is no state to update */
+    (void) stream;
+    (void) for_writing;
+    (void) length;
+    return AVS_OK;
+}
+#    endif // AVS_COMMONS_STREAM_WITH_SENDFILE
+
+static avs_error_t buffered_netstream_readv(avs_stream_t *stream_,
+                                            size_t *out_bytes_read,
+                                            bool *out_message_finished,
+                                            const avs_stream_iovec_t *iov,
+                                            size_t iov_count) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    if (avs_buffer_data_size(stream->in_buffer) == 0) {
+        if (iov_count > 0
+                && iov[0].size >= avs_buffer_capacity(stream->in_buffer)) {
+            return read_data_to_user_buffer(stream, out_bytes_read,
+                                            out_message_finished, iov[0].data,
+                                            iov[0].size);
+        }
+        avs_error_t err = in_buffer_read_some(stream, &(size_t) { 0 });
+        if (avs_is_err(err)) {
+            return err;
+        }
+        if (avs_buffer_data_size(stream->in_buffer) == 0) {
+            *out_message_finished = true;
+            return AVS_OK;
+        }
+    }
+    for (size_t i = 0;
+         i < iov_count && avs_buffer_data_size(stream->in_buffer) > 0;
+         ++i) {
+        size_t chunk;
+        return_data_from_buffer(stream->in_buffer, &chunk, iov[i].data,
+                                iov[i].size);
+        *out_bytes_read += chunk;
+    }
+    return AVS_OK;
+}
+
+static avs_error_t
+buffered_netstream_peek_contiguous(avs_stream_t *stream_,
+                                   const void **out_data,
+                                   size_t *out_size,
+                                   bool *out_message_finished) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    if (avs_buffer_data_size(stream->in_buffer) == 0) {
+        avs_error_t err = in_buffer_read_some(stream, &(size_t) { 0 });
+        if (avs_is_err(err)) {
+            return err;
+        }
+    }
+    avs_buffer_const_span_t spans[AVS_BUFFER_MAX_SPANS];
+    if (avs_buffer_data_spans(stream->in_buffer, spans)) {
+        *out_data = spans[0].data;
+        *out_size = spans[0].size;
+        *out_message_finished = false;
+    } else {
+        *out_data = NULL;
+        *out_size = 0;
+        *out_message_finished = true;
+    }
+    return AVS_OK;
+}
+
+static avs_error_t buffered_netstream_consume(avs_stream_t *stream_,
+                                              size_t size) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    if (avs_buffer_consume_bytes(stream->in_buffer, size)) {
+        return avs_errno(AVS_EINVAL);
+    }
+    return AVS_OK;
+}
+
+static avs_error_t buffered_netstream_reserve(avs_stream_t *stream_,
+                                              size_t size_hint,
+                                              void **out_data,
+                                              size_t *out_size) {
+    (void) size_hint;
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    if (avs_buffer_space_left(stream->out_buffer) == 0) {
+        avs_error_t err = out_buffer_flush(stream);
+        if (avs_is_err(err)) {
+            return err;
+        }
+    }
+    avs_buffer_span_t spans[AVS_BUFFER_MAX_SPANS];
+    if (avs_buffer_free_spans(stream->out_buffer, spans)) {
+        *out_data = spans[0].data;
+        *out_size = spans[0].size;
+    } else {
+        *out_data = NULL;
+        *out_size = 0;
+    }
+    return AVS_OK;
+}
+
+static avs_error_t buffered_netstream_commit(avs_stream_t *stream_,
+                                             size_t size) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    if (avs_buffer_advance_ptr(stream->out_buffer, size)) {
+        return avs_errno(AVS_EINVAL);
+    }
+    return AVS_OK;
+}
+
 static const avs_stream_v_table_t buffered_netstream_vtable = {
     .write_some = buffered_netstream_write_some,
     .finish_message = buffered_netstream_finish_message,
@@ -319,6 +626,27 @@ static const avs_stream_v_table_t buffered_netstream_vtable = {
                       &(const avs_stream_v_table_extension_nonblock_t) {
                               buffered_netstream_nonblock_read_ready,
                               buffered_netstream_nonblock_write_ready } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_NONBLOCK_IO,
+                      &(const avs_stream_v_table_extension_nonblock_io_t) {
+                              buffered_netstream_read_nonblock,
+                              buffered_netstream_write_some_nonblock,
+                              buffered_netstream_flush } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_VECTORED,
+                      &(const avs_stream_v_table_extension_vectored_t) {
+                              buffered_netstream_writev,
+                              buffered_netstream_readv } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_ZEROCOPY,
+                      &(const avs_stream_v_table_extension_zerocopy_t) {
+                              buffered_netstream_peek_contiguous,
+                              buffered_netstream_consume,
+                              buffered_netstream_reserve,
+                              buffered_netstream_commit } },
+#    ifdef AVS_COMMONS_STREAM_WITH_SENDFILE
+                    { AVS_STREAM_V_TABLE_EXTENSION_FD,
+                      &(const avs_stream_v_table_extension_fd_t) {
+                              buffered_netstream_get_fd,
+                              buffered_netstream_fd_advance } },
+#    endif // AVS_COMMONS_STREAM_WITH_SENDFILE
                     AVS_STREAM_V_TABLE_EXTENSION_NULL }
 };
 
@@ -410,6 +738,10 @@ void avs_stream_netbuf_set_recv_timeout(avs_stream_t *str,
                            timeout_opt);
 }
 
+#    ifdef AVS_UNIT_TESTING
+#        include "tests/stream/test_stream_netbuf.c"
+#    endif
+
 #endif // defined(AVS_COMMONS_WITH_AVS_STREAM) &&
        // defined(AVS_COMMONS_WITH_AVS_BUFFER) &&
        // defined(AVS_COMMONS_WITH_AVS_NET)
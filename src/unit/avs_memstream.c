@@ -28,6 +28,9 @@
 #    include <avsystem/commons/avs_unit_memstream.h>
 #    include <avsystem/commons/avs_unit_test.h>
 
+#    define MODULE_NAME avs_unit
+#    include <avs_x_log_config.h>
+
 VISIBILITY_SOURCE_BEGIN
 
 typedef struct {
@@ -26,6 +26,9 @@
 
 #    include <avsystem/commons/avs_unit_mock_helpers.h>
 
+#    define MODULE_NAME avs_unit
+#    include <avs_x_log_config.h>
+
 VISIBILITY_SOURCE_BEGIN
 
 typedef struct {
@@ -43,6 +43,9 @@
 
 #    include "avs_unit_test_private.h"
 
+#    define MODULE_NAME avs_unit
+#    include <avs_x_log_config.h>
+
 VISIBILITY_SOURCE_BEGIN
 
 #    define MAX_TRACE_LEVELS 256
@@ -45,6 +45,9 @@
 #    include "avs_stack_trace.h"
 #    include "avs_unit_test_private.h"
 
+#    define MODULE_NAME avs_unit
+#    include <avs_x_log_config.h>
+
 VISIBILITY_SOURCE_BEGIN
 
 typedef struct avs_unit_test_struct {
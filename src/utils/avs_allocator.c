@@ -0,0 +1,264 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define AVS_UTILS_ALLOCATOR_C
+#include <avs_commons_init.h>
+
+#if defined(AVS_COMMONS_WITH_AVS_UTILS) \
+        && defined(AVS_COMMONS_UTILS_WITH_ALLOCATORS)
+
+#    include <assert.h>
+#    include <stdint.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_allocator.h>
+#    include <avsystem/commons/avs_memory.h>
+
+#    include "avs_memory_stats_impl.h"
+#    ifdef AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+#        include "avs_memory_stats_module.h"
+#    endif // AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+
+VISIBILITY_SOURCE_BEGIN
+
+/**
+ * Every block handed out by this layer is preceded by a header that records
+ * where the block came from, so that avs_free() and avs_realloc() do not need
+ * any context. The union makes sure that the user part stays aligned for any
+ * type.
+ */
+typedef union {
+    struct {
+        avs_allocator_t *allocator;
+        size_t size;
+#    ifdef AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+        avs_memory_stats_slot_t *stats_slot;
+#    endif // AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+    } info;
+    avs_max_align_t align;
+} block_header_t;
+
+static avs_allocator_t *SUBSYSTEM_ALLOCATORS[AVS_MEMORY_SUBSYSTEM_COUNT_];
+
+static block_header_t *get_header(void *ptr) {
+    return (block_header_t *) ((char *) ptr - sizeof(block_header_t));
+}
+
+void avs_memory_set_allocator(avs_memory_subsystem_t subsystem,
+                              avs_allocator_t *allocator) {
+    assert((int) subsystem >= 0 && subsystem < AVS_MEMORY_SUBSYSTEM_COUNT_);
+    SUBSYSTEM_ALLOCATORS[subsystem] = allocator;
+}
+
+avs_allocator_t *avs_memory_get_allocator(avs_memory_subsystem_t subsystem) {
+    assert((int) subsystem >= 0 && subsystem < AVS_MEMORY_SUBSYSTEM_COUNT_);
+    if (SUBSYSTEM_ALLOCATORS[subsystem]) {
+        return SUBSYSTEM_ALLOCATORS[subsystem];
+    }
+    if (SUBSYSTEM_ALLOCATORS[AVS_MEMORY_SUBSYSTEM_DEFAULT]) {
+        return SUBSYSTEM_ALLOCATORS[AVS_MEMORY_SUBSYSTEM_DEFAULT];
+    }
+    return avs_allocator_system();
+}
+
+static avs_memory_stats_slot_t *slot_for_tag(const char *tag) {
+#    ifdef AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+    return _avs_memory_stats_slot(tag);
+#    else  // AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+    (void) tag;
+    return NULL;
+#    endif // AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+}
+
+void *_avs_allocator_malloc_in_slot(avs_allocator_t *allocator,
+                                    size_t size,
+                                    avs_memory_stats_slot_t *slot) {
+    block_header_t *header;
+    (void) slot;
+    if (size > SIZE_MAX - sizeof(block_header_t)) {
+        return NULL;
+    }
+    header = (block_header_t *) allocator->vtable->alloc_fn(
+            allocator, sizeof(block_header_t) + size);
+    if (!header) {
+        return NULL;
+    }
+    header->info.allocator = allocator;
+    header->info.size = size;
+#    ifdef AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+    header->info.stats_slot = slot;
+    _avs_memory_stats_on_alloc(slot, size);
+#    endif // AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+    return header + 1;
+}
+
+void *avs_allocator_malloc_tagged(avs_allocator_t *allocator,
+                                  size_t size,
+                                  const char *tag) {
+    return _avs_allocator_malloc_in_slot(allocator, size, slot_for_tag(tag));
+}
+
+void *avs_allocator_malloc(avs_allocator_t *allocator, size_t size) {
+    return avs_allocator_malloc_tagged(allocator, size, NULL);
+}
+
+void *_avs_allocator_calloc_in_slot(avs_allocator_t *allocator,
+                                    size_t nmemb,
+                                    size_t size,
+                                    avs_memory_stats_slot_t *slot) {
+    void *result;
+    if (size && nmemb > SIZE_MAX / size) {
+        return NULL;
+    }
+    result = _avs_allocator_malloc_in_slot(allocator, nmemb * size, slot);
+    if (result) {
+        memset(result, 0, nmemb * size);
+    }
+    return result;
+}
+
+void *avs_allocator_calloc_tagged(avs_allocator_t *allocator,
+                                  size_t nmemb,
+                                  size_t size,
+                                  const char *tag) {
+    return _avs_allocator_calloc_in_slot(allocator, nmemb, size,
+                                         slot_for_tag(tag));
+}
+
+void *avs_allocator_calloc(avs_allocator_t *allocator,
+                           size_t nmemb,
+                           size_t size) {
+    return avs_allocator_calloc_tagged(allocator, nmemb, size, NULL);
+}
+
+void *_avs_allocator_realloc_in_slot(avs_allocator_t *allocator,
+                                     void *ptr,
+                                     size_t size,
+                                     avs_memory_stats_slot_t *slot) {
+    block_header_t *header;
+    avs_allocator_t *owner;
+    void *result;
+    if (!ptr) {
+        return _avs_allocator_malloc_in_slot(allocator, size, slot);
+    }
+    if (!size) {
+        avs_free(ptr);
+        return NULL;
+    }
+    if (size > SIZE_MAX - sizeof(block_header_t)) {
+        return NULL;
+    }
+    header = get_header(ptr);
+    owner = header->info.allocator;
+    if (owner->vtable->realloc_fn) {
+        block_header_t *new_header =
+                (block_header_t *) owner->vtable->realloc_fn(
+                        owner, header,
+                        sizeof(block_header_t) + header->info.size,
+                        sizeof(block_header_t) + size);
+        if (!new_header) {
+            return NULL;
+        }
+#    ifdef AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+        _avs_memory_stats_on_resize(new_header->info.stats_slot,
+                                    new_header->info.size, size);
+#    endif // AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+        new_header->info.size = size;
+        return new_header + 1;
+    }
+    result = _avs_allocator_malloc_in_slot(owner, size, slot);
+    if (result) {
+        memcpy(result, ptr, AVS_MIN(size, header->info.size));
+        avs_free(ptr);
+    }
+    return result;
+}
+
+void *avs_allocator_realloc_tagged(avs_allocator_t *allocator,
+                                   void *ptr,
+                                   size_t size,
+                                   const char *tag) {
+    return _avs_allocator_realloc_in_slot(allocator, ptr, size,
+                                          slot_for_tag(tag));
+}
+
+void *
+avs_allocator_realloc(avs_allocator_t *allocator, void *ptr, size_t size) {
+    return avs_allocator_realloc_tagged(allocator, ptr, size, NULL);
+}
+
+#    ifdef AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+static avs_allocator_t *subsystem_allocator(int subsystem) {
+    if (subsystem == _AVS_MEMORY_SUBSYSTEM_NONE) {
+        return avs_memory_get_allocator(AVS_MEMORY_SUBSYSTEM_DEFAULT);
+    }
+    return avs_memory_get_allocator((avs_memory_subsystem_t) subsystem);
+}
+
+void *_avs_memory_malloc_in_slot(int subsystem,
+                                 size_t size,
+                                 avs_memory_stats_slot_t *slot) {
+    return _avs_allocator_malloc_in_slot(subsystem_allocator(subsystem), size,
+                                         slot);
+}
+
+void *_avs_memory_calloc_in_slot(int subsystem,
+                                 size_t nmemb,
+                                 size_t size,
+                                 avs_memory_stats_slot_t *slot) {
+    return _avs_allocator_calloc_in_slot(subsystem_allocator(subsystem),
+                                         nmemb, size, slot);
+}
+
+void *_avs_memory_realloc_in_slot(int subsystem,
+                                  void *ptr,
+                                  size_t size,
+                                  avs_memory_stats_slot_t *slot) {
+    return _avs_allocator_realloc_in_slot(subsystem_allocator(subsystem), ptr,
+                                          size, slot);
+}
+#    endif // AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+
+void *avs_malloc(size_t size) {
+    return avs_allocator_malloc(
+            avs_memory_get_allocator(AVS_MEMORY_SUBSYSTEM_DEFAULT), size);
+}
+
+void *avs_calloc(size_t nmemb, size_t size) {
+    return avs_allocator_calloc(
+            avs_memory_get_allocator(AVS_MEMORY_SUBSYSTEM_DEFAULT), nmemb,
+            size);
+}
+
+void *avs_realloc(void *ptr, size_t size) {
+    return avs_allocator_realloc(
+            avs_memory_get_allocator(AVS_MEMORY_SUBSYSTEM_DEFAULT), ptr, size);
+}
+
+void avs_free(void *ptr) {
+    if (ptr) {
+        block_header_t *header = get_header(ptr);
+        avs_allocator_t *owner = header->info.allocator;
+#    ifdef AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+        _avs_memory_stats_on_free(header->info.stats_slot, header->info.size);
+#    endif // AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+        owner->vtable->free_fn(owner, header,
+                               sizeof(block_header_t) + header->info.size);
+    }
+}
+
+#endif // defined(AVS_COMMONS_WITH_AVS_UTILS) &&
+       // defined(AVS_COMMONS_UTILS_WITH_ALLOCATORS)
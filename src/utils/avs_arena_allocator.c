@@ -0,0 +1,221 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#if defined(AVS_COMMONS_WITH_AVS_UTILS) \
+        && defined(AVS_COMMONS_UTILS_WITH_ALLOCATORS)
+
+#    include <assert.h>
+#    include <stdbool.h>
+#    include <stddef.h>
+#    include <stdint.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_allocator.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+#    define ARENA_ALIGNMENT AVS_ALIGNOF(avs_max_align_t)
+
+typedef struct arena_chunk_struct {
+    struct arena_chunk_struct *next;
+    size_t capacity;
+    size_t used;
+    union {
+        char data[1]; /* variable length */
+        avs_max_align_t align;
+    } data;
+} arena_chunk_t;
+
+typedef struct {
+    avs_allocator_t allocator;
+    avs_allocator_t *backing;
+    size_t chunk_size;
+    size_t max_size;
+    size_t bytes_reserved;
+    /* list of chunks, the one currently allocated from is the first one */
+    arena_chunk_t *chunks;
+    /* most recently allocated block, which may be freed or resized in place */
+    char *last_block;
+} arena_allocator_t;
+
+static size_t align_size(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+}
+
+static size_t chunk_total_size(size_t capacity) {
+    return offsetof(arena_chunk_t, data) + capacity;
+}
+
+static int add_chunk(arena_allocator_t *arena, size_t min_capacity) {
+    size_t capacity = AVS_MAX(arena->chunk_size, min_capacity);
+    if (capacity > SIZE_MAX - offsetof(arena_chunk_t, data)
+            || (arena->max_size
+                && chunk_total_size(capacity)
+                               > arena->max_size - arena->bytes_reserved)) {
+        return -1;
+    }
+    arena_chunk_t *chunk = (arena_chunk_t *) arena->backing->vtable->alloc_fn(
+            arena->backing, chunk_total_size(capacity));
+    if (!chunk) {
+        return -1;
+    }
+    chunk->next = arena->chunks;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    arena->chunks = chunk;
+    arena->bytes_reserved += chunk_total_size(capacity);
+    return 0;
+}
+
+static void free_chunk(arena_allocator_t *arena, arena_chunk_t *chunk) {
+    arena->bytes_reserved -= chunk_total_size(chunk->capacity);
+    arena->backing->vtable->free_fn(arena->backing, chunk,
+                                    chunk_total_size(chunk->capacity));
+}
+
+static void *arena_alloc(avs_allocator_t *allocator, size_t size) {
+    arena_allocator_t *arena = (arena_allocator_t *) allocator;
+    if (size > SIZE_MAX - ARENA_ALIGNMENT) {
+        return NULL;
+    }
+    size = align_size(size);
+    if ((!arena->chunks
+         || arena->chunks->capacity - arena->chunks->used < size)
+            && add_chunk(arena, size)) {
+        return NULL;
+    }
+    arena->last_block = arena->chunks->data.data + arena->chunks->used;
+    arena->chunks->used += size;
+    return arena->last_block;
+}
+
+static bool is_last_block(arena_allocator_t *arena, void *ptr) {
+    return arena->chunks && ptr == arena->last_block;
+}
+
+static void *arena_realloc(avs_allocator_t *allocator,
+                           void *ptr,
+                           size_t old_size,
+                           size_t new_size) {
+    arena_allocator_t *arena = (arena_allocator_t *) allocator;
+    old_size = align_size(old_size);
+    if (new_size <= SIZE_MAX - ARENA_ALIGNMENT && is_last_block(arena, ptr)) {
+        size_t available =
+                arena->chunks->capacity - arena->chunks->used + old_size;
+        if (align_size(new_size) <= available) {
+            arena->chunks->used =
+                    arena->chunks->used - old_size + align_size(new_size);
+            return ptr;
+        }
+    }
+    if (new_size <= old_size) {
+        return ptr;
+    }
+    void *result = arena_alloc(allocator, new_size);
+    if (result) {
+        memcpy(result, ptr, old_size);
+    }
+    return result;
+}
+
+static void arena_free(avs_allocator_t *allocator, void *ptr, size_t size) {
+    arena_allocator_t *arena = (arena_allocator_t *) allocator;
+    if (is_last_block(arena, ptr)) {
+        arena->chunks->used -= align_size(size);
+        arena->last_block = NULL;
+    }
+}
+
+static const avs_allocator_v_table_t arena_allocator_vtable = {
+    .alloc_fn = arena_alloc,
+    .realloc_fn = arena_realloc,
+    .free_fn = arena_free
+};
+
+static arena_allocator_t *get_arena(const avs_allocator_t *allocator) {
+    assert(allocator->vtable == &arena_allocator_vtable);
+    return (arena_allocator_t *) (intptr_t) allocator;
+}
+
+int avs_arena_allocator_create(avs_allocator_t **out_arena,
+                               avs_allocator_t *backing,
+                               size_t chunk_size,
+                               size_t max_size) {
+    if (!backing) {
+        backing = avs_allocator_system();
+    }
+    arena_allocator_t *arena = (arena_allocator_t *) backing->vtable->alloc_fn(
+            backing, sizeof(arena_allocator_t));
+    if (!arena) {
+        *out_arena = NULL;
+        return -1;
+    }
+    memset(arena, 0, sizeof(*arena));
+    arena->allocator.vtable = &arena_allocator_vtable;
+    arena->backing = backing;
+    arena->chunk_size = align_size(chunk_size);
+    arena->max_size = max_size;
+    *out_arena = &arena->allocator;
+    return 0;
+}
+
+void avs_arena_allocator_reset(avs_allocator_t *allocator) {
+    arena_allocator_t *arena = get_arena(allocator);
+    if (!arena->chunks) {
+        return;
+    }
+    /* the oldest chunk is the last one on the list */
+    while (arena->chunks->next) {
+        arena_chunk_t *chunk = arena->chunks;
+        arena->chunks = chunk->next;
+        free_chunk(arena, chunk);
+    }
+    arena->chunks->used = 0;
+    arena->last_block = NULL;
+}
+
+void avs_arena_allocator_cleanup(avs_allocator_t **arena_ptr) {
+    if (!*arena_ptr) {
+        return;
+    }
+    arena_allocator_t *arena = get_arena(*arena_ptr);
+    while (arena->chunks) {
+        arena_chunk_t *chunk = arena->chunks;
+        arena->chunks = chunk->next;
+        free_chunk(arena, chunk);
+    }
+    arena->backing->vtable->free_fn(arena->backing, arena, sizeof(*arena));
+    *arena_ptr = NULL;
+}
+
+size_t avs_arena_allocator_bytes_used(const avs_allocator_t *allocator) {
+    const arena_allocator_t *arena = get_arena(allocator);
+    size_t result = 0;
+    for (const arena_chunk_t *chunk = arena->chunks; chunk;
+         chunk = chunk->next) {
+        result += chunk->used;
+    }
+    return result;
+}
+
+size_t avs_arena_allocator_bytes_reserved(const avs_allocator_t *allocator) {
+    return get_arena(allocator)->bytes_reserved;
+}
+
+#endif // defined(AVS_COMMONS_WITH_AVS_UTILS) &&
+       // defined(AVS_COMMONS_UTILS_WITH_ALLOCATORS)
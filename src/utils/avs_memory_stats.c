@@ -0,0 +1,253 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#if defined(AVS_COMMONS_WITH_AVS_UTILS) \
+        && defined(AVS_COMMONS_UTILS_WITH_MEMORY_STATS)
+
+#    include <stdatomic.h>
+#    include <stdbool.h>
+#    include <stdint.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_memory_stats.h>
+
+#    include "avs_memory_stats_impl.h"
+#    include "avs_memory_stats_module.h"
+
+#    define MODULE_NAME avs_utils
+#    include <avs_x_log_config.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+struct avs_memory_stats_slot_struct {
+    /* const char *, stored as an integer so that the atomic type can be
+     * spelled using the stdatomic.h typedefs */
+    atomic_uintptr_t tag;
+    atomic_size_t live_bytes;
+    atomic_size_t peak_bytes;
+    atomic_size_t live_allocations;
+    atomic_size_t total_allocations;
+    atomic_size_t histogram[AVS_MEMORY_STATS_HISTOGRAM_BUCKETS];
+};
+
+/* slot 0 is reserved for AVS_MEMORY_STATS_UNTAGGED */
+static avs_memory_stats_slot_t SLOTS[AVS_MEMORY_STATS_MAX_TAGS] = {
+    {
+        .tag = (uintptr_t) AVS_MEMORY_STATS_UNTAGGED
+    }
+};
+
+static atomic_size_t ALLOCATION_COUNTER;
+static atomic_size_t DUMP_PERIOD;
+static atomic_bool DUMP_DUE;
+
+static const char *load_tag(avs_memory_stats_slot_t *slot) {
+    return (const char *) atomic_load_explicit(&slot->tag,
+                                               memory_order_acquire);
+}
+
+static bool tag_matches(const char *slot_tag, const char *tag) {
+    return slot_tag == tag || strcmp(slot_tag, tag) == 0;
+}
+
+avs_memory_stats_slot_t *_avs_memory_stats_slot(const char *tag) {
+    if (!tag) {
+        return &SLOTS[0];
+    }
+    for (size_t i = 0; i < AVS_MEMORY_STATS_MAX_TAGS; ++i) {
+        uintptr_t slot_tag =
+                atomic_load_explicit(&SLOTS[i].tag, memory_order_acquire);
+        if (!slot_tag
+                && atomic_compare_exchange_strong_explicit(
+                           &SLOTS[i].tag, &slot_tag, (uintptr_t) tag,
+                           memory_order_acq_rel, memory_order_acquire)) {
+            return &SLOTS[i];
+        }
+        /* if another thread claimed the slot first, slot_tag now holds the
+         * tag it has stored */
+        if (tag_matches((const char *) slot_tag, tag)) {
+            return &SLOTS[i];
+        }
+    }
+    return &SLOTS[0];
+}
+
+avs_memory_stats_slot_t *_avs_memory_stats_cached_slot(atomic_uintptr_t *cache,
+                                                       const char *tag) {
+    uintptr_t slot = atomic_load_explicit(cache, memory_order_relaxed);
+    if (!slot) {
+        /* threads racing here all store the same value */
+        slot = (uintptr_t) _avs_memory_stats_slot(tag);
+        atomic_store_explicit(cache, slot, memory_order_relaxed);
+    }
+    return (avs_memory_stats_slot_t *) slot;
+}
+
+static size_t histogram_bucket(size_t size) {
+    size_t bucket = 0;
+    size_t limit = 16;
+    while (size > limit && bucket < AVS_MEMORY_STATS_HISTOGRAM_BUCKETS - 1) {
+        limit *= 2;
+        ++bucket;
+    }
+    return bucket;
+}
+
+static void add_live_bytes(avs_memory_stats_slot_t *slot, size_t size) {
+    size_t live = atomic_fetch_add_explicit(&slot->live_bytes, size,
+                                            memory_order_relaxed)
+                  + size;
+    size_t peak = atomic_load_explicit(&slot->peak_bytes, memory_order_relaxed);
+    while (live > peak
+           && !atomic_compare_exchange_weak_explicit(&slot->peak_bytes, &peak,
+                                                     live, memory_order_relaxed,
+                                                     memory_order_relaxed)) {
+    }
+}
+
+static void count_allocation(void) {
+    size_t period = atomic_load_explicit(&DUMP_PERIOD, memory_order_relaxed);
+    size_t count = atomic_fetch_add_explicit(&ALLOCATION_COUNTER, 1,
+                                             memory_order_relaxed)
+                   + 1;
+    if (period && count % period == 0) {
+        atomic_store_explicit(&DUMP_DUE, true, memory_order_relaxed);
+    }
+}
+
+void _avs_memory_stats_on_alloc(avs_memory_stats_slot_t *slot, size_t size) {
+    atomic_fetch_add_explicit(&slot->live_allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&slot->total_allocations, 1,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&slot->histogram[histogram_bucket(size)], 1,
+                              memory_order_relaxed);
+    add_live_bytes(slot, size);
+    count_allocation();
+}
+
+void _avs_memory_stats_on_resize(avs_memory_stats_slot_t *slot,
+                                 size_t old_size,
+                                 size_t new_size) {
+    if (new_size > old_size) {
+        add_live_bytes(slot, new_size - old_size);
+    } else {
+        atomic_fetch_sub_explicit(&slot->live_bytes, old_size - new_size,
+                                  memory_order_relaxed);
+    }
+}
+
+void _avs_memory_stats_on_free(avs_memory_stats_slot_t *slot, size_t size) {
+    atomic_fetch_sub_explicit(&slot->live_allocations, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&slot->live_bytes, size, memory_order_relaxed);
+}
+
+static void read_slot(avs_memory_stats_slot_t *slot,
+                      avs_memory_stats_t *out_stats) {
+    out_stats->tag = load_tag(slot);
+    out_stats->live_bytes =
+            atomic_load_explicit(&slot->live_bytes, memory_order_relaxed);
+    out_stats->peak_bytes =
+            atomic_load_explicit(&slot->peak_bytes, memory_order_relaxed);
+    out_stats->live_allocations =
+            atomic_load_explicit(&slot->live_allocations, memory_order_relaxed);
+    out_stats->total_allocations = atomic_load_explicit(
+            &slot->total_allocations, memory_order_relaxed);
+    for (size_t i = 0; i < AVS_MEMORY_STATS_HISTOGRAM_BUCKETS; ++i) {
+        out_stats->histogram[i] =
+                atomic_load_explicit(&slot->histogram[i], memory_order_relaxed);
+    }
+}
+
+int avs_memory_stats_get(const char *tag, avs_memory_stats_t *out_stats) {
+    for (size_t i = 0; i < AVS_MEMORY_STATS_MAX_TAGS; ++i) {
+        const char *slot_tag = load_tag(&SLOTS[i]);
+        if (!slot_tag) {
+            break;
+        }
+        if (tag_matches(slot_tag, tag)) {
+            read_slot(&SLOTS[i], out_stats);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void avs_memory_stats_foreach(avs_memory_stats_handler_t *handler, void *arg) {
+    for (size_t i = 0; i < AVS_MEMORY_STATS_MAX_TAGS; ++i) {
+        if (!load_tag(&SLOTS[i])) {
+            break;
+        }
+        avs_memory_stats_t stats;
+        read_slot(&SLOTS[i], &stats);
+        if (stats.total_allocations) {
+            handler(&stats, arg);
+        }
+    }
+}
+
+static void add_to_total(const avs_memory_stats_t *stats, void *total_) {
+    avs_memory_stats_t *total = (avs_memory_stats_t *) total_;
+    total->live_bytes += stats->live_bytes;
+    total->peak_bytes += stats->peak_bytes;
+    total->live_allocations += stats->live_allocations;
+    total->total_allocations += stats->total_allocations;
+    for (size_t i = 0; i < AVS_MEMORY_STATS_HISTOGRAM_BUCKETS; ++i) {
+        total->histogram[i] += stats->histogram[i];
+    }
+}
+
+void avs_memory_stats_get_total(avs_memory_stats_t *out_stats) {
+    memset(out_stats, 0, sizeof(*out_stats));
+    avs_memory_stats_foreach(add_to_total, out_stats);
+}
+
+void avs_memory_stats_reset_peak(void) {
+    for (size_t i = 0; i < AVS_MEMORY_STATS_MAX_TAGS; ++i) {
+        atomic_store_explicit(&SLOTS[i].peak_bytes,
+                              atomic_load_explicit(&SLOTS[i].live_bytes,
+                                                   memory_order_relaxed),
+                              memory_order_relaxed);
+    }
+}
+
+void avs_memory_stats_set_dump_period(size_t period) {
+    atomic_store_explicit(&DUMP_PERIOD, period, memory_order_relaxed);
+    atomic_store_explicit(&DUMP_DUE, false, memory_order_relaxed);
+}
+
+bool avs_memory_stats_dump_due(void) {
+    return atomic_exchange_explicit(&DUMP_DUE, false, memory_order_relaxed);
+}
+
+static void log_stats(const avs_memory_stats_t *stats, void *arg) {
+    (void) arg;
+    LOG(INFO,
+        "%s" _(": live ") "%lu" _(" B in ") "%lu" _(" blocks, peak ") "%lu" _(
+                " B, ") "%lu" _(" allocations total"),
+        stats->tag, (unsigned long) stats->live_bytes,
+        (unsigned long) stats->live_allocations,
+        (unsigned long) stats->peak_bytes,
+        (unsigned long) stats->total_allocations);
+}
+
+void avs_memory_stats_log(void) {
+    avs_memory_stats_foreach(log_stats, NULL);
+}
+
+#endif // defined(AVS_COMMONS_WITH_AVS_UTILS) &&
+       // defined(AVS_COMMONS_UTILS_WITH_MEMORY_STATS)
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVS_COMMONS_UTILS_MEMORY_STATS_IMPL_H
+#define AVS_COMMONS_UTILS_MEMORY_STATS_IMPL_H
+
+#include <stddef.h>
+
+#include <avsystem/commons/avs_allocator.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+struct avs_memory_stats_slot_struct;
+typedef struct avs_memory_stats_slot_struct avs_memory_stats_slot_t;
+
+/**
+ * Same as avs_allocator_malloc_tagged(), avs_allocator_calloc_tagged() and
+ * avs_allocator_realloc_tagged(), respectively, but take an already looked up
+ * statistics slot, which is ignored unless AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+ * is enabled. Used by avs_x_log_config.h to tag library allocations.
+ */
+void *_avs_allocator_malloc_in_slot(avs_allocator_t *allocator,
+                                    size_t size,
+                                    avs_memory_stats_slot_t *slot);
+
+void *_avs_allocator_calloc_in_slot(avs_allocator_t *allocator,
+                                    size_t nmemb,
+                                    size_t size,
+                                    avs_memory_stats_slot_t *slot);
+
+void *_avs_allocator_realloc_in_slot(avs_allocator_t *allocator,
+                                     void *ptr,
+                                     size_t size,
+                                     avs_memory_stats_slot_t *slot);
+
+#ifdef AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+/**
+ * Finds the statistics slot for @p tag, allocating one if necessary. NULL
+ * @p tag, or running out of slots, maps to the slot for
+ * AVS_MEMORY_STATS_UNTAGGED. Never returns NULL.
+ */
+avs_memory_stats_slot_t *_avs_memory_stats_slot(const char *tag);
+
+/**
+ * Accounts for a new block of @p size bytes. May mark a statistics dump as
+ * due.
+ */
+void _avs_memory_stats_on_alloc(avs_memory_stats_slot_t *slot, size_t size);
+
+/**
+ * Accounts for a block changing its size from @p old_size to @p new_size.
+ */
+void _avs_memory_stats_on_resize(avs_memory_stats_slot_t *slot,
+                                 size_t old_size,
+                                 size_t new_size);
+
+/**
+ * Accounts for a block of @p size bytes being freed.
+ */
+void _avs_memory_stats_on_free(avs_memory_stats_slot_t *slot, size_t size);
+#endif // AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* AVS_COMMONS_UTILS_MEMORY_STATS_IMPL_H */
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVS_COMMONS_UTILS_MEMORY_STATS_MODULE_H
+#define AVS_COMMONS_UTILS_MEMORY_STATS_MODULE_H
+
+/*
+ * This header is included by avs_x_log_config.h into every library source
+ * when AVS_COMMONS_UTILS_WITH_MEMORY_STATS is enabled, so it deliberately
+ * does not depend on avs_allocator.h.
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+struct avs_memory_stats_slot_struct;
+
+/**
+ * Value passed as the subsystem argument of _avs_memory_malloc_in_slot() etc.
+ * by sources that do not define AVS_MEMORY_SUBSYSTEM. Maps to
+ * AVS_MEMORY_SUBSYSTEM_DEFAULT.
+ */
+#define _AVS_MEMORY_SUBSYSTEM_NONE (-1)
+
+/**
+ * Returns the statistics slot for @p tag. The slot is looked up only if
+ * @p cache is zero, and is then stored in it, so that subsequent calls do not
+ * compare tag strings. Never returns NULL.
+ */
+struct avs_memory_stats_slot_struct *
+_avs_memory_stats_cached_slot(atomic_uintptr_t *cache, const char *tag);
+
+/**
+ * Same as _avs_allocator_malloc_in_slot(), _avs_allocator_calloc_in_slot()
+ * and _avs_allocator_realloc_in_slot(), respectively, but use the allocator
+ * configured for @p subsystem, which is either an avs_memory_subsystem_t
+ * value or _AVS_MEMORY_SUBSYSTEM_NONE.
+ */
+void *_avs_memory_malloc_in_slot(int subsystem,
+                                 size_t size,
+                                 struct avs_memory_stats_slot_struct *slot);
+
+void *_avs_memory_calloc_in_slot(int subsystem,
+                                 size_t nmemb,
+                                 size_t size,
+                                 struct avs_memory_stats_slot_struct *slot);
+
+void *_avs_memory_realloc_in_slot(int subsystem,
+                                  void *ptr,
+                                  size_t size,
+                                  struct avs_memory_stats_slot_struct *slot);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* AVS_COMMONS_UTILS_MEMORY_STATS_MODULE_H */
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#ifdef AVS_COMMONS_WITH_AVS_UTILS
+
+#    include <assert.h>
+#    include <stddef.h>
+
+#    ifdef AVS_COMMONS_HAVE_C11_STDATOMIC
+#        include <stdatomic.h>
+#    endif // AVS_COMMONS_HAVE_C11_STDATOMIC
+
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_refbuf.h>
+
+#    define MODULE_NAME avs_utils
+#    include <avs_x_log_config.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+#    ifdef AVS_COMMONS_HAVE_C11_STDATOMIC
+typedef atomic_size_t refcount_t;
+#    else  // AVS_COMMONS_HAVE_C11_STDATOMIC
+/* not thread-safe; avs_refbuf.h documents that buffers shall then be managed
+ * from a single thread */
+typedef size_t refcount_t;
+#    endif // AVS_COMMONS_HAVE_C11_STDATOMIC
+
+struct avs_refbuf_struct {
+    refcount_t refcount;
+    size_t size;
+    /* memory block passed to avs_refbuf_wrap(), or NULL if the data is stored
+     * in the inline storage below */
+    void *wrapped;
+    union {
+        char data[1]; /* variable length */
+        avs_max_align_t align;
+    } storage;
+};
+
+static void refcount_init(avs_refbuf_t *buf) {
+#    ifdef AVS_COMMONS_HAVE_C11_STDATOMIC
+    atomic_init(&buf->refcount, 1);
+#    else  // AVS_COMMONS_HAVE_C11_STDATOMIC
+    buf->refcount = 1;
+#    endif // AVS_COMMONS_HAVE_C11_STDATOMIC
+}
+
+static void refcount_increment(avs_refbuf_t *buf) {
+#    ifdef AVS_COMMONS_HAVE_C11_STDATOMIC
+    /* a new reference can only be created from an existing one, so no
+     * ordering is necessary */
+    atomic_fetch_add_explicit(&buf->refcount, 1, memory_order_relaxed);
+#    else  // AVS_COMMONS_HAVE_C11_STDATOMIC
+    ++buf->refcount;
+#    endif // AVS_COMMONS_HAVE_C11_STDATOMIC
+}
+
+/* returns true if the last reference has been dropped */
+static bool refcount_decrement(avs_refbuf_t *buf) {
+#    ifdef AVS_COMMONS_HAVE_C11_STDATOMIC
+    /* all accesses to the buffer through the dropped reference shall happen
+     * before the buffer is freed by whichever thread drops the last one */
+    if (atomic_fetch_sub_explicit(&buf->refcount, 1, memory_order_release)
+            == 1) {
+        atomic_thread_fence(memory_order_acquire);
+        return true;
+    }
+    return false;
+#    else  // AVS_COMMONS_HAVE_C11_STDATOMIC
+    return --buf->refcount == 0;
+#    endif // AVS_COMMONS_HAVE_C11_STDATOMIC
+}
+
+static size_t refcount_get(const avs_refbuf_t *buf) {
+#    ifdef AVS_COMMONS_HAVE_C11_STDATOMIC
+    return atomic_load_explicit((refcount_t *) (intptr_t) &buf->refcount,
+                                memory_order_acquire);
+#    else  // AVS_COMMONS_HAVE_C11_STDATOMIC
+    return buf->refcount;
+#    endif // AVS_COMMONS_HAVE_C11_STDATOMIC
+}
+
+avs_refbuf_t *avs_refbuf_new(size_t size) {
+    if (size > SIZE_MAX - offsetof(avs_refbuf_t, storage)) {
+        return NULL;
+    }
+    avs_refbuf_t *buf = (avs_refbuf_t *) avs_malloc(
+            offsetof(avs_refbuf_t, storage) + size);
+    if (!buf) {
+        LOG(ERROR, _("out of memory"));
+        return NULL;
+    }
+    refcount_init(buf);
+    buf->size = size;
+    buf->wrapped = NULL;
+    return buf;
+}
+
+avs_refbuf_t *avs_refbuf_wrap(void *data, size_t size) {
+    assert(data || !size);
+    avs_refbuf_t *buf =
+            (avs_refbuf_t *) avs_malloc(offsetof(avs_refbuf_t, storage));
+    if (!buf) {
+        LOG(ERROR, _("out of memory"));
+        return NULL;
+    }
+    refcount_init(buf);
+    buf->size = size;
+    buf->wrapped = data;
+    return buf;
+}
+
+void *avs_refbuf_data(avs_refbuf_t *buf) {
+    return buf->wrapped ? buf->wrapped : (void *) buf->storage.data;
+}
+
+size_t avs_refbuf_size(const avs_refbuf_t *buf) {
+    return buf->size;
+}
+
+avs_refbuf_t *avs_refbuf_ref(avs_refbuf_t *buf) {
+    refcount_increment(buf);
+    return buf;
+}
+
+void avs_refbuf_unref(avs_refbuf_t **buf_ptr) {
+    if (*buf_ptr && refcount_decrement(*buf_ptr)) {
+        avs_free((*buf_ptr)->wrapped);
+        avs_free(*buf_ptr);
+    }
+    *buf_ptr = NULL;
+}
+
+bool avs_refbuf_is_unique(const avs_refbuf_t *buf) {
+    return refcount_get(buf) == 1;
+}
+
+void *avs_refbuf_unwrap(avs_refbuf_t **buf_ptr) {
+    if (!(*buf_ptr)->wrapped || !avs_refbuf_is_unique(*buf_ptr)) {
+        return NULL;
+    }
+    void *result = (*buf_ptr)->wrapped;
+    avs_free(*buf_ptr);
+    *buf_ptr = NULL;
+    return result;
+}
+
+int avs_refbuf_slice(avs_refbuf_slice_t *out_slice,
+                     avs_refbuf_t *buf,
+                     size_t offset,
+                     size_t size) {
+    if (offset > buf->size || size > buf->size - offset) {
+        *out_slice = (avs_refbuf_slice_t) AVS_REFBUF_SLICE_EMPTY;
+        return -1;
+    }
+    out_slice->buffer = avs_refbuf_ref(buf);
+    out_slice->data = (const char *) avs_refbuf_data(buf) + offset;
+    out_slice->size = size;
+    return 0;
+}
+
+int avs_refbuf_slice_sub(avs_refbuf_slice_t *out_slice,
+                         const avs_refbuf_slice_t *slice,
+                         size_t offset,
+                         size_t size) {
+    if (offset > slice->size || size > slice->size - offset) {
+        return -1;
+    }
+    if (out_slice != slice && slice->buffer) {
+        avs_refbuf_ref(slice->buffer);
+    }
+    out_slice->buffer = slice->buffer;
+    out_slice->data = slice->data ? (const char *) slice->data + offset : NULL;
+    out_slice->size = size;
+    return 0;
+}
+
+void avs_refbuf_slice_release(avs_refbuf_slice_t *slice) {
+    avs_refbuf_unref(&slice->buffer);
+    slice->data = NULL;
+    slice->size = 0;
+}
+
+#endif // AVS_COMMONS_WITH_AVS_UTILS
@@ -0,0 +1,220 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#if defined(AVS_COMMONS_WITH_AVS_UTILS) \
+        && defined(AVS_COMMONS_UTILS_WITH_ALLOCATORS)
+
+#    include <assert.h>
+#    include <stddef.h>
+#    include <stdint.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_allocator.h>
+
+#    define MODULE_NAME avs_utils
+#    include <avs_x_log_config.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+/* smallest size class; large enough for a free list link and for alignment */
+#    define MIN_BLOCK_SIZE AVS_MAX(sizeof(avs_max_align_t), sizeof(void *))
+
+#    define MAX_SIZE_CLASSES (sizeof(size_t) * 8)
+
+typedef struct slab_struct {
+    struct slab_struct *next;
+    union {
+        char data[1]; /* variable length */
+        avs_max_align_t align;
+    } data;
+} slab_t;
+
+typedef union free_block_union {
+    union free_block_union *next;
+    avs_max_align_t align;
+} free_block_t;
+
+typedef struct {
+    free_block_t *free_list;
+    /* not yet used space at the end of the most recently allocated slab */
+    char *bump;
+    size_t bump_left;
+} size_class_t;
+
+typedef struct {
+    avs_allocator_t allocator;
+    avs_allocator_t *backing;
+    size_t slab_size;
+    size_t max_block_size;
+    size_t bytes_reserved;
+    slab_t *slabs;
+    size_class_t classes[MAX_SIZE_CLASSES];
+} slab_allocator_t;
+
+static size_t class_index(size_t size) {
+    size_t index = 0;
+    size_t block_size = MIN_BLOCK_SIZE;
+    while (block_size < size) {
+        block_size *= 2;
+        ++index;
+    }
+    return index;
+}
+
+static size_t class_block_size(size_t index) {
+    return (size_t) MIN_BLOCK_SIZE << index;
+}
+
+static size_t slab_capacity(const slab_allocator_t *slab) {
+    return slab->slab_size - offsetof(slab_t, data);
+}
+
+static int refill_class(slab_allocator_t *slab, size_class_t *size_class) {
+    slab_t *new_slab = (slab_t *) slab->backing->vtable->alloc_fn(
+            slab->backing, slab->slab_size);
+    if (!new_slab) {
+        return -1;
+    }
+    new_slab->next = slab->slabs;
+    slab->slabs = new_slab;
+    slab->bytes_reserved += slab->slab_size;
+    size_class->bump = new_slab->data.data;
+    size_class->bump_left = slab_capacity(slab);
+    return 0;
+}
+
+static void *slab_alloc(avs_allocator_t *allocator, size_t size) {
+    slab_allocator_t *slab = (slab_allocator_t *) allocator;
+    if (size > slab->max_block_size) {
+        return slab->backing->vtable->alloc_fn(slab->backing, size);
+    }
+    size_t index = class_index(size);
+    size_class_t *size_class = &slab->classes[index];
+    if (size_class->free_list) {
+        free_block_t *block = size_class->free_list;
+        size_class->free_list = block->next;
+        return block;
+    }
+    size_t block_size = class_block_size(index);
+    if (size_class->bump_left < block_size
+            && refill_class(slab, size_class)) {
+        return NULL;
+    }
+    void *result = size_class->bump;
+    size_class->bump += block_size;
+    size_class->bump_left -= block_size;
+    return result;
+}
+
+static void slab_free(avs_allocator_t *allocator, void *ptr, size_t size) {
+    slab_allocator_t *slab = (slab_allocator_t *) allocator;
+    if (size > slab->max_block_size) {
+        slab->backing->vtable->free_fn(slab->backing, ptr, size);
+        return;
+    }
+    size_class_t *size_class = &slab->classes[class_index(size)];
+    free_block_t *block = (free_block_t *) ptr;
+    block->next = size_class->free_list;
+    size_class->free_list = block;
+}
+
+static void *slab_realloc(avs_allocator_t *allocator,
+                          void *ptr,
+                          size_t old_size,
+                          size_t new_size) {
+    slab_allocator_t *slab = (slab_allocator_t *) allocator;
+    if (old_size <= slab->max_block_size && new_size <= slab->max_block_size
+            && class_index(old_size) == class_index(new_size)) {
+        return ptr;
+    }
+    if (old_size > slab->max_block_size && new_size > slab->max_block_size
+            && slab->backing->vtable->realloc_fn) {
+        return slab->backing->vtable->realloc_fn(slab->backing, ptr,
+                                                 old_size, new_size);
+    }
+    void *result = slab_alloc(allocator, new_size);
+    if (result) {
+        memcpy(result, ptr, AVS_MIN(old_size, new_size));
+        slab_free(allocator, ptr, old_size);
+    }
+    return result;
+}
+
+static const avs_allocator_v_table_t slab_allocator_vtable = {
+    .alloc_fn = slab_alloc,
+    .realloc_fn = slab_realloc,
+    .free_fn = slab_free
+};
+
+static slab_allocator_t *get_slab(const avs_allocator_t *allocator) {
+    assert(allocator->vtable == &slab_allocator_vtable);
+    return (slab_allocator_t *) (intptr_t) allocator;
+}
+
+int avs_slab_allocator_create(avs_allocator_t **out_slab,
+                              avs_allocator_t *backing,
+                              size_t slab_size,
+                              size_t max_block_size) {
+    *out_slab = NULL;
+    /* slabs are carved into blocks of all sizes, so keep them aligned */
+    slab_size = slab_size / MIN_BLOCK_SIZE * MIN_BLOCK_SIZE;
+    if (max_block_size > slab_size || max_block_size > SIZE_MAX / 2
+            || slab_size <= offsetof(slab_t, data)
+            || class_block_size(class_index(max_block_size))
+                           > slab_size - offsetof(slab_t, data)) {
+        LOG(ERROR, _("slab size too small for the requested size classes"));
+        return -1;
+    }
+    if (!backing) {
+        backing = avs_allocator_system();
+    }
+    slab_allocator_t *slab = (slab_allocator_t *) backing->vtable->alloc_fn(
+            backing, sizeof(slab_allocator_t));
+    if (!slab) {
+        LOG(ERROR, _("out of memory"));
+        return -1;
+    }
+    memset(slab, 0, sizeof(*slab));
+    slab->allocator.vtable = &slab_allocator_vtable;
+    slab->backing = backing;
+    slab->slab_size = slab_size;
+    slab->max_block_size = class_block_size(class_index(max_block_size));
+    *out_slab = &slab->allocator;
+    return 0;
+}
+
+void avs_slab_allocator_cleanup(avs_allocator_t **slab_ptr) {
+    if (!*slab_ptr) {
+        return;
+    }
+    slab_allocator_t *slab = get_slab(*slab_ptr);
+    while (slab->slabs) {
+        slab_t *to_free = slab->slabs;
+        slab->slabs = to_free->next;
+        slab->backing->vtable->free_fn(slab->backing, to_free, slab->slab_size);
+    }
+    slab->backing->vtable->free_fn(slab->backing, slab, sizeof(*slab));
+    *slab_ptr = NULL;
+}
+
+size_t avs_slab_allocator_bytes_reserved(const avs_allocator_t *allocator) {
+    return get_slab(allocator)->bytes_reserved;
+}
+
+#endif // defined(AVS_COMMONS_WITH_AVS_UTILS) &&
+       // defined(AVS_COMMONS_UTILS_WITH_ALLOCATORS)
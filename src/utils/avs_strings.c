@@ -36,6 +36,9 @@
 #    include <avsystem/commons/avs_memory.h>
 #    include <avsystem/commons/avs_utils.h>
 
+#    define MODULE_NAME avs_utils
+#    include <avs_x_log_config.h>
+
 VISIBILITY_SOURCE_BEGIN
 
 int avs_simple_vsnprintf(char *out,
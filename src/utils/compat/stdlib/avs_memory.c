@@ -20,12 +20,51 @@
 #if defined(AVS_COMMONS_WITH_AVS_UTILS) \
         && defined(AVS_COMMONS_UTILS_WITH_STANDARD_ALLOCATOR)
 
+#    include <avsystem/commons/avs_allocator.h>
 #    include <avsystem/commons/avs_memory.h>
 
 #    include <stdlib.h>
 
 VISIBILITY_SOURCE_BEGIN
 
+#    ifdef AVS_COMMONS_UTILS_WITH_ALLOCATORS
+
+static void *system_alloc(avs_allocator_t *allocator, size_t size) {
+    (void) allocator;
+    return malloc(size);
+}
+
+static void *system_realloc(avs_allocator_t *allocator,
+                            void *ptr,
+                            size_t old_size,
+                            size_t new_size) {
+    (void) allocator;
+    (void) old_size;
+    return realloc(ptr, new_size);
+}
+
+static void system_free(avs_allocator_t *allocator, void *ptr, size_t size) {
+    (void) allocator;
+    (void) size;
+    free(ptr);
+}
+
+static const avs_allocator_v_table_t system_allocator_vtable = {
+    .alloc_fn = system_alloc,
+    .realloc_fn = system_realloc,
+    .free_fn = system_free
+};
+
+static avs_allocator_t system_allocator = {
+    .vtable = &system_allocator_vtable
+};
+
+avs_allocator_t *avs_allocator_system(void) {
+    return &system_allocator;
+}
+
+#    else // AVS_COMMONS_UTILS_WITH_ALLOCATORS
+
 void *avs_malloc(size_t size) {
     return malloc(size);
 }
@@ -42,5 +81,7 @@ void *avs_realloc(void *ptr, size_t size) {
     return realloc(ptr, size);
 }
 
+#    endif // AVS_COMMONS_UTILS_WITH_ALLOCATORS
+
 #endif // defined(AVS_COMMONS_WITH_AVS_UTILS) &&
        // defined(AVS_COMMONS_UTILS_WITH_STANDARD_ALLOCATOR)
@@ -27,6 +27,9 @@
 #    include <avsystem/commons/avs_memory.h>
 #    include <avsystem/commons/avs_vector.h>
 
+#    define MODULE_NAME avs_vector
+#    include <avs_x_log_config.h>
+
 VISIBILITY_SOURCE_BEGIN
 
 struct avs_vector_desc_struct {
@@ -143,30 +146,68 @@ void *avs_vector_pop__(void ***ptr) {
     return vector_pop_internal(get_desc(*ptr));
 }
 
+/* Rotates elements in range [beg, end) left by one, without allocating */
+static void
+vector_rotate_left_internal(avs_vector_desc_t *desc, size_t beg, size_t end) {
+    /* Most elements are small enough to be rotated through a stack buffer */
+    char tmp[64];
+    assert(beg < end && end <= desc->size);
+    if (desc->elem_size <= sizeof(tmp)) {
+        memcpy(tmp, vector_at_internal(desc, beg), desc->elem_size);
+        memmove(vector_at_internal(desc, beg),
+                vector_at_internal(desc, beg + 1),
+                desc->elem_size * (end - beg - 1));
+        memcpy(vector_at_internal(desc, end - 1), tmp, desc->elem_size);
+    } else {
+        vector_reverse_range_internal(desc, beg + 1, end);
+        vector_reverse_range_internal(desc, beg, end);
+    }
+}
+
 void *avs_vector_remove__(void ***ptr, size_t index) {
-    size_t size, i;
-    void *tmp;
     avs_vector_desc_t *desc = get_desc(*ptr);
-    size = vector_size_internal(desc);
+    size_t size = vector_size_internal(desc);
     if (size == 0) {
         return NULL;
     }
-    tmp = avs_malloc(desc->elem_size);
-    if (tmp) {
-        memcpy(tmp, vector_at_internal(desc, index), desc->elem_size);
-        memmove(vector_at_internal(desc, index),
-                vector_at_internal(desc, index + 1),
-                desc->elem_size * (size - index - 1));
-        memcpy(vector_at_internal(desc, size - 1), tmp, desc->elem_size);
-        avs_free(tmp);
-    } else {
-        for (i = index; i < size - 1; i++) {
-            vector_swap_internal(desc, i, i + 1);
-        }
+    assert(index < size);
+    vector_rotate_left_internal(desc, index, size);
+    return vector_pop_internal(desc);
+}
+
+void *avs_vector_swap_remove__(void ***ptr, size_t index) {
+    avs_vector_desc_t *desc = get_desc(*ptr);
+    size_t size = vector_size_internal(desc);
+    if (size == 0) {
+        return NULL;
     }
+    assert(index < size);
+    vector_swap_internal(desc, index, size - 1);
     return vector_pop_internal(desc);
 }
 
+size_t avs_vector_remove_if__(void ***ptr,
+                              avs_vector_predicate_func_t pred,
+                              void *arg) {
+    avs_vector_desc_t *desc = get_desc(*ptr);
+    size_t read_idx;
+    size_t write_idx = 0;
+    size_t removed;
+    for (read_idx = 0; read_idx < desc->size; ++read_idx) {
+        void *elem = vector_at_internal(desc, read_idx);
+        if (pred(elem, arg)) {
+            continue;
+        }
+        if (write_idx != read_idx) {
+            memcpy(vector_at_internal(desc, write_idx), elem, desc->elem_size);
+        }
+        ++write_idx;
+    }
+    removed = desc->size - write_idx;
+    desc->size = write_idx;
+    return removed;
+}
+
 size_t avs_vector_size__(void **ptr) {
     return vector_size_internal(get_desc(ptr));
 }
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_posix_init.h>
+
+#include <avsystem/commons/avs_buffer.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#define SPSC_BYTES_TO_TRANSFER (4 * 1024 * 1024)
+
+static uint8_t spsc_pattern(size_t offset) {
+    return (uint8_t) (offset * 31 + offset / 251);
+}
+
+static void *spsc_producer(void *buffer_) {
+    avs_buffer_t *buffer = (avs_buffer_t *) buffer_;
+    size_t sent = 0;
+    while (sent < SPSC_BYTES_TO_TRANSFER) {
+        avs_buffer_span_t spans[AVS_BUFFER_MAX_SPANS];
+        size_t num_spans = avs_buffer_free_spans(buffer, spans);
+        size_t filled = 0;
+        for (size_t i = 0; i < num_spans; ++i) {
+            for (size_t j = 0; j < spans[i].size
+                               && sent + filled < SPSC_BYTES_TO_TRANSFER;
+                 ++j, ++filled) {
+                spans[i].data[j] = (char) spsc_pattern(sent + filled);
+            }
+        }
+        if (filled) {
+            avs_buffer_advance_ptr(buffer, filled);
+            sent += filled;
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+AVS_UNIT_TEST(byte_buffer_spsc, two_threads) {
+    static const avs_buffer_mode_t MODES[] = {
+        AVS_BUFFER_MODE_CIRCULAR, AVS_BUFFER_MODE_CIRCULAR_MIRRORED
+    };
+    for (size_t mode = 0; mode < AVS_ARRAY_SIZE(MODES); ++mode) {
+        avs_buffer_t *buffer;
+        AVS_UNIT_ASSERT_SUCCESS(
+                avs_buffer_create_spsc(&buffer, 1021, MODES[mode]));
+
+        pthread_t producer;
+        AVS_UNIT_ASSERT_SUCCESS(
+                pthread_create(&producer, NULL, spsc_producer, buffer));
+
+        size_t received = 0;
+        size_t mismatches = 0;
+        while (received < SPSC_BYTES_TO_TRANSFER) {
+            avs_buffer_const_span_t spans[AVS_BUFFER_MAX_SPANS];
+            size_t num_spans = avs_buffer_data_spans(buffer, spans);
+            size_t consumed = 0;
+            for (size_t i = 0; i < num_spans; ++i) {
+                for (size_t j = 0; j < spans[i].size; ++j, ++consumed) {
+                    if ((uint8_t) spans[i].data[j]
+                            != spsc_pattern(received + consumed)) {
+                        ++mismatches;
+                    }
+                }
+            }
+            if (consumed) {
+                AVS_UNIT_ASSERT_SUCCESS(
+                        avs_buffer_consume_bytes(buffer, consumed));
+                received += consumed;
+            } else {
+                sched_yield();
+            }
+        }
+
+        AVS_UNIT_ASSERT_SUCCESS(pthread_join(producer, NULL));
+        AVS_UNIT_ASSERT_EQUAL(received, SPSC_BYTES_TO_TRANSFER);
+        AVS_UNIT_ASSERT_EQUAL(mismatches, 0);
+        AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_size(buffer), 0);
+        avs_buffer_free(&buffer);
+    }
+}
@@ -96,12 +96,10 @@ AVS_UNIT_TEST(byte_buffer, defragment) {
     AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_size(buffer), 2);
     AVS_UNIT_ASSERT_EQUAL(avs_buffer_data(buffer)[0], 0xFF);
     AVS_UNIT_ASSERT_EQUAL(avs_buffer_data(buffer)[1], 0xFF);
-    AVS_UNIT_ASSERT_NOT_EQUAL((intptr_t) buffer->begin,
-                              (intptr_t) buffer->data.data);
+    AVS_UNIT_ASSERT_NOT_EQUAL(get_begin(buffer), 0);
 
     defragment_buffer(buffer);
-    AVS_UNIT_ASSERT_EQUAL((intptr_t) buffer->begin,
-                          (intptr_t) buffer->data.data);
+    AVS_UNIT_ASSERT_EQUAL(get_begin(buffer), 0);
     AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_size(buffer), 2);
     AVS_UNIT_ASSERT_EQUAL(avs_buffer_data(buffer)[0], 0xFF);
     AVS_UNIT_ASSERT_EQUAL(avs_buffer_data(buffer)[1], 0xFF);
@@ -117,8 +115,7 @@ AVS_UNIT_TEST(byte_buffer, raw_insert_ptr) {
     AVS_UNIT_ASSERT_SUCCESS(avs_buffer_fill_bytes(buffer, 0, 2));
     AVS_UNIT_ASSERT_SUCCESS(avs_buffer_consume_bytes(buffer, 2));
     AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_size(buffer), 0);
-    AVS_UNIT_ASSERT_NOT_EQUAL((intptr_t) buffer->end,
-                              (intptr_t) buffer->data.data);
+    AVS_UNIT_ASSERT_NOT_EQUAL(get_end(buffer), 0);
 
     AVS_UNIT_ASSERT_NOT_EQUAL(avs_buffer_space_left(buffer),
                               space_left_without_moving(buffer));
@@ -220,3 +217,227 @@ AVS_UNIT_TEST(byte_buffer, fill_bytes) {
 
     avs_buffer_free(&buffer);
 }
+
+AVS_UNIT_TEST(byte_buffer, circular_append_does_not_move_data) {
+    static const int BUFFER_SIZE = 8;
+    avs_buffer_t *buffer;
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_create_with_mode(
+            &buffer, BUFFER_SIZE, AVS_BUFFER_MODE_CIRCULAR));
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_mode(buffer), AVS_BUFFER_MODE_CIRCULAR);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_append_bytes(buffer, "abcdef", 6));
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_consume_bytes(buffer, 4));
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_space_left(buffer), 6);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_append_bytes(buffer, "ghijkl", 6));
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_size(buffer), 8);
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_space_left(buffer), 0);
+    AVS_UNIT_ASSERT_FAILED(avs_buffer_append_bytes(buffer, "m", 1));
+    /* wrapped around, nothing moved */
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer->storage, "ijklefgh", 8);
+
+    /* linearized on demand */
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(avs_buffer_data(buffer), "efghijkl", 8);
+    AVS_UNIT_ASSERT_EQUAL(get_begin(buffer), 0);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_consume_bytes(buffer, 8));
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_size(buffer), 0);
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_space_left(buffer), BUFFER_SIZE);
+
+    avs_buffer_free(&buffer);
+}
+
+AVS_UNIT_TEST(byte_buffer, circular_fill_and_advance) {
+    static const int BUFFER_SIZE = 4;
+    avs_buffer_t *buffer;
+    int i;
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_create_with_mode(
+            &buffer, BUFFER_SIZE, AVS_BUFFER_MODE_CIRCULAR));
+
+    for (i = 0; i < 10; ++i) {
+        const char c = (char) ('a' + i);
+        AVS_UNIT_ASSERT_SUCCESS(avs_buffer_fill_bytes(buffer, c, 3));
+        AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_size(buffer), 3);
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(avs_buffer_data(buffer),
+                                          ((const char[]) { c, c, c }), 3);
+        AVS_UNIT_ASSERT_SUCCESS(avs_buffer_consume_bytes(buffer, 3));
+    }
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_advance_ptr(buffer, 4));
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_size(buffer), 4);
+    AVS_UNIT_ASSERT_FAILED(avs_buffer_advance_ptr(buffer, 1));
+
+    avs_buffer_free(&buffer);
+}
+
+AVS_UNIT_TEST(byte_buffer, circular_raw_insert_ptr) {
+    static const int BUFFER_SIZE = 8;
+    avs_buffer_t *buffer;
+    char *insert_ptr;
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_create_with_mode(
+            &buffer, BUFFER_SIZE, AVS_BUFFER_MODE_CIRCULAR));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_append_bytes(buffer, "abcdef", 6));
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_consume_bytes(buffer, 4));
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_append_bytes(buffer, "gh", 2));
+    /* free space is contiguous, as the data wraps around */
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_append_bytes(buffer, "i", 1));
+    insert_ptr = avs_buffer_raw_insert_ptr(buffer);
+    AVS_UNIT_ASSERT_TRUE(insert_ptr == buffer->storage + 1);
+    memcpy(insert_ptr, "jkl", 3);
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_advance_ptr(buffer, 3));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(avs_buffer_data(buffer), "efghijkl", 8);
+
+    avs_buffer_free(&buffer);
+}
+
+AVS_UNIT_TEST(byte_buffer, mirrored) {
+    avs_buffer_t *buffer;
+    size_t capacity;
+    size_t i;
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_create_with_mode(
+            &buffer, 100, AVS_BUFFER_MODE_CIRCULAR_MIRRORED));
+    capacity = avs_buffer_capacity(buffer);
+    AVS_UNIT_ASSERT_TRUE(capacity >= 100);
+#    ifdef AVS_COMMONS_BUFFER_WITH_MIRRORED_MAPPING
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_mode(buffer),
+                          AVS_BUFFER_MODE_CIRCULAR_MIRRORED);
+#    endif // AVS_COMMONS_BUFFER_WITH_MIRRORED_MAPPING
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_fill_bytes(buffer, 'x', capacity - 2));
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_consume_bytes(buffer, capacity - 2));
+    for (i = 0; i < 3; ++i) {
+        const char *data = avs_buffer_data(buffer);
+        char *insert_ptr;
+        AVS_UNIT_ASSERT_SUCCESS(avs_buffer_append_bytes(buffer, "abcd", 4));
+        if (avs_buffer_mode(buffer) == AVS_BUFFER_MODE_CIRCULAR_MIRRORED) {
+            /* data does not move even though it wraps around */
+            AVS_UNIT_ASSERT_TRUE(avs_buffer_data(buffer) == data);
+        }
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(avs_buffer_data(buffer), "abcd", 4);
+        insert_ptr = avs_buffer_raw_insert_ptr(buffer);
+        memset(insert_ptr, 'y', avs_buffer_space_left(buffer));
+        AVS_UNIT_ASSERT_SUCCESS(
+                avs_buffer_advance_ptr(buffer, avs_buffer_space_left(buffer)));
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(avs_buffer_data(buffer), "abcdy", 5);
+        AVS_UNIT_ASSERT_EQUAL(avs_buffer_data(buffer)[capacity - 1], 'y');
+        AVS_UNIT_ASSERT_SUCCESS(avs_buffer_consume_bytes(buffer, capacity));
+    }
+
+    avs_buffer_free(&buffer);
+}
+
+AVS_UNIT_TEST(byte_buffer, spans_linear) {
+    static const int BUFFER_SIZE = 8;
+    avs_buffer_t *buffer;
+    avs_buffer_const_span_t data_spans[AVS_BUFFER_MAX_SPANS];
+    avs_buffer_span_t free_spans[AVS_BUFFER_MAX_SPANS];
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_create(&buffer, BUFFER_SIZE));
+
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_spans(buffer, data_spans), 0);
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_append_bytes(buffer, "abcdef", 6));
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_consume_bytes(buffer, 4));
+
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_spans(buffer, data_spans), 1);
+    AVS_UNIT_ASSERT_EQUAL(data_spans[0].size, 2);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data_spans[0].data, "ef", 2);
+
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_free_spans(buffer, free_spans), 1);
+    AVS_UNIT_ASSERT_TRUE(free_spans[0].data == buffer->storage + 2);
+    AVS_UNIT_ASSERT_EQUAL(free_spans[0].size, 6);
+    memcpy(free_spans[0].data, "ghijkl", 6);
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_advance_ptr(buffer, 6));
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_free_spans(buffer, free_spans), 0);
+
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_spans(buffer, data_spans), 1);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data_spans[0].data, "efghijkl", 8);
+
+    avs_buffer_free(&buffer);
+}
+
+AVS_UNIT_TEST(byte_buffer, spans_circular) {
+    static const int BUFFER_SIZE = 8;
+    avs_buffer_t *buffer;
+    avs_buffer_const_span_t data_spans[AVS_BUFFER_MAX_SPANS];
+    avs_buffer_span_t free_spans[AVS_BUFFER_MAX_SPANS];
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_create_with_mode(
+            &buffer, BUFFER_SIZE, AVS_BUFFER_MODE_CIRCULAR));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_append_bytes(buffer, "abcdef", 6));
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_consume_bytes(buffer, 4));
+
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_free_spans(buffer, free_spans), 2);
+    AVS_UNIT_ASSERT_TRUE(free_spans[0].data == buffer->storage + 6);
+    AVS_UNIT_ASSERT_EQUAL(free_spans[0].size, 2);
+    AVS_UNIT_ASSERT_TRUE(free_spans[1].data == buffer->storage);
+    AVS_UNIT_ASSERT_EQUAL(free_spans[1].size, 4);
+    memcpy(free_spans[0].data, "gh", 2);
+    memcpy(free_spans[1].data, "ij", 2);
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_advance_ptr(buffer, 4));
+
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_spans(buffer, data_spans), 2);
+    AVS_UNIT_ASSERT_EQUAL(data_spans[0].size, 4);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data_spans[0].data, "efgh", 4);
+    AVS_UNIT_ASSERT_EQUAL(data_spans[1].size, 2);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data_spans[1].data, "ij", 2);
+
+    /* free space is now contiguous */
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_free_spans(buffer, free_spans), 1);
+    AVS_UNIT_ASSERT_TRUE(free_spans[0].data == buffer->storage + 2);
+    AVS_UNIT_ASSERT_EQUAL(free_spans[0].size, 2);
+
+    /* nothing has been moved */
+    AVS_UNIT_ASSERT_EQUAL(position_to_offset(buffer, get_begin(buffer)), 4);
+
+    avs_buffer_free(&buffer);
+}
+
+#ifdef AVS_COMMONS_BUFFER_WITH_SPSC
+AVS_UNIT_TEST(byte_buffer, spsc_requires_circular_mode) {
+    avs_buffer_t *buffer;
+    AVS_UNIT_ASSERT_FAILED(
+            avs_buffer_create_spsc(&buffer, 8, AVS_BUFFER_MODE_LINEAR));
+    AVS_UNIT_ASSERT_NULL(buffer);
+}
+
+AVS_UNIT_TEST(byte_buffer, spsc_wraparound) {
+    static const int BUFFER_SIZE = 8;
+    avs_buffer_t *buffer;
+    avs_buffer_const_span_t data_spans[AVS_BUFFER_MAX_SPANS];
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_create_spsc(&buffer, BUFFER_SIZE,
+                                                   AVS_BUFFER_MODE_CIRCULAR));
+    AVS_UNIT_ASSERT_TRUE(buffer->spsc);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_append_bytes(buffer, "abcdef", 6));
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_consume_bytes(buffer, 5));
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_append_bytes(buffer, "ghijklm", 7));
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_space_left(buffer), 0);
+    AVS_UNIT_ASSERT_FAILED(avs_buffer_append_bytes(buffer, "n", 1));
+
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_spans(buffer, data_spans), 2);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data_spans[0].data, "fgh", 3);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data_spans[1].data, "ijklm", 5);
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_consume_bytes(buffer, 8));
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_size(buffer), 0);
+
+    /* positions are never reset, only wrapped */
+    AVS_UNIT_ASSERT_EQUAL(get_begin(buffer), 13);
+    AVS_UNIT_ASSERT_EQUAL(get_end(buffer), 13);
+
+    avs_buffer_free(&buffer);
+}
+
+AVS_UNIT_TEST(byte_buffer, spsc_mirrored) {
+    avs_buffer_t *buffer;
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_create_spsc(
+            &buffer, 4096, AVS_BUFFER_MODE_CIRCULAR_MIRRORED));
+    size_t capacity = avs_buffer_capacity(buffer);
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_fill_bytes(buffer, 'x', capacity - 2));
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_consume_bytes(buffer, capacity - 2));
+    AVS_UNIT_ASSERT_SUCCESS(avs_buffer_append_bytes(buffer, "abcd", 4));
+    if (avs_buffer_mode(buffer) == AVS_BUFFER_MODE_CIRCULAR_MIRRORED) {
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(avs_buffer_data(buffer), "abcd", 4);
+    }
+    avs_buffer_free(&buffer);
+}
+#endif // AVS_COMMONS_BUFFER_WITH_SPSC
@@ -0,0 +1,351 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/avs_memory.h>
+#include <avsystem/commons/avs_net_poller.h>
+#include <avsystem/commons/avs_socket_v_table.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#define DEFAULT_ADDRESS "localhost"
+#define DEFAULT_PORT "0"
+
+typedef struct {
+    avs_net_socket_t *socket;
+    char port[sizeof("65535")];
+} bound_udp_socket_t;
+
+static void bound_udp_socket_init(bound_udp_socket_t *out) {
+    out->socket = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_udp_socket_create(&out->socket, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_bind(out->socket, DEFAULT_ADDRESS, DEFAULT_PORT));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_local_port(
+            out->socket, out->port, sizeof(out->port)));
+}
+
+static void send_datagram(avs_net_socket_t *client, const char *port) {
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_send_to(client, "ping", 4, DEFAULT_ADDRESS, port));
+}
+
+static size_t wait_events(avs_net_poller_t *poller,
+                          avs_time_duration_t timeout,
+                          avs_net_poller_event_t *out_events,
+                          size_t max_events) {
+    size_t count = (size_t) -1;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_poller_wait(poller, timeout, out_events,
+                                                max_events, &count));
+    AVS_UNIT_ASSERT_TRUE(count <= max_events);
+    return count;
+}
+
+static void test_read_write_events(avs_net_poller_t *poller) {
+    bound_udp_socket_t server;
+    bound_udp_socket_init(&server);
+    bound_udp_socket_t client;
+    bound_udp_socket_init(&client);
+
+    int user_data;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_poller_add(poller, server.socket,
+                                               AVS_NET_POLLER_READ,
+                                               &user_data));
+
+    avs_net_poller_event_t events[4];
+    AVS_UNIT_ASSERT_EQUAL(wait_events(poller, AVS_TIME_DURATION_ZERO, events,
+                                      AVS_ARRAY_SIZE(events)),
+                          0);
+
+    send_datagram(client.socket, server.port);
+    AVS_UNIT_ASSERT_EQUAL(wait_events(poller,
+                                      avs_time_duration_from_scalar(
+                                              5, AVS_TIME_S),
+                                      events, AVS_ARRAY_SIZE(events)),
+                          1);
+    AVS_UNIT_ASSERT_TRUE(events[0].socket == server.socket);
+    AVS_UNIT_ASSERT_TRUE(events[0].user_data == &user_data);
+    AVS_UNIT_ASSERT_EQUAL(events[0].events, AVS_NET_POLLER_READ);
+
+    // level-triggered: still readable until the datagram is consumed
+    AVS_UNIT_ASSERT_EQUAL(wait_events(poller, AVS_TIME_DURATION_ZERO, events,
+                                      AVS_ARRAY_SIZE(events)),
+                          1);
+
+    char buf[16];
+    size_t received;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_receive(server.socket, &received, buf, sizeof(buf)));
+    AVS_UNIT_ASSERT_EQUAL(received, 4);
+    AVS_UNIT_ASSERT_EQUAL(wait_events(poller, AVS_TIME_DURATION_ZERO, events,
+                                      AVS_ARRAY_SIZE(events)),
+                          0);
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_poller_modify(poller, server.socket, AVS_NET_POLLER_WRITE));
+    AVS_UNIT_ASSERT_EQUAL(wait_events(poller, AVS_TIME_DURATION_ZERO, events,
+                                      AVS_ARRAY_SIZE(events)),
+                          1);
+    AVS_UNIT_ASSERT_TRUE(events[0].socket == server.socket);
+    AVS_UNIT_ASSERT_EQUAL(events[0].events, AVS_NET_POLLER_WRITE);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_poller_remove(poller, server.socket));
+    AVS_UNIT_ASSERT_EQUAL(wait_events(poller, AVS_TIME_DURATION_ZERO, events,
+                                      AVS_ARRAY_SIZE(events)),
+                          0);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client.socket));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&server.socket));
+}
+
+AVS_UNIT_TEST(poller, read_write_events) {
+    avs_net_poller_t *poller = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_poller_create(&poller));
+    test_read_write_events(poller);
+    avs_net_poller_cleanup(&poller);
+    AVS_UNIT_ASSERT_NULL(poller);
+}
+
+/* Every third socket is removed before any data is sent, and then every other
+ * of the remaining ones receives a datagram. */
+static void test_many_sockets(avs_net_poller_t *poller, size_t socket_count) {
+    bound_udp_socket_t *servers = (bound_udp_socket_t *) avs_calloc(
+            socket_count, sizeof(bound_udp_socket_t));
+    bool *reported = (bool *) avs_calloc(socket_count, sizeof(bool));
+    AVS_UNIT_ASSERT_NOT_NULL(servers);
+    AVS_UNIT_ASSERT_NOT_NULL(reported);
+    for (size_t i = 0; i < socket_count; ++i) {
+        bound_udp_socket_init(&servers[i]);
+        AVS_UNIT_ASSERT_SUCCESS(avs_net_poller_add(poller, servers[i].socket,
+                                                   AVS_NET_POLLER_WRITE,
+                                                   &servers[i]));
+    }
+    bound_udp_socket_t client;
+    bound_udp_socket_init(&client);
+
+    for (size_t i = 0; i < socket_count; i += 3) {
+        AVS_UNIT_ASSERT_SUCCESS(
+                avs_net_poller_remove(poller, servers[i].socket));
+    }
+    for (size_t i = 0; i < socket_count; ++i) {
+        if (i % 3) {
+            AVS_UNIT_ASSERT_SUCCESS(avs_net_poller_modify(
+                    poller, servers[i].socket, AVS_NET_POLLER_READ));
+        } else {
+            AVS_UNIT_ASSERT_FAILED(avs_net_poller_modify(
+                    poller, servers[i].socket, AVS_NET_POLLER_READ));
+            AVS_UNIT_ASSERT_FAILED(
+                    avs_net_poller_remove(poller, servers[i].socket));
+        }
+    }
+
+    size_t expected_count = 0;
+    for (size_t i = 0; i < socket_count; i += 2) {
+        send_datagram(client.socket, servers[i].port);
+        if (i % 3) {
+            ++expected_count;
+        }
+    }
+
+    // collect the events in small batches; each socket is reported only once
+    // per call, and the remaining ones in subsequent calls
+    size_t reported_count = 0;
+    avs_time_monotonic_t deadline = avs_time_monotonic_add(
+            avs_time_monotonic_now(),
+            avs_time_duration_from_scalar(5, AVS_TIME_S));
+    while (reported_count < expected_count) {
+        AVS_UNIT_ASSERT_TRUE(
+                avs_time_monotonic_before(avs_time_monotonic_now(), deadline));
+        avs_net_poller_event_t events[3];
+        size_t count = wait_events(poller,
+                                   avs_time_duration_from_scalar(1, AVS_TIME_S),
+                                   events, AVS_ARRAY_SIZE(events));
+        for (size_t i = 0; i < count; ++i) {
+            bound_udp_socket_t *server =
+                    (bound_udp_socket_t *) events[i].user_data;
+            size_t index = (size_t) (server - servers);
+            AVS_UNIT_ASSERT_TRUE(index < socket_count);
+            AVS_UNIT_ASSERT_EQUAL(index % 2, 0);
+            AVS_UNIT_ASSERT_NOT_EQUAL(index % 3, 0);
+            AVS_UNIT_ASSERT_TRUE(events[i].socket == server->socket);
+            if (!reported[index]) {
+                reported[index] = true;
+                ++reported_count;
+                char buf[16];
+                size_t received;
+                AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_receive(
+                        server->socket, &received, buf, sizeof(buf)));
+            }
+        }
+    }
+
+    avs_net_poller_event_t events[4];
+    AVS_UNIT_ASSERT_EQUAL(wait_events(poller, AVS_TIME_DURATION_ZERO, events,
+                                      AVS_ARRAY_SIZE(events)),
+                          0);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client.socket));
+    for (size_t i = 0; i < socket_count; ++i) {
+        if (i % 3) {
+            AVS_UNIT_ASSERT_SUCCESS(
+                    avs_net_poller_remove(poller, servers[i].socket));
+        }
+        AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&servers[i].socket));
+    }
+    avs_free(reported);
+    avs_free(servers);
+}
+
+AVS_UNIT_TEST(poller, many_sockets) {
+    avs_net_poller_t *poller = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_poller_create(&poller));
+    // more than the initial capacity, so that the lookup table is rebuilt
+    test_many_sockets(poller, 40);
+    avs_net_poller_cleanup(&poller);
+}
+
+#ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+AVS_UNIT_TEST(poller, poll_fallback_read_write_events) {
+    avs_net_poller_t *poller = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(poller_create(&poller, false));
+    AVS_UNIT_ASSERT_FALSE(uses_epoll(poller));
+    test_read_write_events(poller);
+    avs_net_poller_cleanup(&poller);
+    AVS_UNIT_ASSERT_NULL(poller);
+}
+
+AVS_UNIT_TEST(poller, poll_fallback_many_sockets) {
+    avs_net_poller_t *poller = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(poller_create(&poller, false));
+    AVS_UNIT_ASSERT_FALSE(uses_epoll(poller));
+    test_many_sockets(poller, 40);
+    avs_net_poller_cleanup(&poller);
+}
+#endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+
+AVS_UNIT_TEST(poller, invalid_operations) {
+    avs_net_poller_t *poller = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_poller_create(&poller));
+
+    avs_net_socket_t *unbound = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_udp_socket_create(&unbound, NULL));
+    AVS_UNIT_ASSERT_FAILED(
+            avs_net_poller_add(poller, unbound, AVS_NET_POLLER_READ, NULL));
+
+    bound_udp_socket_t server;
+    bound_udp_socket_init(&server);
+    AVS_UNIT_ASSERT_FAILED(avs_net_poller_add(poller, server.socket,
+                                              AVS_NET_POLLER_ERROR, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_poller_add(poller, server.socket,
+                                               AVS_NET_POLLER_READ, NULL));
+    AVS_UNIT_ASSERT_FAILED(avs_net_poller_add(poller, server.socket,
+                                              AVS_NET_POLLER_READ, NULL));
+
+    AVS_UNIT_ASSERT_FAILED(
+            avs_net_poller_modify(poller, unbound, AVS_NET_POLLER_READ));
+    AVS_UNIT_ASSERT_FAILED(avs_net_poller_remove(poller, unbound));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_poller_remove(poller, server.socket));
+    AVS_UNIT_ASSERT_FAILED(avs_net_poller_remove(poller, server.socket));
+
+    avs_net_poller_cleanup(&poller);
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&unbound));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&server.socket));
+}
+
+// Wrapper socket simulating a (D)TLS socket with decrypted data buffered
+typedef struct {
+    const avs_net_socket_v_table_t *const operations;
+    avs_net_socket_t *backend;
+    bool has_buffered_data;
+} buffering_socket_t;
+
+static const void *buffering_get_system(avs_net_socket_t *socket) {
+    return avs_net_socket_get_system(((buffering_socket_t *) socket)->backend);
+}
+
+static avs_error_t buffering_get_opt(avs_net_socket_t *socket,
+                                     avs_net_socket_opt_key_t option_key,
+                                     avs_net_socket_opt_value_t *out_value) {
+    buffering_socket_t *buffering = (buffering_socket_t *) socket;
+    if (option_key == AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA) {
+        out_value->flag = buffering->has_buffered_data;
+        return AVS_OK;
+    }
+    return avs_net_socket_get_opt(buffering->backend, option_key, out_value);
+}
+
+static const avs_net_socket_v_table_t BUFFERING_VTABLE = {
+    .get_system_socket = buffering_get_system,
+    .get_opt = buffering_get_opt
+};
+
+AVS_UNIT_TEST(poller, buffered_data) {
+    avs_net_poller_t *poller = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_poller_create(&poller));
+
+    bound_udp_socket_t server;
+    bound_udp_socket_init(&server);
+    buffering_socket_t buffering = {
+        .operations = &BUFFERING_VTABLE,
+        .backend = server.socket,
+        .has_buffered_data = true
+    };
+    avs_net_socket_t *socket = (avs_net_socket_t *) &buffering;
+
+    // newly added socket is checked for buffered data
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_poller_add(poller, socket, AVS_NET_POLLER_READ, NULL));
+    avs_net_poller_event_t events[2];
+    AVS_UNIT_ASSERT_EQUAL(wait_events(poller, AVS_TIME_DURATION_ZERO, events,
+                                      AVS_ARRAY_SIZE(events)),
+                          1);
+    AVS_UNIT_ASSERT_TRUE(events[0].socket == socket);
+    AVS_UNIT_ASSERT_EQUAL(events[0].events, AVS_NET_POLLER_READ);
+
+    // reported as readable, so checked again
+    AVS_UNIT_ASSERT_EQUAL(wait_events(poller, AVS_TIME_DURATION_ZERO, events,
+                                      AVS_ARRAY_SIZE(events)),
+                          1);
+
+    // buffer drained, and no data in the system socket either
+    buffering.has_buffered_data = false;
+    AVS_UNIT_ASSERT_EQUAL(wait_events(poller, AVS_TIME_DURATION_ZERO, events,
+                                      AVS_ARRAY_SIZE(events)),
+                          0);
+
+    // not reported recently, so the buffer is not queried anymore
+    buffering.has_buffered_data = true;
+    AVS_UNIT_ASSERT_EQUAL(wait_events(poller, AVS_TIME_DURATION_ZERO, events,
+                                      AVS_ARRAY_SIZE(events)),
+                          0);
+
+    // both buffered and system socket readiness yield a single event
+    bound_udp_socket_t client;
+    bound_udp_socket_init(&client);
+    send_datagram(client.socket, server.port);
+    AVS_UNIT_ASSERT_EQUAL(wait_events(poller,
+                                      avs_time_duration_from_scalar(
+                                              5, AVS_TIME_S),
+                                      events, AVS_ARRAY_SIZE(events)),
+                          1);
+    AVS_UNIT_ASSERT_EQUAL(wait_events(poller, AVS_TIME_DURATION_ZERO, events,
+                                      AVS_ARRAY_SIZE(events)),
+                          1);
+    AVS_UNIT_ASSERT_TRUE(events[0].socket == socket);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_poller_remove(poller, socket));
+    avs_net_poller_cleanup(&poller);
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client.socket));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&server.socket));
+}
@@ -68,6 +68,8 @@ run_socket_set_opt_test_cases(avs_net_socket_t *socket,
             opt_val.mtu = 5;
             break;
         case AVS_NET_SOCKET_OPT_SESSION_RESUMED:
+        case AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA:
+        case AVS_NET_SOCKET_OPT_OPTIMISTIC_IO:
             opt_val.flag = true;
             break;
         case AVS_NET_SOCKET_OPT_BYTES_SENT:
@@ -76,6 +78,12 @@ run_socket_set_opt_test_cases(avs_net_socket_t *socket,
         case AVS_NET_SOCKET_OPT_BYTES_RECEIVED:
             opt_val.bytes_received = 321;
             break;
+        case AVS_NET_SOCKET_OPT_SYSCALL_COUNT:
+            opt_val.syscall_count = 42;
+            break;
+        case AVS_NET_SOCKET_OPT_SOCKET_TYPE:
+            opt_val.socket_type = AVS_NET_TCP_SOCKET;
+            break;
         case AVS_NET_SOCKET_OPT_DANE_TLSA_ARRAY:
             AVS_UNREACHABLE("unsupported case");
         }
@@ -36,7 +36,11 @@ AVS_UNIT_TEST(socket, dtls_get_opt) {
         { FAIL, AVS_NET_SOCKET_OPT_INNER_MTU },
         { SUCCESS, AVS_NET_SOCKET_OPT_SESSION_RESUMED },
         { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_SENT },
-        { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_RECEIVED }
+        { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_RECEIVED },
+        { SUCCESS, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA },
+        { SUCCESS, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO },
+        { SUCCESS, AVS_NET_SOCKET_OPT_SYSCALL_COUNT },
+        { SUCCESS, AVS_NET_SOCKET_OPT_SOCKET_TYPE }
     };
     run_socket_get_opt_test_cases(socket, test_cases,
                                   AVS_ARRAY_SIZE(test_cases));
@@ -64,7 +68,11 @@ AVS_UNIT_TEST(socket, dtls_get_opt_after_close) {
         { SUCCESS, AVS_NET_SOCKET_OPT_INNER_MTU },
         { SUCCESS, AVS_NET_SOCKET_OPT_SESSION_RESUMED },
         { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_SENT },
-        { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_RECEIVED }
+        { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_RECEIVED },
+        { SUCCESS, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA },
+        { SUCCESS, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO },
+        { SUCCESS, AVS_NET_SOCKET_OPT_SYSCALL_COUNT },
+        { SUCCESS, AVS_NET_SOCKET_OPT_SOCKET_TYPE }
     };
     run_socket_get_opt_test_cases(socket, test_cases,
                                   AVS_ARRAY_SIZE(test_cases));
@@ -91,7 +99,11 @@ AVS_UNIT_TEST(socket, dtls_set_opt) {
         { FAIL, AVS_NET_SOCKET_OPT_INNER_MTU },
         { FAIL, AVS_NET_SOCKET_OPT_SESSION_RESUMED },
         { FAIL, AVS_NET_SOCKET_OPT_BYTES_SENT },
-        { FAIL, AVS_NET_SOCKET_OPT_BYTES_RECEIVED }
+        { FAIL, AVS_NET_SOCKET_OPT_BYTES_RECEIVED },
+        { FAIL, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA },
+        { SUCCESS, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO },
+        { FAIL, AVS_NET_SOCKET_OPT_SYSCALL_COUNT },
+        { FAIL, AVS_NET_SOCKET_OPT_SOCKET_TYPE }
     };
     run_socket_set_opt_test_cases(socket, test_cases,
                                   AVS_ARRAY_SIZE(test_cases));
@@ -119,7 +131,11 @@ AVS_UNIT_TEST(socket, dtls_set_opt_after_close) {
         { FAIL, AVS_NET_SOCKET_OPT_INNER_MTU },
         { FAIL, AVS_NET_SOCKET_OPT_SESSION_RESUMED },
         { FAIL, AVS_NET_SOCKET_OPT_BYTES_SENT },
-        { FAIL, AVS_NET_SOCKET_OPT_BYTES_RECEIVED }
+        { FAIL, AVS_NET_SOCKET_OPT_BYTES_RECEIVED },
+        { FAIL, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA },
+        { SUCCESS, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO },
+        { FAIL, AVS_NET_SOCKET_OPT_SYSCALL_COUNT },
+        { FAIL, AVS_NET_SOCKET_OPT_SOCKET_TYPE }
     };
     run_socket_set_opt_test_cases(socket, test_cases,
                                   AVS_ARRAY_SIZE(test_cases));
@@ -16,6 +16,8 @@
 
 #include <string.h>
 
+#include <avsystem/commons/avs_addrinfo.h>
+
 #include "socket_common_testcases.h"
 
 //// avs_net_socket_get_opt ////////////////////////////////////////////////////
@@ -35,7 +37,11 @@ AVS_UNIT_TEST(socket, udp_get_opt) {
         { SUCCESS, AVS_NET_SOCKET_OPT_INNER_MTU },
         { FAIL, AVS_NET_SOCKET_OPT_SESSION_RESUMED },
         { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_SENT },
-        { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_RECEIVED }
+        { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_RECEIVED },
+        { SUCCESS, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA },
+        { SUCCESS, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO },
+        { SUCCESS, AVS_NET_SOCKET_OPT_SYSCALL_COUNT },
+        { SUCCESS, AVS_NET_SOCKET_OPT_SOCKET_TYPE }
     };
     run_socket_get_opt_test_cases(socket, test_cases,
                                   AVS_ARRAY_SIZE(test_cases));
@@ -58,7 +64,11 @@ AVS_UNIT_TEST(socket, tcp_get_opt) {
         { FAIL, AVS_NET_SOCKET_OPT_INNER_MTU },
         { FAIL, AVS_NET_SOCKET_OPT_SESSION_RESUMED },
         { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_SENT },
-        { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_RECEIVED }
+        { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_RECEIVED },
+        { SUCCESS, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA },
+        { SUCCESS, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO },
+        { SUCCESS, AVS_NET_SOCKET_OPT_SYSCALL_COUNT },
+        { SUCCESS, AVS_NET_SOCKET_OPT_SOCKET_TYPE }
     };
     run_socket_get_opt_test_cases(socket, test_cases,
                                   AVS_ARRAY_SIZE(test_cases));
@@ -84,7 +94,11 @@ AVS_UNIT_TEST(socket, udp_get_opt_after_close) {
         { FAIL, AVS_NET_SOCKET_OPT_INNER_MTU },
         { FAIL, AVS_NET_SOCKET_OPT_SESSION_RESUMED },
         { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_SENT },
-        { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_RECEIVED }
+        { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_RECEIVED },
+        { SUCCESS, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA },
+        { SUCCESS, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO },
+        { SUCCESS, AVS_NET_SOCKET_OPT_SYSCALL_COUNT },
+        { SUCCESS, AVS_NET_SOCKET_OPT_SOCKET_TYPE }
     };
     run_socket_get_opt_test_cases(socket, test_cases,
                                   AVS_ARRAY_SIZE(test_cases));
@@ -108,7 +122,11 @@ AVS_UNIT_TEST(socket, tcp_get_opt_after_close) {
         { FAIL, AVS_NET_SOCKET_OPT_INNER_MTU },
         { FAIL, AVS_NET_SOCKET_OPT_SESSION_RESUMED },
         { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_SENT },
-        { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_RECEIVED }
+        { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_RECEIVED },
+        { SUCCESS, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA },
+        { SUCCESS, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO },
+        { SUCCESS, AVS_NET_SOCKET_OPT_SYSCALL_COUNT },
+        { SUCCESS, AVS_NET_SOCKET_OPT_SOCKET_TYPE }
     };
     run_socket_get_opt_test_cases(socket, test_cases,
                                   AVS_ARRAY_SIZE(test_cases));
@@ -133,7 +151,11 @@ AVS_UNIT_TEST(socket, udp_set_opt) {
         { FAIL, AVS_NET_SOCKET_OPT_INNER_MTU },
         { FAIL, AVS_NET_SOCKET_OPT_SESSION_RESUMED },
         { FAIL, AVS_NET_SOCKET_OPT_BYTES_SENT },
-        { FAIL, AVS_NET_SOCKET_OPT_BYTES_RECEIVED }
+        { FAIL, AVS_NET_SOCKET_OPT_BYTES_RECEIVED },
+        { FAIL, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA },
+        { SUCCESS, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO },
+        { FAIL, AVS_NET_SOCKET_OPT_SYSCALL_COUNT },
+        { FAIL, AVS_NET_SOCKET_OPT_SOCKET_TYPE }
     };
     run_socket_set_opt_test_cases(socket, test_cases,
                                   AVS_ARRAY_SIZE(test_cases));
@@ -156,7 +178,11 @@ AVS_UNIT_TEST(socket, tcp_set_opt) {
         { FAIL, AVS_NET_SOCKET_OPT_INNER_MTU },
         { FAIL, AVS_NET_SOCKET_OPT_SESSION_RESUMED },
         { FAIL, AVS_NET_SOCKET_OPT_BYTES_SENT },
-        { FAIL, AVS_NET_SOCKET_OPT_BYTES_RECEIVED }
+        { FAIL, AVS_NET_SOCKET_OPT_BYTES_RECEIVED },
+        { FAIL, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA },
+        { SUCCESS, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO },
+        { FAIL, AVS_NET_SOCKET_OPT_SYSCALL_COUNT },
+        { FAIL, AVS_NET_SOCKET_OPT_SOCKET_TYPE }
     };
     run_socket_set_opt_test_cases(socket, test_cases,
                                   AVS_ARRAY_SIZE(test_cases));
@@ -182,7 +208,11 @@ AVS_UNIT_TEST(socket, udp_set_opt_after_close) {
         { FAIL, AVS_NET_SOCKET_OPT_INNER_MTU },
         { FAIL, AVS_NET_SOCKET_OPT_SESSION_RESUMED },
         { FAIL, AVS_NET_SOCKET_OPT_BYTES_SENT },
-        { FAIL, AVS_NET_SOCKET_OPT_BYTES_RECEIVED }
+        { FAIL, AVS_NET_SOCKET_OPT_BYTES_RECEIVED },
+        { FAIL, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA },
+        { SUCCESS, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO },
+        { FAIL, AVS_NET_SOCKET_OPT_SYSCALL_COUNT },
+        { FAIL, AVS_NET_SOCKET_OPT_SOCKET_TYPE }
     };
     run_socket_set_opt_test_cases(socket, test_cases,
                                   AVS_ARRAY_SIZE(test_cases));
@@ -206,10 +236,377 @@ AVS_UNIT_TEST(socket, tcp_set_opt_after_close) {
         { FAIL, AVS_NET_SOCKET_OPT_INNER_MTU },
         { FAIL, AVS_NET_SOCKET_OPT_SESSION_RESUMED },
         { FAIL, AVS_NET_SOCKET_OPT_BYTES_SENT },
-        { FAIL, AVS_NET_SOCKET_OPT_BYTES_RECEIVED }
+        { FAIL, AVS_NET_SOCKET_OPT_BYTES_RECEIVED },
+        { FAIL, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA },
+        { SUCCESS, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO },
+        { FAIL, AVS_NET_SOCKET_OPT_SYSCALL_COUNT },
+        { FAIL, AVS_NET_SOCKET_OPT_SOCKET_TYPE }
     };
     run_socket_set_opt_test_cases(socket, test_cases,
                                   AVS_ARRAY_SIZE(test_cases));
 
     AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&socket));
 }
+
+//// avs_net_socket_send_batch / avs_net_socket_receive_batch //////////////////
+
+#define BATCH_ADDRESS "127.0.0.1"
+
+static avs_net_socket_t *create_bound_udp_socket(char *out_port,
+                                                 size_t out_port_size) {
+    avs_net_socket_t *socket = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_udp_socket_create(&socket, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_bind(socket, BATCH_ADDRESS, DEFAULT_PORT));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_get_local_port(socket, out_port, out_port_size));
+    return socket;
+}
+
+static avs_net_resolved_endpoint_t resolve_batch_endpoint(const char *port) {
+    avs_net_resolved_endpoint_t endpoint;
+    avs_net_addrinfo_t *info =
+            avs_net_addrinfo_resolve(AVS_NET_UDP_SOCKET, AVS_NET_AF_INET4,
+                                     BATCH_ADDRESS, port, NULL);
+    AVS_UNIT_ASSERT_NOT_NULL(info);
+    AVS_UNIT_ASSERT_EQUAL(avs_net_addrinfo_next(info, &endpoint), 0);
+    avs_net_addrinfo_delete(&info);
+    return endpoint;
+}
+
+static size_t receive_batch_all(avs_net_socket_t *socket,
+                                avs_net_socket_datagram_t *datagrams,
+                                size_t count) {
+    size_t total = 0;
+    while (total < count) {
+        size_t received;
+        AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_receive_batch(
+                socket, datagrams + total, count - total, &received));
+        AVS_UNIT_ASSERT_TRUE(received > 0);
+        total += received;
+    }
+    return total;
+}
+
+AVS_UNIT_TEST(socket, udp_batch_send_receive) {
+    char server_port[sizeof("65535")];
+    char client_port[sizeof("65535")];
+    avs_net_socket_t *server =
+            create_bound_udp_socket(server_port, sizeof(server_port));
+    avs_net_socket_t *client =
+            create_bound_udp_socket(client_port, sizeof(client_port));
+
+    static const char *const PAYLOADS[] = { "", "a", "batch", "of datagrams",
+                                            "too long to fit in buffer" };
+    enum { COUNT = AVS_ARRAY_SIZE(PAYLOADS), BUFFER_SIZE = 16 };
+    const avs_net_resolved_endpoint_t server_endpoint =
+            resolve_batch_endpoint(server_port);
+    avs_net_socket_datagram_t out[COUNT];
+    for (size_t i = 0; i < COUNT; ++i) {
+        out[i] = (avs_net_socket_datagram_t) {
+            .buffer = (void *) (intptr_t) PAYLOADS[i],
+            .buffer_length = strlen(PAYLOADS[i]),
+            .peer = server_endpoint
+        };
+    }
+    size_t sent;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_send_batch(client, out, COUNT, &sent));
+    AVS_UNIT_ASSERT_EQUAL(sent, COUNT);
+
+    char buffers[COUNT + 1][BUFFER_SIZE];
+    avs_net_socket_datagram_t in[COUNT + 1];
+    for (size_t i = 0; i < COUNT + 1; ++i) {
+        in[i] = (avs_net_socket_datagram_t) {
+            .buffer = buffers[i],
+            .buffer_length = BUFFER_SIZE
+        };
+    }
+    AVS_UNIT_ASSERT_EQUAL(receive_batch_all(server, in, COUNT), COUNT);
+    for (size_t i = 0; i < COUNT; ++i) {
+        size_t length = strlen(PAYLOADS[i]);
+        AVS_UNIT_ASSERT_EQUAL(in[i].truncated, length > BUFFER_SIZE);
+        AVS_UNIT_ASSERT_EQUAL(in[i].length, AVS_MIN(length, BUFFER_SIZE));
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(in[i].buffer, PAYLOADS[i],
+                                          in[i].length);
+
+        char host[64];
+        char port[sizeof("65535")];
+        AVS_UNIT_ASSERT_SUCCESS(avs_net_resolved_endpoint_get_host_port(
+                &in[i].peer, host, sizeof(host), port, sizeof(port)));
+        AVS_UNIT_ASSERT_EQUAL_STRING(host, BATCH_ADDRESS);
+        AVS_UNIT_ASSERT_EQUAL_STRING(port, client_port);
+    }
+
+    avs_net_socket_opt_value_t opt;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_opt(
+            client, AVS_NET_SOCKET_OPT_BYTES_SENT, &opt));
+    AVS_UNIT_ASSERT_EQUAL(opt.bytes_sent, 1 + 5 + 12 + 25);
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_opt(
+            server, AVS_NET_SOCKET_OPT_BYTES_RECEIVED, &opt));
+    AVS_UNIT_ASSERT_EQUAL(opt.bytes_received, 1 + 5 + 12 + 16);
+
+    // received peer addresses can be used to reply as-is
+    in[0].buffer_length = in[0].length;
+    in[1].buffer_length = in[1].length;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_send_batch(server, in, 2, &sent));
+    AVS_UNIT_ASSERT_EQUAL(sent, 2);
+    AVS_UNIT_ASSERT_EQUAL(receive_batch_all(client, in + 2, 2), 2);
+    AVS_UNIT_ASSERT_EQUAL(in[2].length, 0);
+    AVS_UNIT_ASSERT_EQUAL(in[3].length, 1);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&server));
+}
+
+AVS_UNIT_TEST(socket, udp_batch_large) {
+    char server_port[sizeof("65535")];
+    char client_port[sizeof("65535")];
+    avs_net_socket_t *server =
+            create_bound_udp_socket(server_port, sizeof(server_port));
+    avs_net_socket_t *client =
+            create_bound_udp_socket(client_port, sizeof(client_port));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_connect(client, BATCH_ADDRESS, server_port));
+
+    // more than fits in a single system call; unset peer addresses use the
+    // connected remote address
+    enum { COUNT = 100 };
+    uint32_t values[COUNT];
+    avs_net_socket_datagram_t datagrams[COUNT];
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        values[i] = i;
+        datagrams[i] = (avs_net_socket_datagram_t) {
+            .buffer = &values[i],
+            .buffer_length = sizeof(values[i])
+        };
+    }
+    size_t sent;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_send_batch(client, datagrams, COUNT, &sent));
+    AVS_UNIT_ASSERT_EQUAL(sent, COUNT);
+
+    memset(values, 0xFF, sizeof(values));
+    for (size_t i = 0; i < COUNT; ++i) {
+        datagrams[i].peer.size = 0;
+    }
+    AVS_UNIT_ASSERT_EQUAL(receive_batch_all(server, datagrams, COUNT), COUNT);
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        AVS_UNIT_ASSERT_EQUAL(datagrams[i].length, sizeof(uint32_t));
+        AVS_UNIT_ASSERT_EQUAL(values[i], i);
+        AVS_UNIT_ASSERT_TRUE(datagrams[i].peer.size > 0);
+    }
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&server));
+}
+
+AVS_UNIT_TEST(socket, udp_batch_receive_timeout) {
+    char port[sizeof("65535")];
+    avs_net_socket_t *socket = create_bound_udp_socket(port, sizeof(port));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_set_opt(
+            socket, AVS_NET_SOCKET_OPT_RECV_TIMEOUT,
+            (avs_net_socket_opt_value_t) {
+                .recv_timeout = avs_time_duration_from_scalar(10, AVS_TIME_MS)
+            }));
+
+    char buffer[16];
+    avs_net_socket_datagram_t datagram = {
+        .buffer = buffer,
+        .buffer_length = sizeof(buffer)
+    };
+    size_t received = 1;
+    avs_error_t err =
+            avs_net_socket_receive_batch(socket, &datagram, 1, &received);
+    AVS_UNIT_ASSERT_TRUE(avs_is_err(err));
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_ETIMEDOUT);
+    AVS_UNIT_ASSERT_EQUAL(received, 0);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&socket));
+}
+
+AVS_UNIT_TEST(socket, tcp_batch_not_supported) {
+    avs_net_socket_t *socket = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_tcp_socket_create(&socket, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_bind(socket, DEFAULT_ADDRESS, DEFAULT_PORT));
+
+    avs_net_socket_datagram_t datagram = {
+        .buffer = (void *) (intptr_t) "x",
+        .buffer_length = 1
+    };
+    size_t count;
+    AVS_UNIT_ASSERT_FAILED(
+            avs_net_socket_send_batch(socket, &datagram, 1, &count));
+    AVS_UNIT_ASSERT_EQUAL(count, 0);
+    AVS_UNIT_ASSERT_FAILED(
+            avs_net_socket_receive_batch(socket, &datagram, 1, &count));
+    AVS_UNIT_ASSERT_EQUAL(count, 0);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&socket));
+}
+
+//// AVS_NET_SOCKET_OPT_OPTIMISTIC_IO //////////////////////////////////////////
+
+static uint64_t get_syscall_count(avs_net_socket_t *socket) {
+    avs_net_socket_opt_value_t opt;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_opt(
+            socket, AVS_NET_SOCKET_OPT_SYSCALL_COUNT, &opt));
+    return opt.syscall_count;
+}
+
+static uint64_t receive_queued_datagram(avs_net_socket_t *server,
+                                        avs_net_socket_t *client) {
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_send(client, "ping", 4));
+
+    char buffer[16];
+    size_t received;
+    uint64_t syscalls_before = get_syscall_count(server);
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_receive(server, &received, buffer, sizeof(buffer)));
+    AVS_UNIT_ASSERT_EQUAL(received, 4);
+    return get_syscall_count(server) - syscalls_before;
+}
+
+AVS_UNIT_TEST(socket, udp_optimistic_io) {
+    char server_port[sizeof("65535")];
+    char client_port[sizeof("65535")];
+    avs_net_socket_t *server =
+            create_bound_udp_socket(server_port, sizeof(server_port));
+    avs_net_socket_t *client =
+            create_bound_udp_socket(client_port, sizeof(client_port));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_connect(client, BATCH_ADDRESS, server_port));
+
+    avs_net_socket_opt_value_t opt;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_opt(
+            server, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO, &opt));
+    AVS_UNIT_ASSERT_TRUE(opt.flag);
+
+    // data already queued: receiving does not need to poll() first
+    AVS_UNIT_ASSERT_EQUAL(receive_queued_datagram(server, client), 1);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_set_opt(
+            server, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO,
+            (avs_net_socket_opt_value_t) {
+                .flag = false
+            }));
+    AVS_UNIT_ASSERT_EQUAL(receive_queued_datagram(server, client), 2);
+
+    // no data: recvfrom() fails with EAGAIN, then poll() times out
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_set_opt(
+            server, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO,
+            (avs_net_socket_opt_value_t) {
+                .flag = true
+            }));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_set_opt(
+            server, AVS_NET_SOCKET_OPT_RECV_TIMEOUT,
+            (avs_net_socket_opt_value_t) {
+                .recv_timeout = avs_time_duration_from_scalar(10, AVS_TIME_MS)
+            }));
+    char buffer[16];
+    size_t received;
+    uint64_t syscalls_before = get_syscall_count(server);
+    avs_error_t err =
+            avs_net_socket_receive(server, &received, buffer, sizeof(buffer));
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_ETIMEDOUT);
+    AVS_UNIT_ASSERT_EQUAL(get_syscall_count(server) - syscalls_before, 2);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&server));
+}
+
+//// avs_net_socket_sendv //////////////////////////////////////////////////////
+
+#ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+static void create_tcp_socket_pair(avs_net_socket_t **out_client,
+                                   avs_net_socket_t **out_server) {
+    avs_net_socket_t *listener = NULL;
+    char port[sizeof("65535")];
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_tcp_socket_create(&listener, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_bind(listener, BATCH_ADDRESS, DEFAULT_PORT));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_get_local_port(listener, port, sizeof(port)));
+
+    *out_client = NULL;
+    *out_server = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_tcp_socket_create(out_client, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_connect(*out_client, BATCH_ADDRESS, port));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_tcp_socket_create(out_server, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_accept(listener, *out_server));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&listener));
+}
+
+AVS_UNIT_TEST(socket, udp_sendv) {
+    char server_port[sizeof("65535")];
+    char client_port[sizeof("65535")];
+    avs_net_socket_t *server =
+            create_bound_udp_socket(server_port, sizeof(server_port));
+    avs_net_socket_t *client =
+            create_bound_udp_socket(client_port, sizeof(client_port));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_connect(client, BATCH_ADDRESS, server_port));
+
+    const avs_net_socket_iovec_t iov[] = {
+        { "single", 6 }, { "", 0 }, { " datagram", 9 }
+    };
+    uint64_t syscalls_before = get_syscall_count(client);
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_sendv(client, iov, AVS_ARRAY_SIZE(iov)));
+    AVS_UNIT_ASSERT_EQUAL(get_syscall_count(client) - syscalls_before, 1);
+
+    char buffer[32];
+    size_t received;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_receive(server, &received, buffer, sizeof(buffer)));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer, "single datagram", received);
+
+    avs_net_socket_iovec_t too_many[AVS_NET_SOCKET_SENDV_MAX_IOV + 1];
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(too_many); ++i) {
+        too_many[i] = (avs_net_socket_iovec_t) { "x", 1 };
+    }
+    avs_error_t err = avs_net_socket_sendv(client, too_many,
+                                           AVS_ARRAY_SIZE(too_many));
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_EMSGSIZE);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&server));
+}
+
+AVS_UNIT_TEST(socket, tcp_sendv) {
+    avs_net_socket_t *client;
+    avs_net_socket_t *server;
+    create_tcp_socket_pair(&client, &server);
+
+    // more buffers than fit in a single sendmsg() call
+    enum { COUNT = 3 * AVS_NET_SOCKET_SENDV_MAX_IOV };
+    uint32_t values[COUNT];
+    avs_net_socket_iovec_t iov[COUNT];
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        values[i] = i;
+        iov[i] = (avs_net_socket_iovec_t) { &values[i], sizeof(values[i]) };
+    }
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_sendv(client, iov, COUNT));
+
+    uint32_t received_values[COUNT];
+    size_t received_size = 0;
+    while (received_size < sizeof(received_values)) {
+        size_t received;
+        AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_receive(
+                server, &received, (char *) received_values + received_size,
+                sizeof(received_values) - received_size));
+        AVS_UNIT_ASSERT_TRUE(received > 0);
+        received_size += received;
+    }
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(received_values, values,
+                                      sizeof(values));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&server));
+}
+#endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
@@ -48,11 +48,21 @@ AVS_UNIT_TEST(socket, ssl_get_opt) {
         { SUCCESS, AVS_NET_SOCKET_OPT_INNER_MTU },
         { SUCCESS, AVS_NET_SOCKET_OPT_SESSION_RESUMED },
         { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_SENT },
-        { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_RECEIVED }
+        { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_RECEIVED },
+        { SUCCESS, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA },
+        { SUCCESS, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO },
+        { SUCCESS, AVS_NET_SOCKET_OPT_SYSCALL_COUNT },
+        { SUCCESS, AVS_NET_SOCKET_OPT_SOCKET_TYPE }
     };
     run_socket_get_opt_test_cases(socket, test_cases,
                                   AVS_ARRAY_SIZE(test_cases));
 
+    // the type of the backend TCP socket is not reported
+    avs_net_socket_opt_value_t opt;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_opt(
+            socket, AVS_NET_SOCKET_OPT_SOCKET_TYPE, &opt));
+    AVS_UNIT_ASSERT_EQUAL(opt.socket_type, AVS_NET_SSL_SOCKET);
+
     AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&socket));
     cleanup_default_ssl_config(&config);
 }
@@ -76,7 +86,11 @@ AVS_UNIT_TEST(socket, ssl_get_opt_after_close) {
         { SUCCESS, AVS_NET_SOCKET_OPT_INNER_MTU },
         { SUCCESS, AVS_NET_SOCKET_OPT_SESSION_RESUMED },
         { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_SENT },
-        { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_RECEIVED }
+        { SUCCESS, AVS_NET_SOCKET_OPT_BYTES_RECEIVED },
+        { SUCCESS, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA },
+        { SUCCESS, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO },
+        { SUCCESS, AVS_NET_SOCKET_OPT_SYSCALL_COUNT },
+        { SUCCESS, AVS_NET_SOCKET_OPT_SOCKET_TYPE }
     };
     run_socket_get_opt_test_cases(socket, test_cases,
                                   AVS_ARRAY_SIZE(test_cases));
@@ -103,7 +117,11 @@ AVS_UNIT_TEST(socket, ssl_set_opt) {
         { FAIL, AVS_NET_SOCKET_OPT_INNER_MTU },
         { FAIL, AVS_NET_SOCKET_OPT_SESSION_RESUMED },
         { FAIL, AVS_NET_SOCKET_OPT_BYTES_SENT },
-        { FAIL, AVS_NET_SOCKET_OPT_BYTES_RECEIVED }
+        { FAIL, AVS_NET_SOCKET_OPT_BYTES_RECEIVED },
+        { FAIL, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA },
+        { SUCCESS, AVS_NET_SOCKET_OPT_OPTIMISTIC_IO },
+        { FAIL, AVS_NET_SOCKET_OPT_SYSCALL_COUNT },
+        { FAIL, AVS_NET_SOCKET_OPT_SOCKET_TYPE }
     };
     run_socket_set_opt_test_cases(socket, test_cases,
                                   AVS_ARRAY_SIZE(test_cases));
@@ -0,0 +1,394 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_net_udp_server.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#define SERVER_ADDRESS "127.0.0.1"
+
+static const avs_time_duration_t WAIT_TIMEOUT = { 5, 0 };
+
+static avs_net_udp_server_t *create_server(char *out_port,
+                                           size_t out_port_size) {
+    avs_net_udp_server_t *server = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_udp_server_create(&server, NULL, SERVER_ADDRESS, "0"));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_local_port(
+            avs_net_udp_server_socket(server), out_port, out_port_size));
+    return server;
+}
+
+static avs_net_socket_t *create_client(const char *server_port) {
+    avs_net_socket_t *client = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_udp_socket_create(&client, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_connect(client, SERVER_ADDRESS, server_port));
+    return client;
+}
+
+static void send_string(avs_net_socket_t *socket, const char *data) {
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_send(socket, data, strlen(data)));
+}
+
+static void assert_receive_string(avs_net_socket_t *socket,
+                                  const char *expected) {
+    char buffer[64];
+    size_t received;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_receive(socket, &received, buffer,
+                                                   sizeof(buffer) - 1));
+    buffer[received] = '\0';
+    AVS_UNIT_ASSERT_EQUAL_STRING(buffer, expected);
+}
+
+static void assert_timed_out(avs_error_t err) {
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_ETIMEDOUT);
+}
+
+AVS_UNIT_TEST(udp_server, accept_and_exchange) {
+    char port[sizeof("65535")];
+    avs_net_udp_server_t *server = create_server(port, sizeof(port));
+    avs_net_socket_t *client_a = create_client(port);
+    avs_net_socket_t *client_b = create_client(port);
+
+    send_string(client_a, "a1");
+    send_string(client_b, "b1");
+    send_string(client_a, "a2");
+
+    avs_net_socket_t *peer_a = NULL;
+    avs_net_socket_t *peer_b = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_udp_server_accept(server, WAIT_TIMEOUT, &peer_a, &peer_a));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_udp_server_accept(server, WAIT_TIMEOUT, &peer_b, &peer_b));
+    AVS_UNIT_ASSERT_EQUAL(avs_net_udp_server_peer_count(server), 2);
+    avs_net_socket_t *peer_c = NULL;
+    assert_timed_out(avs_net_udp_server_accept(server, AVS_TIME_DURATION_ZERO,
+                                               &peer_c, NULL));
+    AVS_UNIT_ASSERT_NULL(peer_c);
+
+    avs_net_socket_opt_value_t opt;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_get_opt(peer_a, AVS_NET_SOCKET_OPT_STATE, &opt));
+    AVS_UNIT_ASSERT_EQUAL(opt.state, AVS_NET_SOCKET_STATE_ACCEPTED);
+    AVS_UNIT_ASSERT_NULL(avs_net_socket_get_system(peer_a));
+
+    char client_port[sizeof("65535")];
+    char peer_port[sizeof("65535")];
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_local_port(
+            client_a, client_port, sizeof(client_port)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_remote_port(
+            peer_a, peer_port, sizeof(peer_port)));
+    AVS_UNIT_ASSERT_EQUAL_STRING(peer_port, client_port);
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_local_port(
+            peer_a, peer_port, sizeof(peer_port)));
+    AVS_UNIT_ASSERT_EQUAL_STRING(peer_port, port);
+
+    // datagrams received before accepting are kept in order
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_opt(
+            peer_a, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA, &opt));
+    AVS_UNIT_ASSERT_TRUE(opt.flag);
+    assert_receive_string(peer_a, "a1");
+    assert_receive_string(peer_a, "a2");
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_opt(
+            peer_a, AVS_NET_SOCKET_OPT_HAS_BUFFERED_DATA, &opt));
+    AVS_UNIT_ASSERT_FALSE(opt.flag);
+
+    // receiving on one peer socket queues datagrams for the others
+    send_string(client_b, "b2");
+    send_string(client_a, "a3");
+    assert_receive_string(peer_a, "a3");
+    assert_receive_string(peer_b, "b1");
+    assert_receive_string(peer_b, "b2");
+
+    // user data passed when accepting is reported when waiting
+    send_string(client_b, "b3");
+    avs_net_socket_t *socket = NULL;
+    bool is_new = true;
+    void *user_data = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_udp_server_wait(
+            server, WAIT_TIMEOUT, &socket, &is_new, &user_data));
+    AVS_UNIT_ASSERT_TRUE(socket == peer_b);
+    AVS_UNIT_ASSERT_FALSE(is_new);
+    AVS_UNIT_ASSERT_TRUE(user_data == &peer_b);
+    assert_receive_string(peer_b, "b3");
+
+    send_string(peer_a, "reply a");
+    send_string(peer_b, "reply b");
+    assert_receive_string(client_a, "reply a");
+    assert_receive_string(client_b, "reply b");
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_set_opt(
+            peer_b, AVS_NET_SOCKET_OPT_RECV_TIMEOUT,
+            (avs_net_socket_opt_value_t) {
+                .recv_timeout = avs_time_duration_from_scalar(10, AVS_TIME_MS)
+            }));
+    char buffer[16];
+    size_t received;
+    assert_timed_out(
+            avs_net_socket_receive(peer_b, &received, buffer, sizeof(buffer)));
+
+    // too long datagrams are truncated, like on regular UDP sockets
+    send_string(client_b, "too long to fit");
+    avs_error_t err = avs_net_socket_receive(peer_b, &received, buffer, 4);
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_EMSGSIZE);
+    AVS_UNIT_ASSERT_EQUAL(received, 4);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer, "too ", 4);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&peer_a));
+    AVS_UNIT_ASSERT_EQUAL(avs_net_udp_server_peer_count(server), 1);
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&peer_b));
+    AVS_UNIT_ASSERT_EQUAL(avs_net_udp_server_peer_count(server), 0);
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client_a));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client_b));
+    avs_net_udp_server_cleanup(&server);
+    AVS_UNIT_ASSERT_NULL(server);
+}
+
+AVS_UNIT_TEST(udp_server, wait) {
+    char port[sizeof("65535")];
+    avs_net_udp_server_t *server = create_server(port, sizeof(port));
+    avs_net_socket_t *client = create_client(port);
+
+    avs_net_socket_t *socket = NULL;
+    bool is_new = false;
+    void *user_data = &is_new;
+    assert_timed_out(avs_net_udp_server_wait(
+            server, AVS_TIME_DURATION_ZERO, &socket, &is_new, &user_data));
+
+    send_string(client, "first");
+    send_string(client, "second");
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_udp_server_wait(
+            server, WAIT_TIMEOUT, &socket, &is_new, &user_data));
+    AVS_UNIT_ASSERT_TRUE(is_new);
+    AVS_UNIT_ASSERT_NULL(user_data);
+    avs_net_socket_t *peer = socket;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_udp_server_set_user_data(peer, &peer));
+    assert_receive_string(peer, "first");
+
+    // the remaining datagram is reported again
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_udp_server_wait(
+            server, WAIT_TIMEOUT, &socket, &is_new, &user_data));
+    AVS_UNIT_ASSERT_FALSE(is_new);
+    AVS_UNIT_ASSERT_TRUE(socket == peer);
+    AVS_UNIT_ASSERT_TRUE(user_data == &peer);
+    assert_receive_string(peer, "second");
+    assert_timed_out(avs_net_udp_server_wait(server, AVS_TIME_DURATION_ZERO,
+                                             &socket, &is_new, NULL));
+
+    send_string(client, "third");
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_udp_server_wait(
+            server, WAIT_TIMEOUT, &socket, &is_new, &user_data));
+    AVS_UNIT_ASSERT_FALSE(is_new);
+    AVS_UNIT_ASSERT_TRUE(socket == peer);
+    AVS_UNIT_ASSERT_TRUE(user_data == &peer);
+
+    // after closing the peer socket, the peer is accepted anew
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_close(peer));
+    AVS_UNIT_ASSERT_EQUAL(avs_net_udp_server_peer_count(server), 0);
+    char buffer[16];
+    size_t received;
+    AVS_UNIT_ASSERT_FAILED(
+            avs_net_socket_receive(peer, &received, buffer, sizeof(buffer)));
+    send_string(client, "fourth");
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_udp_server_wait(
+            server, WAIT_TIMEOUT, &socket, &is_new, &user_data));
+    AVS_UNIT_ASSERT_TRUE(is_new);
+    AVS_UNIT_ASSERT_TRUE(socket != peer);
+    AVS_UNIT_ASSERT_NULL(user_data);
+    assert_receive_string(socket, "fourth");
+
+    // only peer sockets carry user data
+    AVS_UNIT_ASSERT_FAILED(avs_net_udp_server_set_user_data(client, NULL));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&socket));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&peer));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client));
+    avs_net_udp_server_cleanup(&server);
+}
+
+AVS_UNIT_TEST(udp_server, many_peers) {
+    char port[sizeof("65535")];
+    avs_net_udp_server_t *server = create_server(port, sizeof(port));
+
+    // more than the initial size of the hash table
+    enum { COUNT = 50 };
+    avs_net_socket_t *clients[COUNT];
+    avs_net_socket_t *peers[COUNT];
+    for (size_t i = 0; i < COUNT; ++i) {
+        clients[i] = create_client(port);
+        send_string(clients[i], "hello");
+        AVS_UNIT_ASSERT_SUCCESS(
+                avs_net_udp_server_accept(server, WAIT_TIMEOUT, &peers[i],
+                                          NULL));
+        assert_receive_string(peers[i], "hello");
+    }
+    AVS_UNIT_ASSERT_EQUAL(avs_net_udp_server_peer_count(server), COUNT);
+
+    for (size_t i = 0; i < COUNT; ++i) {
+        char data[16];
+        snprintf(data, sizeof(data), "%u", (unsigned) i);
+        send_string(clients[i], data);
+    }
+    for (size_t i = COUNT; i-- > 0;) {
+        char data[16];
+        snprintf(data, sizeof(data), "%u", (unsigned) i);
+        assert_receive_string(peers[i], data);
+    }
+
+    for (size_t i = 0; i < COUNT; ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&peers[i]));
+        AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&clients[i]));
+    }
+    avs_net_udp_server_cleanup(&server);
+}
+
+AVS_UNIT_TEST(udp_server, cleanup_with_open_peers) {
+    char port[sizeof("65535")];
+    avs_net_udp_server_t *server = create_server(port, sizeof(port));
+    avs_net_socket_t *client = create_client(port);
+
+    send_string(client, "hello");
+    send_string(client, "world");
+    avs_net_socket_t *peer = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_udp_server_accept(server, WAIT_TIMEOUT, &peer, NULL));
+    avs_net_udp_server_cleanup(&server);
+
+    avs_net_socket_opt_value_t opt;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_get_opt(peer, AVS_NET_SOCKET_OPT_STATE, &opt));
+    AVS_UNIT_ASSERT_EQUAL(opt.state, AVS_NET_SOCKET_STATE_CLOSED);
+    char buffer[16];
+    size_t received;
+    AVS_UNIT_ASSERT_FAILED(
+            avs_net_socket_receive(peer, &received, buffer, sizeof(buffer)));
+    AVS_UNIT_ASSERT_FAILED(avs_net_socket_send(peer, "x", 1));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&peer));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client));
+}
+
+// Wrapper around a UDP socket that does not implement batch operations
+typedef struct {
+    const avs_net_socket_v_table_t *const operations;
+    avs_net_socket_t *backend;
+} unbatched_socket_t;
+
+static avs_error_t unbatched_send_to(avs_net_socket_t *socket,
+                                     const void *buffer,
+                                     size_t buffer_length,
+                                     const char *host,
+                                     const char *port) {
+    return avs_net_socket_send_to(((unbatched_socket_t *) socket)->backend,
+                                  buffer, buffer_length, host, port);
+}
+
+static avs_error_t unbatched_receive_from(avs_net_socket_t *socket,
+                                          size_t *out_bytes_received,
+                                          void *buffer,
+                                          size_t buffer_length,
+                                          char *host,
+                                          size_t host_size,
+                                          char *port,
+                                          size_t port_size) {
+    return avs_net_socket_receive_from(((unbatched_socket_t *) socket)->backend,
+                                       out_bytes_received, buffer,
+                                       buffer_length, host, host_size, port,
+                                       port_size);
+}
+
+static avs_error_t unbatched_cleanup(avs_net_socket_t **socket) {
+    avs_error_t err = avs_net_socket_cleanup(
+            &((unbatched_socket_t *) *socket)->backend);
+    avs_free(*socket);
+    *socket = NULL;
+    return err;
+}
+
+static avs_error_t unbatched_get_opt(avs_net_socket_t *socket,
+                                     avs_net_socket_opt_key_t option_key,
+                                     avs_net_socket_opt_value_t *out_value) {
+    return avs_net_socket_get_opt(((unbatched_socket_t *) socket)->backend,
+                                  option_key, out_value);
+}
+
+static avs_error_t unbatched_set_opt(avs_net_socket_t *socket,
+                                     avs_net_socket_opt_key_t option_key,
+                                     avs_net_socket_opt_value_t value) {
+    return avs_net_socket_set_opt(((unbatched_socket_t *) socket)->backend,
+                                  option_key, value);
+}
+
+static const avs_net_socket_v_table_t UNBATCHED_VTABLE = {
+    .send_to = unbatched_send_to,
+    .receive_from = unbatched_receive_from,
+    .cleanup = unbatched_cleanup,
+    .get_opt = unbatched_get_opt,
+    .set_opt = unbatched_set_opt
+};
+
+AVS_UNIT_TEST(udp_server, without_batch_operations) {
+    char port[sizeof("65535")];
+    avs_net_udp_server_t *server = create_server(port, sizeof(port));
+    unbatched_socket_t *unbatched =
+            (unbatched_socket_t *) avs_calloc(1, sizeof(unbatched_socket_t));
+    AVS_UNIT_ASSERT_NOT_NULL(unbatched);
+    const avs_net_socket_v_table_t *const VTABLE_PTR = &UNBATCHED_VTABLE;
+    memcpy((void *) (intptr_t) &unbatched->operations, &VTABLE_PTR,
+           sizeof(VTABLE_PTR));
+    unbatched->backend = server->socket;
+    server->socket = (avs_net_socket_t *) unbatched;
+
+    avs_net_socket_t *client_a = create_client(port);
+    avs_net_socket_t *client_b = create_client(port);
+    send_string(client_a, "a1");
+    send_string(client_b, "b1");
+    send_string(client_a, "a2");
+
+    avs_net_socket_t *peer_a = NULL;
+    avs_net_socket_t *peer_b = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_udp_server_accept(server, WAIT_TIMEOUT, &peer_a, NULL));
+    AVS_UNIT_ASSERT_TRUE(server->receive_batch_unsupported);
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_udp_server_accept(server, WAIT_TIMEOUT, &peer_b, NULL));
+    AVS_UNIT_ASSERT_EQUAL(avs_net_udp_server_peer_count(server), 2);
+
+    // datagrams from the same peer are recognized as such
+    assert_receive_string(peer_a, "a1");
+    assert_receive_string(peer_a, "a2");
+    assert_receive_string(peer_b, "b1");
+    send_string(client_b, "b2");
+    assert_receive_string(peer_b, "b2");
+    AVS_UNIT_ASSERT_EQUAL(avs_net_udp_server_peer_count(server), 2);
+
+    send_string(peer_a, "reply a");
+    AVS_UNIT_ASSERT_TRUE(server->send_batch_unsupported);
+    send_string(peer_b, "reply b");
+    assert_receive_string(client_a, "reply a");
+    assert_receive_string(client_b, "reply b");
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&peer_a));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&peer_b));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client_a));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client_b));
+    avs_net_udp_server_cleanup(&server);
+}
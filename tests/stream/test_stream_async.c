@@ -0,0 +1,277 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include <avsystem/commons/avs_stream_membuf.h>
+#include <avsystem/commons/avs_stream_v_table.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+/* Stream that simulates a transport with limited readable data and a small
+ * output buffer that is only emptied by flushing. */
+typedef struct {
+    const avs_stream_v_table_t *const vtable;
+    const char *input;
+    size_t input_available;
+    char out_buffer[4];
+    size_t out_buffered;
+    char sink[64];
+    size_t sink_length;
+    size_t flush_count;
+    bool message_finished;
+} nbio_stream_t;
+
+static avs_error_t nbio_read(avs_stream_t *stream_,
+                             size_t *out_bytes_read,
+                             bool *out_message_finished,
+                             void *buffer,
+                             size_t buffer_length) {
+    nbio_stream_t *stream = (nbio_stream_t *) stream_;
+    if (!stream->input_available) {
+        return avs_errno(AVS_EAGAIN);
+    }
+    *out_bytes_read = AVS_MIN(buffer_length, stream->input_available);
+    memcpy(buffer, stream->input, *out_bytes_read);
+    stream->input += *out_bytes_read;
+    stream->input_available -= *out_bytes_read;
+    *out_message_finished = !*stream->input;
+    return AVS_OK;
+}
+
+static avs_error_t nbio_write_some(avs_stream_t *stream_,
+                                   const void *buffer,
+                                   size_t *inout_data_length) {
+    nbio_stream_t *stream = (nbio_stream_t *) stream_;
+    size_t space = sizeof(stream->out_buffer) - stream->out_buffered;
+    if (!space) {
+        return avs_errno(AVS_EAGAIN);
+    }
+    *inout_data_length = AVS_MIN(*inout_data_length, space);
+    memcpy(stream->out_buffer + stream->out_buffered, buffer,
+           *inout_data_length);
+    stream->out_buffered += *inout_data_length;
+    return AVS_OK;
+}
+
+static avs_error_t nbio_flush(avs_stream_t *stream_) {
+    nbio_stream_t *stream = (nbio_stream_t *) stream_;
+    AVS_UNIT_ASSERT_TRUE(stream->sink_length + stream->out_buffered
+                         <= sizeof(stream->sink));
+    memcpy(stream->sink + stream->sink_length, stream->out_buffer,
+           stream->out_buffered);
+    stream->sink_length += stream->out_buffered;
+    stream->out_buffered = 0;
+    ++stream->flush_count;
+    return AVS_OK;
+}
+
+static avs_error_t nbio_finish_message(avs_stream_t *stream_) {
+    nbio_stream_t *stream = (nbio_stream_t *) stream_;
+    avs_error_t err = nbio_flush(stream_);
+    stream->message_finished = true;
+    return err;
+}
+
+static const avs_stream_v_table_extension_nonblock_io_t NBIO_EXT = {
+    .read = nbio_read,
+    .write_some = nbio_write_some,
+    .flush = nbio_flush
+};
+
+static const avs_stream_v_table_t NBIO_VTABLE = {
+    .finish_message = nbio_finish_message,
+    .extension_list =
+            (const avs_stream_v_table_extension_t[]) {
+                    { AVS_STREAM_V_TABLE_EXTENSION_NONBLOCK_IO, &NBIO_EXT },
+                    AVS_STREAM_V_TABLE_EXTENSION_NULL }
+};
+
+typedef struct {
+    size_t calls;
+    avs_error_t err;
+    size_t bytes_read;
+    bool message_finished;
+    /* if set, the next read is started from within the handler */
+    char *next_buffer;
+    size_t next_buffer_length;
+    /* if set, the object is destroyed from within the handler */
+    avs_stream_async_t **async_to_destroy;
+} read_result_t;
+
+static void on_read(avs_stream_async_t *async,
+                    avs_error_t err,
+                    size_t bytes_read,
+                    bool message_finished,
+                    void *result_) {
+    read_result_t *result = (read_result_t *) result_;
+    ++result->calls;
+    result->err = err;
+    result->bytes_read = bytes_read;
+    result->message_finished = message_finished;
+    if (result->next_buffer) {
+        char *buffer = result->next_buffer;
+        result->next_buffer = NULL;
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_async_read(
+                async, buffer, result->next_buffer_length, on_read, result));
+    }
+    if (result->async_to_destroy) {
+        avs_stream_async_cleanup(result->async_to_destroy);
+    }
+}
+
+typedef struct {
+    size_t calls;
+    avs_error_t err;
+} write_result_t;
+
+static void on_write(avs_stream_async_t *async,
+                     avs_error_t err,
+                     void *result_) {
+    (void) async;
+    write_result_t *result = (write_result_t *) result_;
+    ++result->calls;
+    result->err = err;
+}
+
+AVS_UNIT_TEST(stream_async, read) {
+    nbio_stream_t stream = {
+        .vtable = &NBIO_VTABLE,
+        .input = "Hello, world"
+    };
+    avs_stream_async_t *async = avs_stream_async_new((avs_stream_t *) &stream);
+    AVS_UNIT_ASSERT_NOT_NULL(async);
+
+    char buf1[8];
+    char buf2[8];
+    read_result_t result = {
+        .next_buffer = buf2,
+        .next_buffer_length = sizeof(buf2)
+    };
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_async_read(async, buf1, sizeof(buf1), on_read, &result));
+    AVS_UNIT_ASSERT_FAILED(
+            avs_stream_async_read(async, buf1, sizeof(buf1), on_read, &result));
+
+    avs_stream_async_process(async, 0);
+    AVS_UNIT_ASSERT_EQUAL(result.calls, 0);
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_async_wanted_events(async),
+                          AVS_STREAM_ASYNC_EVENT_READ);
+
+    /* first read completes, the one started from the handler would block */
+    stream.input_available = 5;
+    avs_stream_async_process(async, AVS_STREAM_ASYNC_EVENT_READ);
+    AVS_UNIT_ASSERT_EQUAL(result.calls, 1);
+    AVS_UNIT_ASSERT_SUCCESS(result.err);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf1, "Hello", 5);
+    AVS_UNIT_ASSERT_EQUAL(result.bytes_read, 5);
+    AVS_UNIT_ASSERT_FALSE(result.message_finished);
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_async_wanted_events(async),
+                          AVS_STREAM_ASYNC_EVENT_READ);
+
+    stream.input_available = 7;
+    avs_stream_async_process(async, AVS_STREAM_ASYNC_EVENT_READ);
+    AVS_UNIT_ASSERT_EQUAL(result.calls, 2);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf2, ", world", 7);
+    AVS_UNIT_ASSERT_TRUE(result.message_finished);
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_async_wanted_events(async), 0);
+
+    avs_stream_async_cleanup(&async);
+    AVS_UNIT_ASSERT_NULL(async);
+}
+
+AVS_UNIT_TEST(stream_async, write) {
+    nbio_stream_t stream = {
+        .vtable = &NBIO_VTABLE
+    };
+    avs_stream_async_t *async = avs_stream_async_new((avs_stream_t *) &stream);
+    AVS_UNIT_ASSERT_NOT_NULL(async);
+
+    static const char DATA[] = "0123456789";
+    write_result_t result = { 0 };
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_async_write(
+            async, DATA, strlen(DATA), true, on_write, &result));
+
+    /* only the internal buffer is filled without the WRITE event */
+    avs_stream_async_process(async, 0);
+    AVS_UNIT_ASSERT_EQUAL(result.calls, 0);
+    AVS_UNIT_ASSERT_EQUAL(stream.out_buffered, 4);
+    AVS_UNIT_ASSERT_EQUAL(stream.flush_count, 0);
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_async_wanted_events(async),
+                          AVS_STREAM_ASYNC_EVENT_WRITE);
+
+    /* each event allows for a single flush */
+    avs_stream_async_process(async, AVS_STREAM_ASYNC_EVENT_WRITE);
+    AVS_UNIT_ASSERT_EQUAL(stream.flush_count, 1);
+    AVS_UNIT_ASSERT_EQUAL(result.calls, 0);
+    avs_stream_async_process(async, AVS_STREAM_ASYNC_EVENT_WRITE);
+    AVS_UNIT_ASSERT_EQUAL(stream.flush_count, 2);
+    AVS_UNIT_ASSERT_EQUAL(result.calls, 0);
+    AVS_UNIT_ASSERT_FALSE(stream.message_finished);
+
+    /* all data accepted, finishing the message needs another event */
+    avs_stream_async_process(async, AVS_STREAM_ASYNC_EVENT_WRITE);
+    AVS_UNIT_ASSERT_EQUAL(result.calls, 1);
+    AVS_UNIT_ASSERT_SUCCESS(result.err);
+    AVS_UNIT_ASSERT_TRUE(stream.message_finished);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(stream.sink, DATA, strlen(DATA));
+    AVS_UNIT_ASSERT_EQUAL(stream.sink_length, strlen(DATA));
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_async_wanted_events(async), 0);
+
+    avs_stream_async_cleanup(&async);
+}
+
+AVS_UNIT_TEST(stream_async, cleanup_from_handler) {
+    nbio_stream_t stream = {
+        .vtable = &NBIO_VTABLE,
+        .input = "abc",
+        .input_available = 3
+    };
+    avs_stream_async_t *async = avs_stream_async_new((avs_stream_t *) &stream);
+    AVS_UNIT_ASSERT_NOT_NULL(async);
+
+    char buf[8];
+    read_result_t read_result = {
+        .async_to_destroy = &async
+    };
+    write_result_t write_result = { 0 };
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_async_read(async, buf, sizeof(buf),
+                                                  on_read, &read_result));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_async_write(async, "x", 1, false,
+                                                   on_write, &write_result));
+    avs_stream_async_process(async, 0);
+    AVS_UNIT_ASSERT_NULL(async);
+    AVS_UNIT_ASSERT_EQUAL(read_result.calls, 1);
+    /* the pending write has been abandoned */
+    AVS_UNIT_ASSERT_EQUAL(write_result.calls, 0);
+}
+
+AVS_UNIT_TEST(stream_async, unsupported_stream) {
+    avs_stream_t *membuf = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(membuf);
+    avs_stream_async_t *async = avs_stream_async_new(membuf);
+    AVS_UNIT_ASSERT_NOT_NULL(async);
+
+    write_result_t result = { 0 };
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_async_write(async, "x", 1, false, on_write, &result));
+    avs_stream_async_process(async, AVS_STREAM_ASYNC_EVENT_WRITE);
+    AVS_UNIT_ASSERT_EQUAL(result.calls, 1);
+    AVS_UNIT_ASSERT_TRUE(result.err.category == AVS_ERRNO_CATEGORY
+                         && result.err.code == AVS_ENOTSUP);
+
+    avs_stream_async_cleanup(&async);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&membuf));
+}
@@ -16,7 +16,8 @@
 
 #include <avsystem/commons/avs_unit_test.h>
 
-/* Underlying stream implementation used for tests */
+/* Underlying stream implementations used for tests */
+#include <avsystem/commons/avs_stream_membuf.h>
 #include <avsystem/commons/avs_stream_simple_io.h>
 
 #define STREAM_BUFFER_SIZE 64
@@ -387,3 +388,143 @@ AVS_UNIT_TEST(stream_buffered, peek) {
 
     teardown_stream(&stream, &ctx);
 }
+
+AVS_UNIT_TEST(stream_buffered, zerocopy_copy) {
+    stream_ctx_t ictx;
+    stream_ctx_t octx;
+    avs_stream_t *input = setup_input_stream(&ictx);
+    avs_stream_t *output = setup_output_stream(&octx);
+
+    const void *data;
+    size_t data_size;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek_contiguous(
+            input, &data, &data_size, &message_finished));
+    AVS_UNIT_ASSERT_EQUAL(data_size, STREAM_BUFFER_SIZE);
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, TEST_DATA, STREAM_BUFFER_SIZE);
+
+    void *space;
+    size_t space_size;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_reserve(output, 1, &space, &space_size));
+    AVS_UNIT_ASSERT_EQUAL(space_size, STREAM_BUFFER_SIZE);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_copy(output, input));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(output));
+    AVS_UNIT_ASSERT_EQUAL(octx.curr_offset, STREAM_SIZE);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(octx.data, TEST_DATA, STREAM_SIZE);
+
+    teardown_stream(&input, &ictx);
+    teardown_stream(&output, &octx);
+}
+
+AVS_UNIT_TEST(stream_buffered, writev_large_element) {
+    stream_ctx_t ctx;
+    avs_stream_t *stream = setup_output_stream(&ctx);
+
+    const avs_stream_const_iovec_t iov[] = {
+        { TEST_DATA, 3 },
+        { TEST_DATA + 3, STREAM_BUFFER_SIZE },
+        { TEST_DATA + 3 + STREAM_BUFFER_SIZE, 5 }
+    };
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_writev(stream, iov, AVS_ARRAY_SIZE(iov)));
+    /* the large element has been written directly, the last one is still
+     * buffered */
+    AVS_UNIT_ASSERT_EQUAL(ctx.curr_offset, 3 + STREAM_BUFFER_SIZE);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(stream));
+    AVS_UNIT_ASSERT_EQUAL(ctx.curr_offset, 8 + STREAM_BUFFER_SIZE);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(ctx.data, TEST_DATA,
+                                      8 + STREAM_BUFFER_SIZE);
+
+    teardown_stream(&stream, &ctx);
+}
+
+AVS_UNIT_TEST(stream_buffered, readv) {
+    stream_ctx_t ctx;
+    avs_stream_t *stream = setup_input_stream(&ctx);
+
+    char first[10];
+    char second[STREAM_BUFFER_SIZE];
+    const avs_stream_iovec_t iov[] = {
+        { first, sizeof(first) },
+        { second, sizeof(second) }
+    };
+    size_t bytes_read;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_readv(
+            stream, &bytes_read, &message_finished, iov, AVS_ARRAY_SIZE(iov)));
+    /* only the buffered data is returned */
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, STREAM_BUFFER_SIZE);
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(first, TEST_DATA, sizeof(first));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(second, TEST_DATA + sizeof(first),
+                                      STREAM_BUFFER_SIZE - sizeof(first));
+
+    teardown_stream(&stream, &ctx);
+}
+
+AVS_UNIT_TEST(stream_buffered, read_in_parts_after_last_fetch) {
+    avs_stream_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "0123456789", 10));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_buffered_create(&stream, 64, 0));
+
+    /* the underlying stream reports end of message along with all the data;
+     * it shall not be reported until the buffer is drained */
+    char buf[8];
+    size_t bytes_read;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read,
+                                            &message_finished, buf, 4));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 4);
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read,
+                                            &message_finished, buf,
+                                            sizeof(buf)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 6);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, "456789", 6);
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(stream_buffered, getline_block_boundary) {
+    avs_stream_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_write_f(stream, "abcdefg\r\nxy\rz\r\n\r\r\n"));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_buffered_create(&stream, 8, 0));
+
+    char buf[16];
+    size_t bytes_read;
+    size_t next_offset;
+    bool message_finished;
+    /* '\r' is the last byte of the first block */
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_getline(stream, &bytes_read,
+                                               &message_finished, buf,
+                                               sizeof(buf)));
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, "abcdefg");
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 7);
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+
+    /* lone '\r' is a part of the line */
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peekline(stream, 0, &bytes_read,
+                                                &next_offset, buf,
+                                                sizeof(buf)));
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, "xy\rz");
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 4);
+    AVS_UNIT_ASSERT_EQUAL(next_offset, 6);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_getline(stream, &bytes_read,
+                                               &message_finished, buf,
+                                               sizeof(buf)));
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, "xy\rz");
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_getline(stream, &bytes_read,
+                                               &message_finished, buf,
+                                               sizeof(buf)));
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, "\r");
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
@@ -169,3 +169,327 @@ AVS_UNIT_TEST(stream_file, extensions_length) {
     AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
     unlink(filename);
 }
+
+#define MAPPED_READ_MODE (AVS_STREAM_FILE_READ | AVS_STREAM_FILE_MAPPED)
+
+AVS_UNIT_TEST(stream_file, mapped) {
+    char filename[sizeof(TEMPLATE)];
+    char data[] = "0123456789";
+    char buf[16];
+    size_t bytes_read;
+    bool end_of_msg;
+    char value;
+    avs_off_t offset;
+    avs_stream_t *stream;
+
+    AVS_UNIT_ASSERT_SUCCESS(make_temporary(filename));
+    AVS_UNIT_ASSERT_NULL(avs_stream_file_create(
+            filename, AVS_STREAM_FILE_WRITE | AVS_STREAM_FILE_MAPPED));
+    AVS_UNIT_ASSERT_NOT_NULL(
+            (stream = avs_stream_file_create(filename, AVS_STREAM_FILE_WRITE)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, data, sizeof(data) - 1));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+
+    AVS_UNIT_ASSERT_NOT_NULL((stream = avs_stream_file_create(
+                                      filename, MAPPED_READ_MODE)));
+    avs_error_t err = avs_stream_write(stream, data, sizeof(data));
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_EBADF);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_length(stream, &offset));
+    AVS_UNIT_ASSERT_EQUAL(offset, sizeof(data) - 1);
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_read(stream, &bytes_read, &end_of_msg, buf, 4));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 4);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, "0123", 4);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek(stream, 5, &value));
+    AVS_UNIT_ASSERT_EQUAL(value, '9');
+    AVS_UNIT_ASSERT_TRUE(avs_is_eof(avs_stream_peek(stream, 6, &value)));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_seek(stream, 7));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_offset(stream, &offset));
+    AVS_UNIT_ASSERT_EQUAL(offset, 7);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read, &end_of_msg,
+                                            buf, sizeof(buf)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 3);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, "789", 3);
+    AVS_UNIT_ASSERT_TRUE(end_of_msg);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_seek(stream, 9001));
+    AVS_UNIT_ASSERT_TRUE(avs_is_eof(avs_stream_peek(stream, 0, &value)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read, &end_of_msg,
+                                            buf, sizeof(buf)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 0);
+    AVS_UNIT_ASSERT_TRUE(end_of_msg);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_reset(stream));
+#    ifdef AVS_COMMONS_STREAM_WITH_FILE_MMAP
+    const void *contiguous;
+    size_t size;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_peek_contiguous(stream, &contiguous, &size, NULL));
+    AVS_UNIT_ASSERT_EQUAL(size, sizeof(data) - 1);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(contiguous, data, size);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_consume(stream, 2));
+    AVS_UNIT_ASSERT_FAILED(avs_stream_consume(stream, size));
+#    else  // AVS_COMMONS_STREAM_WITH_FILE_MMAP
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_seek(stream, 2));
+#    endif // AVS_COMMONS_STREAM_WITH_FILE_MMAP
+    // no newline at the end of file
+    AVS_UNIT_ASSERT_TRUE(avs_is_eof(avs_stream_getline(
+            stream, &bytes_read, &end_of_msg, buf, sizeof(buf))));
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, "23456789");
+    AVS_UNIT_ASSERT_TRUE(end_of_msg);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+    unlink(filename);
+}
+
+AVS_UNIT_TEST(stream_file, mapped_empty) {
+    char filename[sizeof(TEMPLATE)];
+    size_t bytes_read;
+    bool end_of_msg;
+    avs_off_t length;
+    avs_stream_t *stream;
+
+    AVS_UNIT_ASSERT_SUCCESS(make_temporary(filename));
+    AVS_UNIT_ASSERT_NOT_NULL((stream = avs_stream_file_create(
+                                      filename, MAPPED_READ_MODE)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_length(stream, &length));
+    AVS_UNIT_ASSERT_EQUAL(length, 0);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read, &end_of_msg,
+                                            &(char) { 0 }, 1));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 0);
+    AVS_UNIT_ASSERT_TRUE(end_of_msg);
+    AVS_UNIT_ASSERT_TRUE(avs_is_eof(avs_stream_peek(stream, 0, &(char) { 0 })));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+
+    unlink(filename);
+    AVS_UNIT_ASSERT_NULL(avs_stream_file_create(filename, MAPPED_READ_MODE));
+}
+
+#ifdef AVS_COMMONS_STREAM_WITH_FILE_FD
+static void fill_pattern(char *buf, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        buf[i] = (char) ('a' + i % 26);
+    }
+}
+
+static void test_fd_write_and_read(const avs_stream_file_fd_config_t *config,
+                                   size_t total_size) {
+    char filename[sizeof(TEMPLATE)];
+    char *buf = (char *) avs_malloc(total_size);
+    char *expected = (char *) avs_malloc(total_size);
+    size_t bytes_read;
+    bool end_of_msg;
+    avs_off_t length;
+    avs_stream_t *stream;
+
+    AVS_UNIT_ASSERT_NOT_NULL(buf);
+    AVS_UNIT_ASSERT_NOT_NULL(expected);
+    fill_pattern(expected, total_size);
+    AVS_UNIT_ASSERT_SUCCESS(make_temporary(filename));
+
+    stream = avs_stream_file_create_fd(filename, AVS_STREAM_FILE_WRITE, config);
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_FAILED(avs_stream_read(stream, &bytes_read, &end_of_msg,
+                                           buf, total_size));
+    // various chunk sizes, both smaller and larger than the buffer
+    size_t written = 0;
+    for (size_t chunk = 1; written < total_size; chunk *= 3) {
+        chunk = AVS_MIN(chunk, total_size - written);
+        AVS_UNIT_ASSERT_SUCCESS(
+                avs_stream_write(stream, expected + written, chunk));
+        written += chunk;
+        if (written > total_size / 2 && written - chunk <= total_size / 2) {
+            AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(stream));
+        }
+    }
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_length(stream, &length));
+    AVS_UNIT_ASSERT_EQUAL(length, total_size);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+
+    AVS_UNIT_ASSERT_NOT_NULL((stream = avs_stream_file_create_fd(
+                                      filename, AVS_STREAM_FILE_READ, config)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_length(stream, &length));
+    AVS_UNIT_ASSERT_EQUAL(length, total_size);
+    AVS_UNIT_ASSERT_FAILED(avs_stream_write(stream, "x", 1));
+    char value;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek(stream, 1, &value));
+    AVS_UNIT_ASSERT_EQUAL(value, expected[1]);
+    size_t offset = 0;
+    for (size_t chunk = 1; offset < total_size; chunk *= 5) {
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(
+                stream, &bytes_read, &end_of_msg, buf + offset,
+                AVS_MIN(chunk, total_size - offset)));
+        offset += bytes_read;
+    }
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, expected, total_size);
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_read(stream, &bytes_read, &end_of_msg, buf, 1));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 0);
+    AVS_UNIT_ASSERT_TRUE(end_of_msg);
+    AVS_UNIT_ASSERT_TRUE(avs_is_eof(avs_stream_peek(stream, 0, &value)));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_seek(stream, 7));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek(stream, 0, &value));
+    AVS_UNIT_ASSERT_EQUAL(value, expected[7]);
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_read(stream, &bytes_read, &end_of_msg, buf, 3));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 3);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, expected + 7, 3);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_offset(stream, &length));
+    AVS_UNIT_ASSERT_EQUAL(length, 10);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+
+    unlink(filename);
+    avs_free(buf);
+    avs_free(expected);
+}
+
+AVS_UNIT_TEST(stream_file, fd_write_and_read) {
+    test_fd_write_and_read(NULL, 100000);
+    test_fd_write_and_read(
+            &(const avs_stream_file_fd_config_t) {
+                .buffer_size = 16,
+                .sync_on_finish = true
+            },
+            1000);
+}
+
+AVS_UNIT_TEST(stream_file, fd_direct_io) {
+    // falls back to buffered I/O if the file system does not support it
+    const avs_stream_file_fd_config_t config = {
+        .buffer_size = 8192,
+        .direct_io = true
+    };
+    test_fd_write_and_read(&config, 30000);
+    test_fd_write_and_read(&config, 100);
+}
+
+AVS_UNIT_TEST(stream_file, fd_preallocate) {
+    char filename[sizeof(TEMPLATE)];
+    avs_off_t length;
+    avs_stream_t *stream;
+    AVS_UNIT_ASSERT_SUCCESS(make_temporary(filename));
+    AVS_UNIT_ASSERT_NOT_NULL((stream = avs_stream_file_create_fd(
+                                      filename, AVS_STREAM_FILE_WRITE,
+                                      &(const avs_stream_file_fd_config_t) {
+                                          .preallocate_length = 4096
+                                      })));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "TEST", 4));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_length(stream, &length));
+    AVS_UNIT_ASSERT_EQUAL(length, 4);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+
+    // the file is truncated to the actual length on close
+    AVS_UNIT_ASSERT_NOT_NULL((stream = avs_stream_file_create_fd(
+                                      filename, AVS_STREAM_FILE_READ, NULL)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_length(stream, &length));
+    AVS_UNIT_ASSERT_EQUAL(length, 4);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+    unlink(filename);
+}
+
+AVS_UNIT_TEST(stream_file, fd_invalid) {
+    char filename[sizeof(TEMPLATE)];
+    AVS_UNIT_ASSERT_SUCCESS(make_temporary(filename));
+    AVS_UNIT_ASSERT_NULL(avs_stream_file_create_fd(
+            filename, AVS_STREAM_FILE_READ | AVS_STREAM_FILE_WRITE, NULL));
+    unlink(filename);
+    AVS_UNIT_ASSERT_NULL(
+            avs_stream_file_create_fd(filename, AVS_STREAM_FILE_READ, NULL));
+}
+
+AVS_UNIT_TEST(stream_file, fd_peek_beyond_buffer) {
+    char filename[sizeof(TEMPLATE)];
+    char value;
+    avs_stream_t *stream;
+    AVS_UNIT_ASSERT_SUCCESS(make_temporary(filename));
+    AVS_UNIT_ASSERT_NOT_NULL((stream = avs_stream_file_create_fd(
+                                      filename, AVS_STREAM_FILE_WRITE, NULL)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "0123456789", 10));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+
+    AVS_UNIT_ASSERT_NOT_NULL((stream = avs_stream_file_create_fd(
+                                      filename, AVS_STREAM_FILE_READ,
+                                      &(const avs_stream_file_fd_config_t) {
+                                          .buffer_size = 4
+                                      })));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek(stream, 3, &value));
+    AVS_UNIT_ASSERT_EQUAL(value, '3');
+    AVS_UNIT_ASSERT_FAILED(avs_stream_peek(stream, 4, &value));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_seek(stream, 8));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek(stream, 1, &value));
+    AVS_UNIT_ASSERT_EQUAL(value, '9');
+    AVS_UNIT_ASSERT_TRUE(avs_is_eof(avs_stream_peek(stream, 2, &value)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+    unlink(filename);
+}
+
+AVS_UNIT_TEST(stream_file, fd_copy) {
+    const size_t size = 100000;
+    char *data = (char *) avs_malloc(size);
+    char *copied = (char *) avs_malloc(size);
+    AVS_UNIT_ASSERT_NOT_NULL(data);
+    AVS_UNIT_ASSERT_NOT_NULL(copied);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = (char) (i % 251);
+    }
+
+    char input_filename[sizeof(TEMPLATE)];
+    char output_filename[sizeof(TEMPLATE)];
+    avs_stream_t *input;
+    avs_stream_t *output;
+    AVS_UNIT_ASSERT_SUCCESS(make_temporary(input_filename));
+    AVS_UNIT_ASSERT_SUCCESS(make_temporary(output_filename));
+    AVS_UNIT_ASSERT_NOT_NULL((output = avs_stream_file_create_fd(
+                                      input_filename, AVS_STREAM_FILE_WRITE,
+                                      NULL)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(output, data, size));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&output));
+
+    // data already buffered in both streams must be taken into account
+    size_t bytes_read;
+    bool end_of_msg;
+    AVS_UNIT_ASSERT_NOT_NULL((input = avs_stream_file_create_fd(
+                                      input_filename, AVS_STREAM_FILE_READ,
+                                      NULL)));
+    AVS_UNIT_ASSERT_NOT_NULL((output = avs_stream_file_create_fd(
+                                      output_filename, AVS_STREAM_FILE_WRITE,
+                                      NULL)));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_read(input, &bytes_read, &end_of_msg, copied, 10));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 10);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(output, copied, 10));
+
+    size_t bytes_copied;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_copy_buffer(output, input, NULL, 4096, &bytes_copied));
+    AVS_UNIT_ASSERT_EQUAL(bytes_copied, size - 10);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(output, "END", 3));
+    avs_off_t length;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_length(output, &length));
+    AVS_UNIT_ASSERT_EQUAL(length, size + 3);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&output));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&input));
+
+    AVS_UNIT_ASSERT_NOT_NULL((input = avs_stream_file_create_fd(
+                                      output_filename, AVS_STREAM_FILE_READ,
+                                      NULL)));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_read(input, &bytes_read, &end_of_msg, copied, size));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, size);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(copied, data, size);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(input, &bytes_read, &end_of_msg,
+                                            copied, size));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 3);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(copied, "END", 3);
+    AVS_UNIT_ASSERT_TRUE(end_of_msg);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&input));
+
+    unlink(input_filename);
+    unlink(output_filename);
+    avs_free(data);
+    avs_free(copied);
+}
+#endif // AVS_COMMONS_STREAM_WITH_FILE_FD
@@ -22,7 +22,9 @@
 #include <avsystem/commons/avs_stream_buffered.h>
 #include <avsystem/commons/avs_stream_file.h>
 #include <avsystem/commons/avs_stream_membuf.h>
+#include <avsystem/commons/avs_stream_outbuf.h>
 #include <avsystem/commons/avs_stream_simple_io.h>
+#include <avsystem/commons/avs_stream_v_table.h>
 
 #include "test_stream_common.h"
 
@@ -200,6 +202,20 @@ AVS_UNIT_TEST(stream_generic, write) {
     test_output_streams(write_test);
 }
 
+static void writev_test(avs_stream_t *stream) {
+    const avs_stream_const_iovec_t iov[] = {
+        { TEST_DATA, 10 },
+        { NULL, 0 },
+        { TEST_DATA + 10, STREAM_SIZE - 10 }
+    };
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_writev(stream, iov, AVS_ARRAY_SIZE(iov)));
+}
+
+AVS_UNIT_TEST(stream_generic, writev) {
+    test_output_streams(writev_test);
+}
+
 /**
  * Tests two consecutive formatted writes
  * As we cannot reach the data when we dont know
@@ -374,6 +390,57 @@ AVS_UNIT_TEST(stream_generic, read_some_greater_than_memory_size) {
     test_input_streams(read_some_greater_than_memory_size);
 }
 
+static void read_slice_test(avs_stream_t *stream) {
+    avs_refbuf_slice_t first;
+    avs_refbuf_slice_t second;
+    bool message_finished = true;
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_read_slice(stream, &first, &message_finished, 29));
+    AVS_UNIT_ASSERT_EQUAL(first.size, 29);
+    AVS_UNIT_ASSERT_EQUAL(message_finished, false);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read_slice(
+            stream, &second, &message_finished, STREAM_SIZE));
+    AVS_UNIT_ASSERT_EQUAL(second.size, STREAM_SIZE - 29);
+    AVS_UNIT_ASSERT_EQUAL(message_finished, true);
+
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(first.data, TEST_DATA, 29);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(second.data, TEST_DATA + 29,
+                                      STREAM_SIZE - 29);
+    avs_refbuf_slice_release(&first);
+    avs_refbuf_slice_release(&second);
+}
+
+AVS_UNIT_TEST(stream_generic, read_slice) {
+    test_input_streams(read_slice_test);
+}
+
+static void readv_test(avs_stream_t *stream) {
+    char buffer[STREAM_SIZE + 30];
+    size_t total_read = 0;
+    bool message_finished = false;
+    while (!message_finished) {
+        AVS_UNIT_ASSERT_TRUE(total_read <= STREAM_SIZE);
+        const avs_stream_iovec_t iov[] = {
+            { buffer + total_read, 10 },
+            { NULL, 0 },
+            { buffer + total_read + 10, 20 }
+        };
+        size_t bytes_read;
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_readv(stream, &bytes_read,
+                                                 &message_finished, iov,
+                                                 AVS_ARRAY_SIZE(iov)));
+        total_read += bytes_read;
+    }
+    AVS_UNIT_ASSERT_EQUAL(total_read, STREAM_SIZE);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer, TEST_DATA, STREAM_SIZE);
+}
+
+AVS_UNIT_TEST(stream_generic, readv) {
+    test_input_streams(readv_test);
+}
+
 static void multiple_reads_test(avs_stream_t *stream) {
     char buffer[STREAM_SIZE + 1];
     bool message_finished = false;
@@ -618,3 +685,163 @@ AVS_UNIT_TEST(stream_generic, copy_stream) {
     cleanup_output_streams(istreams, ictx, istream_num);
     cleanup_output_streams(ostreams, octx, ostream_num);
 }
+
+static void copy_buffer_test(void *buffer, size_t buffer_size) {
+    stream_ctx_t ictx = {
+        .data = (char *) (intptr_t) TEST_DATA
+    };
+    char output[STREAM_SIZE];
+    stream_ctx_t octx = {
+        .data = output
+    };
+    avs_stream_t *istream = avs_stream_simple_input_create(reader, &ictx);
+    avs_stream_t *ostream = avs_stream_simple_output_create(writer, &octx);
+    AVS_UNIT_ASSERT_NOT_NULL(istream);
+    AVS_UNIT_ASSERT_NOT_NULL(ostream);
+
+    size_t bytes_copied;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_copy_buffer(
+            ostream, istream, buffer, buffer_size, &bytes_copied));
+    AVS_UNIT_ASSERT_EQUAL(bytes_copied, STREAM_SIZE);
+    AVS_UNIT_ASSERT_EQUAL(octx.curr_offset, STREAM_SIZE);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(output, TEST_DATA, STREAM_SIZE);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&istream));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&ostream));
+}
+
+AVS_UNIT_TEST(stream_generic, copy_buffer) {
+    char buffer[7];
+    copy_buffer_test(buffer, sizeof(buffer));
+    // heap buffer, grown while the reads fill it completely
+    copy_buffer_test(NULL, 3);
+    copy_buffer_test(NULL, 64 * 1024);
+
+    avs_stream_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_FAILED(
+            avs_stream_copy_buffer(stream, stream, buffer, 0, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+/**
+ * Input stream that never has any data, but never finishes the message
+ * either, like a non-blocking stream with nothing queued.
+ */
+typedef struct {
+    const avs_stream_v_table_t *const vtable;
+} stalled_stream_t;
+
+static avs_error_t stalled_read(avs_stream_t *stream,
+                                size_t *out_bytes_read,
+                                bool *out_message_finished,
+                                void *buffer,
+                                size_t buffer_length) {
+    (void) stream;
+    (void) buffer;
+    (void) buffer_length;
+    *out_bytes_read = 0;
+    *out_message_finished = false;
+    return AVS_OK;
+}
+
+static avs_error_t stalled_peek_contiguous(avs_stream_t *stream,
+                                           const void **out_data,
+                                           size_t *out_size,
+                                           bool *out_message_finished) {
+    (void) stream;
+    *out_data = NULL;
+    *out_size = 0;
+    *out_message_finished = false;
+    return AVS_OK;
+}
+
+static avs_error_t stalled_consume(avs_stream_t *stream, size_t size) {
+    (void) stream;
+    return size ? avs_errno(AVS_EINVAL) : AVS_OK;
+}
+
+static const avs_stream_v_table_t STALLED_VTABLE = {
+    .read = stalled_read
+};
+
+static const avs_stream_v_table_t STALLED_ZEROCOPY_VTABLE = {
+    .read = stalled_read,
+    .extension_list =
+            (const avs_stream_v_table_extension_t[]) {
+                    { AVS_STREAM_V_TABLE_EXTENSION_ZEROCOPY,
+                      &(const avs_stream_v_table_extension_zerocopy_t) {
+                              stalled_peek_contiguous, stalled_consume, NULL,
+                              NULL } },
+                    AVS_STREAM_V_TABLE_EXTENSION_NULL }
+};
+
+static void assert_copy_einval(avs_stream_t *output_stream,
+                               avs_stream_t *input_stream) {
+    size_t bytes_copied;
+    avs_error_t err = avs_stream_copy_buffer(output_stream, input_stream,
+                                             NULL, 64, &bytes_copied);
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_EINVAL);
+    AVS_UNIT_ASSERT_EQUAL(bytes_copied, 0);
+}
+
+AVS_UNIT_TEST(stream_generic, copy_without_progress) {
+    stalled_stream_t stalled = { &STALLED_VTABLE };
+    stalled_stream_t stalled_zerocopy = { &STALLED_ZEROCOPY_VTABLE };
+    avs_stream_t *membuf = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(membuf);
+
+    // peeking straight from the input's buffer
+    assert_copy_einval(membuf, (avs_stream_t *) &stalled_zerocopy);
+    // reading into space reserved in the output's buffer
+    assert_copy_einval(membuf, (avs_stream_t *) &stalled);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&membuf));
+
+    // copying through an intermediate buffer
+    char output[STREAM_SIZE];
+    stream_ctx_t octx = {
+        .data = output
+    };
+    avs_stream_t *ostream = avs_stream_simple_output_create(writer, &octx);
+    AVS_UNIT_ASSERT_NOT_NULL(ostream);
+    assert_copy_einval(ostream, (avs_stream_t *) &stalled);
+    AVS_UNIT_ASSERT_FAILED(
+            avs_stream_copy(ostream, (avs_stream_t *) &stalled));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&ostream));
+}
+
+AVS_UNIT_TEST(stream_generic, write_f_reserved) {
+    // the formatted string is much longer than the format, so the space in
+    // the stream needs to be reserved again with the right size
+    char long_string[2000];
+    memset(long_string, 'x', sizeof(long_string) - 1);
+    long_string[sizeof(long_string) - 1] = '\0';
+
+    avs_stream_t *membuf = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(membuf);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write_f(membuf, "<%s>", long_string));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write_f(membuf, "%d", 42));
+    char buffer[sizeof(long_string) + 4];
+    size_t bytes_read;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(membuf, &bytes_read,
+                                            &message_finished, buffer,
+                                            sizeof(buffer)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, sizeof(long_string) + 3);
+    AVS_UNIT_ASSERT_EQUAL(buffer[0], '<');
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer + 1, long_string,
+                                      sizeof(long_string) - 1);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer + sizeof(long_string), ">42", 3);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&membuf));
+
+    // fixed buffer that is too small for the second write
+    char out[16];
+    avs_stream_outbuf_t outbuf = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+    avs_stream_outbuf_set_buffer(&outbuf, out, sizeof(out));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_write_f((avs_stream_t *) &outbuf, "%s", "0123456789"));
+    AVS_UNIT_ASSERT_FAILED(
+            avs_stream_write_f((avs_stream_t *) &outbuf, "%s", "0123456789"));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(out, "0123456789", 10);
+}
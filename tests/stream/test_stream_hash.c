@@ -0,0 +1,127 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+typedef enum { HASH_CRC32, HASH_SHA1, HASH_SHA256, HASH_COUNT } hash_t;
+
+static avs_stream_t *(*const HASH_CREATE[HASH_COUNT])(void) = {
+    [HASH_CRC32] = avs_stream_crc32_create,
+    [HASH_SHA1] = avs_stream_sha1_create,
+    [HASH_SHA256] = avs_stream_sha256_create
+};
+
+static const struct {
+    const char *input;
+    const char *digests[HASH_COUNT];
+} HASH_VECTORS[] = {
+    { "",
+      { "00000000", "da39a3ee5e6b4b0d3255bfef95601890afd80709",
+        "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" } },
+    { "abc",
+      { "352441c2", "a9993e364706816aba3e25717850c26c9cd0d89d",
+        "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" } },
+    { "123456789",
+      { "cbf43926", "f7c3bc1d808e04732adf679965ccc34ca7ae3441",
+        "15e2b0d3c33891ebb0f1ef609ec419420c20e320ce94c65fbc8c3312448eb225" } },
+    /* two blocks after padding */
+    { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+      { "171a3f5f", "84983e441c3bd26ebaae4aa1f95129e5e54670f1",
+        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" } }
+};
+
+static void assert_digest(avs_stream_t *stream, const char *expected_hex) {
+    unsigned char digest[AVS_HASH_MAX_DIGEST_LENGTH];
+    size_t digest_size = strlen(expected_hex) / 2;
+    size_t bytes_read;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(stream));
+    /* writing after finishing the message is not allowed */
+    AVS_UNIT_ASSERT_FAILED(avs_stream_write(stream, "x", 1));
+    /* read in two parts to check that the position is tracked */
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read,
+                                            &message_finished, digest, 3));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 3);
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read,
+                                            &message_finished, digest + 3,
+                                            sizeof(digest) - 3));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, digest_size - 3);
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+
+    char hex[2 * AVS_HASH_MAX_DIGEST_LENGTH + 1];
+    for (size_t i = 0; i < digest_size; ++i) {
+        snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+    }
+    AVS_UNIT_ASSERT_EQUAL_STRING(hex, expected_hex);
+}
+
+static void test_vectors(hash_t hash) {
+    avs_stream_t *stream = HASH_CREATE[hash]();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(HASH_VECTORS); ++i) {
+        /* the stream is reset after reading the digest */
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(
+                stream, HASH_VECTORS[i].input, strlen(HASH_VECTORS[i].input)));
+        assert_digest(stream, HASH_VECTORS[i].digests[hash]);
+    }
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(stream_hash, crc32) {
+    test_vectors(HASH_CRC32);
+}
+
+AVS_UNIT_TEST(stream_hash, sha1) {
+    test_vectors(HASH_SHA1);
+}
+
+AVS_UNIT_TEST(stream_hash, sha256) {
+    test_vectors(HASH_SHA256);
+}
+
+AVS_UNIT_TEST(stream_hash, unaligned_writes_and_reset) {
+    /* 1000 bytes written in pieces of various sizes, at odd offsets */
+    char data[1001];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = (char) ('a' + i % 26);
+    }
+    static const char *const EXPECTED[HASH_COUNT] = {
+        "42fbc861", "af07aabc310dd1a904b0ce47315e8e9e2b6edfa4",
+        "57c7e94fa54c28c8959de103926fdfcbc6c6b8ee385cef2a1293b8569714e863"
+    };
+    for (size_t hash = 0; hash < HASH_COUNT; ++hash) {
+        avs_stream_t *stream = HASH_CREATE[hash]();
+        AVS_UNIT_ASSERT_NOT_NULL(stream);
+        /* data written before reset is discarded */
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "garbage", 7));
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_reset(stream));
+
+        size_t offset = 1;
+        for (size_t size = 1; offset < sizeof(data);
+             size = size * 3 % 200 + 1) {
+            size = AVS_MIN(size, sizeof(data) - offset);
+            AVS_UNIT_ASSERT_SUCCESS(
+                    avs_stream_write(stream, data + offset, size));
+            offset += size;
+        }
+        assert_digest(stream, EXPECTED[hash]);
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+    }
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include <avsystem/commons/avs_stream_md5.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+static void assert_md5(avs_stream_t *stream, const char *expected_hex) {
+    unsigned char digest[MD5_LENGTH];
+    size_t bytes_read;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(stream));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read,
+                                            &message_finished, digest,
+                                            sizeof(digest)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, MD5_LENGTH);
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+
+    char hex[2 * MD5_LENGTH + 1];
+    for (size_t i = 0; i < MD5_LENGTH; ++i) {
+        snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+    }
+    AVS_UNIT_ASSERT_EQUAL_STRING(hex, expected_hex);
+}
+
+/* test suite from RFC 1321 */
+static const struct {
+    const char *input;
+    const char *md5;
+} MD5_VECTORS[] = {
+    { "", "d41d8cd98f00b204e9800998ecf8427e" },
+    { "a", "0cc175b9c0f1b6a831c399e269772661" },
+    { "abc", "900150983cd24fb0d6963f7d28e17f72" },
+    { "message digest", "f96b697d7cb7938d525a2f31aaf161d0" },
+    { "abcdefghijklmnopqrstuvwxyz", "c3fcd3d76192e4007dfb496cca67e13b" },
+    { "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+      "d174ab98d277d9f5a5611c2c9f419d9f" },
+    { "1234567890123456789012345678901234567890123456789012345678901234567890"
+      "1234567890",
+      "57edf4a22be3c955ac49da2e2107b67a" }
+};
+
+AVS_UNIT_TEST(stream_md5, rfc1321) {
+    avs_stream_t *stream = avs_stream_md5_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(MD5_VECTORS); ++i) {
+        /* the stream is reset after reading the digest */
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, MD5_VECTORS[i].input,
+                                                 strlen(MD5_VECTORS[i].input)));
+        assert_md5(stream, MD5_VECTORS[i].md5);
+    }
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(stream_md5, unaligned_writes) {
+    /* 1000 bytes written in pieces of various sizes, at odd offsets */
+    char data[1001];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = (char) ('a' + i % 26);
+    }
+    avs_stream_t *stream = avs_stream_md5_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    size_t offset = 1;
+    for (size_t size = 1; offset < sizeof(data); size = size * 3 % 200 + 1) {
+        size = AVS_MIN(size, sizeof(data) - offset);
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, data + offset, size));
+        offset += size;
+    }
+    assert_md5(stream, "cb6fc4cf328edb0541f313982a01e994");
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
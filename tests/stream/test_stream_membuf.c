@@ -136,6 +136,135 @@ AVS_UNIT_TEST(stream_membuf, defragment_partial) {
     AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
 }
 
+AVS_UNIT_TEST(stream_membuf, read_slice) {
+    avs_stream_t *stream = avs_stream_membuf_create();
+    avs_stream_membuf_t *internal = (avs_stream_membuf_t *) stream;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_membuf_ensure_free_bytes(stream, 32));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "very stream", 11));
+
+    avs_refbuf_slice_t first;
+    avs_refbuf_slice_t second;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_read_slice(stream, &first, &message_finished, 4));
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(first.data, "very", 4);
+    /* the slice points directly into the stream's storage */
+    AVS_UNIT_ASSERT_TRUE(first.data == internal->buffer);
+
+    /* appending and reading more does not disturb the slice */
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, " data", 5));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_read_slice(stream, &second, &message_finished, 100));
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(second.data, " stream data", 12);
+    AVS_UNIT_ASSERT_TRUE(first.buffer == second.buffer);
+
+    /* all data has been read, so the buffer is left to the slices */
+    AVS_UNIT_ASSERT_NULL(internal->lent);
+    AVS_UNIT_ASSERT_NULL(internal->buffer);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "more", 4));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(first.data, "very", 4);
+    avs_refbuf_slice_release(&first);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(second.data, " stream data", 12);
+    avs_refbuf_slice_release(&second);
+}
+
+AVS_UNIT_TEST(stream_membuf, read_slice_reclaim) {
+    avs_stream_t *stream = avs_stream_membuf_create();
+    avs_stream_membuf_t *internal = (avs_stream_membuf_t *) stream;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "very stream", 11));
+    char *original_buffer = internal->buffer;
+
+    avs_refbuf_slice_t slice;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read_slice(stream, &slice, NULL, 5));
+    AVS_UNIT_ASSERT_NOT_NULL(internal->lent);
+
+    /* once the slice is released, the buffer is taken back without copying */
+    avs_refbuf_slice_release(&slice);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_membuf_fit(stream));
+    AVS_UNIT_ASSERT_NULL(internal->lent);
+    AVS_UNIT_ASSERT_EQUAL(internal->index_read, 0);
+    AVS_UNIT_ASSERT_EQUAL(internal->index_write, 6);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(internal->buffer, "stream", 6);
+
+    /* with a live slice, unread data is moved to a new buffer */
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read_slice(stream, &slice, NULL, 3));
+    original_buffer = internal->buffer;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_reset(stream));
+    AVS_UNIT_ASSERT_NULL(internal->lent);
+    AVS_UNIT_ASSERT_TRUE(internal->buffer != original_buffer);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "xyz", 3));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(slice.data, "str", 3);
+    avs_refbuf_slice_release(&slice);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(stream_membuf, zerocopy) {
+    avs_stream_t *stream = avs_stream_membuf_create();
+    avs_stream_membuf_t *internal = (avs_stream_membuf_t *) stream;
+
+    void *space;
+    size_t space_size;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_reserve(stream, 16, &space, &space_size));
+    AVS_UNIT_ASSERT_TRUE(space_size >= 16);
+    memcpy(space, "very stream", 11);
+    AVS_UNIT_ASSERT_FAILED(avs_stream_commit(stream, space_size + 1));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_commit(stream, 11));
+
+    const void *data;
+    size_t data_size;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek_contiguous(
+            stream, &data, &data_size, &message_finished));
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, "very stream", data_size);
+    AVS_UNIT_ASSERT_TRUE(data == internal->buffer);
+    AVS_UNIT_ASSERT_FAILED(avs_stream_consume(stream, 12));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_consume(stream, 5));
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_peek_contiguous(stream, &data, &data_size, NULL));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, "stream", data_size);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_consume(stream, data_size));
+    AVS_UNIT_ASSERT_EQUAL(internal->index_read, 0);
+    AVS_UNIT_ASSERT_EQUAL(internal->index_write, 0);
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_peek_contiguous(stream, &data, &data_size, NULL));
+    AVS_UNIT_ASSERT_EQUAL(data_size, 0);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(stream_membuf, zerocopy_copy) {
+    avs_stream_t *input = avs_stream_membuf_create();
+    avs_stream_t *output = avs_stream_membuf_create();
+    char data[3000];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = (char) i;
+    }
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(input, data, sizeof(data)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_copy(output, input));
+
+    char result[sizeof(data) + 1];
+    size_t bytes_read;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(
+            output, &bytes_read, &message_finished, result, sizeof(result)));
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(result, data, sizeof(data));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, sizeof(data));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(
+            input, &bytes_read, &message_finished, result, sizeof(result)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 0);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&input));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&output));
+}
+
 AVS_UNIT_TEST(stream_getline, simple) {
     avs_stream_t *stream = avs_stream_membuf_create();
     AVS_UNIT_ASSERT_SUCCESS(
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+static size_t count_chunks(avs_stream_t *stream) {
+    size_t result = 0;
+    for (const membuf_chunk_t *chunk = ((membuf_chunked_t *) stream)->head;
+         chunk;
+         chunk = chunk->next) {
+        ++result;
+    }
+    return result;
+}
+
+static const char CHUNKED_DATA[] =
+        "The quick brown fox jumps over the lazy dog";
+
+AVS_UNIT_TEST(stream_membuf_chunked, write_read) {
+    AVS_UNIT_ASSERT_NULL(avs_stream_membuf_create_chunked(0));
+    avs_stream_t *stream = avs_stream_membuf_create_chunked(8);
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_write(stream, CHUNKED_DATA, sizeof(CHUNKED_DATA)));
+    AVS_UNIT_ASSERT_EQUAL(count_chunks(stream), 6);
+
+    char value;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek(stream, 16, &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 'f');
+    AVS_UNIT_ASSERT_TRUE(avs_is_eof(
+            avs_stream_peek(stream, sizeof(CHUNKED_DATA), &value)));
+
+    /* chunks are released as soon as they are read */
+    char buf[64];
+    size_t bytes_read;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_read(stream, &bytes_read, &message_finished, buf, 19));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 19);
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL(count_chunks(stream), 4);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek(stream, 1, &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 'j');
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read,
+                                            &message_finished, buf + 19,
+                                            sizeof(buf) - 19));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, sizeof(CHUNKED_DATA) - 19);
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, CHUNKED_DATA);
+    /* the last chunk is kept for reuse */
+    AVS_UNIT_ASSERT_EQUAL(count_chunks(stream), 1);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(stream_membuf_chunked, zerocopy) {
+    avs_stream_t *stream = avs_stream_membuf_create_chunked(8);
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+
+    void *space;
+    size_t space_size;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_reserve(stream, 100, &space, &space_size));
+    AVS_UNIT_ASSERT_EQUAL(space_size, 8);
+    memcpy(space, "abcdef", 6);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_commit(stream, 6));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "ghijkl", 6));
+
+    const void *data;
+    size_t data_size;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek_contiguous(stream, &data,
+                                                       &data_size,
+                                                       &message_finished));
+    AVS_UNIT_ASSERT_EQUAL(data_size, 8);
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, "abcdefgh", 8);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_consume(stream, 8));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek_contiguous(stream, &data,
+                                                       &data_size,
+                                                       &message_finished));
+    AVS_UNIT_ASSERT_EQUAL(data_size, 4);
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, "ijkl", 4);
+    AVS_UNIT_ASSERT_FAILED(avs_stream_consume(stream, 5));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_consume(stream, 4));
+    AVS_UNIT_ASSERT_EQUAL(count_chunks(stream), 1);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek_contiguous(stream, &data,
+                                                       &data_size,
+                                                       &message_finished));
+    AVS_UNIT_ASSERT_EQUAL(data_size, 0);
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(stream_membuf_chunked, ensure_free_bytes_fit) {
+    avs_stream_t *stream = avs_stream_membuf_create_chunked(8);
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_membuf_ensure_free_bytes(stream, 20));
+    AVS_UNIT_ASSERT_EQUAL(count_chunks(stream), 3);
+
+    /* preallocated chunks are used for writing */
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, CHUNKED_DATA, 10));
+    AVS_UNIT_ASSERT_EQUAL(count_chunks(stream), 3);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_membuf_fit(stream));
+    AVS_UNIT_ASSERT_EQUAL(count_chunks(stream), 2);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_reset(stream));
+    AVS_UNIT_ASSERT_EQUAL(count_chunks(stream), 1);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_membuf_fit(stream));
+    AVS_UNIT_ASSERT_EQUAL(count_chunks(stream), 0);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(stream_membuf_chunked, take_ownership) {
+    avs_stream_t *stream = avs_stream_membuf_create_chunked(8);
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_write(stream, CHUNKED_DATA, strlen(CHUNKED_DATA)));
+    char buf[4];
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_read(stream, NULL, NULL, buf, sizeof(buf)));
+
+    void *ptr;
+    size_t size;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_membuf_take_ownership(stream, &ptr, &size));
+    AVS_UNIT_ASSERT_EQUAL(size, strlen(CHUNKED_DATA) - 4);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(ptr, CHUNKED_DATA + 4, size);
+    avs_free(ptr);
+    AVS_UNIT_ASSERT_EQUAL(count_chunks(stream), 0);
+
+    /* the stream is still usable afterwards */
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "x", 1));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_membuf_take_ownership(stream, &ptr, &size));
+    AVS_UNIT_ASSERT_EQUAL(size, 1);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(ptr, "x", 1);
+    avs_free(ptr);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
@@ -0,0 +1,300 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <avsystem/commons/avs_stream_file.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#define TEST_ADDRESS "127.0.0.1"
+
+#define NETBUF_BUFFER_SIZE 16
+
+typedef struct {
+    avs_stream_t *stream;
+    avs_net_socket_t *peer;
+} netbuf_env_t;
+
+static netbuf_env_t netbuf_env_create(void) {
+    avs_net_socket_t *listener = NULL;
+    avs_net_socket_t *client = NULL;
+    char port[sizeof("65535")];
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_tcp_socket_create(&listener, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_bind(listener, TEST_ADDRESS, "0"));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_get_local_port(listener, port, sizeof(port)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_tcp_socket_create(&client, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_connect(client, TEST_ADDRESS, port));
+
+    netbuf_env_t env = {
+        .stream = NULL,
+        .peer = NULL
+    };
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_tcp_socket_create(&env.peer, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_accept(listener, env.peer));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&listener));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_netbuf_create(
+            &env.stream, client, NETBUF_BUFFER_SIZE, NETBUF_BUFFER_SIZE));
+    return env;
+}
+
+static void netbuf_env_cleanup(netbuf_env_t *env) {
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&env->stream));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&env->peer));
+}
+
+static uint64_t netbuf_syscall_count(netbuf_env_t *env) {
+    avs_net_socket_opt_value_t opt;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_opt(
+            avs_stream_net_getsock(env->stream),
+            AVS_NET_SOCKET_OPT_SYSCALL_COUNT, &opt));
+    return opt.syscall_count;
+}
+
+static void assert_peer_receives(netbuf_env_t *env,
+                                 const char *expected,
+                                 size_t expected_size) {
+    char buffer[256];
+    while (expected_size) {
+        size_t received;
+        AVS_UNIT_ASSERT_SUCCESS(
+                avs_net_socket_receive(env->peer, &received, buffer,
+                                       AVS_MIN(expected_size, sizeof(buffer))));
+        AVS_UNIT_ASSERT_TRUE(received > 0);
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer, expected, received);
+        expected += received;
+        expected_size -= received;
+    }
+}
+
+#ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+AVS_UNIT_TEST(netbuf, writev_sends_buffered_data_in_one_call) {
+    netbuf_env_t env = netbuf_env_create();
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(env.stream, "head:", 5));
+
+    const avs_stream_const_iovec_t iov[] = {
+        { "larger than ", 12 }, { "", 0 }, { "the output buffer", 17 }
+    };
+    uint64_t syscalls_before = netbuf_syscall_count(&env);
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_writev(env.stream, iov, AVS_ARRAY_SIZE(iov)));
+    AVS_UNIT_ASSERT_EQUAL(netbuf_syscall_count(&env) - syscalls_before, 1);
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_size(
+                                  ((buffered_netstream_t *) env.stream)
+                                          ->out_buffer),
+                          0);
+
+    static const char EXPECTED[] = "head:larger than the output buffer";
+    assert_peer_receives(&env, EXPECTED, sizeof(EXPECTED) - 1);
+
+    netbuf_env_cleanup(&env);
+}
+#endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+
+AVS_UNIT_TEST(netbuf, writev_small_data_is_buffered) {
+    netbuf_env_t env = netbuf_env_create();
+
+    const avs_stream_const_iovec_t iov[] = { { "ab", 2 }, { "cd", 2 } };
+    uint64_t syscalls_before = netbuf_syscall_count(&env);
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_writev(env.stream, iov, AVS_ARRAY_SIZE(iov)));
+    AVS_UNIT_ASSERT_EQUAL(netbuf_syscall_count(&env), syscalls_before);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(env.stream));
+    assert_peer_receives(&env, "abcd", 4);
+
+    netbuf_env_cleanup(&env);
+}
+
+AVS_UNIT_TEST(netbuf, read_nonblock) {
+    netbuf_env_t env = netbuf_env_create();
+
+    char buffer[NETBUF_BUFFER_SIZE];
+    size_t bytes_read = 0;
+    bool message_finished = false;
+    avs_error_t err =
+            avs_stream_read_nonblock(env.stream, &bytes_read, &message_finished,
+                                     buffer, sizeof(buffer));
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_EAGAIN);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_send(env.peer, "hello", 5));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read_nonblock(env.stream, &bytes_read,
+                                                     &message_finished, buffer,
+                                                     sizeof(buffer)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 5);
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer, "hello", 5);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_shutdown(env.peer));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read_nonblock(env.stream, &bytes_read,
+                                                     &message_finished, buffer,
+                                                     sizeof(buffer)));
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+
+    netbuf_env_cleanup(&env);
+}
+
+AVS_UNIT_TEST(netbuf, write_some_nonblock) {
+    netbuf_env_t env = netbuf_env_create();
+
+    char data[NETBUF_BUFFER_SIZE + 4];
+    memset(data, 'x', sizeof(data));
+    size_t data_length = sizeof(data);
+    uint64_t syscalls_before = netbuf_syscall_count(&env);
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_write_some_nonblock(env.stream, data, &data_length));
+    AVS_UNIT_ASSERT_EQUAL(data_length, NETBUF_BUFFER_SIZE);
+
+    data_length = sizeof(data);
+    avs_error_t err =
+            avs_stream_write_some_nonblock(env.stream, data, &data_length);
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_EAGAIN);
+    AVS_UNIT_ASSERT_EQUAL(netbuf_syscall_count(&env), syscalls_before);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_flush(env.stream));
+    assert_peer_receives(&env, data, NETBUF_BUFFER_SIZE);
+
+    netbuf_env_cleanup(&env);
+}
+
+static size_t fill_send_buffer(avs_net_socket_t *socket) {
+    static const char CHUNK[4096] = { 0 };
+    size_t total_sent = 0;
+    size_t sent;
+    avs_error_t err;
+    while (avs_is_ok((err = avs_net_socket_send_nonblock(
+                              socket, CHUNK, sizeof(CHUNK), &sent)))) {
+        total_sent += sent;
+    }
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_EAGAIN);
+    AVS_UNIT_ASSERT_EQUAL(sent, 0);
+    return total_sent;
+}
+
+static void drain_peer(netbuf_env_t *env, size_t size) {
+    static char buffer[65536];
+    while (size) {
+        size_t received;
+        AVS_UNIT_ASSERT_SUCCESS(
+                avs_net_socket_receive(env->peer, &received, buffer,
+                                       AVS_MIN(size, sizeof(buffer))));
+        AVS_UNIT_ASSERT_TRUE(received > 0);
+        size -= received;
+    }
+}
+
+AVS_UNIT_TEST(netbuf, flush_does_not_block) {
+    netbuf_env_t env = netbuf_env_create();
+    buffered_netstream_t *stream = (buffered_netstream_t *) env.stream;
+
+    size_t data_length = 4;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_write_some_nonblock(env.stream, "data", &data_length));
+    size_t filled = fill_send_buffer(avs_stream_net_getsock(env.stream));
+
+    // the transport does not accept anything: data stays buffered
+    uint64_t syscalls_before = netbuf_syscall_count(&env);
+    avs_error_t err = avs_stream_flush(env.stream);
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_EAGAIN);
+    AVS_UNIT_ASSERT_EQUAL(netbuf_syscall_count(&env) - syscalls_before, 1);
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_size(stream->out_buffer), 4);
+
+    drain_peer(&env, filled);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_flush(env.stream));
+    AVS_UNIT_ASSERT_EQUAL(avs_buffer_data_size(stream->out_buffer), 0);
+    assert_peer_receives(&env, "data", 4);
+
+    netbuf_env_cleanup(&env);
+}
+
+#if defined(AVS_COMMONS_STREAM_WITH_SENDFILE) \
+        && defined(AVS_COMMONS_STREAM_WITH_FILE_FD)
+int mkstemp(char *filename_template);
+
+AVS_UNIT_TEST(netbuf, copy_from_file_uses_sendfile) {
+    netbuf_env_t env = netbuf_env_create();
+
+    static char data[32 * 1024];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = (char) ('a' + i % 26);
+    }
+    char filename[] = "/tmp/test_stream_netbuf-XXXXXX";
+    int fd = mkstemp(filename);
+    AVS_UNIT_ASSERT_TRUE(fd >= 0);
+    AVS_UNIT_ASSERT_EQUAL(write(fd, data, sizeof(data)), sizeof(data));
+    close(fd);
+    avs_stream_t *input =
+            avs_stream_file_create_fd(filename, AVS_STREAM_FILE_READ, NULL);
+    AVS_UNIT_ASSERT_NOT_NULL(input);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(env.stream, "head:", 5));
+    uint64_t syscalls_before = netbuf_syscall_count(&env);
+    size_t copied;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_copy_buffer(env.stream, input, NULL, 1024, &copied));
+    AVS_UNIT_ASSERT_EQUAL(copied, sizeof(data));
+    // the only send() flushed the buffered data; the file contents were
+    // transferred with sendfile(), bypassing the socket layer
+    AVS_UNIT_ASSERT_EQUAL(netbuf_syscall_count(&env) - syscalls_before, 1);
+
+    assert_peer_receives(&env, "head:", 5);
+    assert_peer_receives(&env, data, sizeof(data));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&input));
+    unlink(filename);
+    netbuf_env_cleanup(&env);
+}
+
+AVS_UNIT_TEST(netbuf, copy_to_file_with_buffered_input) {
+    netbuf_env_t env = netbuf_env_create();
+
+    char filename[] = "/tmp/test_stream_netbuf-XXXXXX";
+    int fd = mkstemp(filename);
+    AVS_UNIT_ASSERT_TRUE(fd >= 0);
+    close(fd);
+    avs_stream_t *output =
+            avs_stream_file_create_fd(filename, AVS_STREAM_FILE_WRITE, NULL);
+    AVS_UNIT_ASSERT_NOT_NULL(output);
+
+    // data buffered in the netbuf is not bypassed
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_send(env.peer, "hello", 5));
+    char peeked;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek(env.stream, 0, &peeked));
+    AVS_UNIT_ASSERT_EQUAL(peeked, 'h');
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_shutdown(env.peer));
+
+    size_t copied;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_copy_buffer(output, env.stream, NULL, 1024, &copied));
+    AVS_UNIT_ASSERT_EQUAL(copied, 5);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&output));
+
+    char buffer[16];
+    AVS_UNIT_ASSERT_TRUE((fd = open(filename, O_RDONLY)) >= 0);
+    AVS_UNIT_ASSERT_EQUAL(read(fd, buffer, sizeof(buffer)), 5);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer, "hello", 5);
+    close(fd);
+    unlink(filename);
+    netbuf_env_cleanup(&env);
+}
+#endif /* defined(AVS_COMMONS_STREAM_WITH_SENDFILE) &&
+          defined(AVS_COMMONS_STREAM_WITH_FILE_FD) */
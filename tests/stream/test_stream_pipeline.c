@@ -0,0 +1,268 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ctype.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_stream_inbuf.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+/* Filter that converts data to upper case, with a tiny internal buffer so that
+ * data needs to be passed through it in many small steps. */
+typedef struct {
+    const avs_stream_v_table_t *const vtable;
+    char data[8];
+    size_t begin;
+    size_t end;
+    bool finished;
+} upper_filter_t;
+
+static void upper_compact(upper_filter_t *filter) {
+    memmove(filter->data, filter->data + filter->begin,
+            filter->end - filter->begin);
+    filter->end -= filter->begin;
+    filter->begin = 0;
+}
+
+static void upper_convert(char *data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = (char) toupper((unsigned char) data[i]);
+    }
+}
+
+static avs_error_t upper_write_some(avs_stream_t *stream,
+                                    const void *buffer,
+                                    size_t *inout_data_length) {
+    upper_filter_t *filter = (upper_filter_t *) stream;
+    AVS_UNIT_ASSERT_FALSE(filter->finished);
+    upper_compact(filter);
+    *inout_data_length =
+            AVS_MIN(*inout_data_length, sizeof(filter->data) - filter->end);
+    memcpy(filter->data + filter->end, buffer, *inout_data_length);
+    upper_convert(filter->data + filter->end, *inout_data_length);
+    filter->end += *inout_data_length;
+    return AVS_OK;
+}
+
+static avs_error_t upper_finish_message(avs_stream_t *stream) {
+    ((upper_filter_t *) stream)->finished = true;
+    return AVS_OK;
+}
+
+static avs_error_t upper_read(avs_stream_t *stream,
+                              size_t *out_bytes_read,
+                              bool *out_message_finished,
+                              void *buffer,
+                              size_t buffer_length) {
+    upper_filter_t *filter = (upper_filter_t *) stream;
+    *out_bytes_read = AVS_MIN(buffer_length, filter->end - filter->begin);
+    memcpy(buffer, filter->data + filter->begin, *out_bytes_read);
+    filter->begin += *out_bytes_read;
+    *out_message_finished = filter->finished && filter->begin == filter->end;
+    return AVS_OK;
+}
+
+static avs_error_t
+upper_peek(avs_stream_t *stream, size_t offset, char *out_value) {
+    upper_filter_t *filter = (upper_filter_t *) stream;
+    if (offset >= filter->end - filter->begin) {
+        return AVS_EOF;
+    }
+    *out_value = filter->data[filter->begin + offset];
+    return AVS_OK;
+}
+
+static avs_error_t upper_reserve(avs_stream_t *stream,
+                                 size_t size_hint,
+                                 void **out_data,
+                                 size_t *out_size) {
+    (void) size_hint;
+    upper_filter_t *filter = (upper_filter_t *) stream;
+    AVS_UNIT_ASSERT_FALSE(filter->finished);
+    upper_compact(filter);
+    *out_data = filter->data + filter->end;
+    *out_size = sizeof(filter->data) - filter->end;
+    return AVS_OK;
+}
+
+static avs_error_t upper_commit(avs_stream_t *stream, size_t size) {
+    upper_filter_t *filter = (upper_filter_t *) stream;
+    AVS_UNIT_ASSERT_TRUE(size <= sizeof(filter->data) - filter->end);
+    upper_convert(filter->data + filter->end, size);
+    filter->end += size;
+    return AVS_OK;
+}
+
+static const avs_stream_v_table_t upper_filter_vtable = {
+    .write_some = upper_write_some,
+    .finish_message = upper_finish_message,
+    .read = upper_read,
+    .peek = upper_peek
+};
+
+static const avs_stream_v_table_t upper_filter_zerocopy_vtable = {
+    .write_some = upper_write_some,
+    .finish_message = upper_finish_message,
+    .read = upper_read,
+    .peek = upper_peek,
+    .extension_list =
+            (const avs_stream_v_table_extension_t[]) {
+                    { AVS_STREAM_V_TABLE_EXTENSION_ZEROCOPY,
+                      &(const avs_stream_v_table_extension_zerocopy_t) {
+                              .reserve = upper_reserve,
+                              .commit = upper_commit } },
+                    AVS_STREAM_V_TABLE_EXTENSION_NULL }
+};
+
+static avs_stream_t *upper_filter_create(bool zerocopy) {
+    upper_filter_t *filter =
+            (upper_filter_t *) avs_calloc(1, sizeof(upper_filter_t));
+    AVS_UNIT_ASSERT_NOT_NULL(filter);
+    *(const avs_stream_v_table_t **) (intptr_t) &filter->vtable =
+            zerocopy ? &upper_filter_zerocopy_vtable : &upper_filter_vtable;
+    return (avs_stream_t *) filter;
+}
+
+/* Source that returns at most 3 bytes at a time and has no extensions. */
+typedef struct {
+    const avs_stream_v_table_t *const vtable;
+    const char *data;
+} trickle_source_t;
+
+static avs_error_t trickle_read(avs_stream_t *stream,
+                                size_t *out_bytes_read,
+                                bool *out_message_finished,
+                                void *buffer,
+                                size_t buffer_length) {
+    trickle_source_t *source = (trickle_source_t *) stream;
+    *out_bytes_read = AVS_MIN(AVS_MIN(buffer_length, 3), strlen(source->data));
+    memcpy(buffer, source->data, *out_bytes_read);
+    source->data += *out_bytes_read;
+    *out_message_finished = !*source->data;
+    return AVS_OK;
+}
+
+static const avs_stream_v_table_t trickle_source_vtable = {
+    .read = trickle_read
+};
+
+static avs_stream_t *trickle_source_create(const char *data) {
+    trickle_source_t *source =
+            (trickle_source_t *) avs_calloc(1, sizeof(trickle_source_t));
+    AVS_UNIT_ASSERT_NOT_NULL(source);
+    *(const avs_stream_v_table_t **) (intptr_t) &source->vtable =
+            &trickle_source_vtable;
+    source->data = data;
+    return (avs_stream_t *) source;
+}
+
+static void read_all(avs_stream_t *stream, char *buffer, size_t buffer_size) {
+    size_t total = 0;
+    bool message_finished = false;
+    while (!message_finished) {
+        size_t bytes_read;
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(
+                stream, &bytes_read, &message_finished, buffer + total,
+                AVS_MIN(5, buffer_size - total)));
+        total += bytes_read;
+        AVS_UNIT_ASSERT_TRUE(total < buffer_size);
+    }
+    buffer[total] = '\0';
+}
+
+static const char PIPELINE_INPUT[] =
+        "The quick brown fox jumps over the lazy dog";
+static const char PIPELINE_OUTPUT[] =
+        "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG";
+
+AVS_UNIT_TEST(stream_pipeline, chain) {
+    avs_stream_t *filters[] = {
+        upper_filter_create(false),
+        upper_filter_create(true),
+        upper_filter_create(false)
+    };
+    avs_stream_t *pipeline = avs_stream_pipeline_create(
+            trickle_source_create(PIPELINE_INPUT), filters,
+            AVS_ARRAY_SIZE(filters), 4);
+    AVS_UNIT_ASSERT_NOT_NULL(pipeline);
+
+    char buffer[sizeof(PIPELINE_OUTPUT) + 8];
+    read_all(pipeline, buffer, sizeof(buffer));
+    AVS_UNIT_ASSERT_EQUAL_STRING(buffer, PIPELINE_OUTPUT);
+
+    /* subsequent reads keep reporting end of message */
+    size_t bytes_read;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(pipeline, &bytes_read,
+                                            &message_finished, buffer, 1));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 0);
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&pipeline));
+}
+
+AVS_UNIT_TEST(stream_pipeline, zerocopy_source) {
+    /* the inbuf stream is peeked directly by the first filter, and the second
+     * one is read into directly - no intermediate buffers are necessary */
+    avs_stream_inbuf_t *source =
+            (avs_stream_inbuf_t *) avs_malloc(sizeof(avs_stream_inbuf_t));
+    AVS_UNIT_ASSERT_NOT_NULL(source);
+    memcpy(source, &AVS_STREAM_INBUF_STATIC_INITIALIZER,
+           sizeof(avs_stream_inbuf_t));
+    avs_stream_inbuf_set_buffer(source, PIPELINE_INPUT,
+                                sizeof(PIPELINE_INPUT) - 1);
+    avs_stream_t *filters[] = {
+        upper_filter_create(false),
+        upper_filter_create(true)
+    };
+    avs_stream_t *pipeline =
+            avs_stream_pipeline_create((avs_stream_t *) source, filters,
+                                       AVS_ARRAY_SIZE(filters), 0);
+    AVS_UNIT_ASSERT_NOT_NULL(pipeline);
+
+    char value;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek(pipeline, 4, &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 'Q');
+    /* the offset is beyond what the last filter is able to buffer */
+    avs_error_t err = avs_stream_peek(pipeline, 100, &value);
+    AVS_UNIT_ASSERT_TRUE(err.category == AVS_ERRNO_CATEGORY
+                         && err.code == AVS_ENOBUFS);
+
+    char buffer[sizeof(PIPELINE_OUTPUT) + 8];
+    read_all(pipeline, buffer, sizeof(buffer));
+    AVS_UNIT_ASSERT_EQUAL_STRING(buffer, PIPELINE_OUTPUT);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&pipeline));
+}
+
+AVS_UNIT_TEST(stream_pipeline, invalid) {
+    avs_stream_t *source = trickle_source_create("");
+    avs_stream_t *filter = upper_filter_create(false);
+    AVS_UNIT_ASSERT_NULL(avs_stream_pipeline_create(source, &filter, 0, 16));
+    /* intermediate buffer is necessary for a filter without reserve() */
+    AVS_UNIT_ASSERT_NULL(avs_stream_pipeline_create(source, &filter, 1, 0));
+
+    /* ownership is only taken on success */
+    avs_stream_t *pipeline = avs_stream_pipeline_create(source, &filter, 1, 16);
+    AVS_UNIT_ASSERT_NOT_NULL(pipeline);
+    size_t bytes_read;
+    bool message_finished;
+    char buffer[4];
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(pipeline, &bytes_read,
+                                            &message_finished, buffer,
+                                            sizeof(buffer)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 0);
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&pipeline));
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include <avsystem/commons/avs_stream_membuf.h>
+#include <avsystem/commons/avs_stream_outbuf.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+typedef struct {
+    const avs_stream_v_table_t *const vtable;
+    avs_error_t result;
+    size_t write_calls;
+    size_t reset_calls;
+} mock_sink_t;
+
+static avs_error_t mock_sink_write_some(avs_stream_t *stream,
+                                        const void *buffer,
+                                        size_t *inout_data_length) {
+    (void) buffer;
+    (void) inout_data_length;
+    ++((mock_sink_t *) stream)->write_calls;
+    return ((mock_sink_t *) stream)->result;
+}
+
+static avs_error_t mock_sink_finish_message(avs_stream_t *stream) {
+    return ((mock_sink_t *) stream)->result;
+}
+
+static avs_error_t mock_sink_reset(avs_stream_t *stream) {
+    ++((mock_sink_t *) stream)->reset_calls;
+    return ((mock_sink_t *) stream)->result;
+}
+
+static const avs_stream_v_table_t mock_sink_vtable = {
+    .write_some = mock_sink_write_some,
+    .finish_message = mock_sink_finish_message,
+    .reset = mock_sink_reset,
+    AVS_STREAM_V_TABLE_NO_EXTENSIONS
+};
+
+static mock_sink_t mock_sink(avs_error_t result) {
+    return (mock_sink_t) {
+        .vtable = &mock_sink_vtable,
+        .result = result
+    };
+}
+
+static void assert_membuf_contents(avs_stream_t *membuf,
+                                   const char *expected) {
+    char buf[64];
+    size_t bytes_read;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(membuf, &bytes_read,
+                                            &message_finished, buf,
+                                            sizeof(buf)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, strlen(expected));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, expected, bytes_read);
+}
+
+AVS_UNIT_TEST(stream_tee, write_to_all_sinks) {
+    AVS_UNIT_ASSERT_NULL(avs_stream_tee_create(NULL, 0));
+    /* the size of the stream object would overflow */
+    avs_stream_t *dummy_sink = NULL;
+    AVS_UNIT_ASSERT_NULL(avs_stream_tee_create(&dummy_sink, SIZE_MAX / 2));
+
+    avs_stream_t *sinks[] = { avs_stream_membuf_create(),
+                              avs_stream_membuf_create() };
+    AVS_UNIT_ASSERT_NOT_NULL(sinks[0]);
+    AVS_UNIT_ASSERT_NOT_NULL(sinks[1]);
+    avs_stream_t *tee = avs_stream_tee_create(sinks, AVS_ARRAY_SIZE(sinks));
+    AVS_UNIT_ASSERT_NOT_NULL(tee);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(tee, "Hello, ", 7));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(tee, "world", 5));
+    const avs_stream_const_iovec_t iov[] = { { "!", 1 }, { "?", 1 } };
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_writev(tee, iov, AVS_ARRAY_SIZE(iov)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(tee));
+
+    /* cleaning up the tee stream does not affect the sinks */
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&tee));
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(sinks); ++i) {
+        assert_membuf_contents(sinks[i], "Hello, world!?");
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&sinks[i]));
+    }
+}
+
+AVS_UNIT_TEST(stream_tee, first_sink_limits_write) {
+    char buf[4];
+    avs_stream_outbuf_t outbuf = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+    avs_stream_outbuf_set_buffer(&outbuf, buf, sizeof(buf));
+    avs_stream_t *sinks[] = { (avs_stream_t *) &outbuf,
+                              avs_stream_membuf_create() };
+    AVS_UNIT_ASSERT_NOT_NULL(sinks[1]);
+    avs_stream_t *tee = avs_stream_tee_create(sinks, AVS_ARRAY_SIZE(sinks));
+    AVS_UNIT_ASSERT_NOT_NULL(tee);
+
+    size_t length = 6;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write_some(tee, "abcdef", &length));
+    AVS_UNIT_ASSERT_EQUAL(length, sizeof(buf));
+    AVS_UNIT_ASSERT_EQUAL_BYTES(buf, "abcd");
+    /* the other sinks receive only what the first one accepted */
+    assert_membuf_contents(sinks[1], "abcd");
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_reset(tee));
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&outbuf), 0);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&tee));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&sinks[1]));
+}
+
+AVS_UNIT_TEST(stream_tee, sink_errors) {
+    mock_sink_t ok = mock_sink(AVS_OK);
+    mock_sink_t failing = mock_sink(avs_errno(AVS_EIO));
+    mock_sink_t last = mock_sink(AVS_OK);
+    avs_stream_t *sinks[] = { (avs_stream_t *) &ok, (avs_stream_t *) &failing,
+                              (avs_stream_t *) &last };
+    avs_stream_t *tee = avs_stream_tee_create(sinks, AVS_ARRAY_SIZE(sinks));
+    AVS_UNIT_ASSERT_NOT_NULL(tee);
+
+    /* writing stops at the first failing sink */
+    avs_error_t err = avs_stream_write(tee, "data", 4);
+    AVS_UNIT_ASSERT_TRUE(err.category == AVS_ERRNO_CATEGORY
+                         && err.code == AVS_EIO);
+    AVS_UNIT_ASSERT_EQUAL(ok.write_calls, 1);
+    AVS_UNIT_ASSERT_EQUAL(failing.write_calls, 1);
+    AVS_UNIT_ASSERT_EQUAL(last.write_calls, 0);
+
+    /* vectored writes are attempted on all sinks */
+    const avs_stream_const_iovec_t iov[] = { { "da", 2 }, { "ta", 2 } };
+    err = avs_stream_writev(tee, iov, AVS_ARRAY_SIZE(iov));
+    AVS_UNIT_ASSERT_TRUE(err.category == AVS_ERRNO_CATEGORY
+                         && err.code == AVS_EIO);
+    AVS_UNIT_ASSERT_TRUE(ok.write_calls > 1);
+    AVS_UNIT_ASSERT_TRUE(failing.write_calls > 1);
+    AVS_UNIT_ASSERT_TRUE(last.write_calls > 0);
+
+    /* reset and finish_message are attempted on all sinks */
+    AVS_UNIT_ASSERT_FAILED(avs_stream_finish_message(tee));
+    AVS_UNIT_ASSERT_FAILED(avs_stream_reset(tee));
+    AVS_UNIT_ASSERT_EQUAL(ok.reset_calls, 1);
+    AVS_UNIT_ASSERT_EQUAL(failing.reset_calls, 1);
+    AVS_UNIT_ASSERT_EQUAL(last.reset_calls, 1);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&tee));
+}
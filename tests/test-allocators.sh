@@ -0,0 +1,57 @@
+#!/usr/bin/env bash
+#
+# Copyright 2021 AVSystem <avsystem@avsystem.com>
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Builds the library with pluggable allocators in a separate directory, with
+# tests and libc symbol poisoning enabled, and runs the unit tests of the
+# modules that use them. TLS backends are disabled, as their headers are not
+# guaranteed to be compatible with poisoning.
+
+set -e
+
+canonicalize() {
+    echo "$(cd "$(dirname "$1")" && pwd -P)/$(basename "$1")"
+}
+
+SCRIPT_DIR="$(dirname "$(canonicalize "$0")")"
+ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+
+TESTS=(avs_utils avs_buffer avs_stream avs_sched avs_persistence
+       avs_compat_threading_pthread)
+
+test_allocators() {
+    # test_allocators cmake_options...
+    local TEMP_DIR
+    TEMP_DIR="$(mktemp -d)"
+
+    pushd "$TEMP_DIR"
+        cmake -D WITH_TEST=ON \
+              -D WITH_POISONING=ON \
+              -D WITH_EXTRA_WARNINGS=ON \
+              -D WITH_AVS_ALLOCATORS=ON \
+              -D WITH_AVS_CRYPTO=OFF \
+              -D WITH_OPENSSL=OFF \
+              -D WITH_MBEDTLS=OFF \
+              "$@" "$ROOT_DIR"
+        cmake --build . -- -j"$(nproc)" all "${TESTS[@]/%/_test}"
+        ctest --output-on-failure \
+              -R "^($(IFS='|'; echo "${TESTS[*]}"))_test$"
+    popd
+
+    rm -rf "$TEMP_DIR"
+}
+
+test_allocators
+test_allocators -D WITH_AVS_MEMORY_STATS=ON
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#ifdef AVS_COMMONS_UTILS_WITH_ALLOCATORS
+
+#    include <string.h>
+
+#    include <avsystem/commons/avs_allocator.h>
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_unit_test.h>
+
+typedef struct {
+    avs_allocator_t allocator;
+    size_t allocs;
+    size_t frees;
+} counting_allocator_t;
+
+static void *counting_alloc(avs_allocator_t *allocator, size_t size) {
+    ++((counting_allocator_t *) allocator)->allocs;
+    return avs_allocator_system()->vtable->alloc_fn(avs_allocator_system(),
+                                                    size);
+}
+
+static void counting_free(avs_allocator_t *allocator, void *ptr, size_t size) {
+    ++((counting_allocator_t *) allocator)->frees;
+    avs_allocator_system()->vtable->free_fn(avs_allocator_system(), ptr, size);
+}
+
+static const avs_allocator_v_table_t counting_allocator_vtable = {
+    .alloc_fn = counting_alloc,
+    .free_fn = counting_free
+};
+
+AVS_UNIT_TEST(allocator, free_returns_to_owner) {
+    counting_allocator_t counting = {
+        .allocator = { &counting_allocator_vtable }
+    };
+    AVS_UNIT_ASSERT_TRUE(avs_memory_get_allocator(AVS_MEMORY_SUBSYSTEM_NET)
+                         == avs_allocator_system());
+
+    avs_memory_set_allocator(AVS_MEMORY_SUBSYSTEM_DEFAULT,
+                             &counting.allocator);
+    AVS_UNIT_ASSERT_TRUE(avs_memory_get_allocator(AVS_MEMORY_SUBSYSTEM_NET)
+                         == &counting.allocator);
+    char *ptr = (char *) avs_malloc(10);
+    avs_memory_set_allocator(AVS_MEMORY_SUBSYSTEM_DEFAULT, NULL);
+    AVS_UNIT_ASSERT_NOT_NULL(ptr);
+    AVS_UNIT_ASSERT_EQUAL(counting.allocs, 1);
+
+    /* no realloc in vtable - emulated with alloc, copy and free */
+    memcpy(ptr, "0123456789", 10);
+    ptr = (char *) avs_realloc(ptr, 100);
+    AVS_UNIT_ASSERT_NOT_NULL(ptr);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(ptr, "0123456789", 10);
+    AVS_UNIT_ASSERT_EQUAL(counting.allocs, 2);
+    AVS_UNIT_ASSERT_EQUAL(counting.frees, 1);
+
+    /* freed to the allocator it came from, even though it's not installed */
+    avs_free(ptr);
+    AVS_UNIT_ASSERT_EQUAL(counting.frees, 2);
+}
+
+AVS_UNIT_TEST(allocator, calloc_overflow) {
+    AVS_UNIT_ASSERT_NULL(avs_calloc(SIZE_MAX / 2, 4));
+    AVS_UNIT_ASSERT_NULL(avs_malloc(SIZE_MAX - 4));
+}
+
+AVS_UNIT_TEST(allocator, arena) {
+    avs_allocator_t *arena;
+    AVS_UNIT_ASSERT_SUCCESS(avs_arena_allocator_create(&arena, NULL, 256, 0));
+
+    char *a = (char *) avs_allocator_malloc(arena, 10);
+    char *b = (char *) avs_allocator_calloc(arena, 4, 10);
+    AVS_UNIT_ASSERT_NOT_NULL(a);
+    AVS_UNIT_ASSERT_NOT_NULL(b);
+    AVS_UNIT_ASSERT_TRUE(b > a);
+    AVS_UNIT_ASSERT_EQUAL((uintptr_t) b % AVS_ALIGNOF(avs_max_align_t), 0);
+    size_t used = avs_arena_allocator_bytes_used(arena);
+
+    /* the most recent block may grow in place */
+    char *b2 = (char *) avs_realloc(b, 80);
+    AVS_UNIT_ASSERT_TRUE(b2 == b);
+    AVS_UNIT_ASSERT_TRUE(avs_arena_allocator_bytes_used(arena) > used);
+
+    /* freeing the most recent block gives the space back */
+    avs_free(b2);
+    AVS_UNIT_ASSERT_EQUAL(avs_arena_allocator_bytes_used(arena),
+                          (size_t) (b - a));
+    avs_free(a);
+
+    /* allocations larger than chunk size get a dedicated chunk */
+    AVS_UNIT_ASSERT_NOT_NULL(avs_allocator_malloc(arena, 1000));
+    AVS_UNIT_ASSERT_TRUE(avs_arena_allocator_bytes_reserved(arena) > 1000);
+
+    avs_arena_allocator_reset(arena);
+    AVS_UNIT_ASSERT_EQUAL(avs_arena_allocator_bytes_used(arena), 0);
+    AVS_UNIT_ASSERT_TRUE(avs_arena_allocator_bytes_reserved(arena) < 1000);
+
+    avs_arena_allocator_cleanup(&arena);
+    AVS_UNIT_ASSERT_NULL(arena);
+}
+
+AVS_UNIT_TEST(allocator, arena_limit) {
+    avs_allocator_t *arena;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_arena_allocator_create(&arena, NULL, 256, 1024));
+    while (avs_allocator_malloc(arena, 100)) {
+    }
+    AVS_UNIT_ASSERT_TRUE(avs_arena_allocator_bytes_reserved(arena) <= 1024);
+    AVS_UNIT_ASSERT_TRUE(avs_arena_allocator_bytes_reserved(arena) >= 512);
+    avs_arena_allocator_cleanup(&arena);
+}
+
+AVS_UNIT_TEST(allocator, subsystem_arena) {
+    avs_allocator_t *arena;
+    AVS_UNIT_ASSERT_SUCCESS(avs_arena_allocator_create(&arena, NULL, 256, 0));
+    avs_memory_set_allocator(AVS_MEMORY_SUBSYSTEM_SCHED, arena);
+    AVS_UNIT_ASSERT_TRUE(avs_memory_get_allocator(AVS_MEMORY_SUBSYSTEM_SCHED)
+                         == arena);
+    AVS_UNIT_ASSERT_TRUE(avs_memory_get_allocator(AVS_MEMORY_SUBSYSTEM_HTTP)
+                         == avs_allocator_system());
+    avs_memory_set_allocator(AVS_MEMORY_SUBSYSTEM_SCHED, NULL);
+    avs_arena_allocator_cleanup(&arena);
+}
+
+AVS_UNIT_TEST(allocator, slab) {
+    avs_allocator_t *slab;
+    AVS_UNIT_ASSERT_FAILED(avs_slab_allocator_create(&slab, NULL, 256, 512));
+    AVS_UNIT_ASSERT_SUCCESS(avs_slab_allocator_create(&slab, NULL, 4096, 256));
+
+    void *a = avs_allocator_malloc(slab, 20);
+    void *b = avs_allocator_malloc(slab, 20);
+    AVS_UNIT_ASSERT_NOT_NULL(a);
+    AVS_UNIT_ASSERT_NOT_NULL(b);
+    AVS_UNIT_ASSERT_TRUE(a != b);
+    AVS_UNIT_ASSERT_EQUAL(avs_slab_allocator_bytes_reserved(slab), 4096);
+
+    /* freed blocks are reused for requests of the same size class */
+    avs_free(a);
+    void *c = avs_allocator_malloc(slab, 18);
+    AVS_UNIT_ASSERT_TRUE(c == a);
+
+    /* resizing within the size class does not move the block */
+    AVS_UNIT_ASSERT_TRUE(avs_realloc(c, 20) == c);
+
+    /* large requests bypass slabs */
+    void *large = avs_allocator_malloc(slab, 10000);
+    AVS_UNIT_ASSERT_NOT_NULL(large);
+    AVS_UNIT_ASSERT_EQUAL(avs_slab_allocator_bytes_reserved(slab), 4096);
+    memset(large, 0, 10000);
+    large = avs_realloc(large, 20000);
+    AVS_UNIT_ASSERT_NOT_NULL(large);
+    avs_free(large);
+
+    avs_free(b);
+    avs_free(c);
+    avs_slab_allocator_cleanup(&slab);
+    AVS_UNIT_ASSERT_NULL(slab);
+}
+
+#endif // AVS_COMMONS_UTILS_WITH_ALLOCATORS
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#ifdef AVS_COMMONS_UTILS_WITH_MEMORY_STATS
+
+#    include <avsystem/commons/avs_allocator.h>
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_memory_stats.h>
+#    include <avsystem/commons/avs_unit_test.h>
+#    include <avsystem/commons/avs_utils.h>
+
+static avs_allocator_t *default_allocator(void) {
+    return avs_memory_get_allocator(AVS_MEMORY_SUBSYSTEM_DEFAULT);
+}
+
+AVS_UNIT_TEST(memory_stats, tagged) {
+    avs_memory_stats_t stats;
+    AVS_UNIT_ASSERT_FAILED(avs_memory_stats_get("test_tagged", &stats));
+
+    void *a = avs_allocator_malloc_tagged(default_allocator(), 10,
+                                          "test_tagged");
+    void *b = avs_allocator_calloc_tagged(default_allocator(), 10, 10,
+                                          "test_tagged");
+    AVS_UNIT_ASSERT_NOT_NULL(a);
+    AVS_UNIT_ASSERT_NOT_NULL(b);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_memory_stats_get("test_tagged", &stats));
+    AVS_UNIT_ASSERT_EQUAL_STRING(stats.tag, "test_tagged");
+    AVS_UNIT_ASSERT_EQUAL(stats.live_bytes, 110);
+    AVS_UNIT_ASSERT_EQUAL(stats.peak_bytes, 110);
+    AVS_UNIT_ASSERT_EQUAL(stats.live_allocations, 2);
+    AVS_UNIT_ASSERT_EQUAL(stats.total_allocations, 2);
+    /* 10 bytes fall into bucket 0 (up to 16), 100 bytes into bucket 3
+     * (65..128) */
+    AVS_UNIT_ASSERT_EQUAL(stats.histogram[0], 1);
+    AVS_UNIT_ASSERT_EQUAL(stats.histogram[3], 1);
+
+    avs_free(a);
+    AVS_UNIT_ASSERT_SUCCESS(avs_memory_stats_get("test_tagged", &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.live_bytes, 100);
+    AVS_UNIT_ASSERT_EQUAL(stats.peak_bytes, 110);
+    AVS_UNIT_ASSERT_EQUAL(stats.live_allocations, 1);
+    AVS_UNIT_ASSERT_EQUAL(stats.total_allocations, 2);
+
+    avs_memory_stats_reset_peak();
+    AVS_UNIT_ASSERT_SUCCESS(avs_memory_stats_get("test_tagged", &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.peak_bytes, 100);
+
+    avs_free(b);
+    AVS_UNIT_ASSERT_SUCCESS(avs_memory_stats_get("test_tagged", &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.live_bytes, 0);
+    AVS_UNIT_ASSERT_EQUAL(stats.live_allocations, 0);
+}
+
+AVS_UNIT_TEST(memory_stats, realloc) {
+    char *ptr = (char *) avs_allocator_realloc_tagged(default_allocator(), NULL,
+                                                      50, "test_realloc");
+    AVS_UNIT_ASSERT_NOT_NULL(ptr);
+    ptr = (char *) avs_realloc(ptr, 200);
+    AVS_UNIT_ASSERT_NOT_NULL(ptr);
+
+    avs_memory_stats_t stats;
+    AVS_UNIT_ASSERT_SUCCESS(avs_memory_stats_get("test_realloc", &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.live_bytes, 200);
+    AVS_UNIT_ASSERT_EQUAL(stats.peak_bytes, 200);
+    AVS_UNIT_ASSERT_EQUAL(stats.live_allocations, 1);
+
+    ptr = (char *) avs_realloc(ptr, 20);
+    AVS_UNIT_ASSERT_SUCCESS(avs_memory_stats_get("test_realloc", &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.live_bytes, 20);
+    AVS_UNIT_ASSERT_EQUAL(stats.peak_bytes, 200);
+
+    avs_free(ptr);
+    AVS_UNIT_ASSERT_SUCCESS(avs_memory_stats_get("test_realloc", &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.live_bytes, 0);
+    AVS_UNIT_ASSERT_EQUAL(stats.live_allocations, 0);
+}
+
+AVS_UNIT_TEST(memory_stats, untagged) {
+    avs_memory_stats_t before;
+    avs_memory_stats_t after;
+    avs_memory_stats_get_total(&before);
+    AVS_UNIT_ASSERT_NULL(before.tag);
+
+    void *ptr = avs_allocator_malloc(default_allocator(), 1000);
+    AVS_UNIT_ASSERT_NOT_NULL(ptr);
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_memory_stats_get(AVS_MEMORY_STATS_UNTAGGED, &after));
+    AVS_UNIT_ASSERT_TRUE(after.live_bytes >= 1000);
+
+    avs_memory_stats_get_total(&after);
+    AVS_UNIT_ASSERT_EQUAL(after.live_bytes, before.live_bytes + 1000);
+    AVS_UNIT_ASSERT_EQUAL(after.live_allocations, before.live_allocations + 1);
+    avs_free(ptr);
+}
+
+AVS_UNIT_TEST(memory_stats, module_tag) {
+    avs_memory_stats_t before = { 0 };
+    avs_memory_stats_t after;
+    avs_memory_stats_get("avs_utils", &before);
+
+    /* avs_strdup() is implemented in avs_utils */
+    char *str = avs_strdup("test");
+    AVS_UNIT_ASSERT_NOT_NULL(str);
+    AVS_UNIT_ASSERT_SUCCESS(avs_memory_stats_get("avs_utils", &after));
+    AVS_UNIT_ASSERT_EQUAL(after.live_bytes, before.live_bytes + 5);
+    AVS_UNIT_ASSERT_EQUAL(after.live_allocations, before.live_allocations + 1);
+    avs_free(str);
+}
+
+AVS_UNIT_TEST(memory_stats, dump_due) {
+    avs_memory_stats_set_dump_period(4);
+    AVS_UNIT_ASSERT_FALSE(avs_memory_stats_dump_due());
+    void *ptrs[8];
+    size_t due_count = 0;
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(ptrs); ++i) {
+        ptrs[i] = avs_allocator_malloc_tagged(default_allocator(), 1,
+                                              "test_dump_due");
+        if (avs_memory_stats_dump_due()) {
+            ++due_count;
+        }
+    }
+    AVS_UNIT_ASSERT_EQUAL(due_count, 2);
+    avs_memory_stats_set_dump_period(0);
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(ptrs); ++i) {
+        avs_free(ptrs[i]);
+    }
+    AVS_UNIT_ASSERT_FALSE(avs_memory_stats_dump_due());
+
+    /* smoke test of the bundled dump function */
+    avs_memory_stats_log();
+}
+
+#endif // AVS_COMMONS_UTILS_WITH_MEMORY_STATS
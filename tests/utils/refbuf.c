@@ -0,0 +1,108 @@
+/*
+ * Copyright 2021 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#include <string.h>
+
+#include <avsystem/commons/avs_memory.h>
+#include <avsystem/commons/avs_refbuf.h>
+
+#define AVS_UNIT_ENABLE_SHORT_ASSERTS
+#include <avsystem/commons/avs_unit_test.h>
+
+AVS_UNIT_TEST(refbuf, refcount) {
+    avs_refbuf_t *buf = avs_refbuf_new(64);
+    ASSERT_NOT_NULL(buf);
+    ASSERT_EQ(avs_refbuf_size(buf), 64);
+    ASSERT_TRUE(avs_refbuf_is_unique(buf));
+    // use valgrind/ASAN to check for out-of-bounds accesses
+    memset(avs_refbuf_data(buf), 0xDD, 64);
+
+    avs_refbuf_t *ref = avs_refbuf_ref(buf);
+    ASSERT_TRUE(ref == buf);
+    ASSERT_FALSE(avs_refbuf_is_unique(buf));
+
+    avs_refbuf_unref(&ref);
+    ASSERT_NULL(ref);
+    ASSERT_TRUE(avs_refbuf_is_unique(buf));
+    // not a wrapped buffer
+    ASSERT_NULL(avs_refbuf_unwrap(&buf));
+    ASSERT_NOT_NULL(buf);
+
+    avs_refbuf_unref(&buf);
+    ASSERT_NULL(buf);
+    avs_refbuf_unref(&buf);
+}
+
+AVS_UNIT_TEST(refbuf, slices) {
+    avs_refbuf_t *buf = avs_refbuf_new(10);
+    ASSERT_NOT_NULL(buf);
+    memcpy(avs_refbuf_data(buf), "0123456789", 10);
+
+    avs_refbuf_slice_t slice;
+    ASSERT_FAIL(avs_refbuf_slice(&slice, buf, 5, 6));
+    ASSERT_NULL(slice.buffer);
+    ASSERT_OK(avs_refbuf_slice(&slice, buf, 2, 6));
+    ASSERT_EQ_BYTES_SIZED(slice.data, "234567", 6);
+
+    avs_refbuf_slice_t sub;
+    ASSERT_FAIL(avs_refbuf_slice_sub(&sub, &slice, 6, 1));
+    ASSERT_OK(avs_refbuf_slice_sub(&sub, &slice, 1, 3));
+    ASSERT_EQ_BYTES_SIZED(sub.data, "345", 3);
+
+    // narrowing a slice in place does not acquire a new reference
+    ASSERT_OK(avs_refbuf_slice_sub(&slice, &slice, 4, 2));
+    ASSERT_EQ_BYTES_SIZED(slice.data, "67", 2);
+
+    // slices outlive the original reference
+    avs_refbuf_unref(&buf);
+    ASSERT_FALSE(avs_refbuf_is_unique(slice.buffer));
+    avs_refbuf_slice_release(&sub);
+    ASSERT_NULL(sub.buffer);
+    ASSERT_EQ(sub.size, 0);
+    ASSERT_TRUE(avs_refbuf_is_unique(slice.buffer));
+    ASSERT_EQ_BYTES_SIZED(slice.data, "67", 2);
+    avs_refbuf_slice_release(&slice);
+
+    avs_refbuf_slice_t empty = AVS_REFBUF_SLICE_EMPTY;
+    avs_refbuf_slice_release(&empty);
+}
+
+AVS_UNIT_TEST(refbuf, wrap) {
+    char *data = (char *) avs_malloc(4);
+    ASSERT_NOT_NULL(data);
+    avs_refbuf_t *buf = avs_refbuf_wrap(data, 4);
+    ASSERT_NOT_NULL(buf);
+    ASSERT_TRUE(avs_refbuf_data(buf) == data);
+
+    avs_refbuf_slice_t slice;
+    ASSERT_OK(avs_refbuf_slice(&slice, buf, 0, 4));
+    ASSERT_NULL(avs_refbuf_unwrap(&buf));
+    ASSERT_NOT_NULL(buf);
+
+    avs_refbuf_slice_release(&slice);
+    ASSERT_TRUE(avs_refbuf_unwrap(&buf) == data);
+    ASSERT_NULL(buf);
+    avs_free(data);
+
+    // wrapped memory is freed along with the last reference
+    data = (char *) avs_malloc(4);
+    ASSERT_NOT_NULL(data);
+    buf = avs_refbuf_wrap(data, 4);
+    ASSERT_NOT_NULL(buf);
+    avs_refbuf_unref(&buf);
+}
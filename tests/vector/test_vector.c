@@ -153,6 +153,93 @@ AVS_UNIT_TEST(avs_vector, vector_remove) {
     AVS_VECTOR_DELETE(&v);
 }
 
+typedef struct {
+    char payload[100];
+    int id;
+} large_elem_t;
+
+AVS_UNIT_TEST(avs_vector, vector_remove_large_elements) {
+    AVS_VECTOR(large_elem_t) v = AVS_VECTOR_NEW(large_elem_t);
+    large_elem_t elem;
+    large_elem_t *removed;
+    int i;
+    AVS_UNIT_ASSERT_NOT_NULL(v);
+    for (i = 0; i < 5; ++i) {
+        memset(elem.payload, 'a' + i, sizeof(elem.payload));
+        elem.id = i;
+        AVS_UNIT_ASSERT_SUCCESS(AVS_VECTOR_PUSH(&v, &elem));
+    }
+    removed = AVS_VECTOR_REMOVE_AT(&v, 1);
+    AVS_UNIT_ASSERT_EQUAL(removed->id, 1);
+    AVS_UNIT_ASSERT_EQUAL(removed->payload[sizeof(removed->payload) - 1], 'b');
+    AVS_UNIT_ASSERT_EQUAL(AVS_VECTOR_SIZE(v), 4);
+    AVS_UNIT_ASSERT_EQUAL((*v)[0].id, 0);
+    AVS_UNIT_ASSERT_EQUAL((*v)[1].id, 2);
+    AVS_UNIT_ASSERT_EQUAL((*v)[1].payload[0], 'c');
+    AVS_UNIT_ASSERT_EQUAL((*v)[2].id, 3);
+    AVS_UNIT_ASSERT_EQUAL((*v)[3].id, 4);
+    AVS_UNIT_ASSERT_EQUAL((*v)[3].payload[0], 'e');
+    AVS_VECTOR_DELETE(&v);
+}
+
+AVS_UNIT_TEST(avs_vector, vector_swap_remove) {
+    AVS_VECTOR(int) v = AVS_VECTOR_NEW(int);
+    int i, *elem;
+    AVS_UNIT_ASSERT_NOT_NULL(v);
+    for (i = 0; i < 5; ++i) {
+        AVS_VECTOR_PUSH(&v, &i);
+    }
+    elem = AVS_VECTOR_SWAP_REMOVE_AT(&v, 1);
+    AVS_UNIT_ASSERT_EQUAL(*elem, 1);
+    AVS_UNIT_ASSERT_EQUAL(AVS_VECTOR_SIZE(v), 4);
+    AVS_UNIT_ASSERT_EQUAL((*v)[0], 0);
+    AVS_UNIT_ASSERT_EQUAL((*v)[1], 4);
+    AVS_UNIT_ASSERT_EQUAL((*v)[2], 2);
+    AVS_UNIT_ASSERT_EQUAL((*v)[3], 3);
+
+    elem = AVS_VECTOR_SWAP_REMOVE_AT(&v, 3);
+    AVS_UNIT_ASSERT_EQUAL(*elem, 3);
+    AVS_UNIT_ASSERT_EQUAL(AVS_VECTOR_SIZE(v), 3);
+
+    while (AVS_VECTOR_SIZE(v) > 0) {
+        AVS_UNIT_ASSERT_NOT_NULL(AVS_VECTOR_SWAP_REMOVE_AT(&v, 0));
+    }
+    AVS_UNIT_ASSERT_NULL(AVS_VECTOR_SWAP_REMOVE_AT(&v, 0));
+
+    AVS_VECTOR_DELETE(&v);
+}
+
+static int is_divisible(void *elem, void *arg) {
+    return *(int *) elem % *(int *) arg == 0;
+}
+
+AVS_UNIT_TEST(avs_vector, vector_remove_if) {
+    AVS_VECTOR(int) v = AVS_VECTOR_NEW(int);
+    int i;
+    int divisor = 3;
+    AVS_UNIT_ASSERT_NOT_NULL(v);
+    AVS_UNIT_ASSERT_EQUAL(AVS_VECTOR_REMOVE_IF(&v, is_divisible, &divisor), 0);
+    for (i = 0; i < 10; ++i) {
+        AVS_VECTOR_PUSH(&v, &i);
+    }
+    AVS_UNIT_ASSERT_EQUAL(AVS_VECTOR_REMOVE_IF(&v, is_divisible, &divisor), 4);
+    AVS_UNIT_ASSERT_EQUAL(AVS_VECTOR_SIZE(v), 6);
+    AVS_UNIT_ASSERT_EQUAL((*v)[0], 1);
+    AVS_UNIT_ASSERT_EQUAL((*v)[1], 2);
+    AVS_UNIT_ASSERT_EQUAL((*v)[2], 4);
+    AVS_UNIT_ASSERT_EQUAL((*v)[3], 5);
+    AVS_UNIT_ASSERT_EQUAL((*v)[4], 7);
+    AVS_UNIT_ASSERT_EQUAL((*v)[5], 8);
+
+    AVS_UNIT_ASSERT_EQUAL(AVS_VECTOR_REMOVE_IF(&v, is_divisible, &divisor), 0);
+    AVS_UNIT_ASSERT_EQUAL(AVS_VECTOR_SIZE(v), 6);
+
+    divisor = 1;
+    AVS_UNIT_ASSERT_EQUAL(AVS_VECTOR_REMOVE_IF(&v, is_divisible, &divisor), 6);
+    AVS_UNIT_ASSERT_EQUAL(AVS_VECTOR_SIZE(v), 0);
+    AVS_VECTOR_DELETE(&v);
+}
+
 static int decreasing(const void *a, const void *b) {
     const int *p = (const int *) a;
     const int *q = (const int *) b;